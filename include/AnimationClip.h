@@ -0,0 +1,138 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/ext.hpp>
+
+/**
+ * @brief Where one track's keyframes lie in a clip's key arrays.
+ */
+struct KeyRange {
+	uint32_t first{ 0 };
+	uint32_t count{ 0 };
+};
+
+/**
+ * @brief The keyframes that animate one joint: a track each for its translation, rotation and
+ * scale. A track with no keys leaves that part of the joint's bind transformation as it is.
+ */
+struct ClipChannel {
+	uint32_t joint;
+	KeyRange translation;
+	KeyRange rotation;
+	KeyRange scale;
+};
+
+/**
+ * @brief A keyframed animation of a skeleton's joints, such as a glTF animation.
+ *
+ * Keys are stored structure-of-arrays: every track's times in one array and their values in
+ * another, one pair of arrays per kind of track, with each track's keys contiguous and in time
+ * order. Finding a track's current key touches only its times, and the two values either side of
+ * it are adjacent.
+ */
+class AnimationClip {
+private:
+	std::string m_name;
+	// Seconds.
+	float m_duration;
+	std::vector<ClipChannel> m_channels{};
+
+	std::vector<float> m_translationTimes{};
+	std::vector<glm::vec3> m_translations{};
+	std::vector<float> m_rotationTimes{};
+	std::vector<glm::quat> m_rotations{};
+	std::vector<float> m_scaleTimes{};
+	std::vector<glm::vec3> m_scales{};
+
+public:
+	AnimationClip(std::string name, float duration);
+
+	/**
+	 * @brief Appends a joint's tracks, each given as key times in seconds and their values.
+	 */
+	void addChannel(uint32_t joint,
+		const std::vector<float>& translationTimes, const std::vector<glm::vec3>& translations,
+		const std::vector<float>& rotationTimes, const std::vector<glm::quat>& rotations,
+		const std::vector<float>& scaleTimes, const std::vector<glm::vec3>& scales);
+
+	const std::string& name() const { return m_name; }
+	float duration() const { return m_duration; }
+	const std::vector<ClipChannel>& channels() const { return m_channels; }
+
+	const std::vector<float>& translationTimes() const { return m_translationTimes; }
+	const std::vector<glm::vec3>& translations() const { return m_translations; }
+	const std::vector<float>& rotationTimes() const { return m_rotationTimes; }
+	const std::vector<glm::quat>& rotations() const { return m_rotations; }
+	const std::vector<float>& scaleTimes() const { return m_scaleTimes; }
+	const std::vector<glm::vec3>& scales() const { return m_scales; }
+
+	// The total number of keys in every track, and the bytes they take.
+	size_t keyCount() const;
+	size_t keyBytes() const;
+};
+
+/**
+ * @brief Samples one playback of a clip, remembering the key each track was last found at.
+ *
+ * Playback mostly moves forward by less than a key per frame, so the search for a track's key
+ * starts from where it was last time and usually moves at most a step: sampling costs O(1) per
+ * track. Jumping backwards, as when a looping clip wraps around, falls back to a binary search.
+ */
+class ClipSampler {
+private:
+	const AnimationClip* m_clip;
+	// The last key found in each channel's translation, rotation and scale tracks.
+	std::vector<uint32_t> m_cursors;
+	// Each channel's joint's bind translation, rotation and scale, for the parts it has no track for.
+	std::vector<glm::vec3> m_bindTranslations;
+	std::vector<glm::quat> m_bindRotations;
+	std::vector<glm::vec3> m_bindScales;
+
+public:
+	/**
+	 * @brief Prepares to sample a clip of a skeleton with the given bind transformations.
+	 */
+	ClipSampler(const AnimationClip& clip, const std::vector<glm::mat4>& bindLocals);
+
+	const AnimationClip& clip() const { return *m_clip; }
+
+	/**
+	 * @brief Writes the local transformation of every joint the clip animates, at the given time
+	 * in seconds, into locals.
+	 */
+	void sample(float time, std::vector<glm::mat4>& locals);
+};
+
+/**
+ * @brief Finds the key at or before the given time in a track of count keys, starting the search
+ * from cursor and leaving it at the key found. Returns the fraction of the way to the next key.
+ * Times may be stored in any type that compares with a float, such as quantized ticks.
+ */
+template <typename Time>
+float seekKey(const Time* times, uint32_t count, float time, uint32_t& cursor) {
+	if (cursor >= count || times[cursor] > time) {
+		// Time went backwards: search the whole track.
+		cursor = static_cast<uint32_t>(std::upper_bound(times, times + count, time,
+			[](float t, const Time& key) { return t < key; }) - times);
+		cursor = cursor > 0 ? cursor - 1 : 0;
+	}
+	while (cursor + 1 < count && times[cursor + 1] <= time) {
+		++cursor;
+	}
+	if (cursor + 1 >= count || time <= times[cursor]) {
+		return 0;
+	}
+	return (time - times[cursor]) / (times[cursor + 1] - times[cursor]);
+}
+
+/**
+ * @brief Splits a node's transformation, which has no shear, into translation, rotation and scale.
+ */
+void decomposeTransform(const glm::mat4& m, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale);
+
+/**
+ * @brief The transformation that scales, then rotates, then translates.
+ */
+glm::mat4 composeTransform(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale);
@@ -0,0 +1,34 @@
+#pragma once
+#include <assimp/scene.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/ext.hpp>
+#include "Skeleton.h"
+
+// The joint made for each node of an imported scene.
+using JointMap = std::unordered_map<const aiNode*, uint32_t>;
+
+/**
+ * @brief Converts an assimp matrix, which is row-major, to glm.
+ */
+glm::mat4 fromAssimpMatrix(const aiMatrix4x4& m);
+
+/**
+ * @brief Adds a node and everything under it to the skeleton as joints, parents first, in the
+ * same depth-first order that processAssimpNode creates objects.
+ */
+void importJoints(const aiNode* node, int32_t parent, Skeleton& skeleton, JointMap& joints);
+
+/**
+ * @brief Imports the scene's animations as uncompressed clips of the joints made for its nodes.
+ * Channels of nodes that have no joint are skipped.
+ */
+std::vector<AnimationClip> importClips(const aiScene* scene, const JointMap& joints);
+
+/**
+ * @brief Loads only the skeleton and the uncompressed animations of a model file. Needs no
+ * OpenGL context, for offline tools.
+ */
+std::vector<AnimationClip> loadAnimationClips(const std::string& path, Skeleton& skeleton);
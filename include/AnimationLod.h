@@ -0,0 +1,80 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Skeleton.h"
+
+/**
+ * @brief How often a character's clip is sampled into its pose, from most to least often.
+ */
+enum class AnimationRate {
+	// Every frame, every joint.
+	Full,
+	// Every few frames, and only the joints that move a large part of the skeleton.
+	Reduced,
+	// Never: no camera pass sees the character, so only its clip's clock advances, and it picks
+	// up from the right time once it is seen again.
+	ClockOnly,
+};
+
+/**
+ * @brief An animation update-rate level-of-detail policy. Each character is animated at the full
+ * rate until the nearest camera pass that saw it last frame is farther than reducedDistance.
+ * The defaults animate every character at the full rate.
+ */
+struct AnimationLod {
+	float reducedDistance{ std::numeric_limits<float>::max() };
+	// Frames between samples at the reduced rate.
+	uint32_t reducedInterval{ 1 };
+	// The fraction of its skeleton's reach a joint's bones must span to be sampled at the reduced
+	// rate; the joints at the ends of chains span none.
+	float majorJointReach{ 0 };
+	bool clockOnlyWhenHidden{ false };
+
+	/**
+	 * @brief The rate to animate a character at, given the distance to the nearest camera pass
+	 * that saw it, which is infinite if none did.
+	 */
+	AnimationRate select(float viewDistance) const {
+		if (std::isinf(viewDistance)) {
+			return clockOnlyWhenHidden ? AnimationRate::ClockOnly : AnimationRate::Full;
+		}
+		return viewDistance > reducedDistance ? AnimationRate::Reduced : AnimationRate::Full;
+	}
+
+	/**
+	 * @brief A mask of the skeleton's joints that are sampled at the reduced rate, for
+	 * CompressedClipSampler::sample.
+	 */
+	std::vector<uint8_t> majorJoints(const Skeleton& skeleton) const {
+		std::vector<float> reach{ skeleton.jointReach() };
+		float longest{ reach.empty() ? 0.0f : *std::max_element(reach.begin(), reach.end()) };
+		std::vector<uint8_t> mask(reach.size());
+		for (size_t j{ 0 }; j < reach.size(); ++j) {
+			mask[j] = reach[j] > 0 && reach[j] >= longest * majorJointReach;
+		}
+		return mask;
+	}
+};
+
+/**
+ * @brief Whether any of a world-space box may be inside the frustum of a view-projection matrix:
+ * false only when all eight of its corners are outside the same clip plane.
+ */
+inline bool boxInFrustum(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& viewProjection) {
+	uint32_t outside[6]{};
+	for (uint32_t c{ 0 }; c < 8; ++c) {
+		glm::vec4 clip{ viewProjection * glm::vec4{ c & 1 ? boundsMax.x : boundsMin.x,
+			c & 2 ? boundsMax.y : boundsMin.y, c & 4 ? boundsMax.z : boundsMin.z, 1.0f } };
+		outside[0] += clip.x < -clip.w;
+		outside[1] += clip.x > clip.w;
+		outside[2] += clip.y < -clip.w;
+		outside[3] += clip.y > clip.w;
+		outside[4] += clip.z < -clip.w;
+		outside[5] += clip.z > clip.w;
+	}
+	return std::none_of(std::begin(outside), std::end(outside), [](uint32_t count) { return count == 8; });
+}
@@ -1,62 +1,114 @@
 #pragma once
+#include <cstdint>
+#include <functional>
 #include <memory>
-#include "Animation.h"
-#include "RotationAnimation.h"
+#include <vector>
+#include "Object3D.h"
+#include "WorkerPool.h"
 
+/**
+ * @brief Animation tracks of one kind in parallel arrays. Each track changes one attribute of an
+ * object at a constant rate, over an interval of the sequence it belongs to.
+ */
+struct TrackBatch {
+	// The sequence each track belongs to, and the object it changes, as an index of the animator's
+	// targets.
+	std::vector<uint32_t> sequences{};
+	std::vector<uint32_t> targets{};
+	// The interval of its sequence's time over which each track is active.
+	std::vector<float> starts{};
+	std::vector<float> ends{};
+	// How much each track changes its attribute per second.
+	std::vector<glm::vec3> rates{};
+	// How much each track changed its attribute over the last tick.
+	std::vector<glm::vec3> deltas{};
+
+	size_t size() const { return sequences.size(); }
+	void add(uint32_t sequence, uint32_t target, float start, float end, const glm::vec3& rate);
+};
+
+/**
+ * @brief Plays sequences of animations on a scene's objects, each animation starting when the one
+ * before it in its sequence ends.
+ *
+ * Rather than one object per animation, the animator keeps a batch of tracks per kind of
+ * animation, and ticks a whole batch in one loop with no virtual calls: each track's change is
+ * its rate times how much of the tick falls within its interval. Batches of more than
+ * PARALLEL_TRACKS tracks are split across a worker pool. The changes are then summed per object
+ * into the animator's arrays of position and orientation offsets, and each object that moved is
+ * written once.
+ */
 class Animator {
 private:
+	// Each sequence's current time, the time at which its last animation ends, and whether it is
+	// playing.
+	std::vector<float> m_sequenceTimes{};
+	std::vector<float> m_sequenceLengths{};
+	std::vector<uint8_t> m_sequenceRunning{};
+	// The interval of each sequence's time that the current tick covers; empty if it is stopped.
+	std::vector<float> m_tickStarts{};
+	std::vector<float> m_tickEnds{};
+
+	TrackBatch m_translations{};
+	TrackBatch m_rotations{};
+
+	// The objects the tracks animate, and the offsets to their positions and orientations that
+	// the current tick has accumulated.
+	std::vector<Object3D*> m_targets{};
+	std::vector<glm::vec3> m_moves{};
+	std::vector<glm::vec3> m_turns{};
+
+	// Created the first time a batch is large enough to need it.
+	std::unique_ptr<WorkerPool> m_pool{};
+
+	// Called with each sequence that stops, once the tick has moved its objects.
+	std::function<void(uint32_t)> m_finishedCallback{};
+	std::vector<uint32_t> m_finished{};
+
+	// The index of an object among the targets, which adds it if it is new.
+	uint32_t targetIndex(Object3D& object);
+	// Lengthens a sequence by an animation of the given duration, and returns when it starts.
+	float appendInterval(uint32_t sequence, float duration);
+	void evaluate(TrackBatch& batch);
+
+public:
+	static constexpr size_t PARALLEL_TRACKS{ 4096 };
+	static constexpr size_t PARALLEL_GRAIN{ 1024 };
+
 	/**
-	 * @brief How much time has elapsed since the animation started.
-	 */
-	float m_currentTime;
-	/**
-	 * @brief The time at which we transition to the next animation.
-	 */
-	float m_nextTransition;
-	/**
-	 * @brief The sequence of animations to play.
-	 */
-	std::vector<std::unique_ptr<Animation>> m_animations;
-	/**
-	 * @brief The current (active) animation.
-	 */
-	Animation* m_currentAnimation;
-	/**
-	 * @brief The index of the current animation.
+	 * @brief Adds an empty sequence, and returns its index.
 	 */
-	int32_t m_currentIndex;
+	uint32_t addSequence();
 
 	/**
-	 * @brief Activate the next animation.
+	 * @brief Adds an animation to the end of a sequence that moves an object by the given offset,
+	 * at a constant speed over the given duration.
 	 */
-	void nextAnimation();
+	void addTranslation(uint32_t sequence, Object3D& object, float duration, const glm::vec3& moveBy);
 
-public:
 	/**
-	 * @brief Constructs an Animator that acts on the given object.
+	 * @brief Adds an animation to the end of a sequence that rotates an object by the given total
+	 * rotation angles, at a constant rate over the given duration.
 	 */
-	Animator() :
-		m_currentTime(0),
-		m_nextTransition(0),
-		m_currentIndex(-1),
-		m_currentAnimation(nullptr) {
-	}
+	void addRotation(uint32_t sequence, Object3D& object, float duration, const glm::vec3& totalRotation);
 
 	/**
-	 * @brief Add an Animation to the end of the animation sequence.
+	 * @brief Plays a sequence from its beginning, on future tick() calls.
 	 */
-	void addAnimation(std::unique_ptr<Animation> animation) {
-		m_animations.emplace_back(std::move(animation));
-	}
+	void start(uint32_t sequence);
+
+	bool isRunning(uint32_t sequence) const { return m_sequenceRunning[sequence] != 0; }
+	size_t sequenceCount() const { return m_sequenceTimes.size(); }
+	size_t trackCount() const { return m_translations.size() + m_rotations.size(); }
 
 	/**
-	 * @brief Activate the Animator, causing its active animation to receive future tick() calls.
+	 * @brief Sets a function to call with each sequence that stops playing, at the end of the tick
+	 * in which its last animation ends.
 	 */
-	void start();
+	void setFinishedCallback(std::function<void(uint32_t)> callback) { m_finishedCallback = std::move(callback); }
 
 	/**
-	 * @brief Advance the animation sequence by the given time interval, in seconds.
+	 * @brief Advances every playing sequence by the given time interval, in seconds.
 	 */
 	void tick(float dt);
-
-};
\ No newline at end of file
+};
@@ -1,13 +1,43 @@
 #pragma once
 #include "Object3D.h"
+#include "LightmapFile.h"
+#include "AnimationImport.h"
 #include <assimp/scene.h>
 #include <unordered_map>
 #include <filesystem>
+#include <memory>
 #include <string>
 
+// Baked lighting being attached to a model's meshes, in the order they are loaded: either a
+// lightmap and its UV set, or per-vertex lighting.
+struct BakedLightingAttachment {
+	BakedLighting kind;
+	LightmapUVs uvs{};
+	Texture texture{};
+	VertexLighting vertexLighting{};
+	size_t nextMesh{ 0 };
+};
+
+// The skeleton of a skinned or animated model being loaded: every node of the model as a joint,
+// found by node, and the skins of its meshes as they are loaded.
+struct SkeletonAttachment {
+	std::shared_ptr<Skeleton> skeleton{ std::make_shared<Skeleton>() };
+	JointMap joints{};
+};
+
+/**
+ * @brief Loads a model file. If the LightmapBaker has left a lightmap (lightmap.hdr and
+ * lightmap.uv2) or vertex lighting (vertexlight.bin) next to it, that is attached to its meshes
+ * and the returned object is marked with the kind of baked lighting it has. If any of its meshes
+ * has bones, or the file has animations, the returned object carries a SkeletonPose in the bind
+ * pose, whose skeleton holds the animations as compressed clips. Meshes without bones of their
+ * own are then bound rigidly to their node, so that animating the node moves them.
+ */
 Object3D assimpLoad(const std::string& path, bool flipUVCoords);
 Object3D processAssimpNode(
 	const aiNode* node, 
 	const aiScene* scene,
 	const std::filesystem::path& modelPath,
-	std::unordered_map<std::string, Texture>& loadedTextures);
\ No newline at end of file
+	std::unordered_map<std::string, Texture>& loadedTextures,
+	BakedLightingAttachment* baked = nullptr,
+	SkeletonAttachment* skeleton = nullptr);
\ No newline at end of file
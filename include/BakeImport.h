@@ -0,0 +1,11 @@
+#pragma once
+#include <vector>
+#include "BakeScene.h"
+#include "FnafLayout.h"
+
+/**
+ * @brief Loads the meshes of a model file into world space at the given placement, for the
+ * offline bakers. Meshes come out in the same depth-first order that processAssimpNode creates
+ * them, so baked per-mesh data can be matched back up when the game loads the model.
+ */
+std::vector<BakeMesh> loadBakeMeshes(const Placement& placement);
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/ext.hpp>
+#include "PointLight.h"
+#include "TriangleBVH.h"
+
+/**
+ * @brief A static mesh in world space, as the lighting bakers see it.
+ */
+struct BakeMesh {
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<uint32_t> indices;
+	// The mesh's average diffuse color, which tints the light bouncing off it.
+	glm::vec3 albedo;
+};
+
+/**
+ * @brief The static geometry and lights that offline bakers cast rays against. All meshes go into
+ * one TriangleBVH, so every mesh shadows and bounces light onto every other.
+ *
+ * Only the lights marked as baked contribute, along with the directional light. Irradiance is
+ * computed without the surface's own albedo; shaders multiply that in at runtime.
+ */
+class BakeScene {
+private:
+	std::vector<BakeMesh> m_meshes;
+	// For every triangle in BVH order: the mesh it came from, and its geometric normal.
+	std::vector<uint32_t> m_triangleMesh;
+	std::vector<glm::vec3> m_triangleNormals;
+	std::unique_ptr<TriangleBVH> m_bvh;
+	std::vector<PointLight> m_lights;
+	glm::vec3 m_directionalLight;
+	glm::vec3 m_directionalColor;
+
+public:
+	// How far ray origins are pushed off a surface, in world units.
+	static constexpr float SURFACE_OFFSET = 1e-3f;
+	// The length of rays toward the directional light.
+	static constexpr float SUN_DISTANCE = 1e3f;
+
+	/**
+	 * @param directionalLight the direction the directional light travels (the "I" vector).
+	 */
+	BakeScene(std::vector<BakeMesh> meshes, const std::vector<PointLight>& lights,
+		const glm::vec3& directionalLight, const glm::vec3& directionalColor);
+
+	const std::vector<BakeMesh>& meshes() const { return m_meshes; }
+	const TriangleBVH& bvh() const { return *m_bvh; }
+
+	/**
+	 * @brief Light arriving directly from the directional light and the baked point and spot
+	 * lights at a point with the given normal, with shadows. Shadow rays are cast four at a time.
+	 */
+	glm::vec3 directIrradiance(const glm::vec3& position, const glm::vec3& normal) const;
+
+	/**
+	 * @brief Light arriving after one diffuse bounce, estimated from cosine-weighted hemisphere
+	 * rays stratified on a square grid of at least the given number of samples. Rays are traced
+	 * in packets of four.
+	 * @param seed varies the jitter within each stratum between calls.
+	 */
+	glm::vec3 indirectIrradiance(const glm::vec3& position, const glm::vec3& normal, uint32_t samples, uint32_t seed) const;
+
+	/**
+	 * @brief The light a diffuse surface sends back along a ray that hit it, times pi: its albedo
+	 * times the direct irradiance on the side the ray arrived from.
+	 */
+	glm::vec3 bouncedLight(const Ray& ray, const RayHit& hit) const;
+
+	/**
+	 * @brief The fraction of cosine-weighted hemisphere rays, stratified as for
+	 * indirectIrradiance, that travel maxDistance without hitting anything.
+	 */
+	float ambientOcclusion(const glm::vec3& position, const glm::vec3& normal, uint32_t samples, float maxDistance, uint32_t seed) const;
+
+	/**
+	 * @brief A cosine-weighted direction about the normal, from a point (u1, u2) in [0, 1)^2.
+	 */
+	static glm::vec3 cosineDirection(const glm::vec3& normal, float u1, float u2);
+};
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/ext.hpp>
+#include "AnimationClip.h"
+
+/**
+ * @brief How much error key reduction may introduce into each kind of track: in model units for
+ * translations, in quaternion components for rotations, and in scale factor for scales.
+ */
+struct ClipCompressionSettings {
+	float translationTolerance{ 1e-4f };
+	float rotationTolerance{ 1e-4f };
+	float scaleTolerance{ 1e-4f };
+};
+
+/**
+ * @brief A translation or scale key, each component quantized to 16 bits across its track's range.
+ */
+struct PackedVec3 {
+	uint16_t c[3];
+};
+
+/**
+ * @brief A unit quaternion stored as its three smallest components, each quantized to 15 bits
+ * across [-1/sqrt(2), 1/sqrt(2)]. The top bits of the first two hold the index of the largest
+ * component, which is made positive and rebuilt from the other three.
+ */
+struct PackedQuat {
+	uint16_t c[3];
+};
+
+/**
+ * @brief The tracks of one joint in a compressed clip, with the range each translation and scale
+ * track was quantized across: a component's value is min + step * quantized.
+ */
+struct CompressedChannel {
+	uint32_t joint;
+	KeyRange translation;
+	KeyRange rotation;
+	KeyRange scale;
+	glm::vec3 translationMin;
+	glm::vec3 translationStep;
+	glm::vec3 scaleMin;
+	glm::vec3 scaleStep;
+};
+
+/**
+ * @brief An AnimationClip compressed for playback, in the same structure-of-arrays layout.
+ *
+ * Keys that interpolation from their neighbours reproduces within the settings' tolerances are
+ * dropped, and a track that never moves keeps a single key. The remaining key times are quantized
+ * to 16-bit ticks of the clip's duration, rotations to smallest-three quaternions of 6 bytes, and
+ * translations and scales to 16 bits per component across each track's own range. A key takes 8
+ * bytes instead of 16 (translation, scale) or 20 (rotation).
+ */
+class CompressedClip {
+private:
+	std::string m_name;
+	float m_duration;
+	// Seconds per tick of the quantized key times.
+	float m_tickLength;
+	std::vector<CompressedChannel> m_channels{};
+
+	std::vector<uint16_t> m_translationTimes{};
+	std::vector<PackedVec3> m_translations{};
+	std::vector<uint16_t> m_rotationTimes{};
+	std::vector<PackedQuat> m_rotations{};
+	std::vector<uint16_t> m_scaleTimes{};
+	std::vector<PackedVec3> m_scales{};
+
+	CompressedClip(std::string name, float duration);
+
+public:
+	static CompressedClip compress(const AnimationClip& clip, const ClipCompressionSettings& settings);
+
+	const std::string& name() const { return m_name; }
+	float duration() const { return m_duration; }
+	float tickLength() const { return m_tickLength; }
+	const std::vector<CompressedChannel>& channels() const { return m_channels; }
+
+	const std::vector<uint16_t>& translationTimes() const { return m_translationTimes; }
+	const std::vector<PackedVec3>& translations() const { return m_translations; }
+	const std::vector<uint16_t>& rotationTimes() const { return m_rotationTimes; }
+	const std::vector<PackedQuat>& rotations() const { return m_rotations; }
+	const std::vector<uint16_t>& scaleTimes() const { return m_scaleTimes; }
+	const std::vector<PackedVec3>& scales() const { return m_scales; }
+
+	// The total number of keys left in every track, and the bytes they and the channels take.
+	size_t keyCount() const;
+	size_t keyBytes() const;
+};
+
+/**
+ * @brief Samples one playback of a compressed clip, like ClipSampler. Each track's two keys
+ * either side of the time are decompressed and interpolated with SSE where it is available;
+ * rotations are interpolated linearly and renormalized, as they were when keys were reduced.
+ */
+class CompressedClipSampler {
+private:
+	const CompressedClip* m_clip;
+	std::vector<uint32_t> m_cursors;
+	std::vector<glm::vec3> m_bindTranslations;
+	std::vector<glm::quat> m_bindRotations;
+	std::vector<glm::vec3> m_bindScales;
+
+public:
+	CompressedClipSampler(const CompressedClip& clip, const std::vector<glm::mat4>& bindLocals);
+
+	const CompressedClip& clip() const { return *m_clip; }
+
+	/**
+	 * @brief Writes the local transformation of every joint the clip animates, at the given time
+	 * in seconds, into locals. With a joint mask, joints whose entry is 0 are skipped and keep
+	 * whatever transformation they had.
+	 */
+	void sample(float time, std::vector<glm::mat4>& locals, const std::vector<uint8_t>* jointMask = nullptr);
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include "GBuffer.h"
+#include "LightClusters.h"
+#include "Object3D.h"
+#include "ShaderProgram.h"
+
+/**
+ * @brief Selects how a camera pass shades its objects.
+ */
+enum class ShadingPath {
+	// Every object is lit as it is drawn (lighting.frag).
+	Forward,
+	// Objects write a G-buffer, then one fullscreen pass lights every pixel once.
+	Deferred
+};
+
+/**
+ * @brief Renders a camera pass with deferred shading. The geometry pass writes surface
+ * attributes to a GBuffer; the lighting pass then draws one fullscreen triangle that applies the
+ * ambient and directional lights, plus the point and spot lights that LightClusters assigned to
+ * each pixel's cluster. Lighting cost therefore depends on the lights touching each visible
+ * pixel, not on the scene's depth complexity.
+ */
+class DeferredRenderer {
+private:
+	GBuffer m_gbuffer;
+	ShaderProgram m_geometryProgram;
+	ShaderProgram m_lightingProgram;
+	// Core profiles need a bound vertex array even for attribute-less draws.
+	uint32_t m_emptyVao;
+
+public:
+	// The G-buffer occupies four texture units, below those reserved by LightClusters.
+	static constexpr int32_t GBUFFER_FIRST_UNIT = 4;
+
+	/**
+	 * @brief Constructs a renderer from a geometry program (light_perspective.vert + gbuffer.frag)
+	 * and a lighting program (fullscreen.vert + deferred_lighting.frag).
+	 */
+	DeferredRenderer(ShaderProgram geometryProgram, ShaderProgram lightingProgram);
+
+	/**
+	 * @brief The program for the lighting pass. Scene-wide lights ("ambientColor",
+	 * "directionalLight", "directionalColor") must be set on it by the caller.
+	 */
+	ShaderProgram& lightingProgram() { return m_lightingProgram; }
+
+	/**
+	 * @brief Renders the objects' surface attributes into the G-buffer, resized to the given size.
+	 * @param skip objects whose entry is true are left out, because this pass draws them some
+	 * other way. May be empty.
+	 */
+	void geometryPass(const std::vector<Object3D>& objects, const glm::mat4& view, const glm::mat4& projection,
+		uint32_t width, uint32_t height, const std::vector<bool>& skip);
+
+	/**
+	 * @brief Lights the G-buffer into the target framebuffer with a fullscreen pass, then copies
+	 * depth into the target. Leaves the lighting program active.
+	 */
+	void lightingPass(uint32_t targetFbo, const glm::mat4& view, const glm::mat4& projection,
+		const glm::vec3& viewPos, LightClusters& clusters);
+};
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Object3D.h"
+#include "ShaderProgram.h"
+
+/**
+ * @brief Controls an optional depth-only prepass for one render pass. When the prepass runs,
+ * the scene is first drawn with positions only and a trivial fragment shader, and the color pass
+ * then tests with GL_EQUAL so the expensive fragment shader runs at most once per pixel.
+ *
+ * Overdraw is measured with a GL_SAMPLES_PASSED query around the color pass: the number of
+ * samples that passed the depth test (and were therefore shaded) divided by the number of pixels
+ * in the pass. In Auto mode the pass periodically renders one frame without the prepass to
+ * re-measure overdraw, and keeps the prepass on while overdraw exceeds a threshold.
+ */
+class DepthPrepass {
+public:
+	enum class Mode {
+		Off,
+		On,
+		// Enable the prepass only while measured overdraw justifies it.
+		Auto,
+		// Alternate between frames with and without the prepass, and accumulate shaded samples for each.
+		Benchmark
+	};
+
+private:
+	Mode m_mode;
+	float m_overdrawThreshold;
+	bool m_enabled;
+	bool m_prepassThisFrame;
+
+	// Occlusion query state; results are read a frame late to avoid stalling the pipeline.
+	uint32_t m_query;
+	bool m_queryPending;
+	bool m_queryHadPrepass;
+	uint64_t m_queryPixels;
+
+	// Frames until Auto mode measures overdraw without the prepass again.
+	uint32_t m_framesUntilProbe;
+	float m_overdraw;
+
+	// Benchmark totals, indexed by whether the prepass ran.
+	uint64_t m_benchSamples[2];
+	uint64_t m_benchPixels[2];
+	uint32_t m_benchFrames[2];
+
+	void collectQuery();
+
+public:
+	// How often Auto mode renders a frame without the prepass to re-measure overdraw.
+	static constexpr uint32_t PROBE_INTERVAL = 120;
+
+	DepthPrepass(Mode mode = Mode::Auto, float overdrawThreshold = 1.5f);
+
+	/**
+	 * @brief Decides whether the prepass runs this frame. Call once before drawing the pass.
+	 */
+	bool beginFrame();
+
+	/**
+	 * @brief Renders the depth-only prepass of the given objects. The program must be a
+	 * position-only program whose "projection" and "view" uniforms are already set.
+	 * @param skip objects whose entry is true are left out, because this pass draws them some
+	 * other way. May be empty.
+	 */
+	void renderPrepass(ShaderProgram& depthProgram, const std::vector<Object3D>& objects,
+		const std::vector<bool>& skip = {}) const;
+
+	/**
+	 * @brief Sets depth state for the color pass and starts measuring shaded samples.
+	 */
+	void beginColorPass();
+
+	/**
+	 * @brief Stops measuring and restores the default depth state.
+	 * @param pixelCount the number of pixels covered by the pass's viewport.
+	 */
+	void endColorPass(uint64_t pixelCount);
+
+	Mode mode() const { return m_mode; }
+	void setMode(Mode mode) { m_mode = mode; }
+	bool prepassThisFrame() const { return m_prepassThisFrame; }
+
+	/**
+	 * @brief The most recently measured overdraw without the prepass, in shaded samples per pixel.
+	 */
+	float overdraw() const { return m_overdraw; }
+
+	/**
+	 * @brief Average shaded samples per pixel, with and without the prepass, over all Benchmark
+	 * frames so far. Returns 0 for a configuration that has not been measured.
+	 */
+	float benchmarkSamplesPerPixel(bool withPrepass) const;
+	uint32_t benchmarkFrames(bool withPrepass) const { return m_benchFrames[withPrepass]; }
+};
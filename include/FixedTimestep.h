@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Object3D.h"
+
+/**
+ * @brief Runs a simulation at a fixed rate, independent of the frame rate: each frame's time is
+ * added to an accumulator, and the simulation takes as many whole steps as it holds. What is
+ * left over is how far the frame is between the last step and the next, for rendering to
+ * interpolate by.
+ *
+ * A frame that would take more than maxSteps steps takes only that many and drops the rest of
+ * its time, so that a slow simulation can't fall ever further behind.
+ */
+class FixedTimestep {
+private:
+	float m_step;
+	uint32_t m_maxSteps;
+	float m_accumulator{ 0 };
+
+public:
+	FixedTimestep(float step, uint32_t maxSteps);
+
+	/**
+	 * @brief Adds a frame's time, in seconds, and returns the number of steps to take for it.
+	 */
+	uint32_t accumulate(float frameTime);
+
+	float step() const { return m_step; }
+
+	/**
+	 * @brief How far the current frame is from the last step to the next, from 0 to 1.
+	 */
+	float alpha() const { return m_accumulator / m_step; }
+};
+
+/**
+ * @brief Draws a scene's objects between their positions and orientations at the last two
+ * simulation steps, so that motion simulated at a fixed rate looks smooth at any frame rate.
+ * Objects are moved to their interpolated transformations for rendering, and back afterwards.
+ * An object that moves farther than teleportDistance in one step jumped there, and is drawn
+ * where it ended up.
+ */
+class TransformInterpolator {
+private:
+	float m_teleportDistance;
+	// Every object's transformation before the latest step, and while it is being rendered, the
+	// simulated one it is put back to.
+	std::vector<glm::vec3> m_previousPositions{};
+	std::vector<glm::vec3> m_previousOrientations{};
+	std::vector<glm::vec3> m_simulatedPositions{};
+	std::vector<glm::vec3> m_simulatedOrientations{};
+
+public:
+	explicit TransformInterpolator(float teleportDistance);
+
+	/**
+	 * @brief Records the objects' transformations before a simulation step.
+	 */
+	void beginStep(const std::vector<Object3D>& objects);
+
+	/**
+	 * @brief Moves the objects to their transformations the given fraction of the way from
+	 * before the latest step to after it.
+	 */
+	void beginRender(std::vector<Object3D>& objects, float alpha);
+
+	/**
+	 * @brief Puts the objects back to their simulated transformations.
+	 */
+	void endRender(std::vector<Object3D>& objects);
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <glm/ext.hpp>
+#include "PassTimer.h"
+#include "GlIntercept.h"
+
+// A point a camera passes through: where it is and what it looks at, at a time in seconds.
+struct CameraKey {
+	float time;
+	glm::vec3 position;
+	glm::vec3 target;
+	// Jump to this key at its time, as a switch to another camera does, instead of moving to it.
+	bool cut{ false };
+};
+
+struct CameraPose {
+	glm::vec3 position;
+	glm::vec3 forwards;
+};
+
+/**
+ * @brief A camera's path through its keys, a Catmull-Rom spline through both the positions and
+ * the points looked at. Before the first key and after the last, the camera holds still.
+ */
+class CameraPath {
+private:
+	std::vector<CameraKey> m_keys;
+
+public:
+	/**
+	 * @brief Constructs a path through the given keys, which are in order of time. There must be
+	 * at least one.
+	 */
+	explicit CameraPath(std::vector<CameraKey> keys);
+
+	CameraPose sample(float time) const;
+};
+
+// A stretch of a flythrough, with a path for each of the player's and the security camera.
+struct FlythroughSegment {
+	std::string name;
+	float duration;
+	CameraPath player;
+	CameraPath security;
+};
+
+/**
+ * @brief Plays a flythrough's segments one after another, a frame at a time, and measures each:
+ * CPU and GPU frame times, the OpenGL calls of its frames (see RenderStats), and the process's
+ * memory. The results are written as JSON, to compare between builds.
+ *
+ * Needs an OpenGL context, for the GPU timer queries, and GlIntercept installed to count calls.
+ */
+class FlythroughBenchmark {
+private:
+	struct SegmentTotals {
+		RenderStats work{};
+		uint64_t peakResidentBytes{ 0 };
+		uint64_t endResidentBytes{ 0 };
+	};
+
+	std::vector<FlythroughSegment> m_segments;
+	std::vector<SegmentTotals> m_totals;
+	// One pass per segment.
+	PassTimer m_timer{};
+	size_t m_segment{ 0 };
+	float m_time{ 0 };
+	RenderStats m_frameStart{};
+
+public:
+	explicit FlythroughBenchmark(std::vector<FlythroughSegment> segments);
+
+	bool done() const { return m_segment >= m_segments.size(); }
+	const FlythroughSegment& segment() const { return m_segments[m_segment]; }
+	// Seconds into the current segment.
+	float segmentTime() const { return m_time; }
+
+	void beginFrame();
+
+	/**
+	 * @brief Ends the frame begun last, and moves the flythrough on by the given time, to the next
+	 * segment once this one is over.
+	 */
+	void endFrame(float dt);
+
+	/**
+	 * @brief Writes the results, noting the renderer they were measured on. Throws if the file
+	 * can't be written.
+	 */
+	void writeJson(const std::filesystem::path& path, const std::string& renderer);
+
+	/**
+	 * @brief The process's resident memory, in bytes, or 0 where it can't be told.
+	 */
+	static uint64_t residentBytes();
+};
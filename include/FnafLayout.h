@@ -0,0 +1,44 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <glm/ext.hpp>
+#include "PointLight.h"
+
+/**
+ * @brief Where a model file sits in the world, as set up with Object3D's move, grow and rotate.
+ */
+struct Placement {
+	std::string modelPath;
+	glm::vec3 position;
+	glm::vec3 scale;
+	glm::vec3 orientation;
+
+	/**
+	 * @brief The model matrix of a root Object3D with this placement. Must match
+	 * Object3D::buildModelMatrix for an object rotating about its origin.
+	 */
+	glm::mat4 modelMatrix() const;
+};
+
+/*
+ * The fixed layout of the pizzeria, shared by the game and the offline lighting bakers so that
+ * baked lighting lines up with what the game draws.
+ */
+
+/**
+ * @brief The static rooms, whose lighting can be baked: the stage, the office and the pirate
+ * cove, in that order.
+ */
+std::vector<Placement> fnafStaticRooms();
+
+/**
+ * @brief The pizzeria's fixed point and spot lights. The player's flashlight is not included.
+ */
+std::vector<PointLight> fnafLights();
+
+// Where the LightmapBaker writes the pizzeria's light probe grid, for the objects that move.
+const std::string FNAF_LIGHT_PROBES_PATH{ "models/fnaf_movie/lightprobes.bin" };
+
+// The direction ("I" vector) and color of the directional light over the player's view.
+const glm::vec3 FNAF_DIRECTIONAL_LIGHT{ 0, -1, -1 };
+const glm::vec3 FNAF_DIRECTIONAL_COLOR{ 1, 1, 1 };
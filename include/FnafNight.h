@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <random>
+#include "ScriptScheduler.h"
+
+/**
+ * @brief The tunable rules of a night: when the animatronics move and how fast, how long the
+ * night lasts, and how the office's power drains.
+ */
+struct NightSettings {
+	// Seconds from the start of the night until Foxy leaves the cove, and that his run down the
+	// hallway to the office takes.
+	float foxyDelay{ 30.0f };
+	float foxyRunTime{ 32.0f / 2.8f };
+	// How many seconds earlier or later than foxyDelay Foxy may leave, at random.
+	float foxyDelayJitter{ 0.0f };
+	// Seconds until 6 AM, when the player has survived the night.
+	float nightLength{ 360.0f };
+	// The office's power, in percent, and how much of it drains per second, plus how much more
+	// per closed door. With no drain, as in the game so far, it never runs out.
+	float power{ 100.0f };
+	float idleDrain{ 0.0f };
+	float doorDrain{ 0.0f };
+	// Seeds the night's random choices, so that a night plays the same way again with the same
+	// seed and input.
+	uint64_t seed{ 0 };
+};
+
+enum class FoxyState {
+	InCove,
+	Running,
+	// Got into the office through the open left door, and stays until it is closed.
+	InOffice,
+};
+
+enum class NightOutcome {
+	Playing,
+	Survived,
+	CaughtByFoxy,
+};
+
+// Things that happen in a night, for whatever presents it to react to.
+enum class NightEvent {
+	LeftDoorClosed,
+	LeftDoorOpened,
+	RightDoorClosed,
+	RightDoorOpened,
+	FoxyLeftCove,
+	FoxyCaughtPlayer,
+	FoxyReturnedToCove,
+	// The doors open, and can't be closed again.
+	PowerOut,
+	SixAm,
+};
+
+/**
+ * @brief The game's rules for one night, with no window, rendering or real time: the doors, the
+ * animatronics' schedules as scripts on a ScriptScheduler, and the power. The game steps it at
+ * its fixed simulation rate and draws what it reports; a headless simulation can step it as fast
+ * as it likes.
+ */
+class FnafNight {
+private:
+	NightSettings m_settings;
+	std::mt19937_64 m_random;
+	ScriptScheduler m_scripts{};
+	StateFlag m_leftDoorClosed{ false };
+	StateFlag m_rightDoorClosed{ false };
+	float m_time{ 0 };
+	float m_power;
+	FoxyState m_foxy{ FoxyState::InCove };
+	float m_foxyRunStart{ 0 };
+	NightOutcome m_outcome{ NightOutcome::Playing };
+	std::function<void(NightEvent)> m_eventCallback{};
+
+	Script foxyScript();
+	void notify(NightEvent event);
+
+public:
+	explicit FnafNight(const NightSettings& settings);
+	FnafNight(const FnafNight&) = delete;
+	FnafNight& operator=(const FnafNight&) = delete;
+
+	/**
+	 * @brief Sets a function to call with each event of the night, as it happens.
+	 */
+	void setEventCallback(std::function<void(NightEvent)> callback) { m_eventCallback = std::move(callback); }
+
+	/**
+	 * @brief Advances the night by the given time, in seconds: drains the power, and resumes the
+	 * animatronics' scripts that are due.
+	 */
+	void step(float dt);
+
+	/**
+	 * @brief Closes or opens a door. Returns false if it can't, because the power is out or it
+	 * already is.
+	 */
+	bool setLeftDoor(bool closed);
+	bool setRightDoor(bool closed);
+
+	bool leftDoorClosed() const { return m_leftDoorClosed.get(); }
+	bool rightDoorClosed() const { return m_rightDoorClosed.get(); }
+	float time() const { return m_time; }
+	float power() const { return m_power; }
+	FoxyState foxy() const { return m_foxy; }
+	NightOutcome outcome() const { return m_outcome; }
+	bool over() const { return m_outcome != NightOutcome::Playing; }
+	const NightSettings& settings() const { return m_settings; }
+
+	/**
+	 * @brief How far along his run Foxy is, from 0 in the cove to 1 at the office.
+	 */
+	float foxyRunProgress() const;
+};
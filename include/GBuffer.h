@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @brief A geometry buffer for deferred shading: a framebuffer with one render target per
+ * surface attribute, plus a depth-stencil texture.
+ *
+ * The layout is kept compact so that it fits GL 3.3 multiple render targets:
+ *   0: RGBA8   albedo (rgb)
+ *   1: RG16F   world-space normal, octahedral-encoded
+ *   2: RGBA8   material k_a, k_d, k_s, shininess / SHININESS_SCALE
+ * World position is not stored; it is reconstructed from depth.
+ */
+class GBuffer {
+private:
+	uint32_t m_fbo;
+	uint32_t m_albedo;
+	uint32_t m_normal;
+	uint32_t m_material;
+	uint32_t m_depth;
+	uint32_t m_width;
+	uint32_t m_height;
+
+	void destroy();
+
+public:
+	static constexpr float SHININESS_SCALE = 256.0f;
+
+	GBuffer();
+	~GBuffer();
+	GBuffer(const GBuffer&) = delete;
+	GBuffer& operator=(const GBuffer&) = delete;
+
+	/**
+	 * @brief (Re)allocates the render targets if the size has changed.
+	 */
+	void resize(uint32_t width, uint32_t height);
+
+	/**
+	 * @brief Binds the G-buffer as the draw framebuffer and clears it.
+	 */
+	void bindForGeometry();
+
+	/**
+	 * @brief Binds albedo, normal, material and depth to four consecutive texture units, starting
+	 * at firstUnit.
+	 */
+	void bindTextures(int32_t firstUnit) const;
+
+	/**
+	 * @brief Copies the G-buffer's depth into the given framebuffer, so forward-rendered passes
+	 * drawn afterwards are depth tested against the deferred geometry.
+	 */
+	void blitDepthTo(uint32_t targetFbo) const;
+
+	uint32_t width() const { return m_width; }
+	uint32_t height() const { return m_height; }
+};
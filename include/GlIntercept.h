@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "RenderStats.h"
+
+// What an OpenGL call does, as GlIntercept counts it.
+enum class GlCallKind : uint8_t {
+	Other,
+	Draw,
+	StateChange,
+	UniformUpload,
+	BufferUpload,
+	TextureUpload
+};
+
+/**
+ * @brief One OpenGL call, as the mock records it.
+ */
+struct GlCommand {
+	const char* name;
+	GlCallKind kind;
+	// The pass it was made in; 0 outside of every pass.
+	uint32_t pass;
+	uint64_t triangles;
+	bool redundant;
+};
+
+/**
+ * @brief Sits between the program and glad, counting the OpenGL calls made in each pass of each
+ * frame (see RenderStats).
+ *
+ * install() swaps each of glad's function pointers that the program calls for one that counts
+ * the call and then makes it. A call is redundant when it binds, enables or sets what a shadow
+ * copy of the context's state says is already so, or uploads a uniform value the program already
+ * has or a uniform it doesn't have.
+ *
+ * In Mock mode nothing is forwarded, so no context is needed at all: every call is recorded in
+ * commands(), names are made up for generated objects, shaders always compile and framebuffers
+ * are always complete. A program has the uniforms its shaders declare, in the branches of their
+ * #if's that are compiled in, so uploads to others are redundant as with a driver; unlike a
+ * driver, it keeps declared uniforms that go unused. Queries whose answers can't be made up leave
+ * their outputs as they were.
+ *
+ * OpenGL is only called from one thread, so none of this is synchronized.
+ */
+class GlIntercept {
+public:
+	enum class Mode {
+		// Nothing is counted.
+		Off,
+		// Calls are counted, then made.
+		Counting,
+		// Calls are counted and recorded, and not made.
+		Mock
+	};
+
+	/**
+	 * @brief Starts counting, once OpenGL is loaded; or, in Mock mode, instead of loading it.
+	 * Call at most once.
+	 */
+	static void install(Mode mode);
+	static Mode mode();
+
+	/**
+	 * @brief Adds a pass to count separately, and returns its index for beginPass().
+	 */
+	static uint32_t addPass(const std::string& name);
+
+	/**
+	 * @brief Counts the calls from now until endPass() toward the given pass. Passes don't nest.
+	 */
+	static void beginPass(uint32_t pass);
+	static void endPass();
+
+	/**
+	 * @brief Ends a frame: each pass's counts since the last endFrame() become its lastFrame().
+	 */
+	static void endFrame();
+
+	// Pass 0 is everything outside of the added passes.
+	static uint32_t passCount();
+	static const std::string& passName(uint32_t pass);
+	static const RenderStats& lastFrame(uint32_t pass);
+	// The most of each count that any one frame made in the pass.
+	static const RenderStats& peakFrame(uint32_t pass);
+	// Every pass's counts, over every frame.
+	static const RenderStats& totals();
+
+	static const std::vector<GlCommand>& commands();
+	static void clearCommands();
+
+	/**
+	 * @brief Prints each pass's counts per frame, on average and at most.
+	 */
+	static void report(std::ostream& out);
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+
+/**
+ * @brief An OpenGL 3.3 core context with no window or display, from a surfaceless EGL display,
+ * which Mesa's llvmpipe provides on machines with neither a display server nor a GPU. What would
+ * go to the window is drawn to a framebuffer of the given size instead, and can be saved.
+ *
+ * Loads OpenGL with glad on construction, so it must exist before any other OpenGL object.
+ */
+class HeadlessContext {
+private:
+	void* m_display{ nullptr };
+	void* m_context{ nullptr };
+	uint32_t m_width;
+	uint32_t m_height;
+	uint32_t m_fbo{ 0 };
+	uint32_t m_colorBuffer{ 0 };
+	uint32_t m_depthBuffer{ 0 };
+
+public:
+	/**
+	 * @brief Creates the context and makes it current. Throws if there is no EGL display that
+	 * can make one.
+	 */
+	HeadlessContext(uint32_t width, uint32_t height);
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+	~HeadlessContext();
+
+	// The framebuffer that stands in for the window's.
+	uint32_t framebuffer() const { return m_fbo; }
+	uint32_t width() const { return m_width; }
+	uint32_t height() const { return m_height; }
+
+	/**
+	 * @brief Writes the framebuffer's image as a binary PPM. Throws if the file can't be written.
+	 */
+	void saveFrame(const std::filesystem::path& path) const;
+};
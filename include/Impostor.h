@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <glm/ext.hpp>
+#include "Object3D.h"
+#include "ShaderProgram.h"
+
+struct ImpostorSettings {
+	// Views along each side of the octahedral atlas.
+	uint32_t gridSize{ 8 };
+	// Edge length of each view, in texels.
+	uint32_t viewResolution{ 128 };
+};
+
+/**
+ * @brief A stand-in for a distant object: views of it from every direction, baked into an
+ * atlas, and drawn as a single quad facing the camera.
+ *
+ * Views are laid out on an octahedral map of the sphere of directions around the object, so each
+ * cell of the atlas is the object seen from one direction, with its albedo in one texture and its
+ * normals in another for relighting. At runtime the four views nearest the camera direction are
+ * blended on the quad. The object may move and turn freely after baking, but its pose and scale
+ * must stay as they were.
+ */
+class Impostor {
+private:
+	uint32_t m_albedo;
+	uint32_t m_normal;
+	uint32_t m_emptyVao;
+	uint32_t m_gridSize;
+	// The bounding sphere of the object, in the frame it was baked in: the object's own model
+	// matrix with no translation or rotation.
+	glm::vec3 m_center;
+	float m_radius;
+	glm::mat4 m_inverseBakeModel;
+
+	Impostor();
+
+	/**
+	 * @brief The transformation from the baked frame to the world, for the object as it is now.
+	 */
+	glm::mat4 placement(const Object3D& object) const;
+
+public:
+	// Texture units of the atlases, after the shadow atlas.
+	static constexpr int32_t ALBEDO_UNIT = 12;
+	static constexpr int32_t NORMAL_UNIT = 13;
+
+	~Impostor();
+	Impostor(const Impostor&) = delete;
+	Impostor& operator=(const Impostor&) = delete;
+	Impostor(Impostor&& other) noexcept;
+	Impostor& operator=(Impostor&& other) noexcept;
+
+	/**
+	 * @brief Renders the object from every atlas direction with the deferred path's G-buffer
+	 * program, which writes albedo to its first output and an octahedral normal to its second.
+	 * Restores the framebuffer, viewport and clear color afterwards.
+	 */
+	static Impostor bake(const Object3D& object, ShaderProgram& gbufferProgram, const ImpostorSettings& settings);
+
+	/**
+	 * @brief Points a program's impostor samplers at their texture units.
+	 */
+	static void assignSamplers(ShaderProgram& program);
+
+	/**
+	 * @brief The height of the object on screen, in pixels, or infinity if the camera is inside
+	 * its bounding sphere.
+	 */
+	float screenSize(const Object3D& object, const glm::mat4& view, const glm::mat4& projection, float viewportHeight) const;
+
+	/**
+	 * @brief Draws the impostor in place of the object, with the impostor program active and its
+	 * camera uniforms set.
+	 */
+	void render(ShaderProgram& program, const Object3D& object, const glm::vec3& viewPos) const;
+};
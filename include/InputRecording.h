@@ -0,0 +1,91 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// The keys the game reads.
+enum class InputKey : uint8_t {
+	A,
+	D,
+	W,
+	S,
+	Space,
+	LControl,
+	Q,
+	E,
+	Num1,
+	Num2,
+	Num3,
+	Count,
+};
+
+// A key going down or up, at a time in seconds since the start of play.
+struct InputEvent {
+	float time;
+	InputKey key;
+	bool pressed;
+};
+
+/**
+ * @brief The keys held down, and the ones pressed this frame, built from input events whether
+ * they come from the keyboard or a recording.
+ */
+class InputState {
+private:
+	std::array<bool, static_cast<size_t>(InputKey::Count)> m_held{};
+	std::vector<InputKey> m_pressed{};
+
+public:
+	/**
+	 * @brief Forgets the keys pressed last frame; held keys stay held.
+	 */
+	void beginFrame() { m_pressed.clear(); }
+
+	void apply(const InputEvent& event);
+
+	/**
+	 * @brief Lets go of every held key, for when the window loses focus.
+	 */
+	void releaseAll(float time, std::vector<InputEvent>& released);
+
+	bool held(InputKey key) const { return m_held[static_cast<size_t>(key)]; }
+	const std::vector<InputKey>& pressed() const { return m_pressed; }
+};
+
+/**
+ * @brief A session's input, with the seed its night was played with, which replayed at a fixed
+ * timestep gives the same frames every time. Saved as a header, then 8 bytes per event.
+ */
+class InputRecording {
+private:
+	uint64_t m_seed;
+	float m_duration{ 0 };
+	std::vector<InputEvent> m_events{};
+
+public:
+	explicit InputRecording(uint64_t seed) : m_seed{ seed } {}
+
+	void add(const InputEvent& event) { m_events.push_back(event); }
+	void setDuration(float duration) { m_duration = duration; }
+
+	uint64_t seed() const { return m_seed; }
+	float duration() const { return m_duration; }
+	const std::vector<InputEvent>& events() const { return m_events; }
+
+	/**
+	 * @brief Feeds the state the events from the given one up to the given time, and returns the
+	 * first event after it, to continue from on the next frame.
+	 */
+	size_t replay(size_t from, float until, InputState& state) const;
+
+	/**
+	 * @brief Writes the recording. Throws if the file can't be written.
+	 */
+	void save(const std::filesystem::path& path) const;
+
+	/**
+	 * @brief Reads a recording. Throws if the file is missing or malformed.
+	 */
+	static InputRecording load(const std::filesystem::path& path);
+};
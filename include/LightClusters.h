@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/ext.hpp>
+#include "PointLight.h"
+#include "ShaderProgram.h"
+
+/**
+ * @brief Assigns lights to a 3D grid of clusters over the view frustum for clustered forward
+ * shading. The frustum is split into tiles in screen space and exponentially-spaced slices in
+ * depth; each cluster's list of overlapping lights is uploaded to texture buffers, so that the
+ * fragment shader only loops over the lights that can reach its cluster.
+ *
+ * Binning runs on the CPU each frame. Each cluster is bounded by a view-space AABB, and each
+ * light's bounding sphere is tested against the clusters of the depth slices it spans, four
+ * clusters at a time when SSE is available.
+ */
+class LightClusters {
+private:
+	// View-space AABBs of every cluster, in structure-of-arrays form, ordered slice by slice.
+	std::vector<float> m_minX, m_minY, m_minZ, m_maxX, m_maxY, m_maxZ;
+	glm::mat4 m_projection;
+	float m_near;
+	float m_far;
+
+	// Per-cluster (offset, count) into m_indices, and the light index lists themselves.
+	std::vector<uint32_t> m_clusterRanges;
+	std::vector<uint16_t> m_indices;
+	// Packed light data, four texels per light.
+	std::vector<glm::vec4> m_lightData;
+	uint32_t m_lightCount;
+	// Whether the data binned by the last update still has to be uploaded.
+	bool m_dirty;
+
+	// Scratch list of (cluster, light) pairs produced by binning.
+	std::vector<std::pair<uint32_t, uint16_t>> m_pairs;
+
+	// Texture buffer objects: a buffer plus the texture that views it.
+	uint32_t m_lightBuffer, m_lightTexture;
+	uint32_t m_clusterBuffer, m_clusterTexture;
+	uint32_t m_indexBuffer, m_indexTexture;
+
+	void buildClusterBounds(const glm::mat4& projection, float zNear, float zFar);
+	void binLight(const glm::vec3& viewPosition, float radius, uint16_t lightIndex);
+
+public:
+	static constexpr uint32_t TILES_X = 16;
+	static constexpr uint32_t TILES_Y = 9;
+	static constexpr uint32_t SLICES = 24;
+	static constexpr uint32_t CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+
+	// Texture units reserved for the cluster texture buffers.
+	static constexpr int32_t LIGHT_DATA_UNIT = 8;
+	static constexpr int32_t CLUSTER_DATA_UNIT = 9;
+	static constexpr int32_t LIGHT_INDEX_UNIT = 10;
+
+	LightClusters();
+
+	/**
+	 * @brief Points the cluster samplers of the given (active) program at their reserved texture
+	 * units. Must be called once for any program using lighting.frag.
+	 */
+	static void assignSamplers(ShaderProgram& program);
+
+	/**
+	 * @brief Bins lights into clusters for a camera. Only the maxLights lights nearest to the
+	 * camera are considered.
+	 * @param view the world->view camera matrix.
+	 * @param projection a symmetric perspective projection.
+	 */
+	void update(const std::vector<PointLight>& lights, const glm::mat4& view, const glm::mat4& projection,
+		float zNear, float zFar, const glm::vec3& cameraPos, uint32_t maxLights);
+
+	/**
+	 * @brief Uploads the cluster data if it changed since the last bind, binds it to its texture
+	 * units, and sets the cluster uniforms of the given (active) program. Several programs can
+	 * be bound in turn for the same pass.
+	 * @param viewportSize the size of the pass's viewport, in pixels.
+	 */
+	void bind(ShaderProgram& program, const glm::vec2& viewportSize);
+
+	uint32_t lightCount() const { return m_lightCount; }
+	size_t assignmentCount() const { return m_indices.size(); }
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include <glm/ext.hpp>
+
+/**
+ * @brief Irradiance around a point as second-order (L2) spherical harmonics: nine RGB
+ * coefficients, already convolved with the clamped cosine lobe, so the irradiance arriving at a
+ * surface with normal n is the sum of each coefficient times its basis function at n.
+ */
+struct ShIrradiance {
+	static constexpr uint32_t COEFFICIENTS = 9;
+
+	std::array<glm::vec3, COEFFICIENTS> coefficients{};
+
+	/**
+	 * @brief The nine real SH basis functions at a unit direction, in the order lighting.frag uses.
+	 */
+	static std::array<float, COEFFICIENTS> basis(const glm::vec3& direction);
+
+	/**
+	 * @brief The irradiance arriving at a surface with the given unit normal.
+	 */
+	glm::vec3 evaluate(const glm::vec3& normal) const;
+};
+
+/**
+ * @brief A regular 3D grid of baked light probes over the pizzeria, giving objects that move
+ * between rooms the bounced light that static rooms get from their lightmaps.
+ *
+ * Probes hold only indirect light; moving objects still take direct light from every light at
+ * runtime. Each frame, an object's probe lighting is interpolated on the CPU from the eight probes
+ * around it and uploaded as nine uniforms.
+ */
+class LightProbeGrid {
+private:
+	glm::vec3 m_origin;
+	glm::vec3 m_spacing;
+	glm::uvec3 m_dimensions;
+	// x varies fastest, then y, then z.
+	std::vector<ShIrradiance> m_probes;
+
+public:
+	/**
+	 * @brief A grid of dark probes, the first at origin, with the given distance between
+	 * neighbors along each axis.
+	 */
+	LightProbeGrid(const glm::vec3& origin, const glm::vec3& spacing, const glm::uvec3& dimensions);
+
+	const glm::vec3& origin() const { return m_origin; }
+	const glm::vec3& spacing() const { return m_spacing; }
+	const glm::uvec3& dimensions() const { return m_dimensions; }
+	size_t probeCount() const { return m_probes.size(); }
+
+	/**
+	 * @brief The world-space position of the probe at the given index.
+	 */
+	glm::vec3 probePosition(size_t index) const;
+
+	ShIrradiance& probe(size_t index) { return m_probes[index]; }
+	const ShIrradiance& probe(size_t index) const { return m_probes[index]; }
+
+	/**
+	 * @brief Trilinearly interpolates the probes around a position. Positions outside the grid
+	 * take the nearest probes on its boundary.
+	 */
+	ShIrradiance sample(const glm::vec3& position) const;
+};
+
+/**
+ * @brief Writes a baked probe grid.
+ */
+void writeLightProbes(const std::filesystem::path& path, const LightProbeGrid& grid);
+
+/**
+ * @brief Reads a baked probe grid. Throws if the file is missing or malformed.
+ */
+LightProbeGrid readLightProbes(const std::filesystem::path& path);
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/ext.hpp>
+#include "BakeScene.h"
+#include "LightmapFile.h"
+#include "WorkerPool.h"
+
+struct LightmapSettings {
+	// The width and height of the lightmap, in texels.
+	uint32_t resolution{ 1024 };
+	// Hemisphere samples per texel for indirect light.
+	uint32_t indirectSamples{ 64 };
+	// Empty texels between charts, so that filtering never blends one chart into another.
+	uint32_t padding{ 2 };
+};
+
+/**
+ * @brief A baked lightmap: irradiance per texel, rows top to bottom, and the second UV set that
+ * maps each mesh's triangle corners onto it.
+ */
+struct Lightmap {
+	uint32_t width;
+	uint32_t height;
+	std::vector<glm::vec3> texels;
+	LightmapUVs uvs;
+};
+
+/**
+ * @brief Bakes lightmaps for groups of meshes in a BakeScene.
+ *
+ * Meshes are unwrapped automatically: every triangle becomes its own chart, laid flat at its
+ * true shape and shelf-packed into the atlas with a uniform texel density. Each texel covered by
+ * a chart is then lit with direct light plus one indirect bounce, rows spread over a WorkerPool,
+ * and finally empty texels are filled in from their neighbours.
+ */
+class LightmapBaker {
+private:
+	const BakeScene& m_scene;
+	WorkerPool& m_pool;
+	LightmapSettings m_settings;
+
+public:
+	LightmapBaker(const BakeScene& scene, WorkerPool& pool, const LightmapSettings& settings);
+
+	/**
+	 * @brief Bakes one lightmap shared by the scene's meshes [firstMesh, firstMesh + meshCount).
+	 * Throws if the meshes have too many triangles to fit at this resolution.
+	 */
+	Lightmap bake(size_t firstMesh, size_t meshCount) const;
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include <glm/ext.hpp>
+
+/*
+ * Files written by the lighting bakers and read back by assimpLoad. A lightmapped model has two
+ * files next to it: lightmap.hdr, the lightmap itself, and lightmap.uv2, its second UV set. A
+ * vertex-lit model has vertexlight.bin instead.
+ */
+
+// The second UV set of a baked model: for each mesh instance, in the depth-first order that
+// processAssimpNode visits them, the lightmap coordinates of each triangle corner in face order.
+using LightmapUVs = std::vector<std::vector<glm::vec2>>;
+
+// Lighting baked into the vertices of a model: for each mesh instance, in the same order, an
+// (irradiance, ambient occlusion) pair for each vertex.
+using VertexLighting = std::vector<std::vector<glm::vec4>>;
+
+inline const std::filesystem::path LIGHTMAP_IMAGE_NAME{ "lightmap.hdr" };
+inline const std::filesystem::path LIGHTMAP_UV_NAME{ "lightmap.uv2" };
+inline const std::filesystem::path VERTEX_LIGHTING_NAME{ "vertexlight.bin" };
+
+/**
+ * @brief Writes an image as a Radiance .hdr file: shared-exponent RGBE texels, four bytes each,
+ * with every scanline run-length encoded. Rows are written top to bottom.
+ */
+void writeRadianceHdr(const std::filesystem::path& path, uint32_t width, uint32_t height,
+	const std::vector<glm::vec3>& texels);
+
+/**
+ * @brief Writes the second UV set of a baked model.
+ */
+void writeLightmapUVs(const std::filesystem::path& path, const LightmapUVs& uvs);
+
+/**
+ * @brief Reads the second UV set of a baked model. Throws if the file is missing or malformed.
+ */
+LightmapUVs readLightmapUVs(const std::filesystem::path& path);
+
+/**
+ * @brief Writes the vertex lighting of a baked model.
+ */
+void writeVertexLighting(const std::filesystem::path& path, const VertexLighting& lighting);
+
+/**
+ * @brief Reads the vertex lighting of a baked model. Throws if the file is missing or malformed.
+ */
+VertexLighting readVertexLighting(const std::filesystem::path& path);
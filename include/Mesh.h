@@ -8,6 +8,8 @@
 
 #define MAX_BONE_INFLUENCE 4
 
+struct SoftwareMesh;
+
 struct Vertex3D {
 	float x;
 	float y;
@@ -21,13 +23,60 @@ struct Vertex3D {
 	float v;
 };
 
+/**
+ * @brief Extra per-vertex streams from the lighting bakers. Either may be left empty.
+ */
+struct BakedVertexStreams {
+	// Lightmap coordinates, streamed to vertex attribute 3.
+	std::vector<glm::vec2> lightmapCoords;
+	// Baked (irradiance, ambient occlusion), streamed to vertex attribute 4.
+	std::vector<glm::vec4> vertexLighting;
+};
+
+/**
+ * @brief The bones that move a vertex of a skinned mesh: up to MAX_BONE_INFLUENCE indices into
+ * its skin's bones, streamed to vertex attribute 5 of the skinning pass, and their weights in
+ * 255ths, which sum to 255, streamed to attribute 6. Unused slots weigh nothing.
+ */
+struct SkinInfluences {
+	uint16_t bones[MAX_BONE_INFLUENCE];
+	uint8_t weights[MAX_BONE_INFLUENCE];
+};
+
+/**
+ * @brief A skinned mesh's baked vertex animation: each frame's posed positions and normals, one
+ * texel per vertex, in rowsPerFrame consecutive rows of two textures that are width texels wide.
+ */
+struct VertexAnimationTextures {
+	uint32_t positions{ 0 };
+	uint32_t normals{ 0 };
+	int32_t width{ 0 };
+	int32_t rowsPerFrame{ 0 };
+	uint32_t frameCount{ 0 };
+};
 
 class Mesh {
 private:
 	uint32_t m_vao;
+	// A second vertex array that streams only positions, for depth-only passes.
+	uint32_t m_depthVao;
+	uint32_t m_vertexVbo;
+	uint32_t m_elementBuffer{ 0 };
 	std::vector<Texture> m_textures;
 	uint32_t m_vertexCount;
 	uint32_t m_faceCount;
+	// The bounding box of the mesh's vertices, in its local space.
+	glm::vec3 m_boundsMin;
+	glm::vec3 m_boundsMax;
+	// Where the mesh's bones start in its model's skinning palette, or -1 if it is not skinned.
+	int32_t m_paletteOffset{ -1 };
+	// A skinned mesh's skinning pass streams its bind pose and bone influences from m_skinVao,
+	// and transform feedback writes the posed positions and normals to their own buffers, from
+	// which both of the other vertex arrays read them.
+	uint32_t m_skinVao{ 0 };
+	uint32_t m_posedPositions{ 0 };
+	uint32_t m_posedNormals{ 0 };
+	VertexAnimationTextures m_vertexAnimation{};
 
 public:
 	/**
@@ -35,8 +84,49 @@ public:
 	*/
 	Mesh(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& faces);
 	Mesh(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& faces, std::vector<Texture> textures);
+	/**
+	 * @brief Constructs a mesh with baked lighting data, one entry per vertex in each non-empty
+	 * stream.
+	*/
+	Mesh(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& faces, std::vector<Texture> textures,
+		const BakedVertexStreams& baked);
 
 
+	/**
+	 * @brief Makes the mesh skinned, with one entry per vertex. Its vertex arrays then read the
+	 * posed buffers, which start out in the bind pose.
+	*/
+	void attachSkin(const std::vector<SkinInfluences>& influences, int32_t paletteOffset);
+
+	/**
+	 * @brief Poses a skinned mesh into its posed buffers with transform feedback. The active
+	 * program is the skinning program, with the model's palette bound and rasterization discarded.
+	*/
+	void skin(ShaderProgram& program) const;
+
+	/**
+	 * @brief Creates a skinned mesh's vertex animation textures, with room for the given number
+	 * of frames, and rows no wider than maxWidth.
+	*/
+	void allocateVertexAnimation(uint32_t frameCount, int32_t maxWidth);
+
+	/**
+	 * @brief Copies the posed buffers into a frame of the vertex animation textures, on the GPU.
+	*/
+	void captureVertexAnimationFrame(uint32_t frame) const;
+
+	/**
+	 * @brief Binds the mesh's vertex animation textures for the given program, which is active,
+	 * or tells it the mesh has none.
+	*/
+	void bindVertexAnimation(ShaderProgram& program) const;
+
+	/**
+	 * @brief Reads the mesh's vertices, in its current pose if it is skinned, and its faces back
+	 * from the GPU, for the software rasterizer.
+	*/
+	SoftwareMesh readBack() const;
+
 	void addTexture(Texture texture);
 	void addTextures(std::vector<Texture> textures);
 
@@ -52,5 +142,21 @@ public:
 	 * @param proj the view->clip projection matrix.
 	*/
 	void render(ShaderProgram& program) const;
+
+	/**
+	 * @brief Renders only the mesh's positions, with no textures bound. Used by depth-only passes.
+	*/
+	void renderDepth() const;
+
+	int32_t paletteOffset() const { return m_paletteOffset; }
+	bool isSkinned() const { return m_skinVao != 0; }
+	uint32_t vertexCount() const { return m_vertexCount; }
+	const VertexAnimationTextures& vertexAnimation() const { return m_vertexAnimation; }
+
+	// Texture units of the vertex animation textures, after the skinning palette.
+	static constexpr int32_t VERTEX_ANIMATION_POSITION_UNIT = 15;
+	static constexpr int32_t VERTEX_ANIMATION_NORMAL_UNIT = 16;
+	const glm::vec3& boundsMin() const { return m_boundsMin; }
+	const glm::vec3& boundsMax() const { return m_boundsMax; }
 	
 };
@@ -2,6 +2,15 @@
 #include <memory>
 #include "ShaderProgram.h"
 #include "Mesh.h"
+#include "SkeletonPose.h"
+
+// How an object's lighting from static lights reaches it: computed live, or read from lighting
+// baked offline into a lightmap or into its vertices.
+enum class BakedLighting {
+	None,
+	Lightmap,
+	PerVertex
+};
 
 class Object3D {
 private:
@@ -31,6 +40,18 @@ private:
 	// Some objects from Assimp imports have a "name" field, useful for debugging.
 	std::string m_name{};
 
+	// Whether the object's meshes carry baked lighting, and so must be drawn with a program that
+	// reads it.
+	BakedLighting m_bakedLighting{ BakedLighting::None };
+
+	// The pose of a skinned model's skeleton, held by the root of its hierarchy and shared with any
+	// copies of it. Its palette is bound when the object's skinned meshes are posed.
+	std::shared_ptr<SkeletonPose> m_skeletonPose{};
+
+	// The frame of its meshes' baked vertex animations that the object plays, with the fraction
+	// between two frames, or -1 to draw them from their vertex buffers. Set on the root of a model.
+	float m_vertexAnimationFrame{ -1 };
+
 	// Recomputes the local->world transformation matrix.
 	glm::mat4 buildModelMatrix() const;
 
@@ -48,11 +69,38 @@ public:
 	const glm::vec3& getCenter() const;
 	const std::string& getName() const;
 	const glm::vec4& getMaterial() const;
+	BakedLighting getBakedLighting() const;
+	const std::shared_ptr<SkeletonPose>& getSkeletonPose() const;
+	float getVertexAnimationFrame() const;
+	// The local->world transformation of this object as a root.
+	glm::mat4 getModelMatrix() const;
 
 	// Child management.
 	size_t numberOfChildren() const;
 	const Object3D& getChild(size_t index) const;
 	Object3D& getChild(size_t index);
+	// Calls visit with each mesh of the object and its children, recursively.
+	template <typename Visit>
+	void forEachMesh(Visit visit) {
+		for (auto& mesh : m_meshes) {
+			visit(mesh);
+		}
+		for (auto& child : m_children) {
+			child.forEachMesh(visit);
+		}
+	}
+	// Calls visit with each mesh of the object and its children, recursively, with its
+	// local->world transformation and its object's material.
+	template <typename Visit>
+	void forEachMeshTransformed(const glm::mat4& parentModel, Visit visit) const {
+		glm::mat4 trueModel{ parentModel * buildModelMatrix() };
+		for (auto& mesh : m_meshes) {
+			visit(mesh, trueModel, m_material);
+		}
+		for (auto& child : m_children) {
+			child.forEachMeshTransformed(trueModel, visit);
+		}
+	}
 
 
 	// Simple mutators.
@@ -62,6 +110,9 @@ public:
 	void setCenter(glm::vec3 center);
 	void setName(std::string name);
 	void setMaterial(glm::vec4 material);
+	void setBakedLighting(BakedLighting bakedLighting);
+	void setSkeletonPose(std::shared_ptr<SkeletonPose> skeletonPose);
+	void setVertexAnimationFrame(float frame);
 
 	// Transformations.
 	void move(const glm::vec3& offset);
@@ -69,7 +120,22 @@ public:
 	void grow(const glm::vec3& growth);
 	void addChild(Object3D child);
 
+	/**
+	 * @brief Grows the box from boundsMin to boundsMax to enclose the object and its children,
+	 * transformed by parentModel and the object's own model matrix.
+	 */
+	void expandBounds(const glm::mat4& parentModel, glm::vec3& boundsMin, glm::vec3& boundsMax) const;
+
 	// Rendering.
 	void render(ShaderProgram& shaderProgram) const;
-	void renderRecursive(ShaderProgram& shaderProgram, const glm::mat4& parentMatrix) const;
+	void renderRecursive(ShaderProgram& shaderProgram, const glm::mat4& parentMatrix, bool vertexAnimated) const;
+	void renderDepth(ShaderProgram& shaderProgram) const;
+	void renderDepthRecursive(ShaderProgram& shaderProgram, const glm::mat4& parentMatrix, bool vertexAnimated) const;
+
+	/**
+	 * @brief Poses the skinned meshes of a model with a skeleton pose into their posed buffers,
+	 * with the active skinning program. Does nothing for other objects.
+	 */
+	void skin(ShaderProgram& shaderProgram) const;
+	void skinRecursive(ShaderProgram& shaderProgram) const;
 };
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Times the passes of each frame, on the CPU and, with GL_TIME_ELAPSED queries, on the
+ * GPU, and reports the distribution of each over all the frames timed.
+ *
+ * GPU results are read QUERY_LATENCY frames late so that timing never stalls the pipeline. GPU
+ * passes must not overlap each other, as only one GL_TIME_ELAPSED query can run at a time.
+ */
+class PassTimer {
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Pass {
+		std::string name;
+		bool gpu;
+		Clock::time_point cpuStart{};
+		std::vector<float> cpuMs{};
+		std::vector<float> gpuMs{};
+		// A ring of queries, and how many of them are waiting for results, oldest at queryNext - pending.
+		std::vector<uint32_t> queries{};
+		uint32_t queryNext{ 0 };
+		uint32_t pending{ 0 };
+	};
+
+	std::vector<Pass> m_passes{};
+
+	// Reads the pass's oldest pending result, waiting for it if asked to.
+	bool collect(Pass& pass, bool wait);
+
+public:
+	static constexpr uint32_t QUERY_LATENCY = 4;
+
+	PassTimer() = default;
+	PassTimer(const PassTimer&) = delete;
+	PassTimer& operator=(const PassTimer&) = delete;
+	~PassTimer();
+
+	/**
+	 * @brief Adds a pass to time, and returns its index for begin() and end().
+	 * @param gpu whether to time it on the GPU as well.
+	 */
+	uint32_t addPass(const std::string& name, bool gpu = true);
+
+	void begin(uint32_t pass);
+	void end(uint32_t pass);
+
+	/**
+	 * @brief Waits for the GPU times still outstanding. Call before report().
+	 */
+	void finish();
+
+	const std::string& name(uint32_t pass) const { return m_passes[pass].name; }
+	const std::vector<float>& cpuTimes(uint32_t pass) const { return m_passes[pass].cpuMs; }
+	const std::vector<float>& gpuTimes(uint32_t pass) const { return m_passes[pass].gpuMs; }
+
+	/**
+	 * @brief The value below which the given fraction of the values lie.
+	 */
+	static float percentile(std::vector<float> values, float fraction);
+
+	/**
+	 * @brief Prints the 50th, 95th and 99th percentile and maximum time of each pass, in ms.
+	 */
+	void report(std::ostream& out) const;
+};
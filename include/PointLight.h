@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <glm/ext.hpp>
+
+/**
+ * @brief A point light, or a spot light when its cone is narrower than a full sphere. Lights
+ * have a finite radius, beyond which they contribute nothing.
+ */
+struct PointLight {
+	glm::vec3 position;
+	float radius;
+	glm::vec3 color;
+	// Spot lights shine along direction, fading out over [cosOuter, cosInner]. A cosOuter of -1
+	// makes an omnidirectional light.
+	glm::vec3 direction{ 0, -1, 0 };
+	float cosInner{ -1 };
+	float cosOuter{ -1 };
+	// Spot lights that cast shadows are given a ShadowAtlas tile each frame; -1 means unshadowed.
+	bool castsShadows{ false };
+	int32_t shadowTile{ -1 };
+	// Baked lights are already part of the lightmaps of static geometry, so lightmapped surfaces
+	// skip them; they still light everything else.
+	bool baked{ false };
+};
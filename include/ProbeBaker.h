@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <glm/ext.hpp>
+#include "BakeScene.h"
+#include "LightProbeGrid.h"
+#include "WorkerPool.h"
+
+struct ProbeBakeSettings {
+	// Distance between neighboring probes, in world units.
+	float spacing{ 1.0f };
+	// Rays cast over the whole sphere around each probe.
+	uint32_t samples{ 256 };
+};
+
+/**
+ * @brief Bakes a LightProbeGrid over a region of a BakeScene. Each probe casts rays in every
+ * direction, evenly spread on a Fibonacci lattice, and projects the light bounced back along them
+ * onto L2 spherical harmonics. Probes are spread over a WorkerPool.
+ */
+class ProbeBaker {
+private:
+	const BakeScene& m_scene;
+	WorkerPool& m_pool;
+	ProbeBakeSettings m_settings;
+
+	ShIrradiance bakeProbe(const glm::vec3& position) const;
+
+public:
+	ProbeBaker(const BakeScene& scene, WorkerPool& pool, const ProbeBakeSettings& settings);
+
+	/**
+	 * @brief Bakes a grid of probes covering the box from boundsMin to boundsMax.
+	 */
+	LightProbeGrid bake(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+};
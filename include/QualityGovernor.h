@@ -0,0 +1,128 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The rendering knobs that the QualityGovernor is allowed to turn. Each quality level
+ * is one complete set of these values.
+ */
+struct QualitySettings {
+	// Octaves of distance for shading level-of-detail: each whole unit halves the distances at
+	// which objects switch to coarser shading (see ShadingLod::select).
+	float lodBias;
+	// The security feed is re-rendered once every this many frames.
+	uint32_t feedUpdateInterval;
+	// Edge length, in texels, of each shadow map.
+	uint32_t shadowResolution;
+	// The maximum number of dynamic lights shaded in a frame.
+	uint32_t maxLights;
+	// The far clipping plane of every camera pass.
+	float drawDistance;
+};
+
+/**
+ * @brief One evaluation made by the QualityGovernor at the end of a sampling window.
+ */
+struct QualityDecision {
+	enum class Action { Hold, Upgrade, Downgrade };
+
+	// The frame at which the decision was made.
+	uint64_t frame;
+	Action action;
+	size_t fromLevel;
+	size_t toLevel;
+	// The measured frame time percentile over the window, and the budget it was compared to.
+	float measuredMs;
+	float budgetMs;
+	// A human-readable explanation of why the action was taken.
+	std::string reason;
+};
+
+/**
+ * @brief Watches frame times and moves between quality levels so that a frame time percentile
+ * stays within a budget. Level 0 is the highest quality; each later level is cheaper.
+ *
+ * Frame times are collected in fixed-size windows. At the end of each window the governor
+ * compares the chosen percentile against the budget. It downgrades as soon as a window is over
+ * budget, but only upgrades after several consecutive windows have comfortable headroom, so that
+ * a level that barely fits does not oscillate.
+ */
+class QualityGovernor {
+private:
+	float m_budgetMs;
+	float m_percentile;
+	std::vector<QualitySettings> m_levels;
+	size_t m_level;
+
+	// Frame times (in ms) of the current window.
+	std::vector<float> m_window;
+	size_t m_windowSize;
+	uint64_t m_frame;
+
+	// Hysteresis state.
+	uint32_t m_windowsUnderBudget;
+	uint32_t m_cooldownWindows;
+
+	std::deque<QualityDecision> m_decisions;
+	std::function<void(const QualityDecision&)> m_telemetry;
+
+	/**
+	 * @brief Computes the configured percentile of the current window and decides whether to
+	 * change level.
+	 */
+	void evaluateWindow();
+	void record(QualityDecision decision);
+
+public:
+	// Fraction of the budget a window must stay under before it counts toward an upgrade.
+	static constexpr float UPGRADE_HEADROOM = 0.75f;
+	// Consecutive comfortable windows required before upgrading.
+	static constexpr uint32_t UPGRADE_WINDOWS = 3;
+	// Windows to wait after any change before another change is considered.
+	static constexpr uint32_t COOLDOWN_WINDOWS = 1;
+	// How many past decisions are retained for inspection.
+	static constexpr size_t DECISION_HISTORY = 256;
+
+	/**
+	 * @brief Constructs a governor targeting the given percentile (0-1) of frame times, in
+	 * milliseconds, starting at the highest quality level.
+	 */
+	QualityGovernor(float budgetMs = 16.6f, float percentile = 0.95f, size_t windowSize = 60);
+
+	/**
+	 * @brief The default ladder of quality levels, from best to cheapest.
+	 */
+	static std::vector<QualitySettings> defaultLevels();
+
+	/**
+	 * @brief Replaces the quality ladder; the governor restarts at level 0.
+	 */
+	void setLevels(std::vector<QualitySettings> levels);
+
+	/**
+	 * @brief Records the duration of one frame, in seconds. May change the current level.
+	 */
+	void recordFrame(float frameSeconds);
+
+	/**
+	 * @brief The settings of the current quality level.
+	 */
+	const QualitySettings& settings() const { return m_levels[m_level]; }
+	size_t level() const { return m_level; }
+	size_t levelCount() const { return m_levels.size(); }
+	float budgetMs() const { return m_budgetMs; }
+	float percentile() const { return m_percentile; }
+
+	/**
+	 * @brief The most recent decisions, oldest first, including windows where the level held.
+	 */
+	const std::deque<QualityDecision>& decisions() const { return m_decisions; }
+
+	/**
+	 * @brief Registers a function that is called with every decision as it is made.
+	 */
+	void setTelemetryCallback(std::function<void(const QualityDecision&)> callback);
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @brief Counts of the rendering work submitted to OpenGL: draw calls and the triangles they
+ * cover, state changes, uniform uploads, buffer and texture uploads, and how many of all those
+ * calls changed nothing. GlIntercept keeps them; as running totals, the difference between two
+ * snapshots is the work done in between.
+ */
+struct RenderStats {
+	uint64_t draws{ 0 };
+	uint64_t triangles{ 0 };
+	uint64_t stateChanges{ 0 };
+	uint64_t uniformUploads{ 0 };
+	uint64_t bufferUploads{ 0 };
+	uint64_t textureUploads{ 0 };
+	// Calls that set what was already set, or uploaded to a uniform the program doesn't have.
+	uint64_t redundantCalls{ 0 };
+
+	RenderStats operator-(const RenderStats& earlier) const {
+		return RenderStats{ draws - earlier.draws, triangles - earlier.triangles, stateChanges - earlier.stateChanges,
+			uniformUploads - earlier.uniformUploads, bufferUploads - earlier.bufferUploads,
+			textureUploads - earlier.textureUploads, redundantCalls - earlier.redundantCalls };
+	}
+
+	RenderStats& operator+=(const RenderStats& other) {
+		draws += other.draws;
+		triangles += other.triangles;
+		stateChanges += other.stateChanges;
+		uniformUploads += other.uniformUploads;
+		bufferUploads += other.bufferUploads;
+		textureUploads += other.textureUploads;
+		redundantCalls += other.redundantCalls;
+		return *this;
+	}
+};
@@ -0,0 +1,209 @@
+#pragma once
+#include <coroutine>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+#include "TimerWheel.h"
+
+class Animator;
+
+/**
+ * @brief A gameplay script: a coroutine that runs from its call to its first co_await, and is
+ * then resumed by whatever it awaits. Scripts are handed to a ScriptScheduler, which owns them
+ * and destroys them when they finish or it does.
+ */
+class Script {
+public:
+	struct promise_type {
+		Script get_return_object() { return Script{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		// Kept until the scheduler sees it is done and destroys it.
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() {}
+		// Thrown on to whatever resumed the script.
+		void unhandled_exception() { throw; }
+	};
+
+private:
+	std::coroutine_handle<promise_type> m_handle;
+
+	explicit Script(std::coroutine_handle<promise_type> handle) : m_handle{ handle } {}
+
+public:
+	Script(Script&& other) noexcept : m_handle{ std::exchange(other.m_handle, nullptr) } {}
+	Script& operator=(Script&& other) noexcept {
+		std::swap(m_handle, other.m_handle);
+		return *this;
+	}
+	Script(const Script&) = delete;
+	Script& operator=(const Script&) = delete;
+	~Script() {
+		if (m_handle) {
+			m_handle.destroy();
+		}
+	}
+
+	bool done() const { return !m_handle || m_handle.done(); }
+};
+
+/**
+ * @brief Coroutines waiting for the same thing, resumed together when it happens.
+ */
+class WaitList {
+private:
+	std::vector<std::coroutine_handle<>> m_waiting{};
+
+public:
+	void add(std::coroutine_handle<> handle) { m_waiting.push_back(handle); }
+	void remove(std::coroutine_handle<> handle);
+
+	/**
+	 * @brief Resumes every coroutine waiting now. Those that wait on the list again are left for
+	 * the next call.
+	 */
+	void resumeAll();
+};
+
+/**
+ * @brief Awaits a WaitList, unless what it waits for has already happened. A script destroyed
+ * while waiting takes itself off the list.
+ */
+class WaitAwaiter {
+private:
+	WaitList& m_list;
+	bool m_ready;
+	std::coroutine_handle<> m_handle{};
+
+public:
+	WaitAwaiter(WaitList& list, bool ready) : m_list{ list }, m_ready{ ready } {}
+	WaitAwaiter(const WaitAwaiter&) = delete;
+	~WaitAwaiter() {
+		if (m_handle) {
+			m_list.remove(m_handle);
+		}
+	}
+
+	bool await_ready() const noexcept { return m_ready; }
+	void await_suspend(std::coroutine_handle<> handle) {
+		m_handle = handle;
+		m_list.add(handle);
+	}
+	void await_resume() noexcept { m_handle = nullptr; }
+};
+
+/**
+ * @brief A piece of game state scripts can wait on, like whether a door is closed: setting it
+ * resumes the scripts waiting for it to become its new value.
+ */
+class StateFlag {
+private:
+	bool m_value;
+	// The scripts waiting for false, and for true.
+	WaitList m_waiting[2]{};
+
+public:
+	explicit StateFlag(bool value = false) : m_value{ value } {}
+
+	bool get() const { return m_value; }
+	void set(bool value);
+
+	/**
+	 * @brief Sets the flag without resuming its scripts yet, so that what changed it can be
+	 * told first; resumeWaiting() then resumes them. Returns whether the value changed.
+	 */
+	bool change(bool value);
+	void resumeWaiting();
+
+	/**
+	 * @brief Awaits the flag having the given value, which is at once if it already does.
+	 */
+	WaitAwaiter becomes(bool value) { return WaitAwaiter{ m_waiting[value], m_value == value }; }
+};
+
+/**
+ * @brief Runs gameplay scripts that co_await delays, the end of an Animator's sequences and
+ * StateFlags, instead of polling for them every frame. Delays are timers on a TimerWheel, and
+ * the rest are WaitLists resumed by whatever changes, so scheduling a script's next step is
+ * O(1) and a waiting script costs nothing per frame.
+ */
+class ScriptScheduler {
+public:
+	/**
+	 * @brief Awaits a delay by scheduling the script's resumption on the wheel. A script
+	 * destroyed while waiting cancels its timer.
+	 */
+	class DelayAwaiter {
+	private:
+		TimerWheel& m_wheel;
+		float m_seconds;
+		TimerWheel::TimerId m_timer{ TimerWheel::NO_TIMER };
+
+	public:
+		DelayAwaiter(TimerWheel& wheel, float seconds) : m_wheel{ wheel }, m_seconds{ seconds } {}
+		DelayAwaiter(const DelayAwaiter&) = delete;
+		~DelayAwaiter() {
+			if (m_timer != TimerWheel::NO_TIMER) {
+				m_wheel.cancel(m_timer);
+			}
+		}
+
+		bool await_ready() const noexcept { return m_seconds <= 0; }
+		void await_suspend(std::coroutine_handle<> handle) {
+			m_timer = m_wheel.schedule(m_seconds, [this, handle] {
+				m_timer = TimerWheel::NO_TIMER;
+				handle.resume();
+			});
+		}
+		void await_resume() noexcept {}
+	};
+
+private:
+	Animator* m_animator{ nullptr };
+	TimerWheel m_wheel;
+	// The scripts waiting for each sequence to stop. A map, so that adding one doesn't move the
+	// others' lists from under their awaiters.
+	std::map<uint32_t, WaitList> m_sequenceWaits{};
+	std::vector<Script> m_scripts{};
+
+public:
+	/**
+	 * @brief Constructs a scheduler whose scripts' delays are measured in ticks of the given
+	 * length, in seconds.
+	 */
+	explicit ScriptScheduler(float tickLength = 0.01f);
+	~ScriptScheduler();
+	ScriptScheduler(const ScriptScheduler&) = delete;
+	ScriptScheduler& operator=(const ScriptScheduler&) = delete;
+
+	/**
+	 * @brief Lets scripts await the sequences of the given animator, which must outlive the
+	 * scheduler. Schedulers that watch none need nothing of rendering, and run headless.
+	 */
+	void watch(Animator& animator);
+
+	/**
+	 * @brief Takes ownership of a script, which has already run to its first co_await.
+	 */
+	void spawn(Script script);
+
+	/**
+	 * @brief Advances the scripts' clock by the given interval, in seconds, resuming each script
+	 * whose delay ends in it, then destroys the scripts that have finished.
+	 */
+	void advance(float dt);
+
+	/**
+	 * @brief Awaits the given time, in seconds.
+	 */
+	DelayAwaiter delay(float seconds) { return DelayAwaiter{ m_wheel, seconds }; }
+
+	/**
+	 * @brief Awaits the watched animator's sequence stopping, which is at once if it isn't
+	 * playing.
+	 */
+	WaitAwaiter sequenceFinished(uint32_t sequence);
+
+	size_t scriptCount() const { return m_scripts.size(); }
+	const TimerWheel& timers() const { return m_wheel; }
+};
@@ -1,12 +1,26 @@
 #pragma once
 #include <glm/ext.hpp>
 #include <string>
+#include <vector>
 class ShaderProgram {
 	uint32_t m_programId;
 
 public:
 	ShaderProgram();
-	void load(const std::string& vertexShaderPath, const std::string& fragmentShaderPath);
+	/**
+	 * @brief Compiles and links a program. Each of the given defines is inserted as a #define
+	 * after the #version line of both shaders, to select a permutation of them. A line
+	 * #include "name" in either is replaced by the file of that name in the shader's directory.
+	 */
+	void load(const std::string& vertexShaderPath, const std::string& fragmentShaderPath,
+		const std::vector<std::string>& defines = {});
+
+	/**
+	 * @brief Compiles and links a program of only a vertex shader, whose given outputs transform
+	 * feedback captures, each into a buffer of its own. Draws with it should discard rasterization.
+	 */
+	void loadTransformFeedback(const std::string& vertexShaderPath, const std::vector<std::string>& varyings,
+		const std::vector<std::string>& defines = {});
 
 	void activate();
 
@@ -19,4 +33,6 @@ public:
 	void setUniform(const std::string& uniformName, const glm::mat2& value);
 	void setUniform(const std::string& uniformName, const glm::mat3& value);
 	void setUniform(const std::string& uniformName, const glm::mat4& value);
+	// Sets a uniform array of vec3, from its first element.
+	void setUniform(const std::string& uniformName, const glm::vec3* values, size_t count);
 };
\ No newline at end of file
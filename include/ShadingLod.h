@@ -0,0 +1,40 @@
+#pragma once
+#include <cmath>
+
+/**
+ * @brief How much work the lighting shader does for an object, from finest to coarsest.
+ */
+enum class ShadingLevel {
+	// Phong lighting per pixel: lighting.frag.
+	PerPixel,
+	// Phong lighting per vertex, interpolated across triangles: gouraud.vert.
+	PerVertex,
+	// Baked and ambient light only, with no dynamic lights or shadows: lighting.frag with UNLIT.
+	Unlit,
+};
+
+/**
+ * @brief A camera pass's shading level-of-detail policy. Each object is shaded at the pass's
+ * finest level until it is farther from the camera than the distance of a coarser level.
+ */
+struct ShadingLod {
+	ShadingLevel finest;
+	float perVertexDistance;
+	float unlitDistance;
+
+	/**
+	 * @brief The level to shade an object at, at the given distance from the camera. The
+	 * quality level's lodBias is in octaves of distance: each whole unit halves the distances.
+	 */
+	ShadingLevel select(float distance, float lodBias) const {
+		float biased{ distance * std::exp2(lodBias) };
+		ShadingLevel level{ ShadingLevel::PerPixel };
+		if (biased > unlitDistance) {
+			level = ShadingLevel::Unlit;
+		}
+		else if (biased > perVertexDistance) {
+			level = ShadingLevel::PerVertex;
+		}
+		return level > finest ? level : finest;
+	}
+};
@@ -0,0 +1,118 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/ext.hpp>
+#include "Object3D.h"
+#include "ShaderProgram.h"
+
+struct PointLight;
+
+/**
+ * @brief The camera a light renders its shadow map from.
+ */
+struct ShadowView {
+	glm::mat4 view;
+	glm::mat4 projection;
+
+	bool operator==(const ShadowView& other) const {
+		return view == other.view && projection == other.projection;
+	}
+};
+
+/**
+ * @brief A shadow map atlas where each shadowed light owns one square tile, and where static
+ * geometry is rendered only when something about it changes.
+ *
+ * The atlas keeps two depth textures. The static cache holds each tile's static casters
+ * (office, stage, cove) and is re-rendered for a tile only when its light's view changes, the
+ * tile resolution changes, or the static content is invalidated. Every frame, each cached tile
+ * is copied into the live atlas, and the dynamic casters (animatronics, doors) are drawn on top
+ * of it. Shaders sample the live atlas.
+ */
+class ShadowAtlas {
+private:
+	struct Tile {
+		ShadowView view;
+		bool staticValid;
+	};
+
+	ShaderProgram m_depthProgram;
+	uint32_t m_tilesPerSide;
+	uint32_t m_tileResolution;
+	std::vector<Tile> m_tiles;
+
+	std::vector<const Object3D*> m_staticCasters;
+	std::vector<const Object3D*> m_dynamicCasters;
+
+	uint32_t m_staticFbo, m_staticDepth;
+	uint32_t m_liveFbo, m_liveDepth;
+
+	// How many static tiles the last update() had to re-render.
+	uint32_t m_staticRenders;
+
+	void allocate();
+	void destroy();
+	void setTileViewport(size_t tile) const;
+	void renderCasters(const std::vector<const Object3D*>& casters, const ShadowView& view);
+
+public:
+	// The most shadowed lights a shader can reference.
+	static constexpr uint32_t MAX_SHADOWS = 16;
+	// The texture unit reserved for the live atlas.
+	static constexpr int32_t ATLAS_UNIT = 11;
+
+	/**
+	 * @brief Constructs an atlas of tilesPerSide x tilesPerSide tiles, rendering casters with the
+	 * given position-only program (simple_perspective.vert + depth_only.frag).
+	 */
+	ShadowAtlas(ShaderProgram depthProgram, uint32_t tilesPerSide = 2, uint32_t tileResolution = 1024);
+	~ShadowAtlas();
+	ShadowAtlas(const ShadowAtlas&) = delete;
+	ShadowAtlas& operator=(const ShadowAtlas&) = delete;
+
+	/**
+	 * @brief Points the shadow sampler of the given (active) program at its texture unit, and
+	 * disables the directional light's shadow until a caller enables it.
+	 */
+	static void assignSampler(ShaderProgram& program);
+
+	/**
+	 * @brief A perspective shadow view covering a spot light's cone and radius.
+	 */
+	static ShadowView spotView(const PointLight& light);
+
+	/**
+	 * @brief An orthographic shadow view of a directional light, covering a sphere of the
+	 * given radius around center.
+	 */
+	static ShadowView directionalView(const glm::vec3& direction, const glm::vec3& center, float radius);
+
+	uint32_t tileCount() const { return m_tilesPerSide * m_tilesPerSide; }
+
+	/**
+	 * @brief Changes the edge length of each tile; every static tile is re-rendered.
+	 */
+	void setTileResolution(uint32_t resolution);
+
+	void setStaticCasters(std::vector<const Object3D*> casters);
+	void setDynamicCasters(std::vector<const Object3D*> casters);
+
+	/**
+	 * @brief Marks every static tile stale, because static geometry was added, removed or moved.
+	 */
+	void invalidateStatic();
+
+	/**
+	 * @brief Brings the live atlas up to date for this frame. views[i] is rendered into tile i;
+	 * views beyond tileCount() are ignored.
+	 */
+	void update(const std::vector<ShadowView>& views);
+
+	/**
+	 * @brief Binds the live atlas and uploads each tile's shadow matrix and atlas rectangle to
+	 * the given (active) program.
+	 */
+	void bind(ShaderProgram& program) const;
+
+	uint32_t staticRendersLastUpdate() const { return m_staticRenders; }
+};
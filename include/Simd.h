@@ -0,0 +1,7 @@
+#pragma once
+// Detects whether SSE intrinsics can be used. SIMD_SSE is defined when they can; every SIMD code
+// path in the project keeps a scalar fallback for other targets.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE 1
+#include <immintrin.h>
+#endif
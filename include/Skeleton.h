@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/ext.hpp>
+#include "CompressedClip.h"
+
+/**
+ * @brief One node of a model's hierarchy, as a joint that skinned meshes can be bound to.
+ */
+struct Joint {
+	std::string name;
+	// Index of the parent joint, which always comes before this one, or -1 for the root.
+	int32_t parent;
+	// The joint's transformation relative to its parent, as it was imported.
+	glm::mat4 bindLocal;
+};
+
+/**
+ * @brief A bone of a skinned mesh: the joint that moves it, and the transformation from the
+ * mesh's space to that joint's space in the bind pose.
+ */
+struct SkinBone {
+	uint32_t joint;
+	glm::mat4 offset;
+};
+
+/**
+ * @brief The bones of one skinned mesh, which occupy consecutive matrices of the skinning
+ * palette from paletteOffset on. Its vertices refer to bones by their index in this list.
+ */
+struct Skin {
+	// The joint of the node the mesh hangs from, and the inverse of its bind transformation relative
+	// to the root, which the mesh's model matrix already applies.
+	uint32_t meshJoint;
+	glm::mat4 inverseMeshBind;
+	uint32_t paletteOffset;
+	std::vector<SkinBone> bones;
+};
+
+/**
+ * @brief The joints of a model's hierarchy in one flat array, parents before children, the
+ * skins of its meshes, and the compressed clips that animate it.
+ *
+ * Poses are computed by walking the array once: each joint's global transformation is its
+ * parent's times its own local one. The skinning palette then holds one matrix per bone of every
+ * skin, which takes a vertex from its mesh's space in the bind pose to the mesh's space in the
+ * current pose. Since the renderer still places each mesh with its node's bind transformation,
+ * the palette backs that out, and is the identity in the bind pose.
+ */
+class Skeleton {
+private:
+	std::vector<Joint> m_joints{};
+	std::vector<Skin> m_skins{};
+	std::vector<CompressedClip> m_clips{};
+	uint32_t m_paletteSize{ 0 };
+
+public:
+	/**
+	 * @brief Appends a joint, whose parent must already have been added, and returns its index.
+	 */
+	uint32_t addJoint(std::string name, int32_t parent, const glm::mat4& bindLocal);
+
+	/**
+	 * @brief Appends the skin of a mesh, and returns its offset in the skinning palette.
+	 */
+	uint32_t addSkin(uint32_t meshJoint, std::vector<SkinBone> bones);
+
+	void addClip(CompressedClip clip);
+
+	/**
+	 * @brief The index of the first joint with the given name, or -1 if there is none.
+	 */
+	int32_t findJoint(const std::string& name) const;
+
+	const std::vector<Joint>& joints() const { return m_joints; }
+	const std::vector<Skin>& skins() const { return m_skins; }
+	const std::vector<CompressedClip>& clips() const { return m_clips; }
+	// The first clip with the given name, or nullptr if there is none.
+	const CompressedClip* findClip(const std::string& name) const;
+	// The number of matrices in the skinning palette.
+	uint32_t paletteSize() const { return m_paletteSize; }
+
+	/**
+	 * @brief Fills locals with every joint's bind transformation.
+	 */
+	void bindPose(std::vector<glm::mat4>& locals) const;
+
+	/**
+	 * @brief How far each joint's descendants reach from it in the bind pose: the longest chain
+	 * of bones below it, which is 0 for the joints at the ends of chains.
+	 */
+	std::vector<float> jointReach() const;
+
+	/**
+	 * @brief Computes every joint's transformation relative to the root from the local ones.
+	 */
+	void computeGlobals(const std::vector<glm::mat4>& locals, std::vector<glm::mat4>& globals) const;
+
+	/**
+	 * @brief Computes the skinning palette from the joints' global transformations.
+	 */
+	void computePalette(const std::vector<glm::mat4>& globals, std::vector<glm::mat4>& palette) const;
+};
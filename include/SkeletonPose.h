@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/ext.hpp>
+#include "Skeleton.h"
+#include "ShaderProgram.h"
+
+/**
+ * @brief The current pose of one instance of a skinned model, and its skinning palette on the GPU.
+ *
+ * The palette lives in a texture buffer, four RGBA32F texels per matrix, so the number of bones
+ * is limited only by the buffer's size rather than by a uniform array. It is computed and uploaded
+ * once per frame, and then read by the skinning pass that poses the model's meshes.
+ */
+class SkeletonPose {
+private:
+	std::shared_ptr<const Skeleton> m_skeleton;
+	std::vector<glm::mat4> m_locals{};
+	std::vector<glm::mat4> m_globals{};
+	std::vector<glm::mat4> m_palette{};
+	uint32_t m_buffer;
+	uint32_t m_texture;
+	// Whether the locals have changed since the last update.
+	bool m_changed{ true };
+
+public:
+	// Texture unit of the palette, after the impostor atlases.
+	static constexpr int32_t PALETTE_UNIT = 14;
+
+	explicit SkeletonPose(std::shared_ptr<const Skeleton> skeleton);
+	~SkeletonPose();
+	SkeletonPose(const SkeletonPose&) = delete;
+	SkeletonPose& operator=(const SkeletonPose&) = delete;
+
+	const Skeleton& skeleton() const { return *m_skeleton; }
+
+	/**
+	 * @brief Each joint's transformation relative to its parent, for animation to write to.
+	 */
+	std::vector<glm::mat4>& locals() { return m_locals; }
+	const std::vector<glm::mat4>& locals() const { return m_locals; }
+	// Each joint's transformation relative to the root, as of the last update.
+	const std::vector<glm::mat4>& globals() const { return m_globals; }
+	const std::vector<glm::mat4>& palette() const { return m_palette; }
+
+	/**
+	 * @brief Returns every joint to its bind transformation.
+	 */
+	void resetToBind();
+
+	/**
+	 * @brief Records that the locals were written, so the pose must be updated, uploaded and
+	 * skinned again. Poses that did not change keep last frame's palette and posed meshes.
+	 */
+	void markChanged() { m_changed = true; }
+	bool changed() const { return m_changed; }
+
+	/**
+	 * @brief Recomputes the joints' global transformations and the palette from the locals, and
+	 * clears the changed flag.
+	 */
+	void update();
+
+	/**
+	 * @brief Copies the palette to its texture buffer.
+	 */
+	void upload();
+
+	/**
+	 * @brief Binds the palette for skinning the model with the given program, which is active.
+	 */
+	void bind(ShaderProgram& program) const;
+};
@@ -0,0 +1,166 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <glm/ext.hpp>
+#include "Mesh.h"
+#include "PointLight.h"
+#include "WorkerPool.h"
+
+/**
+ * @brief A texture's image in memory, four bytes of RGBA per texel with its rows from v = 0 up,
+ * sampled bilinearly with repeat wrapping, as the GPU samples the base textures.
+ */
+struct SoftwareTexture {
+	int32_t width{ 0 };
+	int32_t height{ 0 };
+	std::vector<uint8_t> texels{};
+
+	glm::vec4 sample(glm::vec2 uv) const;
+
+	/**
+	 * @brief Reads the first level of a 2D texture back from the GPU.
+	 */
+	static SoftwareTexture readBack(uint32_t textureId);
+};
+
+/**
+ * @brief A mesh's triangles in memory: positions, normals and texture coordinates per vertex,
+ * three indices per triangle, and the texture bound to its base sampler, if any.
+ */
+struct SoftwareMesh {
+	std::vector<glm::vec3> positions{};
+	std::vector<glm::vec3> normals{};
+	std::vector<glm::vec2> texCoords{};
+	std::vector<uint32_t> indices{};
+	uint32_t baseTexture{ 0 };
+	glm::vec3 boundsMin{ 0 };
+	glm::vec3 boundsMax{ 0 };
+};
+
+// The lights of a frame, as the Phong program's uniforms give them.
+struct SoftwareLighting {
+	glm::vec3 ambientColor{ 1, 1, 1 };
+	// The "I" vector, pointing away from the light.
+	glm::vec3 directionalLight{ 0, -1, 0 };
+	glm::vec3 directionalColor{ 1, 1, 1 };
+	std::vector<PointLight> lights{};
+};
+
+/**
+ * @brief Draws meshes on the CPU, with the Phong lighting and texturing of the GPU programs, for
+ * machines with no GPU and for output that is the same on every machine.
+ *
+ * Each draw transforms its vertices, clips its triangles to the near plane and bins them into
+ * TILE_SIZE-pixel tiles of the screen. endFrame() then rasterizes the tiles in parallel, the
+ * busiest first, each thread taking the next tile as it finishes one. Within a tile, triangles
+ * are drawn in the order they were submitted, so the image never depends on the threads.
+ * Inside tests evaluate the edge functions four pixels at a time where SIMD_SSE is available.
+ *
+ * Not ported: shadows, baked lightmaps and probes, and vertex animation textures. Skinned
+ * meshes are drawn in the pose they had when first read back.
+ */
+class SoftwareRasterizer {
+public:
+	static constexpr int32_t TILE_SIZE = 32;
+
+private:
+	// A triangle after clipping, in screen space, with what its fragments interpolate.
+	struct Triangle {
+		glm::vec2 screen[3];
+		float depth[3];
+		float invW[3];
+		glm::vec3 world[3];
+		glm::vec3 normal[3];
+		glm::vec2 uv[3];
+		uint32_t draw;
+	};
+
+	// What a draw's fragments are shaded with, and the lights that can reach it.
+	struct Draw {
+		const SoftwareTexture* texture;
+		glm::vec4 material;
+		uint32_t lightsBegin;
+		uint32_t lightsCount;
+	};
+
+	struct ClipVertex {
+		glm::vec4 clip;
+		glm::vec3 world;
+		glm::vec3 normal;
+		glm::vec2 uv;
+	};
+
+	WorkerPool& m_pool;
+	int32_t m_width;
+	int32_t m_height;
+	int32_t m_tilesX;
+	int32_t m_tilesY;
+	std::vector<uint8_t> m_color;
+	std::vector<float> m_depth;
+
+	glm::mat4 m_viewProjection{ 1 };
+	glm::vec3 m_viewPos{ 0 };
+	SoftwareLighting m_lighting{};
+	std::vector<Draw> m_draws{};
+	std::vector<uint32_t> m_drawLights{};
+	std::vector<Triangle> m_triangles{};
+	std::vector<std::vector<uint32_t>> m_bins;
+	std::vector<ClipVertex> m_vertices{};
+
+	// Meshes and textures read back from the GPU, by the Mesh they came from and by texture id.
+	// A mesh is read once, so skinned and vertex-animated meshes stay in the pose they were first
+	// drawn in. Textures are read once too, except those rendered to, which are read every frame.
+	std::unordered_map<const Mesh*, SoftwareMesh> m_meshCache{};
+	std::unordered_map<uint32_t, SoftwareTexture> m_textureCache{};
+	std::unordered_set<uint32_t> m_renderTargets{};
+
+	void setUpTriangle(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, uint32_t draw,
+		std::vector<Triangle>& out) const;
+	// The triangle's bounding box, within the screen.
+	std::pair<glm::vec2, glm::vec2> screenBounds(const Triangle& triangle) const;
+	void rasterizeTile(int32_t tile);
+	glm::vec3 shade(const Triangle& triangle, const Draw& draw, float q0, float q1, float q2) const;
+
+public:
+	SoftwareRasterizer(int32_t width, int32_t height, WorkerPool& pool);
+
+	/**
+	 * @brief Clears the image to black and the depth to the far plane, and sets the camera and
+	 * lights of the draws to come.
+	 */
+	void beginFrame(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos,
+		const SoftwareLighting& lighting);
+
+	/**
+	 * @brief Transforms, clips and bins a mesh's triangles.
+	 * @param texture the base texture, or null for plain white.
+	 * @param material (ambient, diffuse, specular, shininess), as Object3D has it.
+	 */
+	void draw(const SoftwareMesh& mesh, const SoftwareTexture* texture, const glm::mat4& model, const glm::vec4& material);
+
+	/**
+	 * @brief Draws a GPU mesh, reading it and its base texture back the first time it is drawn.
+	 */
+	void draw(const Mesh& mesh, const glm::mat4& model, const glm::vec4& material);
+
+	/**
+	 * @brief Has a texture read back again each frame it is drawn, because it is rendered to.
+	 */
+	void addRenderTarget(uint32_t textureId) { m_renderTargets.insert(textureId); }
+
+	/**
+	 * @brief Rasterizes and shades everything drawn since beginFrame().
+	 */
+	void endFrame();
+
+	int32_t width() const { return m_width; }
+	int32_t height() const { return m_height; }
+
+	/**
+	 * @brief The image, RGB8 with rows from the bottom up, as glTexSubImage2D takes it.
+	 */
+	const std::vector<uint8_t>& pixels() const { return m_color; }
+};
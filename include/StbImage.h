@@ -8,16 +8,20 @@ class StbImage
 {
     int m_width, m_height, m_bpp;
     std::unique_ptr<unsigned char[]> m_data = nullptr;
+    std::unique_ptr<float[]> m_hdrData = nullptr;
 
 public:
     StbImage();
 
     void loadFromFile(const std::string& filepath);
+    // Loads a high dynamic range image (such as a Radiance .hdr) as floating-point RGB.
+    void loadHdrFromFile(const std::string& filepath);
 
     int getWidth() const;
     int getHeight() const;
     int getBpp() const;
     unsigned char* getData() const;
+    float* getHdrData() const;
 };
 
 #endif
\ No newline at end of file
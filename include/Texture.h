@@ -32,4 +32,23 @@ struct Texture {
 
 		return Texture{ texId, samplerName };
 	}
+
+	/**
+	 * @brief Loads a high dynamic range image into VRAM as shared-exponent RGB9_E5, four bytes
+	 * per texel. Used for lightmaps, so it clamps at the edges and has no mipmaps.
+	 */
+	static Texture loadHdrImage(const StbImage& texture, const std::string& samplerName) {
+		uint32_t texId;
+		glGenTextures(1, &texId);
+		glBindTexture(GL_TEXTURE_2D, texId);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB9_E5, texture.getWidth(), texture.getHeight(), 0, GL_RGB,
+			GL_FLOAT, texture.getHdrData());
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		return Texture{ texId, samplerName };
+	}
 };
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Calls callbacks after delays, on a hierarchical timer wheel: LEVELS wheels of SLOTS
+ * slots, where each slot of level n spans SLOTS^n ticks. A timer goes in the slot of the finest
+ * level whose span covers its delay, in a list threaded through a pool of timers, so scheduling
+ * and cancelling are O(1) however many timers are pending. Each tick fires the timers in the
+ * finest wheel's current slot; when that wheel comes round, the next coarser wheel's current
+ * slot is cascaded down into the finer ones.
+ *
+ * Delays longer than the wheels span are held in the coarsest wheel and cascaded until they fit.
+ */
+class TimerWheel {
+public:
+	using TimerId = uint64_t;
+	static constexpr TimerId NO_TIMER{ 0 };
+	static constexpr uint32_t SLOT_BITS{ 6 };
+	static constexpr uint32_t SLOTS{ 1u << SLOT_BITS };
+	static constexpr uint32_t LEVELS{ 4 };
+
+private:
+	struct Timer {
+		uint64_t expiry{ 0 };
+		std::function<void()> callback{};
+		// The timer's neighbours in its slot's list, and the slot, or -1 for none.
+		int32_t prev{ -1 };
+		int32_t next{ -1 };
+		int32_t slot{ -1 };
+		// Bumped each time the timer is released, so that stale ids can't cancel its reuses.
+		uint32_t generation{ 1 };
+	};
+
+	float m_tickLength;
+	// Time advanced that has not yet made up a whole tick.
+	float m_remainder{ 0 };
+	uint64_t m_now{ 0 };
+	std::vector<Timer> m_timers{};
+	std::vector<int32_t> m_free{};
+	// The first timer in each slot, level by level.
+	std::vector<int32_t> m_heads;
+	size_t m_pending{ 0 };
+
+	void link(int32_t timer);
+	void unlink(int32_t timer);
+	void release(int32_t timer);
+	void cascade(uint32_t level);
+	void tick();
+
+public:
+	/**
+	 * @brief Constructs an empty wheel that advances in ticks of the given length, in seconds.
+	 * Timers fire on the first tick at or after their delay.
+	 */
+	explicit TimerWheel(float tickLength);
+
+	/**
+	 * @brief Calls a callback once, after the given delay in seconds, rounded up to a whole tick
+	 * and at least one. Callbacks may schedule and cancel timers.
+	 */
+	TimerId schedule(float delay, std::function<void()> callback);
+
+	/**
+	 * @brief Stops a pending timer from firing. Returns false if it has already fired or been
+	 * cancelled.
+	 */
+	bool cancel(TimerId id);
+
+	/**
+	 * @brief Advances time by the given interval, in seconds, firing every timer due in it in the
+	 * order they expire.
+	 */
+	void advance(float dt);
+
+	float tickLength() const { return m_tickLength; }
+	uint64_t now() const { return m_now; }
+	size_t pending() const { return m_pending; }
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/ext.hpp>
+
+/**
+ * @brief A ray segment from origin along direction, from a small epsilon up to tMax.
+ */
+struct Ray {
+	glm::vec3 origin;
+	glm::vec3 direction;
+	float tMax;
+};
+
+/**
+ * @brief The closest intersection along a ray: the distance, the index of the triangle in the
+ * order it was given to the BVH, and the barycentric coordinates of the hit on that triangle.
+ */
+struct RayHit {
+	static constexpr uint32_t MISS = UINT32_MAX;
+
+	float t{ 0 };
+	uint32_t triangle{ MISS };
+	float u{ 0 };
+	float v{ 0 };
+
+	bool hit() const { return triangle != MISS; }
+};
+
+/**
+ * @brief A bounding volume hierarchy over a static triangle soup, for offline ray casting by the
+ * lighting bakers.
+ *
+ * The tree is built top-down with a binned surface area heuristic. Rays can be traced one at a
+ * time, or as packets of four that traverse the tree together and are intersected with SSE; the
+ * packet path suits coherent rays such as the hemisphere samples taken from one texel.
+ */
+class TriangleBVH {
+private:
+	struct Node {
+		glm::vec3 boundsMin;
+		// For interior nodes, the index of the left child (the right child follows it); for
+		// leaves, the first triangle.
+		uint32_t leftOrFirst;
+		glm::vec3 boundsMax;
+		// The number of triangles in a leaf, or 0 for an interior node.
+		uint32_t count;
+	};
+
+	// Triangles in leaf order, stored as a vertex and two edges for Moller-Trumbore tests.
+	std::vector<glm::vec3> m_v0;
+	std::vector<glm::vec3> m_e1;
+	std::vector<glm::vec3> m_e2;
+	// Maps leaf order back to the caller's triangle indices.
+	std::vector<uint32_t> m_original;
+	std::vector<Node> m_nodes;
+
+	void build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices);
+
+	template <bool AnyHit>
+	bool traverse(const Ray& ray, RayHit& hit) const;
+	template <bool AnyHit>
+	uint32_t traverse4(const Ray* rays, RayHit* hits) const;
+
+public:
+	// Leaves hold at most this many triangles.
+	static constexpr uint32_t MAX_LEAF_SIZE = 4;
+	// Hits closer than this are ignored, so rays leaving a surface don't hit it again.
+	static constexpr float EPSILON = 1e-4f;
+
+	/**
+	 * @brief Builds a BVH over the triangles formed by each three indices into positions.
+	 */
+	TriangleBVH(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices);
+
+	size_t triangleCount() const { return m_original.size(); }
+
+	/**
+	 * @brief Finds the closest hit along the ray. Returns false if it hits nothing.
+	 */
+	bool intersect(const Ray& ray, RayHit& hit) const;
+
+	/**
+	 * @brief Whether anything blocks the ray; stops at the first hit found.
+	 */
+	bool occluded(const Ray& ray) const;
+
+	/**
+	 * @brief Finds the closest hit of each of four rays, traversing the tree as one packet.
+	 * @return a bit mask of the rays that hit something.
+	 */
+	uint32_t intersect4(const Ray rays[4], RayHit hits[4]) const;
+
+	/**
+	 * @brief Tests four rays for occlusion as one packet.
+	 * @return a bit mask of the rays that are blocked.
+	 */
+	uint32_t occluded4(const Ray rays[4]) const;
+};
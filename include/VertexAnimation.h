@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "CompressedClip.h"
+#include "Object3D.h"
+#include "ShaderProgram.h"
+
+/**
+ * @brief How finely a clip is baked into vertex animation textures.
+ */
+struct VertexAnimationSettings {
+	// Frames baked per second of the clip; playback interpolates between them.
+	float frameRate{ 30 };
+	// The most frames baked, however long the clip is.
+	uint32_t maxFrames{ 512 };
+};
+
+/**
+ * @brief A clip of a skinned model, baked into vertex animation textures on each of its skinned
+ * meshes, so that any number of copies of the model can play it with no bones and no work on the
+ * CPU: the vertex shaders' VERTEX_ANIMATION permutation reads each vertex's posed position and
+ * normal from the rows of the frames either side of the object's current frame, and blends them.
+ *
+ * Frames are baked on the GPU: each is sampled from the clip and skinned into the meshes' posed
+ * buffers by the skinning pass, which are then copied into the textures' rows without leaving
+ * the GPU. A mesh holds one baked animation at a time.
+ */
+class VertexAnimation {
+private:
+	std::string m_name;
+	float m_duration;
+	uint32_t m_frameCount;
+
+	VertexAnimation(std::string name, float duration, uint32_t frameCount);
+
+public:
+	/**
+	 * @brief Bakes a clip of the given model, which must have a skeleton pose, with the skinning
+	 * program. The model is left in its bind pose.
+	 */
+	static VertexAnimation bake(Object3D& model, const CompressedClip& clip, ShaderProgram& skinProgram,
+		const VertexAnimationSettings& settings);
+
+	const std::string& name() const { return m_name; }
+	float duration() const { return m_duration; }
+	uint32_t frameCount() const { return m_frameCount; }
+
+	/**
+	 * @brief The frame, with the fraction between two frames, to play at the given time in
+	 * seconds, looping the clip.
+	 */
+	float frameAt(float time) const;
+};
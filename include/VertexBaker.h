@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/ext.hpp>
+#include "BakeScene.h"
+#include "LightmapFile.h"
+#include "WorkerPool.h"
+
+struct VertexBakeSettings {
+	// Hemisphere samples per vertex, for both indirect light and ambient occlusion.
+	uint32_t samples{ 64 };
+	// How far away geometry still occludes ambient light, in world units.
+	float occlusionDistance{ 1.0f };
+};
+
+/**
+ * @brief Bakes lighting into the vertices of meshes in a BakeScene: a cheaper alternative to
+ * lightmaps, with no unwrap and no texture, at the cost of detail between vertices.
+ *
+ * Each vertex gets the direct and one-bounce irradiance at its position, plus the fraction of
+ * its hemisphere open to ambient light. Vertices are spread over a WorkerPool.
+ */
+class VertexBaker {
+private:
+	const BakeScene& m_scene;
+	WorkerPool& m_pool;
+	VertexBakeSettings m_settings;
+
+public:
+	VertexBaker(const BakeScene& scene, WorkerPool& pool, const VertexBakeSettings& settings);
+
+	/**
+	 * @brief Bakes the scene's meshes [firstMesh, firstMesh + meshCount): for each mesh, one
+	 * (irradiance, ambient occlusion) per vertex.
+	 */
+	VertexLighting bake(size_t firstMesh, size_t meshCount) const;
+};
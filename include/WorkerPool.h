@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed set of worker threads that run parallel loops. The calling thread takes part in
+ * every loop, so a pool with no workers simply runs loops inline.
+ *
+ * Work is handed out in chunks through a shared atomic counter, so threads that finish early
+ * keep taking chunks until the range is exhausted.
+ */
+class WorkerPool {
+private:
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+
+	// The loop currently being run.
+	const std::function<void(size_t, size_t)>* m_job;
+	size_t m_end;
+	size_t m_grain;
+	std::atomic<size_t> m_next;
+	uint64_t m_generation;
+	uint32_t m_busy;
+	bool m_stopping;
+
+	void workerLoop();
+	void runChunks();
+
+public:
+	/**
+	 * @brief Starts a pool with the given number of worker threads; by default, one fewer than
+	 * the number of hardware threads, since the caller also works.
+	 */
+	explicit WorkerPool(uint32_t workers = defaultWorkerCount());
+	~WorkerPool();
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	static uint32_t defaultWorkerCount();
+
+	/**
+	 * @brief The number of threads that run each loop, including the caller.
+	 */
+	uint32_t threadCount() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+	/**
+	 * @brief Calls body(begin, end) over disjoint sub-ranges of [0, count), at most grain
+	 * elements at a time, and returns once all of them have completed.
+	 */
+	void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+};
@@ -0,0 +1,58 @@
+#version 330
+// A fragment shader that lights one pixel of a G-buffer in the Phong reflection model. The
+// lighting matches lighting.frag; only the surface attributes come from textures instead of
+// interpolated vertex outputs.
+layout (location=0) out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// The G-buffer written by gbuffer.frag.
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gMaterial;
+uniform sampler2D gDepth;
+uniform float shininessScale;
+
+// Reconstructs world positions from depth.
+uniform mat4 inverseViewProjection;
+
+// Pixels -> tiles scale of the light cluster grid, and the world->view matrix for depth slicing.
+uniform vec2 clusterTileScale;
+uniform mat4 view;
+
+// Read from the G-buffer per pixel, for phong().
+vec4 material;
+
+#include "phong_lighting.glsl"
+
+vec3 decodeNormal(vec2 f) {
+    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main() {
+    float depth = texture(gDepth, TexCoord).r;
+    if (depth == 1.0) {
+        // Nothing was drawn here.
+        discard;
+    }
+    vec4 world = inverseViewProjection * vec4(vec3(TexCoord, depth) * 2.0 - 1.0, 1.0);
+    vec3 fragWorldPos = world.xyz / world.w;
+
+    vec4 albedo = texture(gAlbedo, TexCoord);
+    vec3 norm = decodeNormal(texture(gNormal, TexCoord).xy);
+    material = texture(gMaterial, TexCoord);
+    material.w *= shininessScale;
+
+    vec3 eyeDir = normalize(viewPos - fragWorldPos);
+    vec3 lightIntensity = material.x * ambientColor + phong(norm, eyeDir, normalize(-directionalLight), directionalColor)
+        * shadowFactor(directionalShadowTile, fragWorldPos);
+
+    float viewDepth = -(view * vec4(fragWorldPos, 1)).z;
+    lightIntensity += clusterLighting(clusterIndex(uvec2(gl_FragCoord.xy * clusterTileScale), viewDepth),
+        fragWorldPos, norm, eyeDir);
+
+    FragColor = vec4(lightIntensity, 1) * albedo;
+}
@@ -0,0 +1,5 @@
+#version 330
+// A fragment shader for depth-only passes. Depth is written by fixed-function hardware, so
+// there is nothing to compute here.
+void main() {
+}
@@ -0,0 +1,10 @@
+#version 330
+// A vertex shader that generates one triangle covering the whole viewport, with no vertex
+// attributes. Draw it with glDrawArrays(GL_TRIANGLES, 0, 3).
+out vec2 TexCoord;
+
+void main() {
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TexCoord = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,32 @@
+#version 330
+// A fragment shader that writes surface attributes to a G-buffer for deferred shading.
+layout (location=0) out vec4 gAlbedo;
+layout (location=1) out vec2 gNormal;
+layout (location=2) out vec4 gMaterial;
+
+in vec2 TexCoord;
+in vec3 Normal;
+in vec3 FragWorldPos;
+
+uniform sampler2D baseTexture;
+// Material parameters for the whole mesh: k_a, k_d, k_s, shininess.
+uniform vec4 material;
+// Shininess is divided by this to fit an 8-bit channel.
+uniform float shininessScale;
+
+// Octahedral encoding: project the unit normal onto an octahedron, then fold the lower half
+// over the upper so that it fits in two components.
+vec2 octWrap(vec2 v) {
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec2 encodeNormal(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    return n.z >= 0.0 ? n.xy : octWrap(n.xy);
+}
+
+void main() {
+    gAlbedo = texture(baseTexture, TexCoord);
+    gNormal = encodeNormal(normalize(Normal));
+    gMaterial = vec4(material.xyz, material.w / shininessScale);
+}
@@ -0,0 +1,22 @@
+#version 330
+// Applies the lighting computed per vertex by gouraud.vert to the base texture.
+layout (location=0) out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec3 LightIntensity;
+
+uniform sampler2D baseTexture;
+
+#ifdef LIGHTMAP
+in vec2 LightmapCoord;
+uniform sampler2D lightmap;
+uniform vec4 material;
+#endif
+
+void main() {
+    vec3 lightIntensity = LightIntensity;
+#ifdef LIGHTMAP
+    lightIntensity += material.y * texture(lightmap, LightmapCoord).rgb;
+#endif
+    FragColor = vec4(lightIntensity, 1) * texture(baseTexture, TexCoord);
+}
@@ -0,0 +1,66 @@
+#version 330
+// A vertex shader that evaluates the Phong reflection model once per vertex (Gouraud shading),
+// for distant objects and low-resolution passes where per-pixel lighting is not worth its cost.
+// Takes the same lights, clusters, shadows and permutations (LIGHTMAP, VERTEX_LIGHTING,
+// PROBE_LIGHTING) as lighting.frag, and VERTEX_ANIMATION as light_perspective.vert; gouraud.frag
+// only applies the result to the texture.
+layout (location=0) in vec3 vPosition;
+layout (location=1) in vec3 vNormal;
+layout (location=2) in vec2 vTexCoord;
+#ifdef LIGHTMAP
+layout (location=3) in vec2 vLightmapCoord;
+out vec2 LightmapCoord;
+#endif
+#ifdef VERTEX_LIGHTING
+layout (location=4) in vec4 vVertexLight;
+#endif
+#include "vertex_animation.glsl"
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+
+// Positions must match the depth prepass (simple_perspective.vert) exactly.
+invariant gl_Position;
+
+out vec2 TexCoord;
+// Everything but the lightmap's contribution, which is still fetched per fragment.
+out vec3 LightIntensity;
+
+uniform vec4 material;
+
+#include "phong_lighting.glsl"
+
+void main() {
+    vec3 position = vertexPosition();
+    vec4 worldPos = model * vec4(position, 1.0);
+    gl_Position = projection * view * model * vec4(position, 1.0);
+    TexCoord = vTexCoord;
+#ifdef LIGHTMAP
+    LightmapCoord = vLightmapCoord;
+#endif
+
+    vec3 norm = normalize(mat3(transpose(inverse(model))) * vertexNormal());
+    vec3 eyeDir = normalize(viewPos - worldPos.xyz);
+    vec3 ambientIntensity = material.x * ambientColor;
+#ifdef LIGHTMAP
+    vec3 lightIntensity = ambientIntensity;
+#elif defined(VERTEX_LIGHTING)
+    vec3 lightIntensity = ambientIntensity * vVertexLight.a + material.y * vVertexLight.rgb;
+#else
+    vec3 lightIntensity = ambientIntensity + phong(norm, eyeDir, normalize(-directionalLight), directionalColor)
+        * shadowFactor(directionalShadowTile, worldPos.xyz);
+#ifdef PROBE_LIGHTING
+    lightIntensity += material.y * shIrradiance(norm);
+#endif
+#endif
+
+    // The vertex's cluster, from its projected position. Lights are only gathered from this one
+    // cluster, so a light that reaches the middle of a large triangle but none of its corners'
+    // clusters is missed, as Gouraud shading would miss its highlight anyway.
+    vec2 ndc = clamp(gl_Position.xy / max(gl_Position.w, 1e-6), vec2(-1), vec2(1));
+    float depth = max(gl_Position.w, clusterDepthParams.x);
+    lightIntensity += clusterLighting(clusterIndex(uvec2((ndc * 0.5 + 0.5) * clusterDims.xy), depth),
+        worldPos.xyz, norm, eyeDir);
+    LightIntensity = lightIntensity;
+}
@@ -0,0 +1,60 @@
+#version 330
+// Shades an impostor from its baked atlas: blends the four views nearest the camera direction,
+// then lights the blended albedo and normal with the ambient, directional and probe light that
+// lighting.frag's coarsest level uses.
+layout (location=0) out vec4 FragColor;
+
+in vec2 QuadCoord;
+
+// The octahedral atlas: gridSize x gridSize views, albedo with coverage in alpha, and octahedral
+// normals in the baked frame.
+uniform sampler2D impostorAlbedo;
+uniform sampler2D impostorNormal;
+uniform float gridSize;
+// Atlas cells of the nearest views (first.xy, second.xy) and the blend between them.
+uniform vec4 viewCells;
+uniform vec2 viewBlend;
+uniform mat3 normalToWorld;
+
+uniform vec4 material;
+uniform vec3 ambientColor;
+uniform vec3 directionalLight;
+uniform vec3 directionalColor;
+
+#include "sh_irradiance.glsl"
+
+// The inverse of gbuffer.frag's encodeNormal.
+vec3 decodeNormal(vec2 f) {
+    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+vec2 atlasCoord(vec2 cell) {
+    return (cell + QuadCoord) / gridSize;
+}
+
+void main() {
+    vec2 cells[4] = vec2[4](viewCells.xy, viewCells.zy, viewCells.xw, viewCells.zw);
+    float weights[4] = float[4](
+        (1.0 - viewBlend.x) * (1.0 - viewBlend.y), viewBlend.x * (1.0 - viewBlend.y),
+        (1.0 - viewBlend.x) * viewBlend.y, viewBlend.x * viewBlend.y);
+
+    vec4 albedo = vec4(0.0);
+    vec3 normal = vec3(0.0);
+    for (int i = 0; i < 4; ++i) {
+        vec4 viewAlbedo = texture(impostorAlbedo, atlasCoord(cells[i]));
+        albedo += weights[i] * viewAlbedo;
+        normal += weights[i] * viewAlbedo.a * decodeNormal(texture(impostorNormal, atlasCoord(cells[i])).xy);
+    }
+    if (albedo.a < 0.5) {
+        discard;
+    }
+    vec3 norm = normalize(normalToWorld * normal);
+
+    vec3 lightIntensity = material.x * ambientColor
+        + material.y * directionalColor * max(dot(norm, normalize(-directionalLight)), 0.0)
+        + material.y * shIrradiance(norm);
+    FragColor = vec4(lightIntensity * albedo.rgb / albedo.a, 1.0);
+}
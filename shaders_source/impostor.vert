@@ -0,0 +1,20 @@
+#version 330
+// Draws an impostor: a quad facing the camera, standing in for a distant object. The four corners
+// are generated from gl_VertexID; draw with glDrawArrays(GL_TRIANGLE_STRIP, 0, 4).
+uniform mat4 projection;
+uniform mat4 view;
+
+// The quad's center and half-extent axes in world space, set per object by Impostor::render.
+uniform vec3 quadCenter;
+uniform vec3 quadRight;
+uniform vec3 quadUp;
+
+// Position on the quad, from (0, 0) at the bottom left to (1, 1) at the top right.
+out vec2 QuadCoord;
+
+void main() {
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    QuadCoord = corner;
+    vec3 worldPos = quadCenter + quadRight * (corner.x * 2.0 - 1.0) + quadUp * (corner.y * 2.0 - 1.0);
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+}
@@ -1,27 +1,49 @@
 #version 330
 // A vertex shader for rendering vertices with normal vectors and texture coordinates,
-// which creates outputs needed for a Phong reflection fragment shader.
+// which creates outputs needed for a Phong reflection fragment shader. With VERTEX_ANIMATION,
+// meshes with baked vertex animations can be drawn from them instead of their vertex buffers.
 layout (location=0) in vec3 vPosition;
 layout (location=1) in vec3 vNormal;
 layout (location=2) in vec2 vTexCoord;
+#ifdef LIGHTMAP
+// The second UV set of lightmapped meshes.
+layout (location=3) in vec2 vLightmapCoord;
+out vec2 LightmapCoord;
+#endif
+#ifdef VERTEX_LIGHTING
+// Baked irradiance (rgb) and ambient occlusion (a) of vertex-lit meshes.
+layout (location=4) in vec4 vVertexLight;
+out vec4 VertexLight;
+#endif
+#include "vertex_animation.glsl"
 
 uniform mat4 projection;
 uniform mat4 view;
 uniform mat4 model;
 
+// Positions must match the depth prepass (simple_perspective.vert) exactly.
+invariant gl_Position;
+
 out vec2 TexCoord;
 out vec3 Normal;
 out vec3 FragWorldPos;
 
 void main() {
     // Transform the vertex position from local space to clip space.
-    gl_Position = projection * view * model * vec4(vPosition, 1.0);
-    FragWorldPos = vec3(model * vec4(vPosition, 1.0));
+    vec3 position = vertexPosition();
+    gl_Position = projection * view * model * vec4(position, 1.0);
+    FragWorldPos = vec3(model * vec4(position, 1.0));
     // Pass along the vertex texture coordinate.
     TexCoord = vTexCoord;
+#ifdef LIGHTMAP
+    LightmapCoord = vLightmapCoord;
+#endif
+#ifdef VERTEX_LIGHTING
+    VertexLight = vVertexLight;
+#endif
     // Transform the vertex normal from local space to world space, using the Normal matrix.
     mat4 normalMatrix = transpose(inverse(model));
-    Normal = mat3(transpose(inverse(model))) * vNormal;
+    Normal = mat3(transpose(inverse(model))) * vertexNormal();
     
     // TODO: transform the vertex position into world space, and assign it to FragWorldPos.
 }
\ No newline at end of file
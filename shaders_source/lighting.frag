@@ -1,5 +1,11 @@
 #version 330
 // A fragment shader for rendering fragments in the Phong reflection model.
+// Compiled with LIGHTMAP defined, static surfaces take the directional light and all baked
+// lights from a lightmap instead; compiled with VERTEX_LIGHTING, they take them from
+// irradiance and ambient occlusion baked into each vertex. Compiled with PROBE_LIGHTING, other
+// surfaces add bounced light from the light probes around the object being drawn. Compiled with
+// UNLIT, for the coarsest shading level of detail, only baked and ambient light is applied, with
+// an unshadowed diffuse directional term standing in for surfaces that have no baked lighting.
 layout (location=0) out vec4 FragColor;
 
 // Inputs: the texture coordinates, world-space normal, and world-space position
@@ -13,50 +19,54 @@ in vec3 FragWorldPos;
 // The mesh's base (diffuse) texture.
 uniform sampler2D baseTexture;
 
+#ifdef LIGHTMAP
+in vec2 LightmapCoord;
+// Irradiance from the directional light and the baked lights, with shadows and one bounce.
+uniform sampler2D lightmap;
+#endif
+#ifdef VERTEX_LIGHTING
+in vec4 VertexLight;
+#endif
+
 // Material parameters for the whole mesh: k_a, k_d, k_s, shininess.
 uniform vec4 material;
 
-// Ambient light color.
-uniform vec3 ambientColor;
-
-// Direction and color of a single directional light.
-uniform vec3 directionalLight; // this is the "I" vector, not the "L" vector.
-uniform vec3 directionalColor;
-
-// Add uniforms for other light sources
-// TODO Reformat light calculations to loop through all lights sources and update calculations accordingly
-// Use SetUniform to update stuff like light positions during program runtime
-//uniform vec3 
-
-
+// Pixels -> tiles scale of the light cluster grid.
+uniform vec2 clusterTileScale;
 
-// Location of the camera.
-uniform vec3 viewPos;
+// The world->view matrix, to find this fragment's depth slice.
+uniform mat4 view;
 
+#include "phong_lighting.glsl"
 
 void main() {
-    // TODO: using the lecture notes, compute ambientIntensity, diffuseIntensity, 
-    // and specularIntensity.
-
     vec3 ambientIntensity = material.x * ambientColor;
-    vec3 diffuseIntensity = vec3(0);
-    vec3 specularIntensity = vec3(0);
-    
+
     vec3 norm = normalize(Normal);
-    vec3 lightDir = -directionalLight;
-    float lambertFactor = dot(norm, normalize(lightDir));
-    if (lambertFactor > 0) {
-        diffuseIntensity = material.y * directionalColor * lambertFactor;
-
-        vec3 eyeDir = normalize(viewPos - FragWorldPos);
-        vec3 reflectDir = normalize(reflect(-lightDir, norm));
-        float spec = dot(reflectDir, eyeDir);
-        if (spec > 0) {
-            specularIntensity = material.z * directionalColor * pow(spec, material.w);
-        }
-    }
-    
-
-    vec3 lightIntensity = ambientIntensity + diffuseIntensity + specularIntensity;
+    vec3 eyeDir = normalize(viewPos - FragWorldPos);
+#ifdef LIGHTMAP
+    // Baked light is diffuse only.
+    vec3 lightIntensity = ambientIntensity + material.y * texture(lightmap, LightmapCoord).rgb;
+#elif defined(VERTEX_LIGHTING)
+    // Occlusion darkens the ambient term; baked light is diffuse only.
+    vec3 lightIntensity = ambientIntensity * VertexLight.a + material.y * VertexLight.rgb;
+#elif defined(UNLIT)
+    vec3 lightIntensity = ambientIntensity
+        + material.y * directionalColor * max(dot(norm, normalize(-directionalLight)), 0.0);
+#else
+    vec3 lightIntensity = ambientIntensity + phong(norm, eyeDir, normalize(-directionalLight), directionalColor)
+        * shadowFactor(directionalShadowTile, FragWorldPos);
+#endif
+#if defined(PROBE_LIGHTING) && !defined(LIGHTMAP) && !defined(VERTEX_LIGHTING)
+    lightIntensity += material.y * shIrradiance(norm);
+#endif
+
+#ifndef UNLIT
+    // Find this fragment's cluster, then shade only the lights assigned to it.
+    float depth = -(view * vec4(FragWorldPos, 1)).z;
+    lightIntensity += clusterLighting(clusterIndex(uvec2(gl_FragCoord.xy * clusterTileScale), depth),
+        FragWorldPos, norm, eyeDir);
+#endif
+
     FragColor = vec4(lightIntensity, 1) * texture(baseTexture, TexCoord);
-}
\ No newline at end of file
+}
@@ -0,0 +1,108 @@
+// The Phong reflection model's lights, clusters and shadows, shared by lighting.frag,
+// deferred_lighting.frag and gouraud.vert. #include it after declaring vec4 material
+// (k_a, k_d, k_s, shininess); with LIGHTMAP or VERTEX_LIGHTING defined, baked lights are
+// skipped, and with PROBE_LIGHTING, shIrradiance() gives the light probes' bounced light.
+
+#ifdef PROBE_LIGHTING
+#include "sh_irradiance.glsl"
+#endif
+
+// Ambient light color.
+uniform vec3 ambientColor;
+
+// Direction and color of a single directional light.
+uniform vec3 directionalLight; // this is the "I" vector, not the "L" vector.
+uniform vec3 directionalColor;
+
+// Point and spot lights, assigned to clusters of the view frustum by LightClusters.
+// lightData holds four texels per light: (position, radius), (color, cosOuter), (direction, cosInner),
+// (shadow tile, baked, unused).
+uniform samplerBuffer lightData;
+// clusterData holds (offset, count) into lightIndices for each cluster.
+uniform usamplerBuffer clusterData;
+uniform usamplerBuffer lightIndices;
+// Grid dimensions; (near, slices / log(far / near)) for depth slicing.
+uniform vec3 clusterDims;
+uniform vec2 clusterDepthParams;
+
+// Shadow maps of shadowed lights, packed into one atlas by ShadowAtlas. Each tile has a matrix
+// taking world space to its [0, 1] shadow space, and a rectangle (offset, scale) in the atlas.
+uniform sampler2DShadow shadowAtlas;
+uniform mat4 shadowMatrices[16];
+uniform vec3 shadowTileRects[16];
+uniform int directionalShadowTile;
+
+// Location of the camera.
+uniform vec3 viewPos;
+
+// The fraction of a light reaching worldPos past the casters in its shadow tile.
+float shadowFactor(int tile, vec3 worldPos) {
+    if (tile < 0) {
+        return 1.0;
+    }
+    vec4 p = shadowMatrices[tile] * vec4(worldPos, 1);
+    p.xyz /= p.w;
+    if (any(lessThan(p.xyz, vec3(0))) || any(greaterThan(p.xyz, vec3(1)))) {
+        return 1.0;
+    }
+    vec3 rect = shadowTileRects[tile];
+    return texture(shadowAtlas, vec3(rect.xy + p.xy * rect.z, p.z));
+}
+
+// Diffuse and specular Phong terms of one light arriving from lightDir (pointing toward the light).
+vec3 phong(vec3 norm, vec3 eyeDir, vec3 lightDir, vec3 color) {
+    float lambertFactor = dot(norm, lightDir);
+    if (lambertFactor <= 0) {
+        return vec3(0);
+    }
+    vec3 result = material.y * color * lambertFactor;
+    vec3 reflectDir = normalize(reflect(-lightDir, norm));
+    float spec = dot(reflectDir, eyeDir);
+    if (spec > 0) {
+        result += material.z * color * pow(spec, material.w);
+    }
+    return result;
+}
+
+// The index of the cluster over the given tile of the grid, at the given view-space depth.
+int clusterIndex(uvec2 tile, float depth) {
+    uvec3 cluster = uvec3(tile, uint(max(log(depth / clusterDepthParams.x) * clusterDepthParams.y, 0)));
+    cluster = min(cluster, uvec3(clusterDims) - 1u);
+    return int((cluster.z * uint(clusterDims.y) + cluster.y) * uint(clusterDims.x) + cluster.x);
+}
+
+// The light reaching worldPos from the point and spot lights assigned to the given cluster.
+vec3 clusterLighting(int cluster, vec3 worldPos, vec3 norm, vec3 eyeDir) {
+    vec3 lightIntensity = vec3(0);
+    uvec2 range = texelFetch(clusterData, cluster).xy;
+    for (uint i = 0u; i < range.y; ++i) {
+        int light = int(texelFetch(lightIndices, int(range.x + i)).x) * 4;
+        vec4 positionRadius = texelFetch(lightData, light);
+        vec4 colorCosOuter = texelFetch(lightData, light + 1);
+        vec4 directionCosInner = texelFetch(lightData, light + 2);
+        vec4 shadowBaked = texelFetch(lightData, light + 3);
+#if defined(LIGHTMAP) || defined(VERTEX_LIGHTING)
+        if (shadowBaked.y > 0) {
+            continue;
+        }
+#endif
+
+        vec3 toLight = positionRadius.xyz - worldPos;
+        float distance = length(toLight);
+        if (distance >= positionRadius.w) {
+            continue;
+        }
+        vec3 lightDir = toLight / distance;
+        // Smooth falloff to exactly zero at the light's radius.
+        float falloff = 1 - (distance * distance) / (positionRadius.w * positionRadius.w);
+        float attenuation = falloff * falloff;
+        // Spot cone; omnidirectional lights have cosOuter == -1 and are never cut off.
+        if (colorCosOuter.w > -1) {
+            attenuation *= smoothstep(colorCosOuter.w, directionCosInner.w, dot(-lightDir, directionCosInner.xyz));
+        }
+
+        attenuation *= shadowFactor(int(shadowBaked.x), worldPos);
+        lightIntensity += attenuation * phong(norm, eyeDir, lightDir, colorCosOuter.rgb);
+    }
+    return lightIntensity;
+}
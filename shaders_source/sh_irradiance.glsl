@@ -0,0 +1,16 @@
+// Bounced irradiance as L2 spherical harmonics, interpolated from the probes around this object,
+// for every shader lit by the light probes: phong_lighting.glsl's PROBE_LIGHTING, and impostor.frag.
+uniform vec3 probeIrradiance[9];
+
+vec3 shIrradiance(vec3 n) {
+    vec3 result = probeIrradiance[0] * 0.282095
+        + probeIrradiance[1] * (0.488603 * n.y)
+        + probeIrradiance[2] * (0.488603 * n.z)
+        + probeIrradiance[3] * (0.488603 * n.x)
+        + probeIrradiance[4] * (1.092548 * n.x * n.y)
+        + probeIrradiance[5] * (1.092548 * n.y * n.z)
+        + probeIrradiance[6] * (0.315392 * (3.0 * n.z * n.z - 1.0))
+        + probeIrradiance[7] * (1.092548 * n.x * n.z)
+        + probeIrradiance[8] * (0.546274 * (n.x * n.x - n.y * n.y));
+    return max(result, vec3(0.0));
+}
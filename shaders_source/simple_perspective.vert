@@ -1,11 +1,18 @@
 #version 330
 layout (location=0) in vec3 vPosition;
+// Unused unless vertexNormal() is called; declared for vertex_animation.glsl.
+layout (location=1) in vec3 vNormal;
+#include "vertex_animation.glsl"
 
 uniform mat4 projection;
 uniform mat4 view;
 uniform mat4 model;
 
+// Depth prepasses draw with this shader and color passes then test with GL_EQUAL, so both must
+// compute bit-identical positions.
+invariant gl_Position;
+
 void main() {
     // Project the position to clip space.
-    gl_Position = projection * view * model * vec4(vPosition, 1.0);
+    gl_Position = projection * view * model * vec4(vertexPosition(), 1.0);
 }
\ No newline at end of file
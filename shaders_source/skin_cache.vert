@@ -0,0 +1,29 @@
+#version 330
+// Poses the vertices of a skinned mesh by its model's bone palette, with no rasterization:
+// transform feedback captures the results into the mesh's posed position and normal buffers,
+// which every pass that draws the mesh this frame then reads like any static mesh's.
+layout (location=0) in vec3 vPosition;
+layout (location=1) in vec3 vNormal;
+// The bones moving the vertex, and their weights.
+layout (location=5) in uvec4 vBoneIds;
+layout (location=6) in vec4 vBoneWeights;
+
+// The model's skinning palette, four texels per matrix, and where the mesh's bones start in it.
+uniform samplerBuffer bonePalette;
+uniform int boneOffset;
+
+out vec3 PosedPosition;
+out vec3 PosedNormal;
+
+mat4 boneMatrix(uint bone) {
+    int texel = (boneOffset + int(bone)) * 4;
+    return mat4(texelFetch(bonePalette, texel), texelFetch(bonePalette, texel + 1),
+        texelFetch(bonePalette, texel + 2), texelFetch(bonePalette, texel + 3));
+}
+
+void main() {
+    mat4 skin = boneMatrix(vBoneIds.x) * vBoneWeights.x + boneMatrix(vBoneIds.y) * vBoneWeights.y
+        + boneMatrix(vBoneIds.z) * vBoneWeights.z + boneMatrix(vBoneIds.w) * vBoneWeights.w;
+    PosedPosition = vec3(skin * vec4(vPosition, 1.0));
+    PosedNormal = mat3(skin) * vNormal;
+}
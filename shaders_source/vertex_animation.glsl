@@ -0,0 +1,42 @@
+// Shared by the vertex shaders that draw with VERTEX_ANIMATION, #included after they declare
+// vPosition and vNormal. Provides vertexPosition() and vertexNormal(), from the bound baked
+// animation when there is one and from the vertex buffers otherwise.
+#ifdef VERTEX_ANIMATION
+// A skinned mesh's baked vertex animation: each frame's posed positions and normals, one texel
+// per vertex in vatRowsPerFrame rows of each texture, or 0 rows if the mesh has none. The object
+// plays frame vertexAnimationFrame, with the fraction between two frames, unless it is negative.
+uniform sampler2D vatPositions;
+uniform sampler2D vatNormals;
+uniform int vatRowsPerFrame;
+uniform float vertexAnimationFrame;
+
+bool playsVertexAnimation() {
+    return vatRowsPerFrame > 0 && vertexAnimationFrame >= 0.0;
+}
+
+vec3 sampleVertexAnimation(sampler2D frames) {
+    ivec2 size = textureSize(frames, 0);
+    int frame = int(vertexAnimationFrame);
+    int next = min(frame + 1, size.y / vatRowsPerFrame - 1);
+    ivec2 texel = ivec2(gl_VertexID % size.x, gl_VertexID / size.x);
+    vec3 a = texelFetch(frames, texel + ivec2(0, frame * vatRowsPerFrame), 0).xyz;
+    vec3 b = texelFetch(frames, texel + ivec2(0, next * vatRowsPerFrame), 0).xyz;
+    return mix(a, b, fract(vertexAnimationFrame));
+}
+
+vec3 vertexPosition() {
+    return playsVertexAnimation() ? sampleVertexAnimation(vatPositions) : vPosition;
+}
+
+vec3 vertexNormal() {
+    return playsVertexAnimation() ? sampleVertexAnimation(vatNormals) : vNormal;
+}
+#else
+vec3 vertexPosition() {
+    return vPosition;
+}
+
+vec3 vertexNormal() {
+    return vNormal;
+}
+#endif
@@ -0,0 +1,104 @@
+#include "AnimationClip.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+	template <typename T>
+	KeyRange appendTrack(const std::vector<float>& times, const std::vector<T>& values,
+		std::vector<float>& allTimes, std::vector<T>& allValues) {
+		KeyRange range{ static_cast<uint32_t>(allTimes.size()), static_cast<uint32_t>(std::min(times.size(), values.size())) };
+		allTimes.insert(allTimes.end(), times.begin(), times.begin() + range.count);
+		allValues.insert(allValues.end(), values.begin(), values.begin() + range.count);
+		return range;
+	}
+
+	glm::vec3 sampleVec3(const KeyRange& range, const std::vector<float>& times, const std::vector<glm::vec3>& values,
+		float time, uint32_t& cursor, const glm::vec3& fallback) {
+		if (range.count == 0) {
+			return fallback;
+		}
+		float t{ seekKey(&times[range.first], range.count, time, cursor) };
+		const glm::vec3* keys{ &values[range.first + cursor] };
+		return t > 0 ? glm::mix(keys[0], keys[1], t) : keys[0];
+	}
+
+	glm::quat sampleQuat(const KeyRange& range, const std::vector<float>& times, const std::vector<glm::quat>& values,
+		float time, uint32_t& cursor, const glm::quat& fallback) {
+		if (range.count == 0) {
+			return fallback;
+		}
+		float t{ seekKey(&times[range.first], range.count, time, cursor) };
+		const glm::quat* keys{ &values[range.first + cursor] };
+		return t > 0 ? glm::slerp(keys[0], keys[1], t) : keys[0];
+	}
+}
+
+void decomposeTransform(const glm::mat4& m, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale) {
+	scale = glm::vec3{ glm::length(glm::vec3{ m[0] }), glm::length(glm::vec3{ m[1] }), glm::length(glm::vec3{ m[2] }) };
+	glm::mat3 axes{ glm::vec3{ m[0] } / scale.x, glm::vec3{ m[1] } / scale.y, glm::vec3{ m[2] } / scale.z };
+	rotation = glm::normalize(glm::quat_cast(axes));
+	translation = glm::vec3{ m[3] };
+}
+
+glm::mat4 composeTransform(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale) {
+	glm::mat4 m{ glm::mat4_cast(rotation) };
+	m[0] *= scale.x;
+	m[1] *= scale.y;
+	m[2] *= scale.z;
+	m[3] = glm::vec4{ translation, 1 };
+	return m;
+}
+
+AnimationClip::AnimationClip(std::string name, float duration) :
+	m_name{ std::move(name) }, m_duration{ duration } {
+}
+
+void AnimationClip::addChannel(uint32_t joint,
+	const std::vector<float>& translationTimes, const std::vector<glm::vec3>& translations,
+	const std::vector<float>& rotationTimes, const std::vector<glm::quat>& rotations,
+	const std::vector<float>& scaleTimes, const std::vector<glm::vec3>& scales) {
+	m_channels.push_back(ClipChannel{
+		joint,
+		appendTrack(translationTimes, translations, m_translationTimes, m_translations),
+		appendTrack(rotationTimes, rotations, m_rotationTimes, m_rotations),
+		appendTrack(scaleTimes, scales, m_scaleTimes, m_scales)
+	});
+}
+
+size_t AnimationClip::keyCount() const {
+	return m_translationTimes.size() + m_rotationTimes.size() + m_scaleTimes.size();
+}
+
+size_t AnimationClip::keyBytes() const {
+	return (m_translationTimes.size() + m_rotationTimes.size() + m_scaleTimes.size()) * sizeof(float)
+		+ m_translations.size() * sizeof(glm::vec3) + m_rotations.size() * sizeof(glm::quat)
+		+ m_scales.size() * sizeof(glm::vec3);
+}
+
+ClipSampler::ClipSampler(const AnimationClip& clip, const std::vector<glm::mat4>& bindLocals) :
+	m_clip{ &clip }, m_cursors(clip.channels().size() * 3, 0) {
+	for (auto& channel : clip.channels()) {
+		glm::vec3 translation;
+		glm::quat rotation;
+		glm::vec3 scale;
+		decomposeTransform(bindLocals[channel.joint], translation, rotation, scale);
+		m_bindTranslations.push_back(translation);
+		m_bindRotations.push_back(rotation);
+		m_bindScales.push_back(scale);
+	}
+}
+
+void ClipSampler::sample(float time, std::vector<glm::mat4>& locals) {
+	auto& channels{ m_clip->channels() };
+	for (size_t c{ 0 }; c < channels.size(); ++c) {
+		auto& channel{ channels[c] };
+		uint32_t* cursors{ &m_cursors[c * 3] };
+		glm::vec3 translation{ sampleVec3(channel.translation, m_clip->translationTimes(), m_clip->translations(),
+			time, cursors[0], m_bindTranslations[c]) };
+		glm::quat rotation{ sampleQuat(channel.rotation, m_clip->rotationTimes(), m_clip->rotations(),
+			time, cursors[1], m_bindRotations[c]) };
+		glm::vec3 scale{ sampleVec3(channel.scale, m_clip->scaleTimes(), m_clip->scales(),
+			time, cursors[2], m_bindScales[c]) };
+		locals[channel.joint] = composeTransform(translation, rotation, scale);
+	}
+}
@@ -0,0 +1,75 @@
+#include "AnimationImport.h"
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <stdexcept>
+
+glm::mat4 fromAssimpMatrix(const aiMatrix4x4& m) {
+	glm::mat4 result{};
+	for (uint32_t i{ 0 }; i < 4; ++i) {
+		for (uint32_t j{ 0 }; j < 4; ++j) {
+			result[i][j] = m[j][i];
+		}
+	}
+	return result;
+}
+
+void importJoints(const aiNode* node, int32_t parent, Skeleton& skeleton, JointMap& joints) {
+	uint32_t joint{ skeleton.addJoint(node->mName.C_Str(), parent, fromAssimpMatrix(node->mTransformation)) };
+	joints.emplace(node, joint);
+	for (uint32_t i{ 0 }; i < node->mNumChildren; ++i) {
+		importJoints(node->mChildren[i], static_cast<int32_t>(joint), skeleton, joints);
+	}
+}
+
+std::vector<AnimationClip> importClips(const aiScene* scene, const JointMap& joints) {
+	std::vector<AnimationClip> clips{};
+	for (uint32_t a{ 0 }; a < scene->mNumAnimations; ++a) {
+		const aiAnimation* animation{ scene->mAnimations[a] };
+		// Keys are timed in ticks; files that don't say how long a tick is use assimp's default.
+		double ticksPerSecond{ animation->mTicksPerSecond > 0 ? animation->mTicksPerSecond : 25.0 };
+		AnimationClip clip{ animation->mName.C_Str(), static_cast<float>(animation->mDuration / ticksPerSecond) };
+		for (uint32_t c{ 0 }; c < animation->mNumChannels; ++c) {
+			const aiNodeAnim* channel{ animation->mChannels[c] };
+			auto joint{ joints.find(scene->mRootNode->FindNode(channel->mNodeName.C_Str())) };
+			if (joint == joints.end()) {
+				continue;
+			}
+			std::vector<float> translationTimes(channel->mNumPositionKeys);
+			std::vector<glm::vec3> translations(channel->mNumPositionKeys);
+			for (uint32_t k{ 0 }; k < channel->mNumPositionKeys; ++k) {
+				auto& key{ channel->mPositionKeys[k] };
+				translationTimes[k] = static_cast<float>(key.mTime / ticksPerSecond);
+				translations[k] = glm::vec3{ key.mValue.x, key.mValue.y, key.mValue.z };
+			}
+			std::vector<float> rotationTimes(channel->mNumRotationKeys);
+			std::vector<glm::quat> rotations(channel->mNumRotationKeys);
+			for (uint32_t k{ 0 }; k < channel->mNumRotationKeys; ++k) {
+				auto& key{ channel->mRotationKeys[k] };
+				rotationTimes[k] = static_cast<float>(key.mTime / ticksPerSecond);
+				rotations[k] = glm::quat{ key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z };
+			}
+			std::vector<float> scaleTimes(channel->mNumScalingKeys);
+			std::vector<glm::vec3> scales(channel->mNumScalingKeys);
+			for (uint32_t k{ 0 }; k < channel->mNumScalingKeys; ++k) {
+				auto& key{ channel->mScalingKeys[k] };
+				scaleTimes[k] = static_cast<float>(key.mTime / ticksPerSecond);
+				scales[k] = glm::vec3{ key.mValue.x, key.mValue.y, key.mValue.z };
+			}
+			clip.addChannel(joint->second, translationTimes, translations, rotationTimes, rotations, scaleTimes, scales);
+		}
+		clips.push_back(std::move(clip));
+	}
+	return clips;
+}
+
+std::vector<AnimationClip> loadAnimationClips(const std::string& path, Skeleton& skeleton) {
+	// The same processing as assimpLoad, so the joints match the game's.
+	Assimp::Importer importer{};
+	const aiScene* scene{ importer.ReadFile(path, aiProcessPreset_TargetRealtime_MaxQuality) };
+	if (nullptr == scene) {
+		throw std::runtime_error("Error loading assimp file: " + std::string{ importer.GetErrorString() });
+	}
+	JointMap joints{};
+	importJoints(scene->mRootNode, -1, skeleton, joints);
+	return importClips(scene, joints);
+}
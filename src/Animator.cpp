@@ -1,44 +1,126 @@
 #include "Animator.h"
+#include <algorithm>
 
-void Animator::nextAnimation() {
-	// Increase the animation index, and start the next animation if there is one.
-	++m_currentIndex;
+void TrackBatch::add(uint32_t sequence, uint32_t target, float start, float end, const glm::vec3& rate) {
+	sequences.push_back(sequence);
+	targets.push_back(target);
+	starts.push_back(start);
+	ends.push_back(end);
+	rates.push_back(rate);
+	deltas.push_back(glm::vec3{ 0 });
+}
 
-	if (m_currentIndex < m_animations.size()) {
-		m_currentAnimation = m_animations[m_currentIndex].get();
-		m_currentAnimation->start();
-		m_nextTransition = m_nextTransition + m_currentAnimation->duration();
+uint32_t Animator::targetIndex(Object3D& object) {
+	auto found{ std::find(m_targets.begin(), m_targets.end(), &object) };
+	if (found != m_targets.end()) {
+		return static_cast<uint32_t>(found - m_targets.begin());
+	}
+	m_targets.push_back(&object);
+	m_moves.push_back(glm::vec3{ 0 });
+	m_turns.push_back(glm::vec3{ 0 });
+	return static_cast<uint32_t>(m_targets.size() - 1);
+}
+
+float Animator::appendInterval(uint32_t sequence, float duration) {
+	float start{ m_sequenceLengths[sequence] };
+	m_sequenceLengths[sequence] += duration;
+	return start;
+}
+
+uint32_t Animator::addSequence() {
+	m_sequenceTimes.push_back(0);
+	m_sequenceLengths.push_back(0);
+	m_sequenceRunning.push_back(0);
+	m_tickStarts.push_back(0);
+	m_tickEnds.push_back(0);
+	return static_cast<uint32_t>(m_sequenceTimes.size() - 1);
+}
+
+void Animator::addTranslation(uint32_t sequence, Object3D& object, float duration, const glm::vec3& moveBy) {
+	float start{ appendInterval(sequence, duration) };
+	m_translations.add(sequence, targetIndex(object), start, start + duration, moveBy / duration);
+}
+
+void Animator::addRotation(uint32_t sequence, Object3D& object, float duration, const glm::vec3& totalRotation) {
+	float start{ appendInterval(sequence, duration) };
+	m_rotations.add(sequence, targetIndex(object), start, start + duration, totalRotation / duration);
+}
+
+void Animator::start(uint32_t sequence) {
+	m_sequenceTimes[sequence] = 0;
+	m_sequenceRunning[sequence] = 1;
+}
+
+void Animator::evaluate(TrackBatch& batch) {
+	// A track changes its attribute for the part of the tick that overlaps its interval, which
+	// is nothing for tracks of stopped sequences, or of animations not yet reached or finished.
+	auto body{ [this, &batch](size_t begin, size_t end) {
+		for (size_t i{ begin }; i < end; ++i) {
+			uint32_t sequence{ batch.sequences[i] };
+			float overlap{ std::min(m_tickEnds[sequence], batch.ends[i]) - std::max(m_tickStarts[sequence], batch.starts[i]) };
+			batch.deltas[i] = batch.rates[i] * std::max(overlap, 0.0f);
+		}
+	} };
+	if (batch.size() >= PARALLEL_TRACKS) {
+		if (!m_pool) {
+			m_pool = std::make_unique<WorkerPool>();
+		}
+		m_pool->parallelFor(batch.size(), PARALLEL_GRAIN, body);
 	}
 	else {
-		m_currentIndex = -1;
-		m_currentAnimation = nullptr;
+		body(0, batch.size());
 	}
 }
 
 void Animator::tick(float dt) {
-	// Advance the active animation by the given interval.
-	if (m_currentIndex >= 0) {
-		float lastTime = m_currentTime;
-		m_currentTime += dt;
-
-		// If our current time surpasses the next transition time, we need to tick
-		// both the active animation (up to the transition time), and the subsequent animation
-		// (by the amount we exceeded the transition time).
-		if (m_currentTime >= m_nextTransition) {
-			m_currentAnimation->tick(m_nextTransition - lastTime);
-			float overTime = m_currentTime - m_nextTransition;
-			nextAnimation();
-			if (m_currentAnimation != nullptr) {
-				m_currentAnimation->tick(overTime);
-			}
+	bool anyRunning{ false };
+	for (size_t s{ 0 }; s < m_sequenceTimes.size(); ++s) {
+		if (!m_sequenceRunning[s]) {
+			m_tickStarts[s] = 0;
+			m_tickEnds[s] = 0;
+			continue;
 		}
-		else {
-			m_currentAnimation->tick(dt);
+		// A sequence stops once its time reaches the end of its last animation; the part of the
+		// tick past that is not applied to anything.
+		m_tickStarts[s] = m_sequenceTimes[s];
+		m_sequenceTimes[s] = std::min(m_sequenceTimes[s] + dt, m_sequenceLengths[s]);
+		m_tickEnds[s] = m_sequenceTimes[s];
+		m_sequenceRunning[s] = m_sequenceTimes[s] < m_sequenceLengths[s];
+		if (!m_sequenceRunning[s]) {
+			m_finished.push_back(static_cast<uint32_t>(s));
 		}
+		anyRunning = true;
+	}
+	if (!anyRunning) {
+		return;
 	}
-}
 
-void Animator::start() {
-	m_currentTime = 0;
-	nextAnimation();
+	evaluate(m_translations);
+	evaluate(m_rotations);
+
+	for (size_t i{ 0 }; i < m_translations.size(); ++i) {
+		m_moves[m_translations.targets[i]] += m_translations.deltas[i];
+	}
+	for (size_t i{ 0 }; i < m_rotations.size(); ++i) {
+		m_turns[m_rotations.targets[i]] += m_rotations.deltas[i];
+	}
+	for (size_t t{ 0 }; t < m_targets.size(); ++t) {
+		if (m_moves[t] != glm::vec3{ 0 }) {
+			m_targets[t]->move(m_moves[t]);
+			m_moves[t] = glm::vec3{ 0 };
+		}
+		if (m_turns[t] != glm::vec3{ 0 }) {
+			m_targets[t]->rotate(m_turns[t]);
+			m_turns[t] = glm::vec3{ 0 };
+		}
+	}
+
+	// The callback may start sequences, which the next tick plays.
+	std::vector<uint32_t> finished{ std::move(m_finished) };
+	m_finished.clear();
+	if (m_finishedCallback) {
+		for (uint32_t sequence : finished) {
+			m_finishedCallback(sequence);
+		}
+	}
 }
@@ -3,7 +3,11 @@
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <filesystem>
+#include <optional>
 #include <unordered_map>
 
 std::vector<Texture> loadMaterialTextures(
@@ -35,8 +39,84 @@ std::vector<Texture> loadMaterialTextures(
 	return textures;
 }
 
-Mesh fromAssimpMesh(const aiMesh* mesh, const aiScene* scene, const std::filesystem::path& modelPath,
-	std::unordered_map<std::string, Texture>& loadedTextures) {
+namespace {
+	bool hasBonesOrAnimations(const aiScene* scene) {
+		if (scene->mNumAnimations > 0) {
+			return true;
+		}
+		for (uint32_t i{ 0 }; i < scene->mNumMeshes; ++i) {
+			if (scene->mMeshes[i]->HasBones()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Adds a mesh's bones to the skeleton as a skin, and returns each of its vertices'
+	 * strongest MAX_BONE_INFLUENCE bones, with weights renormalized to sum to 255.
+	 */
+	std::vector<SkinInfluences> importSkin(const aiMesh* mesh, const aiNode* node, const aiScene* scene,
+		SkeletonAttachment& skeleton, int32_t& paletteOffset) {
+		std::vector<SkinBone> bones{};
+		// Each vertex's strongest influences so far, strongest first.
+		std::vector<std::array<std::pair<float, uint16_t>, MAX_BONE_INFLUENCE>> strongest(mesh->mNumVertices);
+		for (auto& s : strongest) {
+			s.fill({ 0.0f, 0 });
+		}
+		for (uint32_t b{ 0 }; b < mesh->mNumBones; ++b) {
+			const aiBone* bone{ mesh->mBones[b] };
+			auto joint{ skeleton.joints.find(scene->mRootNode->FindNode(bone->mName.C_Str())) };
+			if (joint == skeleton.joints.end()) {
+				throw std::runtime_error(std::string{ "Bone " } + bone->mName.C_Str() + " has no node");
+			}
+			bones.push_back(SkinBone{ joint->second, fromAssimpMatrix(bone->mOffsetMatrix) });
+			for (uint32_t w{ 0 }; w < bone->mNumWeights; ++w) {
+				auto& weight{ bone->mWeights[w] };
+				auto& s{ strongest[weight.mVertexId] };
+				if (weight.mWeight > s.back().first) {
+					s.back() = { weight.mWeight, static_cast<uint16_t>(b) };
+					std::sort(s.begin(), s.end(), [](auto& x, auto& y) { return x.first > y.first; });
+				}
+			}
+		}
+
+		std::vector<SkinInfluences> influences(mesh->mNumVertices);
+		for (size_t v{ 0 }; v < influences.size(); ++v) {
+			float total{ 0 };
+			for (auto& [weight, bone] : strongest[v]) {
+				total += weight;
+			}
+			// Quantize each weight, then give the rounding error to the strongest bone so that
+			// the weights still sum to exactly one. A vertex with no bones follows the first.
+			int32_t sum{ 0 };
+			for (uint32_t i{ 0 }; i < MAX_BONE_INFLUENCE; ++i) {
+				float normalized{ total > 0 ? strongest[v][i].first / total : (i == 0 ? 1.0f : 0.0f) };
+				influences[v].bones[i] = strongest[v][i].second;
+				influences[v].weights[i] = static_cast<uint8_t>(std::lround(normalized * 255));
+				sum += influences[v].weights[i];
+			}
+			influences[v].weights[0] = static_cast<uint8_t>(influences[v].weights[0] + 255 - sum);
+		}
+
+		paletteOffset = static_cast<int32_t>(skeleton.skeleton->addSkin(skeleton.joints.at(node), std::move(bones)));
+		return influences;
+	}
+
+	/**
+	 * @brief Binds every vertex of a mesh with no bones of its own to its node's joint, so that the
+	 * mesh follows the node when a clip animates it.
+	 */
+	std::vector<SkinInfluences> importRigidSkin(const aiMesh* mesh, const aiNode* node, SkeletonAttachment& skeleton,
+		int32_t& paletteOffset) {
+		uint32_t joint{ skeleton.joints.at(node) };
+		paletteOffset = static_cast<int32_t>(skeleton.skeleton->addSkin(joint, { SkinBone{ joint, glm::mat4{ 1 } } }));
+		return std::vector<SkinInfluences>(mesh->mNumVertices, SkinInfluences{ { 0, 0, 0, 0 }, { 255, 0, 0, 0 } });
+	}
+}
+
+Mesh fromAssimpMesh(const aiMesh* mesh, const aiNode* node, const aiScene* scene, const std::filesystem::path& modelPath,
+	std::unordered_map<std::string, Texture>& loadedTextures, BakedLightingAttachment* baked, SkeletonAttachment* skeleton) {
 	std::vector<Vertex3D> vertices;
 
 	bool hasUVs = mesh->HasTextureCoords(0);
@@ -101,7 +181,50 @@ Mesh fromAssimpMesh(const aiMesh* mesh, const aiScene* scene, const std::filesys
 		textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
 	}
 
-	return Mesh{ vertices, faces, std::move(textures) };
+	std::vector<SkinInfluences> influences{};
+	int32_t paletteOffset{ -1 };
+	if (skeleton != nullptr && mesh->HasBones()) {
+		influences = importSkin(mesh, node, scene, *skeleton, paletteOffset);
+	}
+	else if (skeleton != nullptr) {
+		influences = importRigidSkin(mesh, node, *skeleton, paletteOffset);
+	}
+
+	if (baked != nullptr && baked->kind == BakedLighting::Lightmap) {
+		// Lightmap coordinates are given per triangle corner, and a vertex shared by two charts
+		// needs a different coordinate in each, so the mesh is drawn unindexed.
+		if (baked->nextMesh >= baked->uvs.size() || baked->uvs[baked->nextMesh].size() != faces.size()) {
+			throw std::runtime_error("Lightmap does not match " + modelPath.string() + "; bake it again");
+		}
+		std::vector<Vertex3D> corners{};
+		std::vector<uint32_t> cornerFaces{};
+		std::vector<SkinInfluences> cornerInfluences{};
+		corners.reserve(faces.size());
+		cornerFaces.reserve(faces.size());
+		for (auto index : faces) {
+			cornerFaces.push_back(static_cast<uint32_t>(corners.size()));
+			corners.push_back(vertices[index]);
+			if (!influences.empty()) {
+				cornerInfluences.push_back(influences[index]);
+			}
+		}
+		textures.push_back(baked->texture);
+		Mesh result{ corners, cornerFaces, std::move(textures), BakedVertexStreams{ baked->uvs[baked->nextMesh++], {} } };
+		result.attachSkin(cornerInfluences, paletteOffset);
+		return result;
+	}
+	if (baked != nullptr && baked->kind == BakedLighting::PerVertex) {
+		if (baked->nextMesh >= baked->vertexLighting.size() || baked->vertexLighting[baked->nextMesh].size() != vertices.size()) {
+			throw std::runtime_error("Vertex lighting does not match " + modelPath.string() + "; bake it again");
+		}
+		Mesh result{ vertices, faces, std::move(textures), BakedVertexStreams{ {}, baked->vertexLighting[baked->nextMesh++] } };
+		result.attachSkin(influences, paletteOffset);
+		return result;
+	}
+
+	Mesh result{ vertices, faces, std::move(textures) };
+	result.attachSkin(influences, paletteOffset);
+	return result;
 }
 
 Object3D assimpLoad(const std::string& path, bool flipTextureCoords) {
@@ -121,7 +244,47 @@ Object3D assimpLoad(const std::string& path, bool flipTextureCoords) {
 	}
 	std::vector<Mesh> meshes{};
 	std::unordered_map<std::string, Texture> loadedTextures{};
-	return processAssimpNode(scene->mRootNode, scene, std::filesystem::path{ path }, loadedTextures);
+
+	// Attach baked lighting if the LightmapBaker has left any next to the model.
+	std::filesystem::path directory{ std::filesystem::path{ path }.parent_path() };
+	std::optional<BakedLightingAttachment> baked{};
+	if (std::filesystem::exists(directory / LIGHTMAP_UV_NAME) && std::filesystem::exists(directory / LIGHTMAP_IMAGE_NAME)) {
+		std::cout << "loading " << directory / LIGHTMAP_IMAGE_NAME << std::endl;
+		StbImage image{};
+		image.loadHdrFromFile((directory / LIGHTMAP_IMAGE_NAME).string());
+		baked = BakedLightingAttachment{ BakedLighting::Lightmap, readLightmapUVs(directory / LIGHTMAP_UV_NAME),
+			Texture::loadHdrImage(image, "lightmap") };
+	}
+	else if (std::filesystem::exists(directory / VERTEX_LIGHTING_NAME)) {
+		std::cout << "loading " << directory / VERTEX_LIGHTING_NAME << std::endl;
+		baked = BakedLightingAttachment{ BakedLighting::PerVertex };
+		baked->vertexLighting = readVertexLighting(directory / VERTEX_LIGHTING_NAME);
+	}
+
+	// Skinned and animated models get a skeleton of all their nodes, since bones and animation
+	// channels may refer to any of them.
+	std::optional<SkeletonAttachment> skeleton{};
+	if (hasBonesOrAnimations(scene)) {
+		skeleton.emplace();
+		importJoints(scene->mRootNode, -1, *skeleton->skeleton, skeleton->joints);
+	}
+
+	Object3D root{ processAssimpNode(scene->mRootNode, scene, std::filesystem::path{ path }, loadedTextures,
+		baked ? &*baked : nullptr, skeleton ? &*skeleton : nullptr) };
+	if (baked) {
+		size_t bakedMeshes{ baked->kind == BakedLighting::Lightmap ? baked->uvs.size() : baked->vertexLighting.size() };
+		if (baked->nextMesh != bakedMeshes) {
+			throw std::runtime_error("Baked lighting does not match " + path + "; bake it again");
+		}
+		root.setBakedLighting(baked->kind);
+	}
+	if (skeleton) {
+		for (auto& clip : importClips(scene, skeleton->joints)) {
+			skeleton->skeleton->addClip(CompressedClip::compress(clip, ClipCompressionSettings{}));
+		}
+		root.setSkeletonPose(std::make_shared<SkeletonPose>(skeleton->skeleton));
+	}
+	return root;
 }
 
 // A "Node" in assimp is an Object3D in our framework. It has one or more meshes,
@@ -130,13 +293,15 @@ Object3D processAssimpNode(
 	const aiNode* node, 
 	const aiScene* scene,
 	const std::filesystem::path& modelPath,
-	std::unordered_map<std::string, Texture>& loadedTextures
+	std::unordered_map<std::string, Texture>& loadedTextures,
+	BakedLightingAttachment* baked,
+	SkeletonAttachment* skeleton
 ) {
 	// Load the aiNode's meshes.
 	std::vector<Mesh> meshes{};
 	for (size_t i{ 0 }; i < node->mNumMeshes; ++i) {
 		aiMesh* mesh{ scene->mMeshes[node->mMeshes[i]] };
-		meshes.emplace_back(fromAssimpMesh(mesh, scene, modelPath, loadedTextures));
+		meshes.emplace_back(fromAssimpMesh(mesh, node, scene, modelPath, loadedTextures, baked, skeleton));
 	}
 
 	// Load the node's textures.
@@ -146,19 +311,14 @@ Object3D processAssimpNode(
 	}
 
 	// Initialize the base transform of the object. (Needs to be transposed from assimp.)
-	glm::mat4 baseTransform{};
-	for (uint32_t i{ 0 }; i < 4; ++i) {
-		for (uint32_t j{ 0 }; j < 4; ++j) {
-			baseTransform[i][j] = node->mTransformation[j][i];
-		}
-	}
+	glm::mat4 baseTransform{ fromAssimpMatrix(node->mTransformation) };
 
 	// Initialize the object.
 	Object3D parent{ std::move(meshes), std::move(baseTransform)};
 
 	// Recursively process the children of the node and add them as child objects.
 	for (size_t i{ 0 }; i < node->mNumChildren; ++i) {
-		Object3D child{ processAssimpNode(node->mChildren[i], scene, modelPath, loadedTextures) };
+		Object3D child{ processAssimpNode(node->mChildren[i], scene, modelPath, loadedTextures, baked, skeleton) };
 		parent.addChild(std::move(child));
 	}
 
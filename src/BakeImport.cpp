@@ -0,0 +1,99 @@
+#include "BakeImport.h"
+#include "StbImage.h"
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+namespace {
+	/**
+	 * @brief The average color of a material's first diffuse texture, or its diffuse color if it
+	 * has no texture.
+	 */
+	glm::vec3 averageAlbedo(const aiMaterial* material, const std::filesystem::path& modelPath,
+		std::unordered_map<std::string, glm::vec3>& cache) {
+		if (material->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
+			aiString name{};
+			material->GetTexture(aiTextureType_DIFFUSE, 0, &name);
+			std::string texPath{ (modelPath.parent_path() / name.C_Str()).string() };
+			auto existing{ cache.find(texPath) };
+			if (existing != cache.end()) {
+				return existing->second;
+			}
+
+			StbImage image{};
+			image.loadFromFile(texPath);
+			size_t texels{ static_cast<size_t>(image.getWidth()) * image.getHeight() };
+			glm::dvec3 sum{ 0 };
+			const unsigned char* data{ image.getData() };
+			for (size_t i{ 0 }; i < texels; ++i) {
+				sum += glm::dvec3(data[4 * i], data[4 * i + 1], data[4 * i + 2]);
+			}
+			glm::vec3 albedo{ texels > 0 ? glm::vec3{ sum / (255.0 * texels) } : glm::vec3{ 0.5f } };
+			cache.insert(std::make_pair(texPath, albedo));
+			return albedo;
+		}
+		aiColor3D diffuse{ 0.5f, 0.5f, 0.5f };
+		material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuse);
+		return glm::vec3{ diffuse.r, diffuse.g, diffuse.b };
+	}
+
+	void collectMeshes(const aiNode* node, const aiScene* scene, const glm::mat4& parentModel,
+		const std::filesystem::path& modelPath, std::unordered_map<std::string, glm::vec3>& albedoCache,
+		std::vector<BakeMesh>& meshes) {
+		// Transposed from assimp, as in processAssimpNode.
+		glm::mat4 baseTransform{};
+		for (uint32_t i{ 0 }; i < 4; ++i) {
+			for (uint32_t j{ 0 }; j < 4; ++j) {
+				baseTransform[i][j] = node->mTransformation[j][i];
+			}
+		}
+		glm::mat4 model{ parentModel * baseTransform };
+		glm::mat3 normalMatrix{ glm::transpose(glm::inverse(glm::mat3{ model })) };
+
+		for (size_t m{ 0 }; m < node->mNumMeshes; ++m) {
+			const aiMesh* mesh{ scene->mMeshes[node->mMeshes[m]] };
+			BakeMesh bakeMesh{};
+			bakeMesh.positions.reserve(mesh->mNumVertices);
+			for (size_t i{ 0 }; i < mesh->mNumVertices; ++i) {
+				auto& v{ mesh->mVertices[i] };
+				bakeMesh.positions.emplace_back(model * glm::vec4{ v.x, v.y, v.z, 1 });
+				if (mesh->HasNormals()) {
+					auto& n{ mesh->mNormals[i] };
+					bakeMesh.normals.push_back(glm::normalize(normalMatrix * glm::vec3{ n.x, n.y, n.z }));
+				}
+			}
+			for (size_t i{ 0 }; i < mesh->mNumFaces; ++i) {
+				auto& face{ mesh->mFaces[i] };
+				bakeMesh.indices.push_back(face.mIndices[0]);
+				bakeMesh.indices.push_back(face.mIndices[1]);
+				bakeMesh.indices.push_back(face.mIndices[2]);
+			}
+			bakeMesh.albedo = averageAlbedo(scene->mMaterials[mesh->mMaterialIndex], modelPath, albedoCache);
+			meshes.push_back(std::move(bakeMesh));
+		}
+
+		for (size_t i{ 0 }; i < node->mNumChildren; ++i) {
+			collectMeshes(node->mChildren[i], scene, model, modelPath, albedoCache, meshes);
+		}
+	}
+}
+
+std::vector<BakeMesh> loadBakeMeshes(const Placement& placement) {
+	Assimp::Importer importer{};
+	// The same options as assimpLoad, so that meshes are triangulated identically.
+	const aiScene* scene{ importer.ReadFile(placement.modelPath, aiProcessPreset_TargetRealtime_MaxQuality | aiProcess_FlipUVs) };
+	if (nullptr == scene) {
+		std::string error{ importer.GetErrorString() };
+		throw std::runtime_error("Error loading assimp file: " + error);
+	}
+
+	std::vector<BakeMesh> meshes{};
+	std::unordered_map<std::string, glm::vec3> albedoCache{};
+	collectMeshes(scene->mRootNode, scene, placement.modelMatrix(), std::filesystem::path{ placement.modelPath },
+		albedoCache, meshes);
+	return meshes;
+}
@@ -0,0 +1,216 @@
+#include "BakeScene.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace {
+	/**
+	 * @brief A small xorshift generator for jittering samples; one per call, seeded per texel.
+	 */
+	struct Random {
+		uint32_t state;
+
+		explicit Random(uint32_t seed) : state{ seed * 747796405u + 2891336453u } {
+			if (state == 0) {
+				state = 1;
+			}
+		}
+
+		float next() {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return (state >> 8) * (1.0f / 16777216.0f);
+		}
+	};
+}
+
+BakeScene::BakeScene(std::vector<BakeMesh> meshes, const std::vector<PointLight>& lights,
+	const glm::vec3& directionalLight, const glm::vec3& directionalColor) :
+	m_meshes{ std::move(meshes) },
+	m_directionalLight{ glm::normalize(directionalLight) },
+	m_directionalColor{ directionalColor } {
+	std::vector<glm::vec3> positions{};
+	std::vector<uint32_t> indices{};
+	for (uint32_t m{ 0 }; m < m_meshes.size(); ++m) {
+		auto& mesh{ m_meshes[m] };
+		uint32_t base{ static_cast<uint32_t>(positions.size()) };
+		positions.insert(positions.end(), mesh.positions.begin(), mesh.positions.end());
+		for (size_t i{ 0 }; i + 2 < mesh.indices.size(); i += 3) {
+			const glm::vec3& a{ mesh.positions[mesh.indices[i]] };
+			glm::vec3 n{ glm::cross(mesh.positions[mesh.indices[i + 1]] - a, mesh.positions[mesh.indices[i + 2]] - a) };
+			float length{ glm::length(n) };
+			m_triangleNormals.push_back(length > 0 ? n / length : glm::vec3{ 0, 1, 0 });
+			m_triangleMesh.push_back(m);
+			for (size_t k{ 0 }; k < 3; ++k) {
+				indices.push_back(base + mesh.indices[i + k]);
+			}
+		}
+	}
+	m_bvh = std::make_unique<TriangleBVH>(positions, indices);
+
+	for (auto& light : lights) {
+		if (light.baked) {
+			m_lights.push_back(light);
+		}
+	}
+}
+
+glm::vec3 BakeScene::directIrradiance(const glm::vec3& position, const glm::vec3& normal) const {
+	glm::vec3 irradiance{ 0 };
+	Ray rays[4];
+	glm::vec3 contributions[4];
+	uint32_t count{ 0 };
+
+	// Shadow rays are queued and tested as packets; unblocked rays add their light.
+	auto flush{ [&]() {
+		if (count == 0) {
+			return;
+		}
+		for (uint32_t i{ count }; i < 4; ++i) {
+			rays[i] = Ray{ position, normal, 0 };
+		}
+		uint32_t blocked{ m_bvh->occluded4(rays) };
+		for (uint32_t i{ 0 }; i < count; ++i) {
+			if ((blocked & (1u << i)) == 0) {
+				irradiance += contributions[i];
+			}
+		}
+		count = 0;
+	} };
+	auto queue{ [&](const glm::vec3& direction, float distance, const glm::vec3& contribution) {
+		rays[count] = Ray{ position, direction, distance };
+		contributions[count++] = contribution;
+		if (count == 4) {
+			flush();
+		}
+	} };
+
+	float sunFactor{ glm::dot(normal, -m_directionalLight) };
+	if (sunFactor > 0) {
+		queue(-m_directionalLight, SUN_DISTANCE, m_directionalColor * sunFactor);
+	}
+
+	// The same falloff and spot cone as lighting.frag.
+	for (auto& light : m_lights) {
+		glm::vec3 toLight{ light.position - position };
+		float distance{ glm::length(toLight) };
+		if (distance >= light.radius || distance <= 0) {
+			continue;
+		}
+		glm::vec3 lightDir{ toLight / distance };
+		float lambert{ glm::dot(normal, lightDir) };
+		if (lambert <= 0) {
+			continue;
+		}
+		float falloff{ 1 - (distance * distance) / (light.radius * light.radius) };
+		float attenuation{ falloff * falloff };
+		if (light.cosOuter > -1) {
+			float cosAngle{ glm::dot(-lightDir, glm::normalize(light.direction)) };
+			float t{ glm::clamp((cosAngle - light.cosOuter) / (light.cosInner - light.cosOuter), 0.0f, 1.0f) };
+			attenuation *= t * t * (3 - 2 * t);
+		}
+		if (attenuation > 0) {
+			queue(lightDir, distance - TriangleBVH::EPSILON, light.color * (attenuation * lambert));
+		}
+	}
+	flush();
+	return irradiance;
+}
+
+glm::vec3 BakeScene::cosineDirection(const glm::vec3& normal, float u1, float u2) {
+	// An orthonormal basis around the normal (Duff et al., "Building an Orthonormal Basis, Revisited").
+	float sign{ std::copysign(1.0f, normal.z) };
+	float a{ -1.0f / (sign + normal.z) };
+	float b{ normal.x * normal.y * a };
+	glm::vec3 tangent{ 1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x };
+	glm::vec3 bitangent{ b, sign + normal.y * normal.y * a, -normal.y };
+
+	float r{ std::sqrt(u1) };
+	float phi{ 2.0f * std::numbers::pi_v<float> * u2 };
+	return tangent * (r * std::cos(phi)) + bitangent * (r * std::sin(phi)) + normal * std::sqrt(std::max(0.0f, 1.0f - u1));
+}
+
+glm::vec3 BakeScene::bouncedLight(const Ray& ray, const RayHit& hit) const {
+	glm::vec3 hitNormal{ m_triangleNormals[hit.triangle] };
+	if (glm::dot(hitNormal, ray.direction) > 0) {
+		hitNormal = -hitNormal;
+	}
+	glm::vec3 hitPosition{ ray.origin + ray.direction * hit.t + hitNormal * SURFACE_OFFSET };
+	return m_meshes[m_triangleMesh[hit.triangle]].albedo * directIrradiance(hitPosition, hitNormal);
+}
+
+glm::vec3 BakeScene::indirectIrradiance(const glm::vec3& position, const glm::vec3& normal, uint32_t samples, uint32_t seed) const {
+	uint32_t grid{ std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(samples))))) };
+	Random random{ seed };
+	glm::vec3 sum{ 0 };
+	Ray rays[4];
+	uint32_t count{ 0 };
+
+	// With cosine-weighted sampling, each ray's estimate of irradiance is pi times the radiance
+	// it finds, and a diffuse surface reflects albedo / pi of its irradiance: the pis cancel.
+	auto flush{ [&]() {
+		if (count == 0) {
+			return;
+		}
+		for (uint32_t i{ count }; i < 4; ++i) {
+			rays[i] = Ray{ position, normal, 0 };
+		}
+		RayHit hits[4];
+		uint32_t mask{ m_bvh->intersect4(rays, hits) };
+		for (uint32_t i{ 0 }; i < count; ++i) {
+			if ((mask & (1u << i)) == 0) {
+				continue;
+			}
+			sum += bouncedLight(rays[i], hits[i]);
+		}
+		count = 0;
+	} };
+
+	for (uint32_t i{ 0 }; i < grid; ++i) {
+		for (uint32_t j{ 0 }; j < grid; ++j) {
+			float u1{ (i + random.next()) / grid };
+			float u2{ (j + random.next()) / grid };
+			rays[count++] = Ray{ position, cosineDirection(normal, u1, u2), SUN_DISTANCE };
+			if (count == 4) {
+				flush();
+			}
+		}
+	}
+	flush();
+	return sum / static_cast<float>(grid * grid);
+}
+
+float BakeScene::ambientOcclusion(const glm::vec3& position, const glm::vec3& normal, uint32_t samples, float maxDistance, uint32_t seed) const {
+	uint32_t grid{ std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(samples))))) };
+	Random random{ seed };
+	uint32_t open{ 0 };
+	Ray rays[4];
+	uint32_t count{ 0 };
+
+	auto flush{ [&]() {
+		for (uint32_t i{ count }; i < 4; ++i) {
+			rays[i] = Ray{ position, normal, 0 };
+		}
+		uint32_t blocked{ m_bvh->occluded4(rays) };
+		for (uint32_t i{ 0 }; i < count; ++i) {
+			open += (blocked & (1u << i)) == 0 ? 1 : 0;
+		}
+		count = 0;
+	} };
+
+	for (uint32_t i{ 0 }; i < grid; ++i) {
+		for (uint32_t j{ 0 }; j < grid; ++j) {
+			float u1{ (i + random.next()) / grid };
+			float u2{ (j + random.next()) / grid };
+			rays[count++] = Ray{ position, cosineDirection(normal, u1, u2), maxDistance };
+			if (count == 4) {
+				flush();
+			}
+		}
+	}
+	if (count > 0) {
+		flush();
+	}
+	return static_cast<float>(open) / static_cast<float>(grid * grid);
+}
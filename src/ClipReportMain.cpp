@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AnimationImport.h"
+#include "CompressedClip.h"
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * @brief A procedural clip of a chain of joints swinging at 30 keys per second, for measuring
+	 * compression when no model at hand has animations.
+	 */
+	AnimationClip syntheticClip(uint32_t joints, Skeleton& skeleton) {
+		constexpr float DURATION{ 10.0f };
+		constexpr uint32_t KEYS{ 301 };
+		AnimationClip clip{ "synthetic", DURATION };
+		for (uint32_t j{ 0 }; j < joints; ++j) {
+			skeleton.addJoint("joint" + std::to_string(j), static_cast<int32_t>(j) - 1,
+				glm::translate(glm::mat4{ 1 }, glm::vec3{ 0, 1, 0 }));
+			std::vector<float> times(KEYS);
+			std::vector<glm::vec3> translations(KEYS);
+			std::vector<glm::quat> rotations(KEYS);
+			std::vector<glm::vec3> scales(KEYS, glm::vec3{ 1 });
+			glm::vec3 axis{ glm::normalize(glm::vec3{ std::sin(j * 1.3f), 1.0f, std::cos(j * 0.7f) }) };
+			for (uint32_t k{ 0 }; k < KEYS; ++k) {
+				float t{ DURATION * k / (KEYS - 1) };
+				times[k] = t;
+				// Only the root bobs; the other joints keep their bone length.
+				translations[k] = glm::vec3{ 0, j == 0 ? 0.1f * std::sin(t * 2.0f) : 1.0f, 0 };
+				rotations[k] = glm::angleAxis(0.6f * std::sin(t * (1.0f + 0.15f * j) + j), axis);
+			}
+			clip.addChannel(j, times, translations, times, rotations, times, scales);
+		}
+		return clip;
+	}
+
+	struct SampleError {
+		float translation{ 0 };
+		float rotation{ 0 };
+		float scale{ 0 };
+	};
+
+	/**
+	 * @brief The largest difference between the raw and compressed clips' joint transformations,
+	 * sampled at 240 Hz.
+	 */
+	SampleError measureError(const AnimationClip& raw, const CompressedClip& compressed, const std::vector<glm::mat4>& bindLocals) {
+		ClipSampler rawSampler{ raw, bindLocals };
+		CompressedClipSampler compressedSampler{ compressed, bindLocals };
+		std::vector<glm::mat4> rawLocals{ bindLocals };
+		std::vector<glm::mat4> compressedLocals{ bindLocals };
+		SampleError error{};
+		for (float time{ 0 }; time <= raw.duration(); time += 1.0f / 240) {
+			rawSampler.sample(time, rawLocals);
+			compressedSampler.sample(time, compressedLocals);
+			for (auto& channel : raw.channels()) {
+				glm::vec3 t0, t1, s0, s1;
+				glm::quat r0, r1;
+				decomposeTransform(rawLocals[channel.joint], t0, r0, s0);
+				decomposeTransform(compressedLocals[channel.joint], t1, r1, s1);
+				if (glm::dot(r0, r1) < 0) {
+					r1 = glm::quat{ -r1.w, -r1.x, -r1.y, -r1.z };
+				}
+				glm::vec3 dt{ glm::abs(t0 - t1) };
+				glm::vec3 ds{ glm::abs(s0 - s1) };
+				error.translation = std::max({ error.translation, dt.x, dt.y, dt.z });
+				error.scale = std::max({ error.scale, ds.x, ds.y, ds.z });
+				error.rotation = std::max({ error.rotation, std::abs(r0.x - r1.x), std::abs(r0.y - r1.y),
+					std::abs(r0.z - r1.z), std::abs(r0.w - r1.w) });
+			}
+		}
+		return error;
+	}
+
+	/**
+	 * @brief Joint samples per second when many instances play the clip at once, each from its
+	 * own start time, for the given number of 60 Hz frames.
+	 */
+	template <typename Sampler, typename Clip>
+	double samplingThroughput(const Clip& clip, const std::vector<glm::mat4>& bindLocals, uint32_t instances, uint32_t frames) {
+		std::vector<Sampler> samplers{};
+		std::vector<std::vector<glm::mat4>> locals(instances, bindLocals);
+		for (uint32_t i{ 0 }; i < instances; ++i) {
+			samplers.emplace_back(clip, bindLocals);
+		}
+		float duration{ std::max(clip.duration(), 1e-3f) };
+		auto start{ Clock::now() };
+		for (uint32_t f{ 0 }; f < frames; ++f) {
+			for (uint32_t i{ 0 }; i < instances; ++i) {
+				float time{ std::fmod(f / 60.0f + duration * i / instances, duration) };
+				samplers[i].sample(time, locals[i]);
+			}
+		}
+		double seconds{ std::chrono::duration<double>(Clock::now() - start).count() };
+		return static_cast<double>(clip.channels().size()) * instances * frames / std::max(seconds, 1e-9);
+	}
+
+	void report(const std::string& source, const AnimationClip& raw, const std::vector<glm::mat4>& bindLocals,
+		const ClipCompressionSettings& settings, uint32_t instances, uint32_t frames) {
+		CompressedClip compressed{ CompressedClip::compress(raw, settings) };
+		SampleError error{ measureError(raw, compressed, bindLocals) };
+		double rawRate{ samplingThroughput<ClipSampler>(raw, bindLocals, instances, frames) };
+		double compressedRate{ samplingThroughput<CompressedClipSampler>(compressed, bindLocals, instances, frames) };
+
+		std::cout << source << " \"" << raw.name() << "\": " << raw.channels().size() << " channels, "
+			<< raw.duration() << " s" << std::endl;
+		std::cout << "  keys: " << raw.keyCount() << " raw, " << compressed.keyCount() << " compressed" << std::endl;
+		std::cout << "  memory: " << raw.keyBytes() << " bytes raw, " << compressed.keyBytes() << " bytes compressed ("
+			<< static_cast<double>(raw.keyBytes()) / std::max<size_t>(compressed.keyBytes(), 1) << "x smaller)" << std::endl;
+		std::cout << "  max error: " << error.translation << " translation, " << error.rotation << " rotation, "
+			<< error.scale << " scale" << std::endl;
+		std::cout << "  sampling: " << rawRate / 1e6 << " M joints/s raw, " << compressedRate / 1e6
+			<< " M joints/s compressed (" << instances << " instances, " << frames << " frames)" << std::endl;
+	}
+}
+
+/*
+ * Reports how well the animatronics' clips compress: keys and bytes before and after, the largest
+ * error compression introduces, and how fast each form samples with many instances playing.
+ * Needs no window or OpenGL context; run it from the game's output directory.
+ *
+ * Arguments are model paths (the four animatronics if none are given). Options:
+ * --translation-tolerance, --rotation-tolerance, --scale-tolerance (1e-4 each),
+ * --instances <playbacks sampled at once> (256), --frames <60 Hz frames sampled> (600),
+ * --synthetic <joints>, which also reports a procedural clip of a chain of that many joints.
+ */
+int main(int argc, char* argv[]) {
+	ClipCompressionSettings settings{};
+	uint32_t instances{ 256 };
+	uint32_t frames{ 600 };
+	uint32_t syntheticJoints{ 0 };
+	std::vector<std::string> paths{};
+	for (int i{ 1 }; i < argc; ++i) {
+		std::string arg{ argv[i] };
+		if (arg.rfind("--", 0) != 0) {
+			paths.push_back(arg);
+		}
+		else if (i + 1 >= argc) {
+			break;
+		}
+		else if (arg == "--translation-tolerance") {
+			settings.translationTolerance = std::stof(argv[++i]);
+		}
+		else if (arg == "--rotation-tolerance") {
+			settings.rotationTolerance = std::stof(argv[++i]);
+		}
+		else if (arg == "--scale-tolerance") {
+			settings.scaleTolerance = std::stof(argv[++i]);
+		}
+		else if (arg == "--instances") {
+			instances = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+		}
+		else if (arg == "--frames") {
+			frames = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+		}
+		else if (arg == "--synthetic") {
+			syntheticJoints = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+	}
+	if (paths.empty()) {
+		paths = {
+			"models/fnaf_movie/freddy/scene.gltf",
+			"models/fnaf_movie/bonnie/scene.gltf",
+			"models/fnaf_movie/chica/scene.gltf",
+			"models/fnaf_movie/foxy/scene.gltf",
+		};
+	}
+
+	// A model that fails to load is reported, and the rest still are.
+	int result{ 0 };
+	for (auto& path : paths) {
+		try {
+			Skeleton skeleton{};
+			auto clips{ loadAnimationClips(path, skeleton) };
+			if (clips.empty()) {
+				std::cout << path << ": no animations" << std::endl;
+			}
+			std::vector<glm::mat4> bindLocals{};
+			skeleton.bindPose(bindLocals);
+			for (auto& clip : clips) {
+				report(path, clip, bindLocals, settings, instances, frames);
+			}
+		}
+		catch (std::runtime_error& e) {
+			std::cout << "ERROR: " << e.what() << std::endl;
+			result = 1;
+		}
+	}
+	if (syntheticJoints > 0) {
+		Skeleton skeleton{};
+		AnimationClip clip{ syntheticClip(syntheticJoints, skeleton) };
+		std::vector<glm::mat4> bindLocals{};
+		skeleton.bindPose(bindLocals);
+		report("synthetic chain", clip, bindLocals, settings, instances, frames);
+	}
+	return result;
+}
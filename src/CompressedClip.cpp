@@ -0,0 +1,311 @@
+#include "CompressedClip.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+	constexpr float INV_SQRT2{ 0.70710678f };
+	// Quantization steps of the smallest three components, and of 16-bit values.
+	constexpr float QUAT_STEP{ 2 * INV_SQRT2 / 32767 };
+	constexpr float VEC3_LEVELS{ 65535 };
+	constexpr float TIME_TICKS{ 65535 };
+
+	float maxDifference(const glm::vec3& a, const glm::vec3& b) {
+		glm::vec3 d{ glm::abs(a - b) };
+		return std::max(d.x, std::max(d.y, d.z));
+	}
+
+	// Quaternions q and -q are the same rotation; compare and blend them on the same side.
+	glm::quat alignedTo(const glm::quat& reference, const glm::quat& q) {
+		return glm::dot(reference, q) < 0 ? glm::quat{ -q.w, -q.x, -q.y, -q.z } : q;
+	}
+
+	float maxDifference(const glm::quat& a, const glm::quat& b) {
+		glm::quat c{ alignedTo(a, b) };
+		return std::max(std::max(std::abs(a.x - c.x), std::abs(a.y - c.y)), std::max(std::abs(a.z - c.z), std::abs(a.w - c.w)));
+	}
+
+	glm::vec3 interpolate(const glm::vec3& a, const glm::vec3& b, float t) {
+		return a + (b - a) * t;
+	}
+
+	glm::quat interpolate(const glm::quat& a, const glm::quat& b, float t) {
+		glm::quat c{ alignedTo(a, b) };
+		return glm::normalize(glm::quat{ a.w + (c.w - a.w) * t, a.x + (c.x - a.x) * t, a.y + (c.y - a.y) * t, a.z + (c.z - a.z) * t });
+	}
+
+	/**
+	 * @brief The keys of a track to keep: each run of keys that interpolation between its ends
+	 * reproduces within the tolerance is reduced to its ends, and a constant track to one key.
+	 */
+	template <typename T>
+	std::vector<uint32_t> reduceKeys(const float* times, const T* values, uint32_t count, float tolerance) {
+		std::vector<uint32_t> kept{};
+		if (count == 0) {
+			return kept;
+		}
+		kept.push_back(0);
+		bool constant{ true };
+		for (uint32_t k{ 1 }; k < count && constant; ++k) {
+			constant = maxDifference(values[0], values[k]) <= tolerance;
+		}
+		if (constant) {
+			return kept;
+		}
+
+		uint32_t anchor{ 0 };
+		for (uint32_t end{ 2 }; end < count; ++end) {
+			float span{ times[end] - times[anchor] };
+			for (uint32_t k{ anchor + 1 }; k < end; ++k) {
+				float t{ span > 0 ? (times[k] - times[anchor]) / span : 0.0f };
+				if (maxDifference(interpolate(values[anchor], values[end], t), values[k]) > tolerance) {
+					// The run can't reach this far; the key before it starts the next one.
+					anchor = end - 1;
+					kept.push_back(anchor);
+					break;
+				}
+			}
+		}
+		kept.push_back(count - 1);
+		return kept;
+	}
+
+	PackedQuat packQuat(const glm::quat& q) {
+		float c[4]{ q.x, q.y, q.z, q.w };
+		uint32_t largest{ 0 };
+		for (uint32_t i{ 1 }; i < 4; ++i) {
+			if (std::abs(c[i]) > std::abs(c[largest])) {
+				largest = i;
+			}
+		}
+		float sign{ c[largest] < 0 ? -1.0f : 1.0f };
+		PackedQuat packed{};
+		uint32_t j{ 0 };
+		for (uint32_t i{ 0 }; i < 4; ++i) {
+			if (i != largest) {
+				float v{ std::clamp(c[i] * sign, -INV_SQRT2, INV_SQRT2) };
+				packed.c[j++] = static_cast<uint16_t>(std::lround((v + INV_SQRT2) / QUAT_STEP));
+			}
+		}
+		packed.c[0] |= static_cast<uint16_t>((largest & 1) << 15);
+		packed.c[1] |= static_cast<uint16_t>((largest >> 1) << 15);
+		return packed;
+	}
+
+	PackedVec3 packVec3(const glm::vec3& v, const glm::vec3& min, const glm::vec3& step) {
+		PackedVec3 packed{};
+		for (int i{ 0 }; i < 3; ++i) {
+			float q{ step[i] > 0 ? (v[i] - min[i]) / step[i] : 0.0f };
+			packed.c[i] = static_cast<uint16_t>(std::clamp<long>(std::lround(q), 0, 65535));
+		}
+		return packed;
+	}
+
+	/**
+	 * @brief Appends the kept keys of a track, with their times quantized to ticks. Keys that
+	 * land on the same tick as the one before them are dropped.
+	 */
+	template <typename T, typename Packed, typename Pack>
+	KeyRange appendTrack(const KeyRange& source, const std::vector<float>& times, const std::vector<T>& values,
+		float tolerance, float tickLength, std::vector<uint16_t>& packedTimes, std::vector<Packed>& packedValues, Pack pack) {
+		KeyRange range{ static_cast<uint32_t>(packedTimes.size()), 0 };
+		if (source.count == 0) {
+			return range;
+		}
+		auto kept{ reduceKeys(&times[source.first], &values[source.first], source.count, tolerance) };
+		for (uint32_t k : kept) {
+			float ticks{ std::clamp(times[source.first + k] / tickLength, 0.0f, TIME_TICKS) };
+			uint16_t tick{ static_cast<uint16_t>(std::lround(ticks)) };
+			if (range.count > 0 && tick <= packedTimes.back()) {
+				continue;
+			}
+			packedTimes.push_back(tick);
+			packedValues.push_back(pack(values[source.first + k]));
+			++range.count;
+		}
+		return range;
+	}
+
+	/**
+	 * @brief The quantization range of a track: its minimum, and the step that spreads its
+	 * extent over 16 bits.
+	 */
+	void trackRange(const KeyRange& source, const std::vector<glm::vec3>& values, glm::vec3& min, glm::vec3& step) {
+		min = glm::vec3{ 0 };
+		glm::vec3 max{ 0 };
+		for (uint32_t k{ 0 }; k < source.count; ++k) {
+			const glm::vec3& v{ values[source.first + k] };
+			min = k == 0 ? v : glm::min(min, v);
+			max = k == 0 ? v : glm::max(max, v);
+		}
+		step = (max - min) / VEC3_LEVELS;
+	}
+
+#ifdef SIMD_SSE
+	__m128 unpackVec3(const PackedVec3& p, const __m128& min, const __m128& step) {
+		__m128 q{ _mm_cvtepi32_ps(_mm_set_epi32(0, p.c[2], p.c[1], p.c[0])) };
+		return _mm_add_ps(min, _mm_mul_ps(q, step));
+	}
+
+	float dot4(const __m128& a, const __m128& b) {
+		__m128 m{ _mm_mul_ps(a, b) };
+		__m128 s{ _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1))) };
+		s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtss_f32(s);
+	}
+
+	// Unpacks a quaternion into x, y, z, w lanes.
+	__m128 unpackQuat(const PackedQuat& p) {
+		uint32_t largest{ static_cast<uint32_t>((p.c[0] >> 15) | ((p.c[1] >> 15) << 1)) };
+		__m128i bits{ _mm_set_epi32(0, p.c[2] & 0x7fff, p.c[1] & 0x7fff, p.c[0] & 0x7fff) };
+		__m128 small{ _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(bits), _mm_set_ps(0, QUAT_STEP, QUAT_STEP, QUAT_STEP)),
+			_mm_set_ps(0, -INV_SQRT2, -INV_SQRT2, -INV_SQRT2)) };
+		float rest{ std::sqrt(std::max(0.0f, 1.0f - dot4(small, small))) };
+		alignas(16) float c[4];
+		_mm_store_ps(c, small);
+		// Move the smallest three up past the largest's slot, and put it back.
+		for (uint32_t i{ 3 }; i > largest; --i) {
+			c[i] = c[i - 1];
+		}
+		c[largest] = rest;
+		return _mm_load_ps(c);
+	}
+#else
+	glm::vec3 unpackVec3(const PackedVec3& p, const glm::vec3& min, const glm::vec3& step) {
+		return min + glm::vec3{ p.c[0], p.c[1], p.c[2] } * step;
+	}
+
+	glm::quat unpackQuat(const PackedQuat& p) {
+		uint32_t largest{ static_cast<uint32_t>((p.c[0] >> 15) | ((p.c[1] >> 15) << 1)) };
+		float small[3];
+		for (int i{ 0 }; i < 3; ++i) {
+			small[i] = (p.c[i] & 0x7fff) * QUAT_STEP - INV_SQRT2;
+		}
+		float c[4];
+		for (uint32_t i{ 0 }, j{ 0 }; i < 4; ++i) {
+			c[i] = i == largest ? 0.0f : small[j++];
+		}
+		c[largest] = std::sqrt(std::max(0.0f, 1.0f - small[0] * small[0] - small[1] * small[1] - small[2] * small[2]));
+		return glm::quat{ c[3], c[0], c[1], c[2] };
+	}
+#endif
+
+	glm::vec3 sampleVec3(const KeyRange& range, const std::vector<uint16_t>& times, const std::vector<PackedVec3>& values,
+		const glm::vec3& min, const glm::vec3& step, float ticks, uint32_t& cursor, const glm::vec3& fallback) {
+		if (range.count == 0) {
+			return fallback;
+		}
+		float t{ seekKey(&times[range.first], range.count, ticks, cursor) };
+		const PackedVec3* keys{ &values[range.first + cursor] };
+#ifdef SIMD_SSE
+		__m128 vmin{ _mm_set_ps(0, min.z, min.y, min.x) };
+		__m128 vstep{ _mm_set_ps(0, step.z, step.y, step.x) };
+		__m128 a{ unpackVec3(keys[0], vmin, vstep) };
+		if (t > 0) {
+			__m128 b{ unpackVec3(keys[1], vmin, vstep) };
+			a = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t)));
+		}
+		alignas(16) float r[4];
+		_mm_store_ps(r, a);
+		return glm::vec3{ r[0], r[1], r[2] };
+#else
+		glm::vec3 a{ unpackVec3(keys[0], min, step) };
+		return t > 0 ? interpolate(a, unpackVec3(keys[1], min, step), t) : a;
+#endif
+	}
+
+	glm::quat sampleQuat(const KeyRange& range, const std::vector<uint16_t>& times, const std::vector<PackedQuat>& values,
+		float ticks, uint32_t& cursor, const glm::quat& fallback) {
+		if (range.count == 0) {
+			return fallback;
+		}
+		float t{ seekKey(&times[range.first], range.count, ticks, cursor) };
+		const PackedQuat* keys{ &values[range.first + cursor] };
+#ifdef SIMD_SSE
+		__m128 a{ unpackQuat(keys[0]) };
+		if (t > 0) {
+			__m128 b{ unpackQuat(keys[1]) };
+			if (dot4(a, b) < 0) {
+				b = _mm_sub_ps(_mm_setzero_ps(), b);
+			}
+			a = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t)));
+			a = _mm_mul_ps(a, _mm_set1_ps(1.0f / std::sqrt(dot4(a, a))));
+		}
+		alignas(16) float r[4];
+		_mm_store_ps(r, a);
+		return glm::quat{ r[3], r[0], r[1], r[2] };
+#else
+		glm::quat a{ unpackQuat(keys[0]) };
+		return t > 0 ? interpolate(a, unpackQuat(keys[1]), t) : a;
+#endif
+	}
+}
+
+CompressedClip::CompressedClip(std::string name, float duration) :
+	m_name{ std::move(name) }, m_duration{ duration },
+	m_tickLength{ duration > 0 ? duration / TIME_TICKS : 1.0f } {
+}
+
+CompressedClip CompressedClip::compress(const AnimationClip& clip, const ClipCompressionSettings& settings) {
+	CompressedClip compressed{ clip.name(), clip.duration() };
+	float tick{ compressed.m_tickLength };
+	for (auto& source : clip.channels()) {
+		CompressedChannel channel{ source.joint };
+		trackRange(source.translation, clip.translations(), channel.translationMin, channel.translationStep);
+		trackRange(source.scale, clip.scales(), channel.scaleMin, channel.scaleStep);
+		channel.translation = appendTrack(source.translation, clip.translationTimes(), clip.translations(),
+			settings.translationTolerance, tick, compressed.m_translationTimes, compressed.m_translations,
+			[&](const glm::vec3& v) { return packVec3(v, channel.translationMin, channel.translationStep); });
+		channel.rotation = appendTrack(source.rotation, clip.rotationTimes(), clip.rotations(),
+			settings.rotationTolerance, tick, compressed.m_rotationTimes, compressed.m_rotations,
+			[](const glm::quat& q) { return packQuat(q); });
+		channel.scale = appendTrack(source.scale, clip.scaleTimes(), clip.scales(),
+			settings.scaleTolerance, tick, compressed.m_scaleTimes, compressed.m_scales,
+			[&](const glm::vec3& v) { return packVec3(v, channel.scaleMin, channel.scaleStep); });
+		compressed.m_channels.push_back(channel);
+	}
+	return compressed;
+}
+
+size_t CompressedClip::keyCount() const {
+	return m_translationTimes.size() + m_rotationTimes.size() + m_scaleTimes.size();
+}
+
+size_t CompressedClip::keyBytes() const {
+	return keyCount() * sizeof(uint16_t) + m_translations.size() * sizeof(PackedVec3)
+		+ m_rotations.size() * sizeof(PackedQuat) + m_scales.size() * sizeof(PackedVec3)
+		+ m_channels.size() * sizeof(CompressedChannel);
+}
+
+CompressedClipSampler::CompressedClipSampler(const CompressedClip& clip, const std::vector<glm::mat4>& bindLocals) :
+	m_clip{ &clip }, m_cursors(clip.channels().size() * 3, 0) {
+	for (auto& channel : clip.channels()) {
+		glm::vec3 translation;
+		glm::quat rotation;
+		glm::vec3 scale;
+		decomposeTransform(bindLocals[channel.joint], translation, rotation, scale);
+		m_bindTranslations.push_back(translation);
+		m_bindRotations.push_back(rotation);
+		m_bindScales.push_back(scale);
+	}
+}
+
+void CompressedClipSampler::sample(float time, std::vector<glm::mat4>& locals, const std::vector<uint8_t>* jointMask) {
+	float ticks{ time / m_clip->tickLength() };
+	auto& channels{ m_clip->channels() };
+	for (size_t c{ 0 }; c < channels.size(); ++c) {
+		auto& channel{ channels[c] };
+		if (jointMask && !(*jointMask)[channel.joint]) {
+			continue;
+		}
+		uint32_t* cursors{ &m_cursors[c * 3] };
+		glm::vec3 translation{ sampleVec3(channel.translation, m_clip->translationTimes(), m_clip->translations(),
+			channel.translationMin, channel.translationStep, ticks, cursors[0], m_bindTranslations[c]) };
+		glm::quat rotation{ sampleQuat(channel.rotation, m_clip->rotationTimes(), m_clip->rotations(),
+			ticks, cursors[1], m_bindRotations[c]) };
+		glm::vec3 scale{ sampleVec3(channel.scale, m_clip->scaleTimes(), m_clip->scales(),
+			channel.scaleMin, channel.scaleStep, ticks, cursors[2], m_bindScales[c]) };
+		locals[channel.joint] = composeTransform(translation, rotation, scale);
+	}
+}
@@ -0,0 +1,59 @@
+#include "DeferredRenderer.h"
+#include "ShadowAtlas.h"
+#include <glad/glad.h>
+
+DeferredRenderer::DeferredRenderer(ShaderProgram geometryProgram, ShaderProgram lightingProgram) :
+	m_geometryProgram{ std::move(geometryProgram) },
+	m_lightingProgram{ std::move(lightingProgram) },
+	m_emptyVao{ 0 } {
+	glGenVertexArrays(1, &m_emptyVao);
+
+	m_lightingProgram.activate();
+	m_lightingProgram.setUniform("gAlbedo", GBUFFER_FIRST_UNIT);
+	m_lightingProgram.setUniform("gNormal", GBUFFER_FIRST_UNIT + 1);
+	m_lightingProgram.setUniform("gMaterial", GBUFFER_FIRST_UNIT + 2);
+	m_lightingProgram.setUniform("gDepth", GBUFFER_FIRST_UNIT + 3);
+	LightClusters::assignSamplers(m_lightingProgram);
+	ShadowAtlas::assignSampler(m_lightingProgram);
+}
+
+void DeferredRenderer::geometryPass(const std::vector<Object3D>& objects, const glm::mat4& view,
+	const glm::mat4& projection, uint32_t width, uint32_t height, const std::vector<bool>& skip) {
+	m_gbuffer.resize(width, height);
+	m_gbuffer.bindForGeometry();
+
+	m_geometryProgram.activate();
+	m_geometryProgram.setUniform("view", view);
+	m_geometryProgram.setUniform("projection", projection);
+	m_geometryProgram.setUniform("shininessScale", GBuffer::SHININESS_SCALE);
+	for (size_t i{ 0 }; i < objects.size(); ++i) {
+		if (i < skip.size() && skip[i]) {
+			continue;
+		}
+		objects[i].render(m_geometryProgram);
+	}
+}
+
+void DeferredRenderer::lightingPass(uint32_t targetFbo, const glm::mat4& view, const glm::mat4& projection,
+	const glm::vec3& viewPos, LightClusters& clusters) {
+	glBindFramebuffer(GL_FRAMEBUFFER, targetFbo);
+	glViewport(0, 0, m_gbuffer.width(), m_gbuffer.height());
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	m_lightingProgram.activate();
+	m_lightingProgram.setUniform("view", view);
+	m_lightingProgram.setUniform("inverseViewProjection", glm::inverse(projection * view));
+	m_lightingProgram.setUniform("viewPos", viewPos);
+	m_lightingProgram.setUniform("shininessScale", GBuffer::SHININESS_SCALE);
+	clusters.bind(m_lightingProgram, glm::vec2{ static_cast<float>(m_gbuffer.width()), static_cast<float>(m_gbuffer.height()) });
+	m_gbuffer.bindTextures(GBUFFER_FIRST_UNIT);
+
+	// A single triangle that covers the viewport, generated in the vertex shader.
+	glDisable(GL_DEPTH_TEST);
+	glBindVertexArray(m_emptyVao);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+	glEnable(GL_DEPTH_TEST);
+
+	m_gbuffer.blitDepthTo(targetFbo);
+}
@@ -0,0 +1,123 @@
+#include "DepthPrepass.h"
+#include <glad/glad.h>
+
+DepthPrepass::DepthPrepass(Mode mode, float overdrawThreshold) :
+	m_mode{ mode },
+	m_overdrawThreshold{ overdrawThreshold },
+	m_enabled{ mode == Mode::On },
+	m_prepassThisFrame{ false },
+	m_query{ 0 },
+	m_queryPending{ false },
+	m_queryHadPrepass{ false },
+	m_queryPixels{ 0 },
+	m_framesUntilProbe{ 0 },
+	m_overdraw{ 0 },
+	m_benchSamples{ 0, 0 },
+	m_benchPixels{ 0, 0 },
+	m_benchFrames{ 0, 0 } {
+}
+
+void DepthPrepass::collectQuery() {
+	if (!m_queryPending) {
+		return;
+	}
+	int32_t available{ 0 };
+	glGetQueryObjectiv(m_query, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) {
+		return;
+	}
+	GLuint64 samples{ 0 };
+	glGetQueryObjectui64v(m_query, GL_QUERY_RESULT, &samples);
+	m_queryPending = false;
+
+	if (m_mode == Mode::Benchmark) {
+		m_benchSamples[m_queryHadPrepass] += samples;
+		m_benchPixels[m_queryHadPrepass] += m_queryPixels;
+		++m_benchFrames[m_queryHadPrepass];
+	}
+	// Only a frame without the prepass shows how much overdraw the pass really has.
+	if (!m_queryHadPrepass && m_queryPixels > 0) {
+		m_overdraw = static_cast<float>(samples) / m_queryPixels;
+		if (m_mode == Mode::Auto) {
+			m_enabled = m_overdraw > m_overdrawThreshold;
+		}
+	}
+}
+
+bool DepthPrepass::beginFrame() {
+	collectQuery();
+
+	switch (m_mode) {
+	case Mode::Off:
+		m_prepassThisFrame = false;
+		break;
+	case Mode::On:
+		m_prepassThisFrame = true;
+		break;
+	case Mode::Auto:
+		// Periodically skip the prepass so the next query measures raw overdraw.
+		if (m_framesUntilProbe == 0 && !m_queryPending) {
+			m_prepassThisFrame = false;
+			m_framesUntilProbe = PROBE_INTERVAL;
+		}
+		else {
+			m_prepassThisFrame = m_enabled;
+			if (m_framesUntilProbe > 0) {
+				--m_framesUntilProbe;
+			}
+		}
+		break;
+	case Mode::Benchmark:
+		// Measure whichever configuration has fewer samples, so that query latency can't make
+		// the alternation lock onto one of them.
+		m_prepassThisFrame = m_benchFrames[1] < m_benchFrames[0];
+		break;
+	}
+	return m_prepassThisFrame;
+}
+
+void DepthPrepass::renderPrepass(ShaderProgram& depthProgram, const std::vector<Object3D>& objects,
+	const std::vector<bool>& skip) const {
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	for (size_t i{ 0 }; i < objects.size(); ++i) {
+		if (i < skip.size() && skip[i]) {
+			continue;
+		}
+		objects[i].renderDepth(depthProgram);
+	}
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+void DepthPrepass::beginColorPass() {
+	if (m_prepassThisFrame) {
+		// Depth is already final; shade only the fragment that won, and don't write depth again.
+		glDepthFunc(GL_EQUAL);
+		glDepthMask(GL_FALSE);
+	}
+	if (!m_queryPending) {
+		if (m_query == 0) {
+			glGenQueries(1, &m_query);
+		}
+		glBeginQuery(GL_SAMPLES_PASSED, m_query);
+	}
+}
+
+void DepthPrepass::endColorPass(uint64_t pixelCount) {
+	if (!m_queryPending) {
+		glEndQuery(GL_SAMPLES_PASSED);
+		m_queryPending = true;
+		m_queryHadPrepass = m_prepassThisFrame;
+		m_queryPixels = pixelCount;
+	}
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+}
+
+float DepthPrepass::benchmarkSamplesPerPixel(bool withPrepass) const {
+	if (m_benchPixels[withPrepass] == 0) {
+		return 0;
+	}
+	return static_cast<float>(m_benchSamples[withPrepass]) / m_benchPixels[withPrepass];
+}
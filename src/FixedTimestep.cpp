@@ -0,0 +1,54 @@
+#include "FixedTimestep.h"
+#include <algorithm>
+
+FixedTimestep::FixedTimestep(float step, uint32_t maxSteps) :
+	m_step{ step }, m_maxSteps{ maxSteps } {
+}
+
+uint32_t FixedTimestep::accumulate(float frameTime) {
+	m_accumulator += frameTime;
+	uint32_t steps{ static_cast<uint32_t>(m_accumulator / m_step) };
+	if (steps > m_maxSteps) {
+		// Drops the time past the steps taken.
+		steps = m_maxSteps;
+		m_accumulator = m_step * steps;
+	}
+	m_accumulator = std::max(m_accumulator - m_step * steps, 0.0f);
+	return steps;
+}
+
+TransformInterpolator::TransformInterpolator(float teleportDistance) :
+	m_teleportDistance{ teleportDistance } {
+}
+
+void TransformInterpolator::beginStep(const std::vector<Object3D>& objects) {
+	m_previousPositions.resize(objects.size());
+	m_previousOrientations.resize(objects.size());
+	for (size_t i{ 0 }; i < objects.size(); ++i) {
+		m_previousPositions[i] = objects[i].getPosition();
+		m_previousOrientations[i] = objects[i].getOrientation();
+	}
+}
+
+void TransformInterpolator::beginRender(std::vector<Object3D>& objects, float alpha) {
+	m_simulatedPositions.resize(objects.size());
+	m_simulatedOrientations.resize(objects.size());
+	for (size_t i{ 0 }; i < objects.size(); ++i) {
+		m_simulatedPositions[i] = objects[i].getPosition();
+		m_simulatedOrientations[i] = objects[i].getOrientation();
+		// Objects added since the last step have nowhere to come from.
+		if (i >= m_previousPositions.size()
+			|| glm::distance(m_previousPositions[i], m_simulatedPositions[i]) > m_teleportDistance) {
+			continue;
+		}
+		objects[i].setPosition(glm::mix(m_previousPositions[i], m_simulatedPositions[i], alpha));
+		objects[i].setOrientation(glm::mix(m_previousOrientations[i], m_simulatedOrientations[i], alpha));
+	}
+}
+
+void TransformInterpolator::endRender(std::vector<Object3D>& objects) {
+	for (size_t i{ 0 }; i < objects.size() && i < m_simulatedPositions.size(); ++i) {
+		objects[i].setPosition(m_simulatedPositions[i]);
+		objects[i].setOrientation(m_simulatedOrientations[i]);
+	}
+}
@@ -0,0 +1,149 @@
+#include "Flythrough.h"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace {
+	glm::vec3 catmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float u) {
+		float u2{ u * u };
+		float u3{ u2 * u };
+		return 0.5f * (2.0f * p1 + (p2 - p0) * u + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * u2
+			+ (3.0f * p1 - p0 - 3.0f * p2 + p3) * u3);
+	}
+
+	CameraPose pose(const glm::vec3& position, const glm::vec3& target) {
+		return CameraPose{ position, glm::normalize(target - position) };
+	}
+
+	void writeDistribution(std::ofstream& out, const std::vector<float>& ms) {
+		float mean{ ms.empty() ? 0.0f : std::accumulate(ms.begin(), ms.end(), 0.0f) / ms.size() };
+		out << "{ \"mean\": " << mean
+			<< ", \"p50\": " << PassTimer::percentile(ms, 0.50f)
+			<< ", \"p95\": " << PassTimer::percentile(ms, 0.95f)
+			<< ", \"p99\": " << PassTimer::percentile(ms, 0.99f)
+			<< ", \"max\": " << (ms.empty() ? 0.0f : *std::max_element(ms.begin(), ms.end())) << " }";
+	}
+
+	// Escapes the characters JSON strings can't hold as they are.
+	std::string jsonString(const std::string& text) {
+		std::string escaped{ "\"" };
+		for (char c : text) {
+			if (c == '"' || c == '\\') {
+				escaped += '\\';
+			}
+			escaped += (static_cast<unsigned char>(c) < 0x20) ? ' ' : c;
+		}
+		return escaped + "\"";
+	}
+}
+
+CameraPath::CameraPath(std::vector<CameraKey> keys) : m_keys{ std::move(keys) } {
+}
+
+CameraPose CameraPath::sample(float time) const {
+	if (time <= m_keys.front().time) {
+		return pose(m_keys.front().position, m_keys.front().target);
+	}
+	if (time >= m_keys.back().time) {
+		return pose(m_keys.back().position, m_keys.back().target);
+	}
+	size_t i{ static_cast<size_t>(std::upper_bound(m_keys.begin(), m_keys.end(), time,
+		[](float t, const CameraKey& key) { return t < key.time; }) - m_keys.begin()) - 1 };
+	const CameraKey& k1{ m_keys[i] };
+	const CameraKey& k2{ m_keys[i + 1] };
+	if (k2.cut) {
+		return pose(k1.position, k1.target);
+	}
+	// The spline's ends, and the keys either side of a cut, have no neighbour to curve towards.
+	const CameraKey& k0{ (i > 0 && !k1.cut) ? m_keys[i - 1] : k1 };
+	const CameraKey& k3{ (i + 2 < m_keys.size() && !m_keys[i + 2].cut) ? m_keys[i + 2] : k2 };
+	float u{ (time - k1.time) / (k2.time - k1.time) };
+	return pose(catmullRom(k0.position, k1.position, k2.position, k3.position, u),
+		catmullRom(k0.target, k1.target, k2.target, k3.target, u));
+}
+
+FlythroughBenchmark::FlythroughBenchmark(std::vector<FlythroughSegment> segments) :
+	m_segments{ std::move(segments) }, m_totals(m_segments.size()) {
+	for (auto& segment : m_segments) {
+		m_timer.addPass(segment.name);
+	}
+}
+
+void FlythroughBenchmark::beginFrame() {
+	m_timer.begin(static_cast<uint32_t>(m_segment));
+	m_frameStart = GlIntercept::totals();
+}
+
+void FlythroughBenchmark::endFrame(float dt) {
+	m_timer.end(static_cast<uint32_t>(m_segment));
+	auto& totals{ m_totals[m_segment] };
+	totals.work += GlIntercept::totals() - m_frameStart;
+	totals.endResidentBytes = residentBytes();
+	totals.peakResidentBytes = std::max(totals.peakResidentBytes, totals.endResidentBytes);
+
+	m_time += dt;
+	if (m_time >= m_segments[m_segment].duration) {
+		m_time = 0;
+		++m_segment;
+	}
+}
+
+void FlythroughBenchmark::writeJson(const std::filesystem::path& path, const std::string& renderer) {
+	m_timer.finish();
+	std::ofstream out{ path };
+	if (!out) {
+		throw std::runtime_error("Could not write " + path.string());
+	}
+	out << "{\n  \"renderer\": " << jsonString(renderer) << ",\n  \"segments\": [";
+	for (uint32_t s{ 0 }; s < m_segments.size(); ++s) {
+		auto& totals{ m_totals[s] };
+		double frames{ static_cast<double>(std::max<size_t>(m_timer.cpuTimes(s).size(), 1)) };
+		out << (s == 0 ? "\n" : ",\n") << "    {\n"
+			<< "      \"name\": " << jsonString(m_segments[s].name) << ",\n"
+			<< "      \"frames\": " << m_timer.cpuTimes(s).size() << ",\n"
+			<< "      \"cpuMs\": ";
+		writeDistribution(out, m_timer.cpuTimes(s));
+		out << ",\n      \"gpuMs\": ";
+		writeDistribution(out, m_timer.gpuTimes(s));
+		out << ",\n"
+			<< "      \"drawsPerFrame\": " << totals.work.draws / frames << ",\n"
+			<< "      \"stateChangesPerFrame\": " << totals.work.stateChanges / frames << ",\n"
+			<< "      \"trianglesPerFrame\": " << totals.work.triangles / frames << ",\n"
+			<< "      \"uniformUploadsPerFrame\": " << totals.work.uniformUploads / frames << ",\n"
+			<< "      \"bufferUploadsPerFrame\": " << totals.work.bufferUploads / frames << ",\n"
+			<< "      \"textureUploadsPerFrame\": " << totals.work.textureUploads / frames << ",\n"
+			<< "      \"redundantCallsPerFrame\": " << totals.work.redundantCalls / frames << ",\n"
+			<< "      \"residentBytes\": " << totals.endResidentBytes << ",\n"
+			<< "      \"peakResidentBytes\": " << totals.peakResidentBytes << "\n"
+			<< "    }";
+	}
+	out << "\n  ]\n}\n";
+}
+
+uint64_t FlythroughBenchmark::residentBytes() {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters{};
+	if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return counters.WorkingSetSize;
+	}
+	return 0;
+#elif defined(__linux__)
+	// The second field of statm is the resident set, in pages.
+	std::ifstream statm{ "/proc/self/statm" };
+	uint64_t size{ 0 };
+	uint64_t resident{ 0 };
+	statm >> size >> resident;
+	return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,51 @@
+#include "FnafLayout.h"
+#include <cmath>
+#include <numbers>
+
+glm::mat4 Placement::modelMatrix() const {
+	auto m = glm::translate(glm::mat4{ 1 }, position);
+	m = glm::rotate(m, orientation[2], glm::vec3{ 0, 0, 1 });
+	m = glm::rotate(m, orientation[0], glm::vec3{ 1, 0, 0 });
+	m = glm::rotate(m, orientation[1], glm::vec3{ 0, 1, 0 });
+	m = glm::scale(m, scale);
+	return m;
+}
+
+std::vector<Placement> fnafStaticRooms() {
+	constexpr float pi{ std::numbers::pi_v<float> };
+	return {
+		{ "models/fnaf_movie/stage/scene.gltf", glm::vec3{ 0, .55, -30 }, glm::vec3{ 0.336, 0.336, 0.336 }, glm::vec3{ 0, pi, 0 } },
+		{ "models/fnaf_movie/office/scene.gltf", glm::vec3{ 0, -.5, 4.5 }, glm::vec3{ 1, 1, 1 }, glm::vec3{ 0, 0, 0 } },
+		{ "models/fnaf_movie/pirate_cove/scene.gltf", glm::vec3{ -9, -.8, -28 }, glm::vec3{ .84, .84, .84 }, glm::vec3{ 0, (5 * pi) / 4, 0 } },
+	};
+}
+
+std::vector<PointLight> fnafLights() {
+	std::vector<PointLight> lights{};
+	// Hallway lamps, from the pirate cove corner down to the office.
+	for (float z : { -16.0f, -10.0f, -4.0f, 2.0f }) {
+		PointLight lamp{ glm::vec3{ -1, 1.2, z }, 4.5f, glm::vec3{ 1.0, 0.85, 0.6 } };
+		lamp.baked = true;
+		lights.push_back(lamp);
+	}
+	// Stage spotlights, aimed down at Freddy, Bonnie and Chica. They stay dynamic, so that the
+	// animatronics cast shadows from them.
+	glm::vec3 stageColors[]{ { 1.0, 0.6, 0.8 }, { 1.0, 0.95, 0.8 }, { 0.6, 0.7, 1.0 } };
+	for (int i{ 0 }; i < 3; ++i) {
+		float x{ (i - 1) * 0.6f };
+		PointLight spot{ glm::vec3{ x, 2.5, -27 }, 6.0f, stageColors[i] * 1.5f };
+		spot.direction = glm::normalize(glm::vec3{ x, -0.5, -29.5 } - spot.position);
+		spot.cosInner = std::cos(0.25f);
+		spot.cosOuter = std::cos(0.4f);
+		spot.castsShadows = true;
+		lights.push_back(spot);
+	}
+	// A dim lamp over the pirate cove curtain, and the office ceiling light.
+	PointLight coveLamp{ glm::vec3{ -8, 1.5, -26 }, 4.0f, glm::vec3{ 0.8, 0.5, 0.9 } };
+	coveLamp.baked = true;
+	lights.push_back(coveLamp);
+	PointLight officeLight{ glm::vec3{ 0, 1.5, 4.5 }, 3.0f, glm::vec3{ 0.9, 0.9, 0.7 } };
+	officeLight.baked = true;
+	lights.push_back(officeLight);
+	return lights;
+}
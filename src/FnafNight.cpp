@@ -0,0 +1,85 @@
+#include "FnafNight.h"
+#include <algorithm>
+#include <utility>
+
+FnafNight::FnafNight(const NightSettings& settings) :
+	m_settings{ settings }, m_random{ settings.seed }, m_power{ settings.power } {
+	m_scripts.spawn(foxyScript());
+}
+
+void FnafNight::notify(NightEvent event) {
+	if (m_eventCallback) {
+		m_eventCallback(event);
+	}
+}
+
+Script FnafNight::foxyScript() {
+	float jitter{ m_settings.foxyDelayJitter };
+	co_await m_scripts.delay(m_settings.foxyDelay + (jitter > 0 ? std::uniform_real_distribution<float>{ -jitter, jitter }(m_random) : 0.0f));
+	m_foxy = FoxyState::Running;
+	m_foxyRunStart = m_time;
+	notify(NightEvent::FoxyLeftCove);
+	co_await m_scripts.delay(m_settings.foxyRunTime);
+
+	// An open door lets him in, and he stays until it is closed; either way, it sends him back.
+	if (!m_leftDoorClosed.get()) {
+		m_foxy = FoxyState::InOffice;
+		if (m_outcome == NightOutcome::Playing) {
+			m_outcome = NightOutcome::CaughtByFoxy;
+		}
+		notify(NightEvent::FoxyCaughtPlayer);
+		co_await m_leftDoorClosed.becomes(true);
+	}
+	m_foxy = FoxyState::InCove;
+	notify(NightEvent::FoxyReturnedToCove);
+}
+
+void FnafNight::step(float dt) {
+	m_time += dt;
+	if (m_power > 0) {
+		uint32_t closedDoors{ static_cast<uint32_t>(m_leftDoorClosed.get()) + static_cast<uint32_t>(m_rightDoorClosed.get()) };
+		m_power = std::max(m_power - (m_settings.idleDrain + m_settings.doorDrain * closedDoors) * dt, 0.0f);
+		if (m_power == 0) {
+			setLeftDoor(false);
+			setRightDoor(false);
+			notify(NightEvent::PowerOut);
+		}
+	}
+	m_scripts.advance(dt);
+	if (m_outcome == NightOutcome::Playing && m_time >= m_settings.nightLength) {
+		m_outcome = NightOutcome::Survived;
+		notify(NightEvent::SixAm);
+	}
+}
+
+bool FnafNight::setLeftDoor(bool closed) {
+	if (closed == m_leftDoorClosed.get() || (closed && m_power <= 0)) {
+		return false;
+	}
+	m_leftDoorClosed.change(closed);
+	// Observers hear of the door before anything it resumes, like Foxy going back to his cove.
+	notify(closed ? NightEvent::LeftDoorClosed : NightEvent::LeftDoorOpened);
+	m_leftDoorClosed.resumeWaiting();
+	return true;
+}
+
+bool FnafNight::setRightDoor(bool closed) {
+	if (closed == m_rightDoorClosed.get() || (closed && m_power <= 0)) {
+		return false;
+	}
+	m_rightDoorClosed.change(closed);
+	notify(closed ? NightEvent::RightDoorClosed : NightEvent::RightDoorOpened);
+	m_rightDoorClosed.resumeWaiting();
+	return true;
+}
+
+float FnafNight::foxyRunProgress() const {
+	switch (m_foxy) {
+	case FoxyState::Running:
+		return std::clamp((m_time - m_foxyRunStart) / m_settings.foxyRunTime, 0.0f, 1.0f);
+	case FoxyState::InOffice:
+		return 1.0f;
+	default:
+		return 0.0f;
+	}
+}
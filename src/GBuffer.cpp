@@ -0,0 +1,89 @@
+#include "GBuffer.h"
+#include <glad/glad.h>
+#include <stdexcept>
+
+GBuffer::GBuffer() :
+	m_fbo{ 0 }, m_albedo{ 0 }, m_normal{ 0 }, m_material{ 0 }, m_depth{ 0 },
+	m_width{ 0 }, m_height{ 0 } {
+}
+
+GBuffer::~GBuffer() {
+	destroy();
+}
+
+void GBuffer::destroy() {
+	if (m_fbo != 0) {
+		uint32_t textures[]{ m_albedo, m_normal, m_material, m_depth };
+		glDeleteTextures(4, textures);
+		glDeleteFramebuffers(1, &m_fbo);
+		m_fbo = 0;
+	}
+}
+
+namespace {
+	uint32_t createTarget(uint32_t width, uint32_t height, GLint internalFormat, GLenum format, GLenum type) {
+		uint32_t id;
+		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D, id);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		return id;
+	}
+}
+
+void GBuffer::resize(uint32_t width, uint32_t height) {
+	if (width == m_width && height == m_height && m_fbo != 0) {
+		return;
+	}
+	destroy();
+	m_width = width;
+	m_height = height;
+
+	glGenFramebuffers(1, &m_fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+
+	m_albedo = createTarget(width, height, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+	m_normal = createTarget(width, height, GL_RG16F, GL_RG, GL_FLOAT);
+	m_material = createTarget(width, height, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+	m_depth = createTarget(width, height, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_albedo, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_normal, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, m_material, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_depth, 0);
+
+	GLenum drawBuffers[]{ GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glDrawBuffers(3, drawBuffers);
+
+	GLenum status{ glCheckFramebufferStatus(GL_FRAMEBUFFER) };
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		throw std::runtime_error("G-buffer framebuffer is incomplete");
+	}
+}
+
+void GBuffer::bindForGeometry() {
+	glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+	glViewport(0, 0, m_width, m_height);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+}
+
+void GBuffer::bindTextures(int32_t firstUnit) const {
+	uint32_t textures[]{ m_albedo, m_normal, m_material, m_depth };
+	for (int32_t i{ 0 }; i < 4; ++i) {
+		glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+		glBindTexture(GL_TEXTURE_2D, textures[i]);
+	}
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void GBuffer::blitDepthTo(uint32_t targetFbo) const {
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFbo);
+	glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, targetFbo);
+}
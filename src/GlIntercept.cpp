@@ -0,0 +1,719 @@
+#include "GlIntercept.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <optional>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+	// What one call did, for the counters.
+	struct Effect {
+		GlCallKind kind{ GlCallKind::Other };
+		uint64_t triangles{ 0 };
+		bool redundant{ false };
+	};
+
+	struct PassCounts {
+		std::string name;
+		RenderStats frame{};
+		RenderStats lastFrame{};
+		RenderStats peakFrame{};
+		RenderStats total{};
+	};
+
+	// A shadow copy of the context state that calls can set redundantly, as a new context has it.
+	struct ShadowState {
+		uint32_t program{ 0 };
+		uint32_t vertexArray{ 0 };
+		uint32_t activeTexture{ GL_TEXTURE0 };
+		uint32_t drawFramebuffer{ 0 };
+		uint32_t readFramebuffer{ 0 };
+		uint32_t renderbuffer{ 0 };
+		// By (unit << 32) | target.
+		std::unordered_map<uint64_t, uint32_t> textures{};
+		// By target; the element array buffer belongs to the vertex array, so is kept by that.
+		std::unordered_map<uint32_t, uint32_t> buffers{};
+		std::unordered_map<uint32_t, uint32_t> elementBuffers{};
+		// By (target << 32) | index.
+		std::unordered_map<uint64_t, uint32_t> indexedBuffers{};
+		std::unordered_map<uint32_t, bool> capabilities{ { GL_DITHER, true }, { GL_MULTISAMPLE, true } };
+		std::unordered_map<uint32_t, int32_t> pixelStore{ { GL_PACK_ALIGNMENT, 4 }, { GL_UNPACK_ALIGNMENT, 4 } };
+		// A hash of each uniform's value, by (program << 32) | location.
+		std::unordered_map<uint64_t, uint64_t> uniforms{};
+		bool depthMask{ true };
+		uint32_t depthFunc{ GL_LESS };
+		std::array<bool, 4> colorMask{ true, true, true, true };
+		std::array<float, 4> clearColor{ 0, 0, 0, 0 };
+		std::array<float, 2> polygonOffset{ 0, 0 };
+		// The window sets the first viewport and scissor box, unseen.
+		std::optional<std::array<int32_t, 4>> viewport{};
+		std::optional<std::array<int32_t, 4>> scissor{};
+	};
+
+	// A uniform the mock made up a location for: the location of its first element, and how many
+	// elements it has (1 if it isn't an array).
+	struct MockUniform {
+		int32_t location;
+		uint32_t size;
+	};
+
+	struct Tracker {
+		GlIntercept::Mode mode{ GlIntercept::Mode::Off };
+		std::vector<PassCounts> passes{ PassCounts{ "Other" } };
+		uint32_t pass{ 0 };
+		uint64_t frames{ 0 };
+		RenderStats totals{};
+		ShadowState state{};
+		std::vector<GlCommand> commands{};
+		// The mock's made-up object names and uniform locations, by program and name.
+		uint32_t nextName{ 0 };
+		std::unordered_map<std::string, MockUniform> uniformLocations{};
+		// The mock's shader sources and the shaders attached to each program, from which linking
+		// finds the uniforms the program has.
+		std::unordered_map<uint32_t, std::string> shaderSources{};
+		std::unordered_map<uint32_t, std::vector<uint32_t>> attachedShaders{};
+	};
+
+	Tracker& tracker() {
+		static Tracker t{};
+		return t;
+	}
+
+	// Sets slot to value, and returns whether it already was.
+	template <typename T>
+	bool set(T& slot, const T& value) {
+		if (slot == value) {
+			return true;
+		}
+		slot = value;
+		return false;
+	}
+
+	template <typename T>
+	bool set(std::optional<T>& slot, const T& value) {
+		if (slot == value) {
+			return true;
+		}
+		slot = value;
+		return false;
+	}
+
+	Effect stateChange(bool redundant) {
+		return Effect{ GlCallKind::StateChange, 0, redundant };
+	}
+
+	Effect draw(GLenum mode, GLsizei count) {
+		uint64_t triangles{ 0 };
+		if (mode == GL_TRIANGLES) {
+			triangles = count / 3;
+		}
+		else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2) {
+			triangles = count - 2;
+		}
+		return Effect{ GlCallKind::Draw, triangles, false };
+	}
+
+	// An upload to a uniform of the current program is redundant if the program doesn't have the
+	// uniform, or already has the value.
+	Effect uniform(GLint location, const void* value, size_t bytes) {
+		if (location < 0) {
+			return Effect{ GlCallKind::UniformUpload, 0, true };
+		}
+		uint64_t hash{ 14695981039346656037ull };
+		for (size_t i{ 0 }; i < bytes; ++i) {
+			hash = (hash ^ static_cast<const uint8_t*>(value)[i]) * 1099511628211ull;
+		}
+		uint64_t key{ (static_cast<uint64_t>(tracker().state.program) << 32) | static_cast<uint32_t>(location) };
+		auto [found, added] { tracker().state.uniforms.try_emplace(key, hash) };
+		return Effect{ GlCallKind::UniformUpload, 0, !added && set(found->second, hash) };
+	}
+
+	/**
+	 * @brief Evaluates the condition of a mocked shader's #if or #elif: defined(NAME), numbers,
+	 * !, &&, || and parentheses, which is all the shaders use. Other names count as 0, as in C.
+	 */
+	struct ConditionParser {
+		const std::string& text;
+		const std::unordered_set<std::string>& defines;
+		size_t at{ 0 };
+
+		void skipSpace() {
+			while (at < text.size() && std::isspace(static_cast<unsigned char>(text[at]))) {
+				++at;
+			}
+		}
+
+		bool accept(const char* token) {
+			skipSpace();
+			size_t length{ std::strlen(token) };
+			if (text.compare(at, length, token) != 0) {
+				return false;
+			}
+			at += length;
+			return true;
+		}
+
+		std::string word() {
+			skipSpace();
+			size_t start{ at };
+			while (at < text.size() && (std::isalnum(static_cast<unsigned char>(text[at])) || text[at] == '_')) {
+				++at;
+			}
+			return text.substr(start, at - start);
+		}
+
+		bool primary() {
+			if (accept("!")) {
+				return !primary();
+			}
+			if (accept("(")) {
+				bool value{ disjunction() };
+				accept(")");
+				return value;
+			}
+			std::string name{ word() };
+			if (name == "defined") {
+				bool parenthesized{ accept("(") };
+				bool value{ defines.contains(word()) };
+				if (parenthesized) {
+					accept(")");
+				}
+				return value;
+			}
+			if (name.empty()) {
+				// Something this doesn't understand: skip it.
+				at = text.size();
+				return false;
+			}
+			return std::isdigit(static_cast<unsigned char>(name[0])) && std::stoul(name, nullptr, 0) != 0;
+		}
+
+		bool conjunction() {
+			bool value{ primary() };
+			while (accept("&&")) {
+				value = primary() && value;
+			}
+			return value;
+		}
+
+		bool disjunction() {
+			bool value{ conjunction() };
+			while (accept("||")) {
+				value = conjunction() || value;
+			}
+			return value;
+		}
+	};
+
+	/**
+	 * @brief Adds the uniforms a mocked shader declares to uniforms, by name, with their array
+	 * sizes. Lines left out by the shader's #ifdef, #ifndef, #if, #elif and #else are skipped.
+	 */
+	void declaredUniforms(const std::string& source, std::unordered_map<std::string, uint32_t>& uniforms) {
+		std::unordered_set<std::string> defines{};
+		// Each open #if: whether the lines around it are kept, whether one of its branches has
+		// been, and whether the current branch is.
+		struct Branch {
+			bool outerKept;
+			bool taken;
+			bool kept;
+		};
+		std::vector<Branch> branches{};
+		auto kept{ [&branches] { return branches.empty() || branches.back().kept; } };
+
+		std::istringstream lines{ source };
+		std::string line{};
+		while (std::getline(lines, line)) {
+			line = line.substr(0, line.find("//"));
+			size_t first{ line.find_first_not_of(" \t") };
+			if (first == std::string::npos) {
+				continue;
+			}
+			if (line[first] == '#') {
+				std::istringstream directive{ line.substr(first + 1) };
+				std::string keyword{};
+				std::string rest{};
+				directive >> keyword;
+				std::getline(directive, rest);
+				std::string name{};
+				std::istringstream{ rest } >> name;
+				if (keyword == "define" && kept()) {
+					defines.insert(name.substr(0, name.find('(')));
+				}
+				else if (keyword == "undef" && kept()) {
+					defines.erase(name);
+				}
+				else if (keyword == "ifdef" || keyword == "ifndef" || keyword == "if") {
+					bool condition{ keyword == "if" ? ConditionParser{ rest, defines }.disjunction()
+						: defines.contains(name) == (keyword == "ifdef") };
+					branches.push_back(Branch{ kept(), condition, kept() && condition });
+				}
+				else if (keyword == "elif" && !branches.empty()) {
+					Branch& branch{ branches.back() };
+					bool condition{ !branch.taken && ConditionParser{ rest, defines }.disjunction() };
+					branch.kept = branch.outerKept && condition;
+					branch.taken = branch.taken || condition;
+				}
+				else if (keyword == "else" && !branches.empty()) {
+					Branch& branch{ branches.back() };
+					branch.kept = branch.outerKept && !branch.taken;
+					branch.taken = true;
+				}
+				else if (keyword == "endif" && !branches.empty()) {
+					branches.pop_back();
+				}
+				continue;
+			}
+			if (!kept()) {
+				continue;
+			}
+
+			// uniform <type> <name>[<size>], ...;
+			size_t at{ line.find("uniform ") };
+			if (at == std::string::npos || (at > 0 && !std::isspace(static_cast<unsigned char>(line[at - 1])) && line[at - 1] != ')')) {
+				continue;
+			}
+			std::istringstream declaration{ line.substr(at + 8, line.find(';', at) - at - 8) };
+			std::string type{};
+			do {
+				declaration >> type;
+			} while (type == "highp" || type == "mediump" || type == "lowp");
+			std::string declarator{};
+			while (std::getline(declaration, declarator, ',')) {
+				std::string uniformName{ ConditionParser{ declarator, defines }.word() };
+				if (uniformName.empty()) {
+					continue;
+				}
+				size_t bracket{ declarator.find('[') };
+				uint32_t size{ bracket == std::string::npos ? 1u
+					: static_cast<uint32_t>(std::strtoul(declarator.c_str() + bracket + 1, nullptr, 0)) };
+				uniforms.try_emplace(uniformName, std::max(size, 1u));
+			}
+		}
+	}
+
+	// Deleting an object unbinds it wherever it is bound.
+	template <typename Map>
+	void unbind(Map& bindings, uint32_t name) {
+		for (auto& [key, bound] : bindings) {
+			if (bound == name) {
+				bound = 0;
+			}
+		}
+	}
+
+	void count(const char* name, const Effect& effect) {
+		Tracker& t{ tracker() };
+		RenderStats delta{};
+		switch (effect.kind) {
+		case GlCallKind::Draw:
+			delta.draws = 1;
+			delta.triangles = effect.triangles;
+			break;
+		case GlCallKind::StateChange:
+			delta.stateChanges = 1;
+			break;
+		case GlCallKind::UniformUpload:
+			delta.uniformUploads = 1;
+			break;
+		case GlCallKind::BufferUpload:
+			delta.bufferUploads = 1;
+			break;
+		case GlCallKind::TextureUpload:
+			delta.textureUploads = 1;
+			break;
+		case GlCallKind::Other:
+			break;
+		}
+		delta.redundantCalls = effect.redundant ? 1 : 0;
+		t.totals += delta;
+		t.passes[t.pass].frame += delta;
+		t.passes[t.pass].total += delta;
+		if (t.mode == GlIntercept::Mode::Mock) {
+			t.commands.push_back(GlCommand{ name, effect.kind, t.pass, effect.triangles, effect.redundant });
+		}
+	}
+
+	/**
+	 * @brief Stands in for one of glad's function pointers, *Slot: observes each call's effect on
+	 * the counters, then makes it; or, mocked, makes one up.
+	 */
+	template <auto* Slot, typename Proc = std::remove_pointer_t<decltype(Slot)>>
+	struct Hook;
+
+	template <auto* Slot, typename R, typename... Args>
+	struct Hook<Slot, R(APIENTRYP)(Args...)> {
+		static inline const char* name{ nullptr };
+		static inline R(APIENTRYP real)(Args...) { nullptr };
+		static inline Effect(*observe)(Args...) { nullptr };
+		static inline R(*fake)(Args...) { nullptr };
+
+		static R APIENTRY call(Args... args) {
+			count(name, observe ? observe(args...) : Effect{});
+			if (real) {
+				return real(args...);
+			}
+			if (fake) {
+				return fake(args...);
+			}
+			if constexpr (!std::is_void_v<R>) {
+				return R{};
+			}
+		}
+	};
+
+	// Observers and fakes are lambdas, generic so as not to repeat each function's parameter types.
+	template <auto* Slot, typename Observe = std::nullptr_t, typename Fake = std::nullptr_t>
+	void hook(const char* name, Observe observe = nullptr, Fake fake = nullptr) {
+		using H = Hook<Slot>;
+		bool mock{ tracker().mode == GlIntercept::Mode::Mock };
+		// Functions the driver doesn't have stay missing.
+		if (!mock && !*Slot) {
+			return;
+		}
+		H::name = name;
+		H::real = mock ? nullptr : *Slot;
+		H::observe = observe;
+		H::fake = fake;
+		*Slot = &H::call;
+	}
+
+	// A mocked glGen*: new names, never used before.
+	constexpr auto GENERATE{ [](auto n, auto* names) {
+		for (decltype(n) i{ 0 }; i < n; ++i) {
+			names[i] = ++tracker().nextName;
+		}
+	} };
+	constexpr auto CREATE{ [](auto...) { return static_cast<GLuint>(++tracker().nextName); } };
+	constexpr auto OTHER{ [](auto...) { return Effect{}; } };
+	constexpr auto STATE{ [](auto...) { return stateChange(false); } };
+	constexpr auto UNIFORM_1{ [](auto location, auto value) { return uniform(location, &value, sizeof(value)); } };
+}
+
+// Each hook is named after the function it stands in for, and installed over glad's pointer to it.
+#define GL_HOOK(function, ...) hook<&glad_##function>(#function, __VA_ARGS__)
+
+void GlIntercept::install(Mode mode) {
+	tracker().mode = mode;
+	if (mode == Mode::Off) {
+		return;
+	}
+
+	// Draws.
+	GL_HOOK(glDrawArrays, [](auto mode, auto, auto count) { return draw(mode, count); });
+	GL_HOOK(glDrawElements, [](auto mode, auto count, auto, auto) { return draw(mode, count); });
+
+	// Bindings.
+	GL_HOOK(glUseProgram, [](auto program) { return stateChange(set(tracker().state.program, program)); });
+	GL_HOOK(glBindVertexArray, [](auto array) { return stateChange(set(tracker().state.vertexArray, array)); });
+	GL_HOOK(glActiveTexture, [](auto unit) { return stateChange(set(tracker().state.activeTexture, unit)); });
+	GL_HOOK(glBindTexture, [](auto target, auto texture) {
+		ShadowState& s{ tracker().state };
+		return stateChange(set(s.textures[(static_cast<uint64_t>(s.activeTexture) << 32) | target], texture));
+	});
+	GL_HOOK(glBindBuffer, [](auto target, auto buffer) {
+		ShadowState& s{ tracker().state };
+		return stateChange(set(target == GL_ELEMENT_ARRAY_BUFFER ? s.elementBuffers[s.vertexArray] : s.buffers[target], buffer));
+	});
+	GL_HOOK(glBindBufferBase, [](auto target, auto index, auto buffer) {
+		ShadowState& s{ tracker().state };
+		s.buffers[target] = buffer;
+		return stateChange(set(s.indexedBuffers[(static_cast<uint64_t>(target) << 32) | index], buffer));
+	});
+	GL_HOOK(glBindFramebuffer, [](auto target, auto framebuffer) {
+		ShadowState& s{ tracker().state };
+		bool drawSet{ target == GL_READ_FRAMEBUFFER || set(s.drawFramebuffer, framebuffer) };
+		bool readSet{ target == GL_DRAW_FRAMEBUFFER || set(s.readFramebuffer, framebuffer) };
+		return stateChange(drawSet && readSet);
+	});
+	GL_HOOK(glBindRenderbuffer, [](auto, auto renderbuffer) { return stateChange(set(tracker().state.renderbuffer, renderbuffer)); });
+
+	// Fixed-function state.
+	GL_HOOK(glEnable, [](auto capability) { return stateChange(set(tracker().state.capabilities[capability], true)); });
+	GL_HOOK(glDisable, [](auto capability) { return stateChange(set(tracker().state.capabilities[capability], false)); });
+	GL_HOOK(glDepthMask, [](auto flag) { return stateChange(set(tracker().state.depthMask, flag != GL_FALSE)); });
+	GL_HOOK(glDepthFunc, [](auto func) { return stateChange(set(tracker().state.depthFunc, func)); });
+	GL_HOOK(glColorMask, [](auto r, auto g, auto b, auto a) {
+		return stateChange(set(tracker().state.colorMask, std::array<bool, 4>{ r != GL_FALSE, g != GL_FALSE, b != GL_FALSE, a != GL_FALSE }));
+	});
+	GL_HOOK(glClearColor, [](auto r, auto g, auto b, auto a) {
+		return stateChange(set(tracker().state.clearColor, std::array<float, 4>{ r, g, b, a }));
+	});
+	GL_HOOK(glPolygonOffset, [](auto factor, auto units) {
+		return stateChange(set(tracker().state.polygonOffset, std::array<float, 2>{ factor, units }));
+	});
+	GL_HOOK(glViewport, [](auto x, auto y, auto width, auto height) {
+		return stateChange(set(tracker().state.viewport, std::array<int32_t, 4>{ x, y, width, height }));
+	});
+	GL_HOOK(glScissor, [](auto x, auto y, auto width, auto height) {
+		return stateChange(set(tracker().state.scissor, std::array<int32_t, 4>{ x, y, width, height }));
+	});
+	GL_HOOK(glPixelStorei, [](auto pname, auto param) { return stateChange(set(tracker().state.pixelStore[pname], param)); });
+	GL_HOOK(glDrawBuffer, STATE);
+	GL_HOOK(glDrawBuffers, STATE);
+	GL_HOOK(glReadBuffer, STATE);
+	GL_HOOK(glTexParameteri, STATE);
+	GL_HOOK(glTexBuffer, STATE);
+	GL_HOOK(glVertexAttribPointer, STATE);
+	GL_HOOK(glVertexAttribIPointer, STATE);
+	GL_HOOK(glEnableVertexAttribArray, STATE);
+
+	// Uniforms, of the current program.
+	GL_HOOK(glUniform1i, UNIFORM_1);
+	GL_HOOK(glUniform1f, UNIFORM_1);
+	GL_HOOK(glUniform2fv, [](auto location, auto n, auto value) { return uniform(location, value, sizeof(*value) * 2 * n); });
+	GL_HOOK(glUniform3fv, [](auto location, auto n, auto value) { return uniform(location, value, sizeof(*value) * 3 * n); });
+	GL_HOOK(glUniform4fv, [](auto location, auto n, auto value) { return uniform(location, value, sizeof(*value) * 4 * n); });
+	GL_HOOK(glUniformMatrix2fv, [](auto location, auto n, auto, auto value) { return uniform(location, value, sizeof(*value) * 4 * n); });
+	GL_HOOK(glUniformMatrix3fv, [](auto location, auto n, auto, auto value) { return uniform(location, value, sizeof(*value) * 9 * n); });
+	GL_HOOK(glUniformMatrix4fv, [](auto location, auto n, auto, auto value) { return uniform(location, value, sizeof(*value) * 16 * n); });
+
+	// Uploads.
+	GL_HOOK(glBufferData, [](auto...) { return Effect{ GlCallKind::BufferUpload }; });
+	GL_HOOK(glBufferSubData, [](auto...) { return Effect{ GlCallKind::BufferUpload }; });
+	GL_HOOK(glTexImage2D, [](auto...) { return Effect{ GlCallKind::TextureUpload }; });
+	GL_HOOK(glTexSubImage2D, [](auto...) { return Effect{ GlCallKind::TextureUpload }; });
+
+	// Objects. Names are only made up when mocked; deleting an object unbinds it.
+	GL_HOOK(glGenBuffers, OTHER, GENERATE);
+	GL_HOOK(glGenTextures, OTHER, GENERATE);
+	GL_HOOK(glGenVertexArrays, OTHER, GENERATE);
+	GL_HOOK(glGenFramebuffers, OTHER, GENERATE);
+	GL_HOOK(glGenRenderbuffers, OTHER, GENERATE);
+	GL_HOOK(glGenQueries, OTHER, GENERATE);
+	GL_HOOK(glCreateShader, OTHER, CREATE);
+	GL_HOOK(glCreateProgram, OTHER, CREATE);
+	GL_HOOK(glDeleteBuffers, [](auto n, auto names) {
+		ShadowState& s{ tracker().state };
+		for (decltype(n) i{ 0 }; i < n; ++i) {
+			unbind(s.buffers, names[i]);
+			unbind(s.elementBuffers, names[i]);
+			unbind(s.indexedBuffers, names[i]);
+		}
+		return Effect{};
+	});
+	GL_HOOK(glDeleteTextures, [](auto n, auto names) {
+		for (decltype(n) i{ 0 }; i < n; ++i) {
+			unbind(tracker().state.textures, names[i]);
+		}
+		return Effect{};
+	});
+	GL_HOOK(glDeleteVertexArrays, [](auto n, auto names) {
+		ShadowState& s{ tracker().state };
+		for (decltype(n) i{ 0 }; i < n; ++i) {
+			s.elementBuffers.erase(names[i]);
+			if (s.vertexArray == names[i]) {
+				s.vertexArray = 0;
+			}
+		}
+		return Effect{};
+	});
+	GL_HOOK(glDeleteFramebuffers, [](auto n, auto names) {
+		ShadowState& s{ tracker().state };
+		for (decltype(n) i{ 0 }; i < n; ++i) {
+			for (uint32_t* bound : { &s.drawFramebuffer, &s.readFramebuffer }) {
+				if (*bound == names[i]) {
+					*bound = 0;
+				}
+			}
+		}
+		return Effect{};
+	});
+	GL_HOOK(glDeleteRenderbuffers, [](auto n, auto names) {
+		ShadowState& s{ tracker().state };
+		for (decltype(n) i{ 0 }; i < n; ++i) {
+			if (s.renderbuffer == names[i]) {
+				s.renderbuffer = 0;
+			}
+		}
+		return Effect{};
+	});
+	GL_HOOK(glDeleteQueries, OTHER);
+	GL_HOOK(glDeleteShader, OTHER);
+
+	// Programs. Linking forgets the values of the program's uniforms; mocked, it gives a location
+	// to each uniform the program's shaders declare.
+	GL_HOOK(glShaderSource, OTHER, [](auto shader, auto n, auto* strings, auto* lengths) {
+		std::string& source{ tracker().shaderSources[shader] };
+		source.clear();
+		for (decltype(n) i{ 0 }; i < n; ++i) {
+			if (lengths && lengths[i] >= 0) {
+				source.append(strings[i], lengths[i]);
+			}
+			else {
+				source += strings[i];
+			}
+		}
+	});
+	GL_HOOK(glCompileShader, OTHER);
+	GL_HOOK(glAttachShader, OTHER, [](auto program, auto shader) { tracker().attachedShaders[program].push_back(shader); });
+	GL_HOOK(glTransformFeedbackVaryings, OTHER);
+	GL_HOOK(glLinkProgram, [](auto program) {
+		std::erase_if(tracker().state.uniforms, [program](auto& entry) { return (entry.first >> 32) == program; });
+		return Effect{};
+	}, [](auto program) {
+		Tracker& t{ tracker() };
+		std::unordered_map<std::string, uint32_t> uniforms{};
+		for (auto shader : t.attachedShaders[program]) {
+			declaredUniforms(t.shaderSources[shader], uniforms);
+		}
+		for (auto& [name, size] : uniforms) {
+			t.uniformLocations[std::to_string(program) + ":" + name] = MockUniform{ static_cast<int32_t>(t.nextName + 1), size };
+			t.nextName += size;
+		}
+	});
+	GL_HOOK(glGetShaderiv, OTHER, [](auto, auto pname, auto* params) { *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0; });
+	GL_HOOK(glGetProgramiv, OTHER, [](auto, auto pname, auto* params) { *params = pname == GL_LINK_STATUS ? GL_TRUE : 0; });
+	GL_HOOK(glGetShaderInfoLog, OTHER, [](auto, auto size, auto* length, auto* log) {
+		if (length) {
+			*length = 0;
+		}
+		if (size > 0) {
+			log[0] = 0;
+		}
+	});
+	GL_HOOK(glGetProgramInfoLog, OTHER, [](auto, auto size, auto* length, auto* log) {
+		if (length) {
+			*length = 0;
+		}
+		if (size > 0) {
+			log[0] = 0;
+		}
+	});
+	// An array's elements are name[i], and name is name[0]; names the program doesn't have are -1.
+	GL_HOOK(glGetUniformLocation, OTHER, [](auto program, auto* uniformName) {
+		std::string name{ uniformName };
+		uint32_t element{ 0 };
+		size_t bracket{ name.find('[') };
+		if (bracket != std::string::npos) {
+			element = static_cast<uint32_t>(std::strtoul(name.c_str() + bracket + 1, nullptr, 10));
+			name.resize(bracket);
+		}
+		auto& locations{ tracker().uniformLocations };
+		auto found{ locations.find(std::to_string(program) + ":" + name) };
+		if (found == locations.end() || element >= found->second.size) {
+			return static_cast<GLint>(-1);
+		}
+		return static_cast<GLint>(found->second.location + element);
+	});
+
+	// Framebuffers, queries and the rest.
+	GL_HOOK(glFramebufferTexture2D, OTHER);
+	GL_HOOK(glFramebufferRenderbuffer, OTHER);
+	GL_HOOK(glRenderbufferStorage, OTHER);
+	GL_HOOK(glCheckFramebufferStatus, OTHER, [](auto) { return static_cast<GLenum>(GL_FRAMEBUFFER_COMPLETE); });
+	GL_HOOK(glClear, OTHER);
+	GL_HOOK(glBlitFramebuffer, OTHER);
+	GL_HOOK(glReadPixels, OTHER);
+	GL_HOOK(glGenerateMipmap, OTHER);
+	GL_HOOK(glBeginQuery, OTHER);
+	GL_HOOK(glEndQuery, OTHER);
+	GL_HOOK(glGetQueryObjectiv, OTHER, [](auto, auto, auto* params) { *params = 1; });
+	GL_HOOK(glGetQueryObjectui64v, OTHER, [](auto, auto, auto* params) { *params = 0; });
+	GL_HOOK(glBeginTransformFeedback, OTHER);
+	GL_HOOK(glEndTransformFeedback, OTHER);
+	GL_HOOK(glGetBufferSubData, OTHER, [](auto, auto, auto size, auto* data) { std::memset(data, 0, size); });
+	GL_HOOK(glGetTexImage, OTHER);
+	GL_HOOK(glGetTexLevelParameteriv, OTHER, [](auto, auto, auto, auto* params) { *params = 0; });
+	GL_HOOK(glGetString, OTHER, [](auto) { return reinterpret_cast<const GLubyte*>("GlIntercept mock"); });
+	GL_HOOK(glGetIntegerv, OTHER, [](auto pname, auto* data) {
+		const ShadowState& s{ tracker().state };
+		if (pname == GL_VIEWPORT) {
+			std::copy_n(s.viewport.value_or(std::array<int32_t, 4>{}).begin(), 4, data);
+		}
+		else {
+			*data = pname == GL_FRAMEBUFFER_BINDING ? static_cast<GLint>(s.drawFramebuffer) : pname == GL_MAX_TEXTURE_SIZE ? 16384 : 0;
+		}
+	});
+	GL_HOOK(glGetFloatv, OTHER, [](auto pname, auto* data) {
+		if (pname == GL_COLOR_CLEAR_VALUE) {
+			std::copy_n(tracker().state.clearColor.begin(), 4, data);
+		}
+		else {
+			*data = 0;
+		}
+	});
+}
+
+#undef GL_HOOK
+
+GlIntercept::Mode GlIntercept::mode() {
+	return tracker().mode;
+}
+
+uint32_t GlIntercept::addPass(const std::string& name) {
+	tracker().passes.push_back(PassCounts{ name });
+	return static_cast<uint32_t>(tracker().passes.size() - 1);
+}
+
+void GlIntercept::beginPass(uint32_t pass) {
+	tracker().pass = pass;
+}
+
+void GlIntercept::endPass() {
+	tracker().pass = 0;
+}
+
+void GlIntercept::endFrame() {
+	for (auto& pass : tracker().passes) {
+		const RenderStats& f{ pass.frame };
+		RenderStats& p{ pass.peakFrame };
+		p = RenderStats{ std::max(p.draws, f.draws), std::max(p.triangles, f.triangles), std::max(p.stateChanges, f.stateChanges),
+			std::max(p.uniformUploads, f.uniformUploads), std::max(p.bufferUploads, f.bufferUploads),
+			std::max(p.textureUploads, f.textureUploads), std::max(p.redundantCalls, f.redundantCalls) };
+		pass.lastFrame = f;
+		pass.frame = RenderStats{};
+	}
+	++tracker().frames;
+}
+
+uint32_t GlIntercept::passCount() {
+	return static_cast<uint32_t>(tracker().passes.size());
+}
+
+const std::string& GlIntercept::passName(uint32_t pass) {
+	return tracker().passes[pass].name;
+}
+
+const RenderStats& GlIntercept::lastFrame(uint32_t pass) {
+	return tracker().passes[pass].lastFrame;
+}
+
+const RenderStats& GlIntercept::peakFrame(uint32_t pass) {
+	return tracker().passes[pass].peakFrame;
+}
+
+const RenderStats& GlIntercept::totals() {
+	return tracker().totals;
+}
+
+const std::vector<GlCommand>& GlIntercept::commands() {
+	return tracker().commands;
+}
+
+void GlIntercept::clearCommands() {
+	tracker().commands.clear();
+}
+
+void GlIntercept::report(std::ostream& out) {
+	const Tracker& t{ tracker() };
+	double frames{ static_cast<double>(std::max<uint64_t>(t.frames, 1)) };
+	out << "OpenGL calls per frame, average / most (" << t.frames << " frames):" << std::endl;
+	for (auto& pass : t.passes) {
+		const RenderStats& total{ pass.total };
+		const RenderStats& peak{ pass.peakFrame };
+		out << "  " << pass.name << ": "
+			<< total.draws / frames << " / " << peak.draws << " draws, "
+			<< total.triangles / frames << " / " << peak.triangles << " triangles, "
+			<< total.stateChanges / frames << " / " << peak.stateChanges << " state changes, "
+			<< total.uniformUploads / frames << " / " << peak.uniformUploads << " uniform uploads, "
+			<< total.bufferUploads / frames << " / " << peak.bufferUploads << " buffer uploads, "
+			<< total.textureUploads / frames << " / " << peak.textureUploads << " texture uploads, "
+			<< total.redundantCalls / frames << " / " << peak.redundantCalls << " redundant" << std::endl;
+	}
+}
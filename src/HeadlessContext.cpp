@@ -0,0 +1,104 @@
+#include "HeadlessContext.h"
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	// A surfaceless display needs no display server; failing that, whatever the default one is.
+	EGLDisplay surfacelessDisplay() {
+		auto getPlatformDisplay{ reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT")) };
+		if (getPlatformDisplay) {
+			EGLDisplay display{ getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr) };
+			if (display != EGL_NO_DISPLAY) {
+				return display;
+			}
+		}
+		return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+}
+
+HeadlessContext::HeadlessContext(uint32_t width, uint32_t height) : m_width{ width }, m_height{ height } {
+	EGLDisplay display{ surfacelessDisplay() };
+	EGLint major{ 0 };
+	EGLint minor{ 0 };
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+		throw std::runtime_error("No EGL display for a headless context");
+	}
+	m_display = display;
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		throw std::runtime_error("EGL display has no desktop OpenGL");
+	}
+
+	// Nothing is drawn to an EGL surface, so the config only has to render OpenGL.
+	const EGLint configAttributes[]{ EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config{ nullptr };
+	EGLint configCount{ 0 };
+	eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+	const EGLint contextAttributes[]{
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	EGLContext context{ eglCreateContext(display, configCount > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes) };
+	if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+		throw std::runtime_error("Could not create a surfaceless OpenGL 3.3 context (EGL error " + std::to_string(eglGetError()) + ")");
+	}
+	m_context = context;
+	if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress))) {
+		throw std::runtime_error("Could not load OpenGL in the headless context");
+	}
+
+	// The stand-in for the window's framebuffer, with the same 24-bit depth and 8-bit stencil.
+	glGenFramebuffers(1, &m_fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+	glGenRenderbuffers(1, &m_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		throw std::runtime_error("Headless framebuffer is incomplete");
+	}
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+}
+
+HeadlessContext::~HeadlessContext() {
+	if (m_context) {
+		glDeleteFramebuffers(1, &m_fbo);
+		glDeleteRenderbuffers(1, &m_colorBuffer);
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(m_display, m_context);
+	}
+	if (m_display) {
+		eglTerminate(m_display);
+	}
+}
+
+void HeadlessContext::saveFrame(const std::filesystem::path& path) const {
+	std::vector<uint8_t> pixels(static_cast<size_t>(m_width) * m_height * 3);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, m_width, m_height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+	std::ofstream out{ path, std::ios::binary };
+	if (!out) {
+		throw std::runtime_error("Could not write " + path.string());
+	}
+	out << "P6\n" << m_width << " " << m_height << "\n255\n";
+	// OpenGL's rows start at the bottom.
+	size_t rowBytes{ static_cast<size_t>(m_width) * 3 };
+	for (uint32_t y{ m_height }; y-- > 0;) {
+		out.write(reinterpret_cast<const char*>(pixels.data() + y * rowBytes), rowBytes);
+	}
+}
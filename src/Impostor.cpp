@@ -0,0 +1,227 @@
+#include "Impostor.h"
+#include "GBuffer.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+	// Octahedral mapping of directions about the y axis: the upper hemisphere maps to the
+	// diamond |x| + |z| <= 1, and the lower hemisphere is folded over its corners.
+	glm::vec2 octFold(const glm::vec2& v) {
+		return (glm::vec2{ 1.0f } - glm::abs(glm::vec2{ v.y, v.x }))
+			* glm::vec2{ v.x >= 0 ? 1.0f : -1.0f, v.y >= 0 ? 1.0f : -1.0f };
+	}
+
+	glm::vec2 octEncode(glm::vec3 d) {
+		d /= std::abs(d.x) + std::abs(d.y) + std::abs(d.z);
+		glm::vec2 v{ d.x, d.z };
+		return d.y >= 0 ? v : octFold(v);
+	}
+
+	glm::vec3 octDecode(const glm::vec2& v) {
+		float y{ 1 - std::abs(v.x) - std::abs(v.y) };
+		glm::vec2 xz{ y >= 0 ? v : octFold(v) };
+		return glm::normalize(glm::vec3{ xz.x, y, xz.y });
+	}
+
+	/**
+	 * @brief The image axes of a view looking back along direction d, as glm::lookAt builds them.
+	 * Baking and drawing must agree on these, so that a view's image lines up with its quad.
+	 */
+	void viewBasis(const glm::vec3& d, glm::vec3& right, glm::vec3& up) {
+		glm::vec3 hint{ std::abs(d.y) > 0.99f ? glm::vec3{ 0, 0, -1 } : glm::vec3{ 0, 1, 0 } };
+		right = glm::normalize(glm::cross(-d, hint));
+		up = glm::cross(right, -d);
+	}
+
+	uint32_t createAtlas(uint32_t size, GLint internalFormat, GLenum format, GLenum type) {
+		uint32_t id;
+		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D, id);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, size, size, 0, format, type, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return id;
+	}
+}
+
+Impostor::Impostor() :
+	m_albedo{ 0 }, m_normal{ 0 }, m_emptyVao{ 0 }, m_gridSize{ 1 },
+	m_center{ 0 }, m_radius{ 0 }, m_inverseBakeModel{ 1 } {
+}
+
+Impostor::~Impostor() {
+	if (m_albedo != 0) {
+		uint32_t textures[]{ m_albedo, m_normal };
+		glDeleteTextures(2, textures);
+		glDeleteVertexArrays(1, &m_emptyVao);
+	}
+}
+
+Impostor::Impostor(Impostor&& other) noexcept :
+	m_albedo{ std::exchange(other.m_albedo, 0) },
+	m_normal{ std::exchange(other.m_normal, 0) },
+	m_emptyVao{ std::exchange(other.m_emptyVao, 0) },
+	m_gridSize{ other.m_gridSize },
+	m_center{ other.m_center },
+	m_radius{ other.m_radius },
+	m_inverseBakeModel{ other.m_inverseBakeModel } {
+}
+
+Impostor& Impostor::operator=(Impostor&& other) noexcept {
+	std::swap(m_albedo, other.m_albedo);
+	std::swap(m_normal, other.m_normal);
+	std::swap(m_emptyVao, other.m_emptyVao);
+	m_gridSize = other.m_gridSize;
+	m_center = other.m_center;
+	m_radius = other.m_radius;
+	m_inverseBakeModel = other.m_inverseBakeModel;
+	return *this;
+}
+
+glm::mat4 Impostor::placement(const Object3D& object) const {
+	return object.getModelMatrix() * m_inverseBakeModel;
+}
+
+Impostor Impostor::bake(const Object3D& object, ShaderProgram& gbufferProgram, const ImpostorSettings& settings) {
+	Impostor impostor{};
+
+	// Bake in the object's own frame, so that it can move and turn afterwards.
+	Object3D frame{ object };
+	frame.setPosition(glm::vec3{ 0 });
+	frame.setOrientation(glm::vec3{ 0 });
+	impostor.m_inverseBakeModel = glm::inverse(frame.getModelMatrix());
+
+	glm::vec3 boundsMin{ std::numeric_limits<float>::max() };
+	glm::vec3 boundsMax{ std::numeric_limits<float>::lowest() };
+	frame.expandBounds(glm::mat4{ 1 }, boundsMin, boundsMax);
+	if (boundsMin.x > boundsMax.x) {
+		throw std::runtime_error("Cannot bake an impostor of an object with no meshes");
+	}
+	impostor.m_center = (boundsMin + boundsMax) * 0.5f;
+	impostor.m_radius = std::max(glm::length(boundsMax - boundsMin) * 0.5f, 1e-3f);
+	impostor.m_gridSize = std::max(settings.gridSize, 1u);
+	uint32_t resolution{ std::max(settings.viewResolution, 1u) };
+	uint32_t size{ impostor.m_gridSize * resolution };
+
+	impostor.m_albedo = createAtlas(size, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+	impostor.m_normal = createAtlas(size, GL_RG16F, GL_RG, GL_FLOAT);
+	glGenVertexArrays(1, &impostor.m_emptyVao);
+
+	GLint previousFbo;
+	GLint previousViewport[4];
+	GLfloat previousClear[4];
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFbo);
+	glGetIntegerv(GL_VIEWPORT, previousViewport);
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, previousClear);
+
+	uint32_t fbo;
+	uint32_t depth;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glGenRenderbuffers(1, &depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, impostor.m_albedo, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, impostor.m_normal, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+	GLenum drawBuffers[]{ GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+	bool complete{ glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE };
+
+	if (complete) {
+		// Empty texels have zero alpha, which the impostor shader discards.
+		glViewport(0, 0, size, size);
+		glClearColor(0, 0, 0, 0);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// Each view is an orthographic projection of the bounding sphere, from outside it.
+		float r{ impostor.m_radius };
+		float distance{ 2 * r };
+		glm::mat4 projection{ glm::ortho(-r, r, -r, r, distance - 1.5f * r, distance + 1.5f * r) };
+		gbufferProgram.activate();
+		gbufferProgram.setUniform("projection", projection);
+		gbufferProgram.setUniform("shininessScale", GBuffer::SHININESS_SCALE);
+		for (uint32_t y{ 0 }; y < impostor.m_gridSize; ++y) {
+			for (uint32_t x{ 0 }; x < impostor.m_gridSize; ++x) {
+				glm::vec2 oct{ (glm::vec2{ static_cast<float>(x), static_cast<float>(y) } + 0.5f)
+					/ static_cast<float>(impostor.m_gridSize) * 2.0f - 1.0f };
+				glm::vec3 d{ octDecode(oct) };
+				glm::vec3 right;
+				glm::vec3 up;
+				viewBasis(d, right, up);
+				glViewport(x * resolution, y * resolution, resolution, resolution);
+				gbufferProgram.setUniform("view", glm::lookAt(impostor.m_center + d * distance, impostor.m_center, up));
+				frame.render(gbufferProgram);
+			}
+		}
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+	glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+	glClearColor(previousClear[0], previousClear[1], previousClear[2], previousClear[3]);
+	glDeleteRenderbuffers(1, &depth);
+	glDeleteFramebuffers(1, &fbo);
+	if (!complete) {
+		throw std::runtime_error("Impostor atlas framebuffer is incomplete");
+	}
+	return impostor;
+}
+
+void Impostor::assignSamplers(ShaderProgram& program) {
+	program.setUniform("impostorAlbedo", ALBEDO_UNIT);
+	program.setUniform("impostorNormal", NORMAL_UNIT);
+}
+
+float Impostor::screenSize(const Object3D& object, const glm::mat4& view, const glm::mat4& projection, float viewportHeight) const {
+	glm::vec4 center{ view * placement(object) * glm::vec4{ m_center, 1 } };
+	float depth{ -center.z };
+	if (depth <= m_radius) {
+		return std::numeric_limits<float>::infinity();
+	}
+	return m_radius * projection[1][1] * viewportHeight / depth;
+}
+
+void Impostor::render(ShaderProgram& program, const Object3D& object, const glm::vec3& viewPos) const {
+	glm::mat4 toWorld{ placement(object) };
+	glm::mat3 rotation{ toWorld };
+
+	// The camera's direction in the baked frame picks the views to blend, and orients the quad
+	// the same way those views were captured.
+	glm::vec3 viewLocal{ glm::inverse(toWorld) * glm::vec4{ viewPos, 1 } };
+	glm::vec3 d{ viewLocal - m_center };
+	d = glm::length(d) > 0 ? glm::normalize(d) : glm::vec3{ 0, 0, 1 };
+	float last{ static_cast<float>(m_gridSize - 1) };
+	glm::vec2 grid{ (octEncode(d) * 0.5f + 0.5f) * static_cast<float>(m_gridSize) - 0.5f };
+	glm::vec2 first{ glm::clamp(glm::floor(grid), glm::vec2{ 0 }, glm::vec2{ last }) };
+	glm::vec2 second{ glm::min(first + 1.0f, glm::vec2{ last }) };
+	glm::vec2 blend{ glm::clamp(grid - first, glm::vec2{ 0 }, glm::vec2{ 1 }) };
+
+	glm::vec3 right;
+	glm::vec3 up;
+	viewBasis(d, right, up);
+	program.setUniform("quadCenter", glm::vec3{ toWorld * glm::vec4{ m_center, 1 } });
+	program.setUniform("quadRight", rotation * right * m_radius);
+	program.setUniform("quadUp", rotation * up * m_radius);
+	program.setUniform("normalToWorld", rotation);
+	program.setUniform("viewCells", glm::vec4{ first, second });
+	program.setUniform("viewBlend", blend);
+	program.setUniform("gridSize", static_cast<float>(m_gridSize));
+	program.setUniform("material", object.getMaterial());
+
+	glActiveTexture(GL_TEXTURE0 + ALBEDO_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_albedo);
+	glActiveTexture(GL_TEXTURE0 + NORMAL_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_normal);
+	glActiveTexture(GL_TEXTURE0);
+
+	glBindVertexArray(m_emptyVao);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	glBindVertexArray(0);
+}
@@ -0,0 +1,90 @@
+#include "InputRecording.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+	constexpr char MAGIC[4]{ 'I', 'N', 'P', 'T' };
+	constexpr uint32_t FORMAT_VERSION{ 1 };
+
+	// An event as stored: its time, the key, and whether it went down.
+	struct StoredEvent {
+		float time;
+		uint8_t key;
+		uint8_t pressed;
+		uint8_t padding[2];
+	};
+	static_assert(sizeof(StoredEvent) == 8);
+}
+
+void InputState::apply(const InputEvent& event) {
+	m_held[static_cast<size_t>(event.key)] = event.pressed;
+	if (event.pressed) {
+		m_pressed.push_back(event.key);
+	}
+}
+
+void InputState::releaseAll(float time, std::vector<InputEvent>& released) {
+	for (size_t k{ 0 }; k < m_held.size(); ++k) {
+		if (m_held[k]) {
+			InputEvent event{ time, static_cast<InputKey>(k), false };
+			apply(event);
+			released.push_back(event);
+		}
+	}
+}
+
+size_t InputRecording::replay(size_t from, float until, InputState& state) const {
+	while (from < m_events.size() && m_events[from].time <= until) {
+		state.apply(m_events[from]);
+		++from;
+	}
+	return from;
+}
+
+void InputRecording::save(const std::filesystem::path& path) const {
+	std::ofstream out{ path, std::ios::binary };
+	if (!out) {
+		throw std::runtime_error("Could not write " + path.string());
+	}
+	uint32_t count{ static_cast<uint32_t>(m_events.size()) };
+	out.write(MAGIC, sizeof(MAGIC));
+	out.write(reinterpret_cast<const char*>(&FORMAT_VERSION), sizeof(FORMAT_VERSION));
+	out.write(reinterpret_cast<const char*>(&m_seed), sizeof(m_seed));
+	out.write(reinterpret_cast<const char*>(&m_duration), sizeof(m_duration));
+	out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	for (auto& event : m_events) {
+		StoredEvent stored{ event.time, static_cast<uint8_t>(event.key), static_cast<uint8_t>(event.pressed), {} };
+		out.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+	}
+}
+
+InputRecording InputRecording::load(const std::filesystem::path& path) {
+	std::ifstream in{ path, std::ios::binary };
+	char magic[4]{};
+	uint32_t version{ 0 };
+	uint64_t seed{ 0 };
+	float duration{ 0 };
+	uint32_t count{ 0 };
+	in.read(magic, sizeof(magic));
+	in.read(reinterpret_cast<char*>(&version), sizeof(version));
+	in.read(reinterpret_cast<char*>(&seed), sizeof(seed));
+	in.read(reinterpret_cast<char*>(&duration), sizeof(duration));
+	in.read(reinterpret_cast<char*>(&count), sizeof(count));
+	if (!in || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != FORMAT_VERSION) {
+		throw std::runtime_error("Unrecognized input recording: " + path.string());
+	}
+
+	InputRecording recording{ seed };
+	recording.m_duration = duration;
+	recording.m_events.reserve(count);
+	for (uint32_t e{ 0 }; e < count; ++e) {
+		StoredEvent stored{};
+		in.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+		if (!in || stored.key >= static_cast<uint8_t>(InputKey::Count)) {
+			throw std::runtime_error("Truncated or corrupt input recording: " + path.string());
+		}
+		recording.m_events.push_back(InputEvent{ stored.time, static_cast<InputKey>(stored.key), stored.pressed != 0 });
+	}
+	return recording;
+}
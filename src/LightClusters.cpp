@@ -0,0 +1,219 @@
+#include "LightClusters.h"
+#include "Simd.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+LightClusters::LightClusters() :
+	m_projection{ 0 },
+	m_near{ 0 },
+	m_far{ 0 },
+	m_lightCount{ 0 },
+	m_dirty{ false },
+	m_lightBuffer{ 0 }, m_lightTexture{ 0 },
+	m_clusterBuffer{ 0 }, m_clusterTexture{ 0 },
+	m_indexBuffer{ 0 }, m_indexTexture{ 0 } {
+	m_clusterRanges.resize(CLUSTER_COUNT * 2);
+}
+
+void LightClusters::assignSamplers(ShaderProgram& program) {
+	program.setUniform("lightData", LIGHT_DATA_UNIT);
+	program.setUniform("clusterData", CLUSTER_DATA_UNIT);
+	program.setUniform("lightIndices", LIGHT_INDEX_UNIT);
+}
+
+void LightClusters::buildClusterBounds(const glm::mat4& projection, float zNear, float zFar) {
+	m_projection = projection;
+	m_near = zNear;
+	m_far = zFar;
+	for (auto* v : { &m_minX, &m_minY, &m_minZ, &m_maxX, &m_maxY, &m_maxZ }) {
+		v->resize(CLUSTER_COUNT);
+	}
+
+	// For a symmetric perspective projection, a point at view depth d with normalized device
+	// coordinate x has view-space x = ndcX * d / P[0][0], and likewise for y.
+	float invScaleX{ 1.0f / projection[0][0] };
+	float invScaleY{ 1.0f / projection[1][1] };
+	for (uint32_t k{ 0 }; k < SLICES; ++k) {
+		float dNear{ zNear * std::pow(zFar / zNear, static_cast<float>(k) / SLICES) };
+		float dFar{ zNear * std::pow(zFar / zNear, static_cast<float>(k + 1) / SLICES) };
+		for (uint32_t j{ 0 }; j < TILES_Y; ++j) {
+			float ndcY0{ -1.0f + 2.0f * j / TILES_Y };
+			float ndcY1{ -1.0f + 2.0f * (j + 1) / TILES_Y };
+			for (uint32_t i{ 0 }; i < TILES_X; ++i) {
+				float ndcX0{ -1.0f + 2.0f * i / TILES_X };
+				float ndcX1{ -1.0f + 2.0f * (i + 1) / TILES_X };
+				uint32_t c{ (k * TILES_Y + j) * TILES_X + i };
+
+				// The cluster is a frustum segment; bound its eight corners.
+				float xs[4]{ ndcX0 * dNear, ndcX1 * dNear, ndcX0 * dFar, ndcX1 * dFar };
+				float ys[4]{ ndcY0 * dNear, ndcY1 * dNear, ndcY0 * dFar, ndcY1 * dFar };
+				m_minX[c] = *std::min_element(xs, xs + 4) * invScaleX;
+				m_maxX[c] = *std::max_element(xs, xs + 4) * invScaleX;
+				m_minY[c] = *std::min_element(ys, ys + 4) * invScaleY;
+				m_maxY[c] = *std::max_element(ys, ys + 4) * invScaleY;
+				// The camera looks down -z in view space.
+				m_minZ[c] = -dFar;
+				m_maxZ[c] = -dNear;
+			}
+		}
+	}
+}
+
+void LightClusters::binLight(const glm::vec3& p, float radius, uint16_t lightIndex) {
+	float depth{ -p.z };
+	if (depth + radius < m_near || depth - radius > m_far) {
+		return;
+	}
+
+	// Only the depth slices the sphere spans need testing.
+	float logRatio{ std::log(m_far / m_near) };
+	auto sliceOf = [&](float d) {
+		float s{ std::floor(std::log(d / m_near) / logRatio * SLICES) };
+		return static_cast<uint32_t>(std::clamp(s, 0.0f, static_cast<float>(SLICES - 1)));
+	};
+	uint32_t firstSlice{ sliceOf(std::max(depth - radius, m_near)) };
+	uint32_t lastSlice{ sliceOf(std::min(depth + radius, m_far)) };
+
+	constexpr uint32_t perSlice{ TILES_X * TILES_Y };
+	static_assert(perSlice % 4 == 0, "clusters are tested four at a time");
+	float r2{ radius * radius };
+
+	for (uint32_t k{ firstSlice }; k <= lastSlice; ++k) {
+		uint32_t begin{ k * perSlice };
+		uint32_t end{ begin + perSlice };
+#ifdef SIMD_SSE
+		// Squared distance from the sphere center to each AABB, four clusters per iteration.
+		const __m128 zero{ _mm_setzero_ps() };
+		const __m128 cx{ _mm_set1_ps(p.x) }, cy{ _mm_set1_ps(p.y) }, cz{ _mm_set1_ps(p.z) };
+		const __m128 radius2{ _mm_set1_ps(r2) };
+		for (uint32_t c{ begin }; c < end; c += 4) {
+			__m128 dx{ _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_minX[c]), cx), zero),
+				_mm_max_ps(_mm_sub_ps(cx, _mm_loadu_ps(&m_maxX[c])), zero)) };
+			__m128 dy{ _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_minY[c]), cy), zero),
+				_mm_max_ps(_mm_sub_ps(cy, _mm_loadu_ps(&m_maxY[c])), zero)) };
+			__m128 dz{ _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_minZ[c]), cz), zero),
+				_mm_max_ps(_mm_sub_ps(cz, _mm_loadu_ps(&m_maxZ[c])), zero)) };
+			__m128 d2{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)) };
+			int mask{ _mm_movemask_ps(_mm_cmple_ps(d2, radius2)) };
+			for (uint32_t lane{ 0 }; mask != 0; ++lane, mask >>= 1) {
+				if (mask & 1) {
+					m_pairs.emplace_back(c + lane, lightIndex);
+				}
+			}
+		}
+#else
+		for (uint32_t c{ begin }; c < end; ++c) {
+			float dx{ std::max(m_minX[c] - p.x, 0.0f) + std::max(p.x - m_maxX[c], 0.0f) };
+			float dy{ std::max(m_minY[c] - p.y, 0.0f) + std::max(p.y - m_maxY[c], 0.0f) };
+			float dz{ std::max(m_minZ[c] - p.z, 0.0f) + std::max(p.z - m_maxZ[c], 0.0f) };
+			if (dx * dx + dy * dy + dz * dz <= r2) {
+				m_pairs.emplace_back(c, lightIndex);
+			}
+		}
+#endif
+	}
+}
+
+void LightClusters::update(const std::vector<PointLight>& lights, const glm::mat4& view, const glm::mat4& projection,
+	float zNear, float zFar, const glm::vec3& cameraPos, uint32_t maxLights) {
+	if (projection != m_projection || zNear != m_near || zFar != m_far) {
+		buildClusterBounds(projection, zNear, zFar);
+	}
+
+	// Keep only the lights nearest the camera when there are more than the budget allows.
+	std::vector<uint32_t> order(lights.size());
+	std::iota(order.begin(), order.end(), 0);
+	size_t keep{ std::min<size_t>({ lights.size(), maxLights, UINT16_MAX }) };
+	if (keep < lights.size()) {
+		std::partial_sort(order.begin(), order.begin() + keep, order.end(), [&](uint32_t a, uint32_t b) {
+			return glm::length(lights[a].position - cameraPos) - lights[a].radius
+				< glm::length(lights[b].position - cameraPos) - lights[b].radius;
+		});
+		order.resize(keep);
+	}
+
+	m_dirty = true;
+	m_lightData.clear();
+	m_pairs.clear();
+	m_lightCount = static_cast<uint32_t>(order.size());
+	for (uint32_t i{ 0 }; i < order.size(); ++i) {
+		const PointLight& light{ lights[order[i]] };
+		m_lightData.emplace_back(light.position, light.radius);
+		m_lightData.emplace_back(light.color, light.cosOuter);
+		m_lightData.emplace_back(glm::normalize(light.direction), light.cosInner);
+		m_lightData.emplace_back(static_cast<float>(light.shadowTile), light.baked ? 1.0f : 0.0f, 0, 0);
+		binLight(glm::vec3{ view * glm::vec4{ light.position, 1 } }, light.radius, static_cast<uint16_t>(i));
+	}
+
+	// Counting sort of the (cluster, light) pairs into contiguous per-cluster lists.
+	std::vector<uint32_t> counts(CLUSTER_COUNT, 0);
+	for (auto& pair : m_pairs) {
+		++counts[pair.first];
+	}
+	uint32_t offset{ 0 };
+	for (uint32_t c{ 0 }; c < CLUSTER_COUNT; ++c) {
+		m_clusterRanges[2 * c] = offset;
+		m_clusterRanges[2 * c + 1] = counts[c];
+		offset += counts[c];
+		counts[c] = m_clusterRanges[2 * c];
+	}
+	m_indices.resize(m_pairs.size());
+	for (auto& pair : m_pairs) {
+		m_indices[counts[pair.first]++] = pair.second;
+	}
+}
+
+namespace {
+	/**
+	 * @brief Creates a texture buffer viewing a new buffer object, in the given texel format.
+	 */
+	void createTextureBuffer(uint32_t& buffer, uint32_t& texture, GLenum format) {
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_BUFFER, texture);
+		glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+	}
+
+	/**
+	 * @brief Replaces the contents of a buffer, orphaning the old storage so the upload does not
+	 * wait on draws still reading it.
+	 */
+	void uploadTextureBuffer(uint32_t buffer, const void* data, size_t bytes, size_t minimumBytes) {
+		glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+		glBufferData(GL_TEXTURE_BUFFER, std::max(bytes, minimumBytes), nullptr, GL_STREAM_DRAW);
+		if (bytes > 0) {
+			glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+		}
+	}
+}
+
+void LightClusters::bind(ShaderProgram& program, const glm::vec2& viewportSize) {
+	if (m_lightBuffer == 0) {
+		createTextureBuffer(m_lightBuffer, m_lightTexture, GL_RGBA32F);
+		createTextureBuffer(m_clusterBuffer, m_clusterTexture, GL_RG32UI);
+		createTextureBuffer(m_indexBuffer, m_indexTexture, GL_R16UI);
+	}
+	if (m_dirty) {
+		uploadTextureBuffer(m_lightBuffer, m_lightData.data(), m_lightData.size() * sizeof(glm::vec4), sizeof(glm::vec4));
+		uploadTextureBuffer(m_clusterBuffer, m_clusterRanges.data(), m_clusterRanges.size() * sizeof(uint32_t), 0);
+		uploadTextureBuffer(m_indexBuffer, m_indices.data(), m_indices.size() * sizeof(uint16_t), sizeof(uint16_t));
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		m_dirty = false;
+	}
+
+	glActiveTexture(GL_TEXTURE0 + LIGHT_DATA_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, m_lightTexture);
+	glActiveTexture(GL_TEXTURE0 + CLUSTER_DATA_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, m_clusterTexture);
+	glActiveTexture(GL_TEXTURE0 + LIGHT_INDEX_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, m_indexTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	program.setUniform("clusterDims", glm::vec3{ TILES_X, TILES_Y, SLICES });
+	program.setUniform("clusterTileScale", glm::vec2{ TILES_X / viewportSize.x, TILES_Y / viewportSize.y });
+	// slice = log(depth / near) * SLICES / log(far / near)
+	program.setUniform("clusterDepthParams", glm::vec2{ m_near, SLICES / std::log(m_far / m_near) });
+}
@@ -0,0 +1,121 @@
+#include "LightProbeGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+	constexpr char PROBE_MAGIC[4]{ 'L', 'P', 'R', 'B' };
+	constexpr uint32_t FORMAT_VERSION{ 1 };
+}
+
+std::array<float, ShIrradiance::COEFFICIENTS> ShIrradiance::basis(const glm::vec3& d) {
+	return {
+		0.282095f,
+		0.488603f * d.y,
+		0.488603f * d.z,
+		0.488603f * d.x,
+		1.092548f * d.x * d.y,
+		1.092548f * d.y * d.z,
+		0.315392f * (3 * d.z * d.z - 1),
+		1.092548f * d.x * d.z,
+		0.546274f * (d.x * d.x - d.y * d.y),
+	};
+}
+
+glm::vec3 ShIrradiance::evaluate(const glm::vec3& normal) const {
+	auto y{ basis(normal) };
+	glm::vec3 result{ 0 };
+	for (uint32_t i{ 0 }; i < COEFFICIENTS; ++i) {
+		result += coefficients[i] * y[i];
+	}
+	return glm::max(result, glm::vec3{ 0 });
+}
+
+LightProbeGrid::LightProbeGrid(const glm::vec3& origin, const glm::vec3& spacing, const glm::uvec3& dimensions) :
+	m_origin{ origin },
+	m_spacing{ spacing },
+	m_dimensions{ glm::max(dimensions, glm::uvec3{ 1 }) },
+	m_probes(static_cast<size_t>(m_dimensions.x) * m_dimensions.y * m_dimensions.z) {
+}
+
+glm::vec3 LightProbeGrid::probePosition(size_t index) const {
+	size_t x{ index % m_dimensions.x };
+	size_t y{ (index / m_dimensions.x) % m_dimensions.y };
+	size_t z{ index / (static_cast<size_t>(m_dimensions.x) * m_dimensions.y) };
+	return m_origin + m_spacing * glm::vec3{ static_cast<float>(x), static_cast<float>(y), static_cast<float>(z) };
+}
+
+ShIrradiance LightProbeGrid::sample(const glm::vec3& position) const {
+	// The cell containing the position, and where in it the position lies.
+	uint32_t cell[3];
+	float t[3];
+	for (int axis{ 0 }; axis < 3; ++axis) {
+		float last{ static_cast<float>(m_dimensions[axis] - 1) };
+		float local{ std::clamp((position[axis] - m_origin[axis]) / m_spacing[axis], 0.0f, last) };
+		cell[axis] = std::min(static_cast<uint32_t>(local), std::max(m_dimensions[axis], 2u) - 2);
+		t[axis] = m_dimensions[axis] > 1 ? local - cell[axis] : 0;
+	}
+
+	ShIrradiance result{};
+	for (uint32_t corner{ 0 }; corner < 8; ++corner) {
+		float weight{ 1 };
+		size_t index{ 0 };
+		size_t stride{ 1 };
+		for (int axis{ 0 }; axis < 3; ++axis) {
+			uint32_t offset{ (corner >> axis) & 1u };
+			weight *= offset ? t[axis] : 1 - t[axis];
+			index += std::min(cell[axis] + offset, m_dimensions[axis] - 1) * stride;
+			stride *= m_dimensions[axis];
+		}
+		if (weight <= 0) {
+			continue;
+		}
+		for (uint32_t i{ 0 }; i < ShIrradiance::COEFFICIENTS; ++i) {
+			result.coefficients[i] += m_probes[index].coefficients[i] * weight;
+		}
+	}
+	return result;
+}
+
+void writeLightProbes(const std::filesystem::path& path, const LightProbeGrid& grid) {
+	std::ofstream out{ path, std::ios::binary };
+	if (!out) {
+		throw std::runtime_error("Could not write " + path.string());
+	}
+	out.write(PROBE_MAGIC, sizeof(PROBE_MAGIC));
+	out.write(reinterpret_cast<const char*>(&FORMAT_VERSION), sizeof(FORMAT_VERSION));
+	out.write(reinterpret_cast<const char*>(&grid.origin()), sizeof(glm::vec3));
+	out.write(reinterpret_cast<const char*>(&grid.spacing()), sizeof(glm::vec3));
+	out.write(reinterpret_cast<const char*>(&grid.dimensions()), sizeof(glm::uvec3));
+	for (size_t i{ 0 }; i < grid.probeCount(); ++i) {
+		out.write(reinterpret_cast<const char*>(grid.probe(i).coefficients.data()), sizeof(ShIrradiance::coefficients));
+	}
+}
+
+LightProbeGrid readLightProbes(const std::filesystem::path& path) {
+	std::ifstream in{ path, std::ios::binary };
+	char magic[4]{};
+	uint32_t version{ 0 };
+	glm::vec3 origin{};
+	glm::vec3 spacing{};
+	glm::uvec3 dimensions{};
+	in.read(magic, sizeof(magic));
+	in.read(reinterpret_cast<char*>(&version), sizeof(version));
+	in.read(reinterpret_cast<char*>(&origin), sizeof(origin));
+	in.read(reinterpret_cast<char*>(&spacing), sizeof(spacing));
+	in.read(reinterpret_cast<char*>(&dimensions), sizeof(dimensions));
+	if (!in || std::memcmp(magic, PROBE_MAGIC, sizeof(magic)) != 0 || version != FORMAT_VERSION) {
+		throw std::runtime_error("Unrecognized light probe file: " + path.string());
+	}
+
+	LightProbeGrid grid{ origin, spacing, dimensions };
+	for (size_t i{ 0 }; i < grid.probeCount(); ++i) {
+		in.read(reinterpret_cast<char*>(grid.probe(i).coefficients.data()), sizeof(ShIrradiance::coefficients));
+	}
+	if (!in) {
+		throw std::runtime_error("Truncated light probe file: " + path.string());
+	}
+	return grid;
+}
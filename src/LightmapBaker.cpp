@@ -0,0 +1,222 @@
+#include "LightmapBaker.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+	constexpr uint32_t NO_CHART = UINT32_MAX;
+
+	/**
+	 * @brief One triangle laid flat: its corners in world units on the triangle's plane, shifted
+	 * so the bounding box starts at the origin, and where that box sits in the atlas.
+	 */
+	struct Chart {
+		uint32_t mesh;
+		uint32_t firstIndex;
+		glm::vec2 corners[3];
+		glm::vec2 size;
+		uint32_t x, y;
+		uint32_t width, height;
+	};
+
+	Chart flatten(const BakeMesh& mesh, uint32_t meshIndex, uint32_t firstIndex) {
+		Chart chart{ meshIndex, firstIndex };
+		const glm::vec3& a{ mesh.positions[mesh.indices[firstIndex]] };
+		glm::vec3 ab{ mesh.positions[mesh.indices[firstIndex + 1]] - a };
+		glm::vec3 ac{ mesh.positions[mesh.indices[firstIndex + 2]] - a };
+		glm::vec3 n{ glm::cross(ab, ac) };
+		float length{ glm::length(ab) };
+		if (length <= 0 || glm::length(n) <= 0) {
+			// Degenerate triangles get a single texel.
+			return chart;
+		}
+		glm::vec3 xAxis{ ab / length };
+		glm::vec3 yAxis{ glm::normalize(glm::cross(glm::normalize(n), xAxis)) };
+		glm::vec2 c{ glm::dot(ac, xAxis), glm::dot(ac, yAxis) };
+		float minX{ std::min(0.0f, c.x) };
+		chart.corners[0] = glm::vec2{ -minX, 0 };
+		chart.corners[1] = glm::vec2{ length - minX, 0 };
+		chart.corners[2] = glm::vec2{ c.x - minX, c.y };
+		chart.size = glm::vec2{ std::max(length, c.x) - minX, c.y };
+		return chart;
+	}
+
+	/**
+	 * @brief Packs charts into rows, tallest first, at the given texels per world unit. Returns
+	 * false if they overflow the atlas.
+	 */
+	bool packShelves(std::vector<Chart>& charts, const std::vector<uint32_t>& order, float scale,
+		uint32_t resolution, uint32_t padding) {
+		uint32_t x{ padding }, y{ padding }, rowHeight{ 0 };
+		for (uint32_t i : order) {
+			Chart& chart{ charts[i] };
+			// One extra texel, so that every texel center the triangle touches lies in the box.
+			chart.width = static_cast<uint32_t>(std::ceil(chart.size.x * scale)) + 1;
+			chart.height = static_cast<uint32_t>(std::ceil(chart.size.y * scale)) + 1;
+			if (x + chart.width + padding > resolution) {
+				x = padding;
+				y += rowHeight + padding;
+				rowHeight = 0;
+			}
+			if (x + chart.width + padding > resolution || y + chart.height + padding > resolution) {
+				return false;
+			}
+			chart.x = x;
+			chart.y = y;
+			x += chart.width + padding;
+			rowHeight = std::max(rowHeight, chart.height);
+		}
+		return true;
+	}
+}
+
+LightmapBaker::LightmapBaker(const BakeScene& scene, WorkerPool& pool, const LightmapSettings& settings) :
+	m_scene{ scene },
+	m_pool{ pool },
+	m_settings{ settings } {
+}
+
+Lightmap LightmapBaker::bake(size_t firstMesh, size_t meshCount) const {
+	const uint32_t resolution{ m_settings.resolution };
+	const uint32_t padding{ m_settings.padding };
+	const auto& meshes{ m_scene.meshes() };
+
+	// Unwrap: one chart per triangle.
+	std::vector<Chart> charts{};
+	float totalArea{ 0 };
+	for (size_t m{ firstMesh }; m < firstMesh + meshCount; ++m) {
+		for (uint32_t i{ 0 }; i + 2 < meshes[m].indices.size(); i += 3) {
+			charts.push_back(flatten(meshes[m], static_cast<uint32_t>(m), i));
+			totalArea += charts.back().size.x * charts.back().size.y;
+		}
+	}
+	uint64_t minimumTexels{ charts.size() * static_cast<uint64_t>(1 + padding) * (1 + padding) };
+	if (minimumTexels > static_cast<uint64_t>(resolution) * resolution || totalArea <= 0) {
+		throw std::runtime_error("Too many triangles (" + std::to_string(charts.size())
+			+ ") for a lightmap of " + std::to_string(resolution) + " texels square");
+	}
+
+	// Pack at the highest density that fits, starting from a guess that fills half the atlas.
+	std::vector<uint32_t> order(charts.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return charts[a].size.y > charts[b].size.y; });
+	float scale{ std::sqrt(0.5f * resolution * resolution / totalArea) };
+	while (!packShelves(charts, order, scale, resolution, padding)) {
+		scale *= 0.9f;
+		if (scale * scale * totalArea < 1e-6f) {
+			throw std::runtime_error("Could not pack lightmap charts");
+		}
+	}
+
+	Lightmap lightmap{ resolution, resolution };
+	lightmap.texels.resize(static_cast<size_t>(resolution) * resolution, glm::vec3{ 0 });
+	lightmap.uvs.resize(meshCount);
+	for (size_t m{ 0 }; m < meshCount; ++m) {
+		lightmap.uvs[m].resize(meshes[firstMesh + m].indices.size() / 3 * 3);
+	}
+	std::vector<uint32_t> owner(lightmap.texels.size(), NO_CHART);
+	for (uint32_t c{ 0 }; c < charts.size(); ++c) {
+		const Chart& chart{ charts[c] };
+		for (int k{ 0 }; k < 3; ++k) {
+			glm::vec2 texel{ glm::vec2{ static_cast<float>(chart.x), static_cast<float>(chart.y) } + 0.5f + chart.corners[k] * scale };
+			lightmap.uvs[chart.mesh - firstMesh][chart.firstIndex + k] = texel / static_cast<float>(resolution);
+		}
+		for (uint32_t y{ chart.y }; y < chart.y + chart.height; ++y) {
+			std::fill_n(owner.begin() + static_cast<size_t>(y) * resolution + chart.x, chart.width, c);
+		}
+	}
+
+	// Light every texel whose center lies on its chart's triangle, or within a texel of it, so
+	// bilinear filtering along the triangle's edges still reads lit texels.
+	std::vector<uint8_t> valid(lightmap.texels.size(), 0);
+	m_pool.parallelFor(resolution, 4, [&](size_t begin, size_t end) {
+		for (size_t y{ begin }; y < end; ++y) {
+			for (uint32_t x{ 0 }; x < resolution; ++x) {
+				size_t texel{ y * resolution + x };
+				if (owner[texel] == NO_CHART) {
+					continue;
+				}
+				const Chart& chart{ charts[owner[texel]] };
+				const BakeMesh& mesh{ meshes[chart.mesh] };
+				glm::vec2 q{ (static_cast<float>(x) - chart.x) / scale, (static_cast<float>(y) - chart.y) / scale };
+
+				const glm::vec2& a{ chart.corners[0] };
+				const glm::vec2& b{ chart.corners[1] };
+				const glm::vec2& c{ chart.corners[2] };
+				float area2{ (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y) };
+				glm::vec3 weights{ 1.0f / 3 };
+				if (area2 > 0) {
+					weights.x = ((b.x - q.x) * (c.y - q.y) - (c.x - q.x) * (b.y - q.y)) / area2;
+					weights.y = ((c.x - q.x) * (a.y - q.y) - (a.x - q.x) * (c.y - q.y)) / area2;
+					weights.z = 1 - weights.x - weights.y;
+					// Distance outside each edge, in texels: the weight times the height over that edge.
+					float margin{ -1.0f / scale };
+					if (weights.x * area2 / glm::length(c - b) < margin || weights.y * area2 / glm::length(a - c) < margin
+						|| weights.z * area2 / glm::length(b - a) < margin) {
+						continue;
+					}
+					weights = glm::max(weights, glm::vec3{ 0 });
+					weights /= weights.x + weights.y + weights.z;
+				}
+
+				uint32_t i0{ mesh.indices[chart.firstIndex] };
+				uint32_t i1{ mesh.indices[chart.firstIndex + 1] };
+				uint32_t i2{ mesh.indices[chart.firstIndex + 2] };
+				glm::vec3 position{ mesh.positions[i0] * weights.x + mesh.positions[i1] * weights.y + mesh.positions[i2] * weights.z };
+				glm::vec3 geometric{ glm::cross(mesh.positions[i1] - mesh.positions[i0], mesh.positions[i2] - mesh.positions[i0]) };
+				geometric = glm::length(geometric) > 0 ? glm::normalize(geometric) : glm::vec3{ 0, 1, 0 };
+				glm::vec3 normal{ geometric };
+				if (!mesh.normals.empty()) {
+					glm::vec3 interpolated{ mesh.normals[i0] * weights.x + mesh.normals[i1] * weights.y + mesh.normals[i2] * weights.z };
+					if (glm::length(interpolated) > 0) {
+						normal = glm::normalize(interpolated);
+					}
+					if (glm::dot(geometric, normal) < 0) {
+						geometric = -geometric;
+					}
+				}
+				position += geometric * BakeScene::SURFACE_OFFSET;
+
+				lightmap.texels[texel] = m_scene.directIrradiance(position, normal)
+					+ m_scene.indirectIrradiance(position, normal, m_settings.indirectSamples, static_cast<uint32_t>(texel));
+				valid[texel] = 1;
+			}
+		}
+	});
+
+	// Dilate: grow the lit texels outward over the padding, so filtering at chart borders and
+	// mipmapped distant lookups don't pull in black.
+	for (uint32_t pass{ 0 }; pass < padding + 1; ++pass) {
+		std::vector<uint8_t> grown{ valid };
+		for (uint32_t y{ 0 }; y < resolution; ++y) {
+			for (uint32_t x{ 0 }; x < resolution; ++x) {
+				size_t texel{ static_cast<size_t>(y) * resolution + x };
+				if (valid[texel]) {
+					continue;
+				}
+				glm::vec3 sum{ 0 };
+				uint32_t count{ 0 };
+				for (int dy{ -1 }; dy <= 1; ++dy) {
+					for (int dx{ -1 }; dx <= 1; ++dx) {
+						int nx{ static_cast<int>(x) + dx }, ny{ static_cast<int>(y) + dy };
+						if (nx < 0 || ny < 0 || nx >= static_cast<int>(resolution) || ny >= static_cast<int>(resolution)) {
+							continue;
+						}
+						size_t neighbour{ static_cast<size_t>(ny) * resolution + nx };
+						if (valid[neighbour]) {
+							sum += lightmap.texels[neighbour];
+							++count;
+						}
+					}
+				}
+				if (count > 0) {
+					lightmap.texels[texel] = sum / static_cast<float>(count);
+					grown[texel] = 1;
+				}
+			}
+		}
+		valid = std::move(grown);
+	}
+	return lightmap;
+}
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "BakeImport.h"
+#include "FnafLayout.h"
+#include "LightmapBaker.h"
+#include "ProbeBaker.h"
+#include "VertexBaker.h"
+#include "WorkerPool.h"
+
+/*
+ * Bakes lighting for the pizzeria's static rooms. Run from the game's output directory; each
+ * room's lightmap.hdr and lightmap.uv2 are written next to its model, where assimpLoad finds them.
+ * With --vertex-lighting, lighting is baked into each room's vertices instead, as vertexlight.bin.
+ * Each bake removes the other kind's files, so the room is drawn with the latest one.
+ * A grid of light probes over all the rooms is baked afterwards, for the objects that move.
+ *
+ * Options: --resolution <texels> (1024), --samples <indirect samples per texel or vertex> (64),
+ * --padding <texels between charts> (2), --occlusion-distance <world units> (1),
+ * --probe-spacing <world units> (1), --probe-samples <rays per probe> (256),
+ * --threads <worker threads>, --vertex-lighting, --no-probes.
+ */
+int main(int argc, char* argv[]) {
+	LightmapSettings settings{};
+	VertexBakeSettings vertexSettings{};
+	ProbeBakeSettings probeSettings{};
+	bool vertexLighting{ false };
+	bool probes{ true };
+	uint32_t workers{ WorkerPool::defaultWorkerCount() };
+	for (int i{ 1 }; i < argc; ++i) {
+		std::string arg{ argv[i] };
+		if (arg == "--vertex-lighting") {
+			vertexLighting = true;
+		}
+		else if (arg == "--no-probes") {
+			probes = false;
+		}
+		else if (i + 1 >= argc) {
+			break;
+		}
+		else if (arg == "--resolution") {
+			settings.resolution = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--samples") {
+			settings.indirectSamples = static_cast<uint32_t>(std::stoul(argv[++i]));
+			vertexSettings.samples = settings.indirectSamples;
+		}
+		else if (arg == "--occlusion-distance") {
+			vertexSettings.occlusionDistance = std::stof(argv[++i]);
+		}
+		else if (arg == "--probe-spacing") {
+			probeSettings.spacing = std::stof(argv[++i]);
+		}
+		else if (arg == "--probe-samples") {
+			probeSettings.samples = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--padding") {
+			settings.padding = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--threads") {
+			workers = std::max<uint32_t>(1, static_cast<uint32_t>(std::stoul(argv[++i]))) - 1;
+		}
+	}
+
+	using Clock = std::chrono::steady_clock;
+	auto seconds{ [](Clock::time_point since) {
+		return std::chrono::duration<float>(Clock::now() - since).count();
+	} };
+
+	try {
+		// Every room goes into one scene, so that light is blocked and bounced between rooms.
+		auto rooms{ fnafStaticRooms() };
+		std::vector<BakeMesh> meshes{};
+		std::vector<std::pair<size_t, size_t>> roomMeshes{};
+		for (auto& room : rooms) {
+			auto loaded{ loadBakeMeshes(room) };
+			roomMeshes.emplace_back(meshes.size(), loaded.size());
+			for (auto& m : loaded) {
+				meshes.push_back(std::move(m));
+			}
+		}
+
+		auto start{ Clock::now() };
+		BakeScene scene{ std::move(meshes), fnafLights(), FNAF_DIRECTIONAL_LIGHT, FNAF_DIRECTIONAL_COLOR };
+		std::cout << "built BVH over " << scene.bvh().triangleCount() << " triangles in "
+			<< seconds(start) << " s" << std::endl;
+
+		WorkerPool pool{ workers };
+		LightmapBaker baker{ scene, pool, settings };
+		VertexBaker vertexBaker{ scene, pool, vertexSettings };
+		for (size_t r{ 0 }; r < rooms.size(); ++r) {
+			auto roomStart{ Clock::now() };
+			std::filesystem::path directory{ std::filesystem::path{ rooms[r].modelPath }.parent_path() };
+			if (vertexLighting) {
+				VertexLighting lighting{ vertexBaker.bake(roomMeshes[r].first, roomMeshes[r].second) };
+				writeVertexLighting(directory / VERTEX_LIGHTING_NAME, lighting);
+				std::filesystem::remove(directory / LIGHTMAP_IMAGE_NAME);
+				std::filesystem::remove(directory / LIGHTMAP_UV_NAME);
+				size_t vertices{ 0 };
+				for (auto& mesh : lighting) {
+					vertices += mesh.size();
+				}
+				std::cout << "baked " << directory / VERTEX_LIGHTING_NAME << " (" << vertices << " vertices) in "
+					<< seconds(roomStart) << " s on " << pool.threadCount() << " threads" << std::endl;
+				continue;
+			}
+			Lightmap lightmap{ baker.bake(roomMeshes[r].first, roomMeshes[r].second) };
+			writeRadianceHdr(directory / LIGHTMAP_IMAGE_NAME, lightmap.width, lightmap.height, lightmap.texels);
+			writeLightmapUVs(directory / LIGHTMAP_UV_NAME, lightmap.uvs);
+			std::filesystem::remove(directory / VERTEX_LIGHTING_NAME);
+			std::cout << "baked " << directory / LIGHTMAP_IMAGE_NAME << " (" << lightmap.width << "x" << lightmap.height
+				<< ") in " << seconds(roomStart) << " s on " << pool.threadCount() << " threads" << std::endl;
+		}
+
+		if (probes) {
+			auto probeStart{ Clock::now() };
+			glm::vec3 boundsMin{ std::numeric_limits<float>::max() };
+			glm::vec3 boundsMax{ std::numeric_limits<float>::lowest() };
+			for (auto& mesh : scene.meshes()) {
+				for (auto& p : mesh.positions) {
+					boundsMin = glm::min(boundsMin, p);
+					boundsMax = glm::max(boundsMax, p);
+				}
+			}
+			ProbeBaker probeBaker{ scene, pool, probeSettings };
+			LightProbeGrid grid{ probeBaker.bake(boundsMin, boundsMax) };
+			writeLightProbes(FNAF_LIGHT_PROBES_PATH, grid);
+			std::cout << "baked " << FNAF_LIGHT_PROBES_PATH << " (" << grid.dimensions().x << "x" << grid.dimensions().y
+				<< "x" << grid.dimensions().z << " probes) in " << seconds(probeStart) << " s" << std::endl;
+		}
+		std::cout << "total " << seconds(start) << " s" << std::endl;
+	}
+	catch (std::runtime_error& e) {
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
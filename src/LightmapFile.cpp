@@ -0,0 +1,171 @@
+#include "LightmapFile.h"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+	constexpr char UV_MAGIC[4]{ 'L', 'M', 'U', 'V' };
+	constexpr char VERTEX_LIGHTING_MAGIC[4]{ 'V', 'X', 'L', 'T' };
+	constexpr uint32_t FORMAT_VERSION{ 1 };
+
+	/**
+	 * @brief Writes one array per mesh: a header, the mesh count, then each array's length and
+	 * contents.
+	 */
+	template <typename T>
+	void writePerMesh(const std::filesystem::path& path, const char (&magic)[4], const std::vector<std::vector<T>>& meshes) {
+		std::ofstream out{ path, std::ios::binary };
+		if (!out) {
+			throw std::runtime_error("Could not write " + path.string());
+		}
+		uint32_t meshCount{ static_cast<uint32_t>(meshes.size()) };
+		out.write(magic, sizeof(magic));
+		out.write(reinterpret_cast<const char*>(&FORMAT_VERSION), sizeof(FORMAT_VERSION));
+		out.write(reinterpret_cast<const char*>(&meshCount), sizeof(meshCount));
+		for (auto& mesh : meshes) {
+			uint32_t length{ static_cast<uint32_t>(mesh.size()) };
+			out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+			out.write(reinterpret_cast<const char*>(mesh.data()), mesh.size() * sizeof(T));
+		}
+	}
+
+	template <typename T>
+	std::vector<std::vector<T>> readPerMesh(const std::filesystem::path& path, const char (&magic)[4]) {
+		std::ifstream in{ path, std::ios::binary };
+		char fileMagic[4]{};
+		uint32_t version{ 0 };
+		uint32_t meshCount{ 0 };
+		in.read(fileMagic, sizeof(fileMagic));
+		in.read(reinterpret_cast<char*>(&version), sizeof(version));
+		in.read(reinterpret_cast<char*>(&meshCount), sizeof(meshCount));
+		if (!in || std::memcmp(fileMagic, magic, sizeof(magic)) != 0 || version != FORMAT_VERSION) {
+			throw std::runtime_error("Unrecognized baked lighting file: " + path.string());
+		}
+
+		std::vector<std::vector<T>> meshes(meshCount);
+		for (auto& mesh : meshes) {
+			uint32_t length{ 0 };
+			in.read(reinterpret_cast<char*>(&length), sizeof(length));
+			mesh.resize(length);
+			in.read(reinterpret_cast<char*>(mesh.data()), mesh.size() * sizeof(T));
+			if (!in) {
+				throw std::runtime_error("Truncated baked lighting file: " + path.string());
+			}
+		}
+		return meshes;
+	}
+
+	std::array<uint8_t, 4> toRgbe(const glm::vec3& color) {
+		float largest{ std::max(color.x, std::max(color.y, color.z)) };
+		if (largest < 1e-32f) {
+			return { 0, 0, 0, 0 };
+		}
+		int exponent;
+		float scale{ std::frexp(largest, &exponent) * 256.0f / largest };
+		return {
+			static_cast<uint8_t>(std::max(color.x, 0.0f) * scale),
+			static_cast<uint8_t>(std::max(color.y, 0.0f) * scale),
+			static_cast<uint8_t>(std::max(color.z, 0.0f) * scale),
+			static_cast<uint8_t>(exponent + 128)
+		};
+	}
+
+	/**
+	 * @brief Run-length encodes one channel of a scanline: runs of at least four equal bytes are
+	 * written as (128 + length, value), everything else as (length, bytes...).
+	 */
+	void writeRunLength(std::ofstream& out, const std::vector<uint8_t>& data) {
+		constexpr size_t MIN_RUN{ 4 };
+		constexpr size_t MAX_LENGTH{ 127 };
+		size_t i{ 0 };
+		while (i < data.size()) {
+			// Find the next run long enough to be worth encoding.
+			size_t runStart{ i };
+			size_t runLength{ 0 };
+			while (runStart < data.size()) {
+				runLength = 1;
+				while (runStart + runLength < data.size() && runLength < MAX_LENGTH
+					&& data[runStart + runLength] == data[runStart]) {
+					++runLength;
+				}
+				if (runLength >= MIN_RUN) {
+					break;
+				}
+				runStart += runLength;
+			}
+			if (runStart >= data.size()) {
+				runLength = 0;
+				runStart = data.size();
+			}
+			// Everything before the run is written literally.
+			while (i < runStart) {
+				size_t count{ std::min(MAX_LENGTH + 1, runStart - i) };
+				out.put(static_cast<char>(count));
+				out.write(reinterpret_cast<const char*>(&data[i]), count);
+				i += count;
+			}
+			if (runLength >= MIN_RUN) {
+				out.put(static_cast<char>(128 + runLength));
+				out.put(static_cast<char>(data[runStart]));
+				i = runStart + runLength;
+			}
+		}
+	}
+}
+
+void writeRadianceHdr(const std::filesystem::path& path, uint32_t width, uint32_t height,
+	const std::vector<glm::vec3>& texels) {
+	std::ofstream out{ path, std::ios::binary };
+	if (!out) {
+		throw std::runtime_error("Could not write " + path.string());
+	}
+	out << "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " << height << " +X " << width << "\n";
+
+	// Run-length encoding is only defined for scanlines 8 to 32767 texels wide.
+	bool encode{ width >= 8 && width < 32768 };
+	std::vector<uint8_t> channels[4];
+	for (auto& c : channels) {
+		c.resize(width);
+	}
+	for (uint32_t y{ 0 }; y < height; ++y) {
+		for (uint32_t x{ 0 }; x < width; ++x) {
+			auto rgbe{ toRgbe(texels[static_cast<size_t>(y) * width + x]) };
+			for (int c{ 0 }; c < 4; ++c) {
+				channels[c][x] = rgbe[c];
+			}
+		}
+		if (!encode) {
+			for (uint32_t x{ 0 }; x < width; ++x) {
+				for (int c{ 0 }; c < 4; ++c) {
+					out.put(static_cast<char>(channels[c][x]));
+				}
+			}
+			continue;
+		}
+		out.put(2);
+		out.put(2);
+		out.put(static_cast<char>(width >> 8));
+		out.put(static_cast<char>(width & 0xFF));
+		for (auto& c : channels) {
+			writeRunLength(out, c);
+		}
+	}
+}
+
+void writeLightmapUVs(const std::filesystem::path& path, const LightmapUVs& uvs) {
+	writePerMesh(path, UV_MAGIC, uvs);
+}
+
+LightmapUVs readLightmapUVs(const std::filesystem::path& path) {
+	return readPerMesh<glm::vec2>(path, UV_MAGIC);
+}
+
+void writeVertexLighting(const std::filesystem::path& path, const VertexLighting& lighting) {
+	writePerMesh(path, VERTEX_LIGHTING_MAGIC, lighting);
+}
+
+VertexLighting readVertexLighting(const std::filesystem::path& path) {
+	return readPerMesh<glm::vec4>(path, VERTEX_LIGHTING_MAGIC);
+}
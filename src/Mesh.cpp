@@ -1,12 +1,23 @@
 #include <glad/glad.h>
 #include "Mesh.h"
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
 
 Mesh::Mesh(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& faces)
 	: Mesh{ vertices, faces, std::vector<Texture>{} } {
 }
 
 Mesh::Mesh(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& faces,
-	std::vector<Texture> textures) :
+	std::vector<Texture> textures)
+	: Mesh{ vertices, faces, std::move(textures), BakedVertexStreams{} } {
+}
+
+Mesh::Mesh(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& faces,
+	std::vector<Texture> textures, const BakedVertexStreams& baked) :
+	m_vertexVbo{ 0 },
 	m_vertexCount{ static_cast<uint32_t>(vertices.size()) }, 
 	m_faceCount{ static_cast<uint32_t>(faces.size()) }, 
 	m_textures{ std::move(textures) } {
@@ -22,6 +33,7 @@ Mesh::Mesh(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& f
 
 	// "Bind" the newly-generated vbo, which makes future functions operate on that specific object.
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	m_vertexVbo = vbo;
 	// This vbo is now associated with m_vao.
 	// Copy the contents of the vertices list to the buffer that lives on the GPU.
 	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex3D), &vertices[0], GL_STATIC_DRAW);
@@ -35,18 +47,233 @@ Mesh::Mesh(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& f
 	glEnableVertexAttribArray(1);
 	glVertexAttribPointer(2, 2, GL_FLOAT, false, sizeof(Vertex3D), (void*)24);
 	glEnableVertexAttribArray(2);
+
+	// Baked lighting data streams from buffers of its own: the lightmap's second UV set, and
+	// lighting baked into the vertices.
+	if (!baked.lightmapCoords.empty()) {
+		uint32_t lightmapVbo;
+		glGenBuffers(1, &lightmapVbo);
+		glBindBuffer(GL_ARRAY_BUFFER, lightmapVbo);
+		glBufferData(GL_ARRAY_BUFFER, baked.lightmapCoords.size() * sizeof(glm::vec2), &baked.lightmapCoords[0], GL_STATIC_DRAW);
+		glVertexAttribPointer(3, 2, GL_FLOAT, false, sizeof(glm::vec2), 0);
+		glEnableVertexAttribArray(3);
+	}
+	if (!baked.vertexLighting.empty()) {
+		uint32_t lightingVbo;
+		glGenBuffers(1, &lightingVbo);
+		glBindBuffer(GL_ARRAY_BUFFER, lightingVbo);
+		glBufferData(GL_ARRAY_BUFFER, baked.vertexLighting.size() * sizeof(glm::vec4), &baked.vertexLighting[0], GL_STATIC_DRAW);
+		glVertexAttribPointer(4, 4, GL_FLOAT, false, sizeof(glm::vec4), 0);
+		glEnableVertexAttribArray(4);
+	}
 	
 
 	// Generate a second buffer, to store the indices of each triangle in the mesh.
 	uint32_t ebo;
 	glGenBuffers(1, &ebo);
+	m_elementBuffer = ebo;
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, faces.size() * sizeof(uint32_t), &faces[0], GL_STATIC_DRAW);
 
+	// Depth-only passes read nothing but positions, so they get a tightly-packed position stream
+	// of their own instead of striding over normals and texture coordinates.
+	std::vector<glm::vec3> positions{};
+	positions.reserve(vertices.size());
+	m_boundsMin = glm::vec3{ vertices.empty() ? 0.0f : std::numeric_limits<float>::max() };
+	m_boundsMax = glm::vec3{ vertices.empty() ? 0.0f : std::numeric_limits<float>::lowest() };
+	for (auto& v : vertices) {
+		positions.emplace_back(v.x, v.y, v.z);
+		m_boundsMin = glm::min(m_boundsMin, positions.back());
+		m_boundsMax = glm::max(m_boundsMax, positions.back());
+	}
+
+	glGenVertexArrays(1, &m_depthVao);
+	glBindVertexArray(m_depthVao);
+	uint32_t positionVbo;
+	glGenBuffers(1, &positionVbo);
+	glBindBuffer(GL_ARRAY_BUFFER, positionVbo);
+	glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), &positions[0], GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(glm::vec3), 0);
+	glEnableVertexAttribArray(0);
+	// The depth vao shares the same element buffer.
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
 	// Unbind the vertex array, so no one else can accidentally mess with it.
 	glBindVertexArray(0);
 }
 
+void Mesh::attachSkin(const std::vector<SkinInfluences>& influences, int32_t paletteOffset) {
+	m_paletteOffset = paletteOffset;
+	if (influences.empty()) {
+		return;
+	}
+	// The skinning pass reads the bind pose from the vertex buffer, and bone indices as integers
+	// and weights as normalized bytes from one 12-byte stream.
+	glGenVertexArrays(1, &m_skinVao);
+	glBindVertexArray(m_skinVao);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexVbo);
+	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(Vertex3D), 0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, false, sizeof(Vertex3D), (void*)12);
+	glEnableVertexAttribArray(1);
+	uint32_t skinVbo;
+	glGenBuffers(1, &skinVbo);
+	glBindBuffer(GL_ARRAY_BUFFER, skinVbo);
+	glBufferData(GL_ARRAY_BUFFER, influences.size() * sizeof(SkinInfluences), &influences[0], GL_STATIC_DRAW);
+	glVertexAttribIPointer(5, MAX_BONE_INFLUENCE, GL_UNSIGNED_SHORT, sizeof(SkinInfluences), 0);
+	glEnableVertexAttribArray(5);
+	glVertexAttribPointer(6, MAX_BONE_INFLUENCE, GL_UNSIGNED_BYTE, true, sizeof(SkinInfluences),
+		(void*)offsetof(SkinInfluences, weights));
+	glEnableVertexAttribArray(6);
+	glBindVertexArray(0);
+
+	// The posed buffers start out as the bind pose, so that anything drawn before the first
+	// skinning pass, such as impostor bakes, still sees the model.
+	std::vector<Vertex3D> vertices(m_vertexCount);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexVbo);
+	glGetBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex3D), &vertices[0]);
+	std::vector<glm::vec3> positions{};
+	std::vector<glm::vec3> normals{};
+	for (auto& v : vertices) {
+		positions.emplace_back(v.x, v.y, v.z);
+		normals.emplace_back(v.nx, v.ny, v.nz);
+	}
+	glGenBuffers(1, &m_posedPositions);
+	glBindBuffer(GL_ARRAY_BUFFER, m_posedPositions);
+	glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), &positions[0], GL_DYNAMIC_COPY);
+	glGenBuffers(1, &m_posedNormals);
+	glBindBuffer(GL_ARRAY_BUFFER, m_posedNormals);
+	glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(glm::vec3), &normals[0], GL_DYNAMIC_COPY);
+
+	// Every pass that draws the mesh reads the posed buffers, with the same static vertex shaders
+	// as any other mesh.
+	glBindVertexArray(m_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, m_posedPositions);
+	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(glm::vec3), 0);
+	glBindBuffer(GL_ARRAY_BUFFER, m_posedNormals);
+	glVertexAttribPointer(1, 3, GL_FLOAT, false, sizeof(glm::vec3), 0);
+	glBindVertexArray(m_depthVao);
+	glBindBuffer(GL_ARRAY_BUFFER, m_posedPositions);
+	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(glm::vec3), 0);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::skin(ShaderProgram& program) const {
+	if (m_skinVao == 0) {
+		return;
+	}
+	program.setUniform("boneOffset", m_paletteOffset);
+	glBindVertexArray(m_skinVao);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_posedPositions);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, m_posedNormals);
+	// Each vertex is posed once, as a point.
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, m_vertexCount);
+	glEndTransformFeedback();
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, 0);
+	glBindVertexArray(0);
+}
+
+void Mesh::allocateVertexAnimation(uint32_t frameCount, int32_t maxWidth) {
+	if (!isSkinned() || m_vertexCount == 0) {
+		return;
+	}
+	// Meshes with more vertices than a row holds spread each frame over several rows.
+	m_vertexAnimation.width = std::min(static_cast<int32_t>(m_vertexCount), maxWidth);
+	m_vertexAnimation.rowsPerFrame = static_cast<int32_t>((m_vertexCount + m_vertexAnimation.width - 1) / m_vertexAnimation.width);
+	m_vertexAnimation.frameCount = frameCount;
+	// Normals only need half precision.
+	for (auto [texture, format] : { std::pair{ &m_vertexAnimation.positions, GL_RGB32F },
+		std::pair{ &m_vertexAnimation.normals, GL_RGB16F } }) {
+		if (*texture == 0) {
+			glGenTextures(1, texture);
+		}
+		glBindTexture(GL_TEXTURE_2D, *texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, format, m_vertexAnimation.width, m_vertexAnimation.rowsPerFrame * frameCount,
+			0, GL_RGB, GL_FLOAT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Mesh::captureVertexAnimationFrame(uint32_t frame) const {
+	if (m_vertexAnimation.positions == 0 || frame >= m_vertexAnimation.frameCount) {
+		return;
+	}
+	// The posed buffers are the source of the upload, so the copy never leaves the GPU. The full
+	// rows go first, then what is left of the frame.
+	int32_t width{ m_vertexAnimation.width };
+	int32_t fullRows{ static_cast<int32_t>(m_vertexCount) / width };
+	int32_t rest{ static_cast<int32_t>(m_vertexCount) % width };
+	int32_t row{ static_cast<int32_t>(frame) * m_vertexAnimation.rowsPerFrame };
+	for (auto [texture, buffer] : { std::pair{ m_vertexAnimation.positions, m_posedPositions },
+		std::pair{ m_vertexAnimation.normals, m_posedNormals } }) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		if (fullRows > 0) {
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row, width, fullRows, GL_RGB, GL_FLOAT, nullptr);
+		}
+		if (rest > 0) {
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row + fullRows, rest, 1, GL_RGB, GL_FLOAT,
+				(void*)(static_cast<size_t>(fullRows) * width * sizeof(glm::vec3)));
+		}
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Mesh::bindVertexAnimation(ShaderProgram& program) const {
+	program.setUniform("vatRowsPerFrame", m_vertexAnimation.rowsPerFrame);
+	if (m_vertexAnimation.positions == 0) {
+		return;
+	}
+	program.setUniform("vatPositions", VERTEX_ANIMATION_POSITION_UNIT);
+	program.setUniform("vatNormals", VERTEX_ANIMATION_NORMAL_UNIT);
+	glActiveTexture(GL_TEXTURE0 + VERTEX_ANIMATION_POSITION_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_vertexAnimation.positions);
+	glActiveTexture(GL_TEXTURE0 + VERTEX_ANIMATION_NORMAL_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_vertexAnimation.normals);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+SoftwareMesh Mesh::readBack() const {
+	SoftwareMesh software{};
+	if (m_vertexCount == 0) {
+		return software;
+	}
+	// Reading through GL_ARRAY_BUFFER leaves the vertex arrays' element buffers alone.
+	std::vector<Vertex3D> vertices(m_vertexCount);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexVbo);
+	glGetBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex3D), &vertices[0]);
+	software.indices.resize(m_faceCount);
+	glBindBuffer(GL_ARRAY_BUFFER, m_elementBuffer);
+	glGetBufferSubData(GL_ARRAY_BUFFER, 0, software.indices.size() * sizeof(uint32_t), software.indices.data());
+	for (auto& v : vertices) {
+		software.positions.emplace_back(v.x, v.y, v.z);
+		software.normals.emplace_back(v.nx, v.ny, v.nz);
+		software.texCoords.emplace_back(v.u, v.v);
+	}
+	if (isSkinned()) {
+		glBindBuffer(GL_ARRAY_BUFFER, m_posedPositions);
+		glGetBufferSubData(GL_ARRAY_BUFFER, 0, software.positions.size() * sizeof(glm::vec3), software.positions.data());
+		glBindBuffer(GL_ARRAY_BUFFER, m_posedNormals);
+		glGetBufferSubData(GL_ARRAY_BUFFER, 0, software.normals.size() * sizeof(glm::vec3), software.normals.data());
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	for (auto& texture : m_textures) {
+		if (texture.samplerName == "baseTexture") {
+			software.baseTexture = texture.textureId;
+		}
+	}
+	software.boundsMin = m_boundsMin;
+	software.boundsMax = m_boundsMax;
+	return software;
+}
+
 void Mesh::addTexture(Texture texture) {
 	m_textures.emplace_back(std::move(texture));
 }
@@ -72,6 +299,12 @@ void Mesh::render(ShaderProgram& program) const {
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void Mesh::renderDepth() const {
+	glBindVertexArray(m_depthVao);
+	glDrawElements(GL_TRIANGLES, m_faceCount, GL_UNSIGNED_INT, nullptr);
+	glBindVertexArray(0);
+}
+
 Mesh Mesh::square(std::vector<Texture> textures) {
 	Mesh m{
 		{
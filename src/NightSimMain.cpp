@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "FnafNight.h"
+#include "PassTimer.h"
+#include "WorkerPool.h"
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * @brief How the simulated player behaves: how often they look at the hallway camera, how
+	 * quickly they close the left door once they see Foxy running, and how long they keep it
+	 * closed after he has gone back.
+	 */
+	struct PlayerModel {
+		float checkInterval{ 6.0f };
+		float reactionMin{ 0.3f };
+		float reactionMax{ 1.5f };
+		float holdTime{ 2.0f };
+	};
+
+	/**
+	 * @brief A player following a PlayerModel, with its own random choices.
+	 */
+	class SimulatedPlayer {
+	private:
+		PlayerModel m_model;
+		std::mt19937_64 m_random;
+		float m_nextCheck;
+		// When the player will close and open the left door, or negative if they don't mean to.
+		float m_closeAt{ -1 };
+		float m_openAt{ -1 };
+
+		float nextCheckDelay() {
+			return std::exponential_distribution<float>{ 1.0f / m_model.checkInterval }(m_random);
+		}
+
+	public:
+		SimulatedPlayer(const PlayerModel& model, std::seed_seq& seed) : m_model{ model }, m_random{ seed } {
+			m_nextCheck = nextCheckDelay();
+		}
+
+		void act(FnafNight& night) {
+			float time{ night.time() };
+			if (time >= m_nextCheck) {
+				m_nextCheck = time + nextCheckDelay();
+				if (night.foxy() == FoxyState::Running && m_closeAt < 0 && !night.leftDoorClosed()) {
+					m_closeAt = time + std::uniform_real_distribution<float>{ m_model.reactionMin, m_model.reactionMax }(m_random);
+				}
+			}
+			if (m_closeAt >= 0 && time >= m_closeAt) {
+				night.setLeftDoor(true);
+				m_closeAt = -1;
+			}
+			if (night.leftDoorClosed() && night.foxy() == FoxyState::InCove && m_openAt < 0) {
+				m_openAt = time + m_model.holdTime;
+			}
+			if (m_openAt >= 0 && time >= m_openAt) {
+				night.setLeftDoor(false);
+				m_openAt = -1;
+			}
+		}
+	};
+
+	struct NightResult {
+		NightOutcome outcome{ NightOutcome::Playing };
+		float endTime{ 0 };
+		float power{ 0 };
+		bool powerOut{ false };
+	};
+
+	NightResult simulateNight(const NightSettings& settings, const PlayerModel& model, uint64_t seed, uint64_t night, float step) {
+		std::seed_seq seq{ static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32),
+			static_cast<uint32_t>(night), static_cast<uint32_t>(night >> 32) };
+		SimulatedPlayer player{ model, seq };
+		NightSettings nightSettings{ settings };
+		uint32_t nightSeed[2];
+		seq.generate(std::begin(nightSeed), std::end(nightSeed));
+		nightSettings.seed = (static_cast<uint64_t>(nightSeed[0]) << 32) | nightSeed[1];
+		FnafNight state{ nightSettings };
+		NightResult result{};
+		state.setEventCallback([&result](NightEvent event) {
+			if (event == NightEvent::PowerOut) {
+				result.powerOut = true;
+			}
+		});
+		while (!state.over()) {
+			player.act(state);
+			state.step(step);
+		}
+		result.outcome = state.outcome();
+		result.endTime = state.time();
+		result.power = state.power();
+		return result;
+	}
+
+	// Parse all of an option's value, throwing std::invalid_argument if any is left over.
+	float toFloat(const std::string& value) {
+		size_t used{ 0 };
+		float number{ std::stof(value, &used) };
+		if (used != value.size() || !std::isfinite(number)) {
+			throw std::invalid_argument{ value };
+		}
+		return number;
+	}
+
+	uint64_t toCount(const std::string& value) {
+		size_t used{ 0 };
+		uint64_t number{ std::stoull(value, &used) };
+		if (used != value.size() || value.find('-') != std::string::npos) {
+			throw std::invalid_argument{ value };
+		}
+		return number;
+	}
+}
+
+/*
+ * Plays many nights of the game's rules with a simulated player, with no window, OpenGL or real
+ * time, spread across every core, and reports how often the player survives. Each night's random
+ * choices come from the seed and the night's number only, so results don't depend on the number
+ * of threads.
+ *
+ * Options: --nights <count> (10000), --seed <seed> (1), --step <seconds> (1/60, the game's
+ * simulation step), the night's rules --foxy-delay, --foxy-jitter, --foxy-run-time,
+ * --night-length, --power, --idle-drain, --door-drain (see NightSettings), and the player's
+ * --check-interval, --reaction-min, --reaction-max, --hold-time (see PlayerModel).
+ */
+int main(int argc, char* argv[]) {
+	NightSettings settings{};
+	PlayerModel model{};
+	uint64_t nights{ 10000 };
+	uint64_t seed{ 1 };
+	float step{ 1.0f / 60 };
+	for (int i{ 1 }; i < argc; ++i) {
+		std::string arg{ argv[i] };
+		if (i + 1 == argc) {
+			std::cout << "ERROR: option " << arg << " needs a value" << std::endl;
+			return 1;
+		}
+		std::string value{ argv[++i] };
+		try {
+			if (arg == "--nights") {
+				nights = std::max<uint64_t>(1, toCount(value));
+			}
+			else if (arg == "--seed") {
+				seed = toCount(value);
+			}
+			else if (arg == "--step") {
+				step = toFloat(value);
+			}
+			else if (arg == "--foxy-delay") {
+				settings.foxyDelay = toFloat(value);
+			}
+			else if (arg == "--foxy-jitter") {
+				settings.foxyDelayJitter = toFloat(value);
+			}
+			else if (arg == "--foxy-run-time") {
+				settings.foxyRunTime = toFloat(value);
+			}
+			else if (arg == "--night-length") {
+				settings.nightLength = toFloat(value);
+			}
+			else if (arg == "--power") {
+				settings.power = toFloat(value);
+			}
+			else if (arg == "--idle-drain") {
+				settings.idleDrain = toFloat(value);
+			}
+			else if (arg == "--door-drain") {
+				settings.doorDrain = toFloat(value);
+			}
+			else if (arg == "--check-interval") {
+				model.checkInterval = toFloat(value);
+			}
+			else if (arg == "--reaction-min") {
+				model.reactionMin = toFloat(value);
+			}
+			else if (arg == "--reaction-max") {
+				model.reactionMax = toFloat(value);
+			}
+			else if (arg == "--hold-time") {
+				model.holdTime = toFloat(value);
+			}
+			else {
+				std::cout << "ERROR: unknown option " << arg << std::endl;
+				return 1;
+			}
+		}
+		catch (std::logic_error&) {
+			std::cout << "ERROR: " << arg << " expects a number, not " << value << std::endl;
+			return 1;
+		}
+	}
+
+	// Steps must move time on, and the player's random delays need a positive mean and an ordered range.
+	if (step <= 0) {
+		std::cout << "ERROR: --step must be positive" << std::endl;
+		return 1;
+	}
+	if (model.checkInterval <= 0) {
+		std::cout << "ERROR: --check-interval must be positive" << std::endl;
+		return 1;
+	}
+	if (model.reactionMin < 0 || model.reactionMin > model.reactionMax) {
+		std::cout << "ERROR: --reaction-min must be at least 0 and at most --reaction-max" << std::endl;
+		return 1;
+	}
+
+	std::vector<NightResult> results(nights);
+	WorkerPool pool{};
+	auto start{ Clock::now() };
+	pool.parallelFor(nights, 64, [&](size_t begin, size_t end) {
+		for (size_t n{ begin }; n < end; ++n) {
+			results[n] = simulateNight(settings, model, seed, n, step);
+		}
+	});
+	double seconds{ std::chrono::duration<double>(Clock::now() - start).count() };
+
+	uint64_t survived{ 0 };
+	uint64_t caught{ 0 };
+	uint64_t powerOuts{ 0 };
+	double simulated{ 0 };
+	std::vector<float> deathTimes{};
+	std::vector<float> powerLeft{};
+	for (auto& result : results) {
+		simulated += result.endTime;
+		powerOuts += result.powerOut;
+		if (result.outcome == NightOutcome::Survived) {
+			++survived;
+			powerLeft.push_back(result.power);
+		}
+		else {
+			++caught;
+			deathTimes.push_back(result.endTime);
+		}
+	}
+
+	std::cout << nights << " nights (seed " << seed << ", " << pool.threadCount() << " threads, "
+		<< seconds << " s, " << simulated / std::max(seconds, 1e-9) << "x real time)" << std::endl;
+	std::cout << "  survived: " << survived << " (" << 100.0 * survived / nights << "%)" << std::endl;
+	std::cout << "  caught by Foxy: " << caught << " (" << 100.0 * caught / nights << "%)";
+	if (!deathTimes.empty()) {
+		std::cout << ", at " << PassTimer::percentile(deathTimes, 0.5f) << " s median, "
+			<< PassTimer::percentile(deathTimes, 0.05f) << "-" << PassTimer::percentile(deathTimes, 0.95f) << " s 5th-95th percentile";
+	}
+	std::cout << std::endl;
+	std::cout << "  power ran out: " << powerOuts << " (" << 100.0 * powerOuts / nights << "%)";
+	if (!powerLeft.empty()) {
+		std::cout << ", " << PassTimer::percentile(powerLeft, 0.5f) << "% median left at 6 AM";
+	}
+	std::cout << std::endl;
+	return 0;
+}
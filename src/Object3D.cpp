@@ -50,6 +50,22 @@ const glm::vec4& Object3D::getMaterial() const {
 	return m_material;
 }
 
+BakedLighting Object3D::getBakedLighting() const {
+	return m_bakedLighting;
+}
+
+const std::shared_ptr<SkeletonPose>& Object3D::getSkeletonPose() const {
+	return m_skeletonPose;
+}
+
+float Object3D::getVertexAnimationFrame() const {
+	return m_vertexAnimationFrame;
+}
+
+glm::mat4 Object3D::getModelMatrix() const {
+	return buildModelMatrix();
+}
+
 size_t Object3D::numberOfChildren() const {
 	return m_children.size();
 }
@@ -94,6 +110,18 @@ void Object3D::setMaterial(glm::vec4 material) {
 	}
 }
 
+void Object3D::setBakedLighting(BakedLighting bakedLighting) {
+	m_bakedLighting = bakedLighting;
+}
+
+void Object3D::setSkeletonPose(std::shared_ptr<SkeletonPose> skeletonPose) {
+	m_skeletonPose = std::move(skeletonPose);
+}
+
+void Object3D::setVertexAnimationFrame(float frame) {
+	m_vertexAnimationFrame = frame;
+}
+
 void Object3D::move(const glm::vec3& offset) {
 	m_position = m_position + offset;
 }
@@ -110,15 +138,38 @@ void Object3D::addChild(Object3D child) {
 	m_children.emplace_back(std::move(child));
 }
 
+void Object3D::expandBounds(const glm::mat4& parentModel, glm::vec3& boundsMin, glm::vec3& boundsMax) const {
+	glm::mat4 trueModel{ parentModel * buildModelMatrix() };
+	for (auto& mesh : m_meshes) {
+		for (int corner{ 0 }; corner < 8; ++corner) {
+			glm::vec3 local{
+				(corner & 1) ? mesh.boundsMax().x : mesh.boundsMin().x,
+				(corner & 2) ? mesh.boundsMax().y : mesh.boundsMin().y,
+				(corner & 4) ? mesh.boundsMax().z : mesh.boundsMin().z
+			};
+			glm::vec3 world{ trueModel * glm::vec4{ local, 1 } };
+			boundsMin = glm::min(boundsMin, world);
+			boundsMax = glm::max(boundsMax, world);
+		}
+	}
+	for (auto& child : m_children) {
+		child.expandBounds(trueModel, boundsMin, boundsMax);
+	}
+}
+
 void Object3D::render(ShaderProgram& shaderProgram) const {
-	renderRecursive(shaderProgram, glm::mat4{ 1 });
+	// The frame holds for the whole hierarchy; while it plays, each mesh says whether it has
+	// textures to play it. Otherwise no mesh is animated, whatever vatRowsPerFrame is left at.
+	shaderProgram.setUniform("vertexAnimationFrame", m_vertexAnimationFrame);
+	renderRecursive(shaderProgram, glm::mat4{ 1 }, m_vertexAnimationFrame >= 0);
 }
 
 /**
  * @brief Renders the object and its children, recursively.
  * @param parentMatrix the model matrix of this object's parent in the model hierarchy.
+ * @param vertexAnimated whether the hierarchy plays a vertex animation frame.
  */
-void Object3D::renderRecursive(ShaderProgram& shaderProgram, const glm::mat4& parentModel) const {
+void Object3D::renderRecursive(ShaderProgram& shaderProgram, const glm::mat4& parentModel, bool vertexAnimated) const {
 	// Build the local model matrix, which is relative to the parent model matrix.
 	glm::mat4 localModel{ buildModelMatrix() };
 
@@ -137,6 +188,9 @@ void Object3D::renderRecursive(ShaderProgram& shaderProgram, const glm::mat4& pa
 	shaderProgram.setUniform("material", m_material);
 	// Render each *mesh* in the object.
 	for (auto& mesh : m_meshes) {
+		if (vertexAnimated) {
+			mesh.bindVertexAnimation(shaderProgram);
+		}
 		mesh.render(shaderProgram);
 	}
 
@@ -144,6 +198,47 @@ void Object3D::renderRecursive(ShaderProgram& shaderProgram, const glm::mat4& pa
 	// and have them render themselves recursively. The parent model matrix for your children is your own
 	// true model matrix.
 	for (auto& child : m_children) {
-		child.renderRecursive(shaderProgram, trueModel);
+		child.renderRecursive(shaderProgram, trueModel, vertexAnimated);
+	}
+}
+
+void Object3D::renderDepth(ShaderProgram& shaderProgram) const {
+	shaderProgram.setUniform("vertexAnimationFrame", m_vertexAnimationFrame);
+	renderDepthRecursive(shaderProgram, glm::mat4{ 1 }, m_vertexAnimationFrame >= 0);
+}
+
+/**
+ * @brief Renders only the positions of the object and its children, recursively, for a
+ * depth-only pass. No material or texture uniforms are set.
+ */
+void Object3D::renderDepthRecursive(ShaderProgram& shaderProgram, const glm::mat4& parentModel, bool vertexAnimated) const {
+	glm::mat4 trueModel{ parentModel * buildModelMatrix() };
+	shaderProgram.setUniform("model", trueModel);
+	for (auto& mesh : m_meshes) {
+		if (vertexAnimated) {
+			mesh.bindVertexAnimation(shaderProgram);
+		}
+		mesh.renderDepth();
+	}
+	for (auto& child : m_children) {
+		child.renderDepthRecursive(shaderProgram, trueModel, vertexAnimated);
+	}
+}
+
+void Object3D::skin(ShaderProgram& shaderProgram) const {
+	if (!m_skeletonPose) {
+		return;
+	}
+	m_skeletonPose->bind(shaderProgram);
+	skinRecursive(shaderProgram);
+}
+
+void Object3D::skinRecursive(ShaderProgram& shaderProgram) const {
+	// Skinned meshes are posed in their own space, so no model matrix is needed.
+	for (auto& mesh : m_meshes) {
+		mesh.skin(shaderProgram);
+	}
+	for (auto& child : m_children) {
+		child.skinRecursive(shaderProgram);
 	}
 }
@@ -0,0 +1,98 @@
+#include "PassTimer.h"
+#include <algorithm>
+#include <glad/glad.h>
+
+namespace {
+	void printDistribution(std::ostream& out, const char* label, const std::vector<float>& ms) {
+		out << label << " p50 " << PassTimer::percentile(ms, 0.50f) << ", p95 " << PassTimer::percentile(ms, 0.95f)
+			<< ", p99 " << PassTimer::percentile(ms, 0.99f) << ", max "
+			<< (ms.empty() ? 0.0f : *std::max_element(ms.begin(), ms.end())) << " ms";
+	}
+}
+
+float PassTimer::percentile(std::vector<float> values, float fraction) {
+	if (values.empty()) {
+		return 0;
+	}
+	size_t index{ std::min(static_cast<size_t>(fraction * values.size()), values.size() - 1) };
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+PassTimer::~PassTimer() {
+	for (auto& pass : m_passes) {
+		if (!pass.queries.empty()) {
+			glDeleteQueries(static_cast<GLsizei>(pass.queries.size()), pass.queries.data());
+		}
+	}
+}
+
+uint32_t PassTimer::addPass(const std::string& name, bool gpu) {
+	Pass pass{ name, gpu };
+	if (gpu) {
+		pass.queries.resize(QUERY_LATENCY);
+		glGenQueries(QUERY_LATENCY, pass.queries.data());
+	}
+	m_passes.push_back(std::move(pass));
+	return static_cast<uint32_t>(m_passes.size() - 1);
+}
+
+bool PassTimer::collect(Pass& pass, bool wait) {
+	if (pass.pending == 0) {
+		return false;
+	}
+	uint32_t query{ pass.queries[(pass.queryNext + QUERY_LATENCY - pass.pending) % QUERY_LATENCY] };
+	if (!wait) {
+		int32_t available{ 0 };
+		glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			return false;
+		}
+	}
+	GLuint64 nanoseconds{ 0 };
+	glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+	pass.gpuMs.push_back(static_cast<float>(nanoseconds / 1e6));
+	--pass.pending;
+	return true;
+}
+
+void PassTimer::begin(uint32_t pass) {
+	auto& p{ m_passes[pass] };
+	if (p.gpu) {
+		while (collect(p, false)) {}
+		// Every query in the ring is still in flight; wait for the oldest rather than lose it.
+		if (p.pending == QUERY_LATENCY) {
+			collect(p, true);
+		}
+		glBeginQuery(GL_TIME_ELAPSED, p.queries[p.queryNext]);
+	}
+	p.cpuStart = Clock::now();
+}
+
+void PassTimer::end(uint32_t pass) {
+	auto& p{ m_passes[pass] };
+	p.cpuMs.push_back(std::chrono::duration<float, std::milli>(Clock::now() - p.cpuStart).count());
+	if (p.gpu) {
+		glEndQuery(GL_TIME_ELAPSED);
+		p.queryNext = (p.queryNext + 1) % QUERY_LATENCY;
+		++p.pending;
+	}
+}
+
+void PassTimer::finish() {
+	for (auto& pass : m_passes) {
+		while (collect(pass, true)) {}
+	}
+}
+
+void PassTimer::report(std::ostream& out) const {
+	for (auto& pass : m_passes) {
+		out << pass.name << " (" << pass.cpuMs.size() << " frames): ";
+		printDistribution(out, "CPU", pass.cpuMs);
+		if (pass.gpu) {
+			out << "; ";
+			printDistribution(out, "GPU", pass.gpuMs);
+		}
+		out << std::endl;
+	}
+}
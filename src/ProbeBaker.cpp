@@ -0,0 +1,70 @@
+#include "ProbeBaker.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+ProbeBaker::ProbeBaker(const BakeScene& scene, WorkerPool& pool, const ProbeBakeSettings& settings) :
+	m_scene{ scene },
+	m_pool{ pool },
+	m_settings{ settings } {
+}
+
+ShIrradiance ProbeBaker::bakeProbe(const glm::vec3& position) const {
+	constexpr float pi{ std::numbers::pi_v<float> };
+	const float goldenAngle{ pi * (3 - std::sqrt(5.0f)) };
+	uint32_t samples{ std::max(m_settings.samples, 4u) };
+
+	// Radiance along each ray is bouncedLight / pi, and each ray stands for 4 pi / samples of the
+	// sphere; the pis cancel in the projection.
+	ShIrradiance radiance{};
+	Ray rays[4];
+	RayHit hits[4];
+	for (uint32_t first{ 0 }; first < samples; first += 4) {
+		for (uint32_t k{ 0 }; k < 4; ++k) {
+			uint32_t i{ std::min(first + k, samples - 1) };
+			float z{ 1 - (2 * i + 1) / static_cast<float>(samples) };
+			float r{ std::sqrt(std::max(0.0f, 1 - z * z)) };
+			float phi{ goldenAngle * i };
+			rays[k] = Ray{ position, glm::vec3{ r * std::cos(phi), r * std::sin(phi), z }, BakeScene::SUN_DISTANCE };
+		}
+		uint32_t mask{ m_scene.bvh().intersect4(rays, hits) };
+		for (uint32_t k{ 0 }; k < 4 && first + k < samples; ++k) {
+			if ((mask & (1u << k)) == 0) {
+				continue;
+			}
+			glm::vec3 light{ m_scene.bouncedLight(rays[k], hits[k]) * (4.0f / samples) };
+			auto y{ ShIrradiance::basis(rays[k].direction) };
+			for (uint32_t c{ 0 }; c < ShIrradiance::COEFFICIENTS; ++c) {
+				radiance.coefficients[c] += light * y[c];
+			}
+		}
+	}
+
+	// Convolving with the clamped cosine lobe scales each band (Ramamoorthi and Hanrahan, "An
+	// Efficient Representation for Irradiance Environment Maps").
+	const float bandScale[3]{ pi, 2 * pi / 3, pi / 4 };
+	ShIrradiance irradiance{};
+	for (uint32_t c{ 0 }; c < ShIrradiance::COEFFICIENTS; ++c) {
+		uint32_t band{ c == 0 ? 0u : c < 4 ? 1u : 2u };
+		irradiance.coefficients[c] = radiance.coefficients[c] * bandScale[band];
+	}
+	return irradiance;
+}
+
+LightProbeGrid ProbeBaker::bake(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+	float spacing{ std::max(m_settings.spacing, 1e-3f) };
+	glm::vec3 extent{ glm::max(boundsMax - boundsMin, glm::vec3{ 0 }) };
+	glm::uvec3 dimensions{
+		static_cast<uint32_t>(std::ceil(extent.x / spacing)) + 1,
+		static_cast<uint32_t>(std::ceil(extent.y / spacing)) + 1,
+		static_cast<uint32_t>(std::ceil(extent.z / spacing)) + 1
+	};
+	LightProbeGrid grid{ boundsMin, glm::vec3{ spacing }, dimensions };
+
+	m_pool.parallelFor(grid.probeCount(), 4, [&](size_t begin, size_t end) {
+		for (size_t i{ begin }; i < end; ++i) {
+			grid.probe(i) = bakeProbe(grid.probePosition(i));
+		}
+	});
+	return grid;
+}
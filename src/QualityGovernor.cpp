@@ -0,0 +1,114 @@
+#include "QualityGovernor.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+QualityGovernor::QualityGovernor(float budgetMs, float percentile, size_t windowSize) :
+	m_budgetMs{ budgetMs },
+	m_percentile{ std::clamp(percentile, 0.0f, 1.0f) },
+	m_levels{ defaultLevels() },
+	m_level{ 0 },
+	m_windowSize{ std::max<size_t>(windowSize, 1) },
+	m_frame{ 0 },
+	m_windowsUnderBudget{ 0 },
+	m_cooldownWindows{ 0 } {
+	m_window.reserve(m_windowSize);
+}
+
+std::vector<QualitySettings> QualityGovernor::defaultLevels() {
+	// lodBias, feedUpdateInterval, shadowResolution, maxLights, drawDistance
+	return {
+		{ 0.0f, 1, 2048, 64, 100.0f },
+		{ 0.5f, 1, 1024, 32, 80.0f },
+		{ 1.0f, 2, 1024, 16, 60.0f },
+		{ 1.5f, 3, 512, 8, 45.0f },
+		{ 2.5f, 4, 256, 4, 35.0f },
+	};
+}
+
+void QualityGovernor::setLevels(std::vector<QualitySettings> levels) {
+	if (levels.empty()) {
+		throw std::invalid_argument("A QualityGovernor needs at least one quality level");
+	}
+	m_levels = std::move(levels);
+	m_level = 0;
+	m_window.clear();
+	m_windowsUnderBudget = 0;
+	m_cooldownWindows = 0;
+}
+
+void QualityGovernor::setTelemetryCallback(std::function<void(const QualityDecision&)> callback) {
+	m_telemetry = std::move(callback);
+}
+
+void QualityGovernor::recordFrame(float frameSeconds) {
+	++m_frame;
+	m_window.push_back(frameSeconds * 1000.0f);
+	if (m_window.size() >= m_windowSize) {
+		evaluateWindow();
+		m_window.clear();
+	}
+}
+
+void QualityGovernor::evaluateWindow() {
+	// Select the percentile sample without fully sorting the window.
+	size_t rank{ static_cast<size_t>(std::ceil(m_percentile * m_window.size())) };
+	rank = std::clamp<size_t>(rank, 1, m_window.size()) - 1;
+	std::nth_element(m_window.begin(), m_window.begin() + rank, m_window.end());
+	float measured{ m_window[rank] };
+
+	QualityDecision decision{ m_frame, QualityDecision::Action::Hold, m_level, m_level, measured, m_budgetMs, "" };
+	std::ostringstream reason;
+
+	if (m_cooldownWindows > 0) {
+		--m_cooldownWindows;
+		m_windowsUnderBudget = 0;
+		reason << "cooling down after a level change";
+	}
+	else if (measured > m_budgetMs) {
+		m_windowsUnderBudget = 0;
+		if (m_level + 1 < m_levels.size()) {
+			decision.action = QualityDecision::Action::Downgrade;
+			decision.toLevel = m_level + 1;
+			reason << "over budget";
+		}
+		else {
+			reason << "over budget at the cheapest level";
+		}
+	}
+	else if (measured < m_budgetMs * UPGRADE_HEADROOM) {
+		++m_windowsUnderBudget;
+		if (m_level > 0 && m_windowsUnderBudget >= UPGRADE_WINDOWS) {
+			decision.action = QualityDecision::Action::Upgrade;
+			decision.toLevel = m_level - 1;
+			reason << "under " << UPGRADE_HEADROOM * 100 << "% of budget for " << m_windowsUnderBudget << " windows";
+		}
+		else {
+			reason << "headroom for " << m_windowsUnderBudget << " of " << UPGRADE_WINDOWS << " windows";
+		}
+	}
+	else {
+		// Within budget, but not by enough to risk a more expensive level.
+		m_windowsUnderBudget = 0;
+		reason << "within budget";
+	}
+
+	if (decision.toLevel != m_level) {
+		m_level = decision.toLevel;
+		m_windowsUnderBudget = 0;
+		m_cooldownWindows = COOLDOWN_WINDOWS;
+	}
+	decision.reason = reason.str();
+	record(std::move(decision));
+}
+
+void QualityGovernor::record(QualityDecision decision) {
+	if (m_telemetry) {
+		m_telemetry(decision);
+	}
+	m_decisions.push_back(std::move(decision));
+	if (m_decisions.size() > DECISION_HISTORY) {
+		m_decisions.pop_front();
+	}
+}
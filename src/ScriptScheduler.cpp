@@ -0,0 +1,75 @@
+#include "ScriptScheduler.h"
+#include <algorithm>
+#include "Animator.h"
+
+void WaitList::remove(std::coroutine_handle<> handle) {
+	auto found{ std::find(m_waiting.begin(), m_waiting.end(), handle) };
+	if (found != m_waiting.end()) {
+		m_waiting.erase(found);
+	}
+}
+
+void WaitList::resumeAll() {
+	std::vector<std::coroutine_handle<>> waiting{};
+	std::swap(waiting, m_waiting);
+	for (auto handle : waiting) {
+		handle.resume();
+	}
+}
+
+void StateFlag::set(bool value) {
+	if (change(value)) {
+		resumeWaiting();
+	}
+}
+
+bool StateFlag::change(bool value) {
+	if (value == m_value) {
+		return false;
+	}
+	m_value = value;
+	return true;
+}
+
+void StateFlag::resumeWaiting() {
+	m_waiting[m_value].resumeAll();
+}
+
+ScriptScheduler::ScriptScheduler(float tickLength) :
+	m_wheel{ tickLength } {
+}
+
+ScriptScheduler::~ScriptScheduler() {
+	if (m_animator) {
+		m_animator->setFinishedCallback(nullptr);
+	}
+	// Destroying the scripts takes them off every list and wheel they wait on, which must still
+	// exist.
+	m_scripts.clear();
+}
+
+void ScriptScheduler::watch(Animator& animator) {
+	m_animator = &animator;
+	m_animator->setFinishedCallback([this](uint32_t sequence) {
+		auto found{ m_sequenceWaits.find(sequence) };
+		if (found != m_sequenceWaits.end()) {
+			found->second.resumeAll();
+		}
+	});
+}
+
+WaitAwaiter ScriptScheduler::sequenceFinished(uint32_t sequence) {
+	return WaitAwaiter{ m_sequenceWaits[sequence], !m_animator->isRunning(sequence) };
+}
+
+void ScriptScheduler::spawn(Script script) {
+	if (!script.done()) {
+		m_scripts.push_back(std::move(script));
+	}
+}
+
+void ScriptScheduler::advance(float dt) {
+	m_wheel.advance(dt);
+	// Scripts also finish when an animation or a flag resumes them, so they are collected here.
+	std::erase_if(m_scripts, [](const Script& script) { return script.done(); });
+}
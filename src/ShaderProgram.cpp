@@ -1,5 +1,6 @@
 #include "ShaderProgram.h"
 #include <glad/glad.h>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -8,7 +9,59 @@ ShaderProgram::ShaderProgram()
 	: m_programId(-1) {
 }
 
-void ShaderProgram::load(const std::string& vertexShaderPath, const std::string& fragmentShaderPath) {
+namespace {
+	std::string readShaderFile(const std::filesystem::path& path);
+
+	// Replaces each line #include "name" with the contents of the file of that name beside the
+	// shader, since GLSL itself has no #include.
+	std::string resolveIncludes(const std::string& code, const std::filesystem::path& directory) {
+		std::istringstream lines{ code };
+		std::string result{};
+		std::string line{};
+		while (std::getline(lines, line)) {
+			if (line.rfind("#include \"", 0) == 0) {
+				size_t end{ line.find('"', 10) };
+				if (end == std::string::npos) {
+					throw std::runtime_error("Malformed shader include: " + line);
+				}
+				result += readShaderFile(directory / line.substr(10, end - 10));
+			}
+			else {
+				result += line + "\n";
+			}
+		}
+		return result;
+	}
+
+	std::string readShaderFile(const std::filesystem::path& path) {
+		std::ifstream file{ path };
+		if (!file) {
+			throw std::runtime_error("Failed to locate shader file " + path.string());
+		}
+		std::stringstream stream;
+		stream << file.rdbuf();
+		return resolveIncludes(stream.str(), path.parent_path());
+	}
+
+	std::string insertDefines(const std::string& code, const std::vector<std::string>& defines) {
+		if (defines.empty()) {
+			return code;
+		}
+		std::string block{};
+		for (auto& d : defines) {
+			block += "#define " + d + "\n";
+		}
+		// #version must stay the first line.
+		size_t afterVersion{ code.find('\n') };
+		if (afterVersion == std::string::npos) {
+			return code + "\n" + block;
+		}
+		return code.substr(0, afterVersion + 1) + block + code.substr(afterVersion + 1);
+	}
+}
+
+void ShaderProgram::load(const std::string& vertexShaderPath, const std::string& fragmentShaderPath,
+	const std::vector<std::string>& defines) {
 	std::string vertexCode;
 	std::string fragmentCode;
 	std::ifstream vShaderFile;
@@ -29,8 +82,10 @@ void ShaderProgram::load(const std::string& vertexShaderPath, const std::string&
 		vShaderFile.close();
 		fShaderFile.close();
 		// convert stream into string
-		vertexCode = vShaderStream.str();
-		fragmentCode = fShaderStream.str();
+		vertexCode = insertDefines(resolveIncludes(vShaderStream.str(),
+			std::filesystem::path{ vertexShaderPath }.parent_path()), defines);
+		fragmentCode = insertDefines(resolveIncludes(fShaderStream.str(),
+			std::filesystem::path{ fragmentShaderPath }.parent_path()), defines);
 	}
 	catch (std::ifstream::failure&) {
 		throw std::runtime_error("Failed to locate vertex or fragment shader files");
@@ -82,6 +137,53 @@ void ShaderProgram::load(const std::string& vertexShaderPath, const std::string&
 	glDeleteShader(fragment);
 }
 
+void ShaderProgram::loadTransformFeedback(const std::string& vertexShaderPath, const std::vector<std::string>& varyings,
+	const std::vector<std::string>& defines) {
+	std::string vertexCode;
+	std::ifstream vShaderFile;
+	vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+	try {
+		vShaderFile.open(vertexShaderPath);
+		std::stringstream vShaderStream;
+		vShaderStream << vShaderFile.rdbuf();
+		vShaderFile.close();
+		vertexCode = insertDefines(resolveIncludes(vShaderStream.str(),
+			std::filesystem::path{ vertexShaderPath }.parent_path()), defines);
+	}
+	catch (std::ifstream::failure&) {
+		throw std::runtime_error("Failed to locate vertex shader file");
+	}
+
+	const char* vShaderCode{ vertexCode.c_str() };
+	int success;
+	char infoLog[512];
+
+	unsigned int vertex{ glCreateShader(GL_VERTEX_SHADER) };
+	glShaderSource(vertex, 1, &vShaderCode, NULL);
+	glCompileShader(vertex);
+	glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+	if (!success) {
+		glGetShaderInfoLog(vertex, 512, NULL, infoLog);
+		throw std::runtime_error(infoLog);
+	}
+
+	// The captured outputs must be named before the program is linked.
+	std::vector<const char*> names{};
+	for (auto& v : varyings) {
+		names.push_back(v.c_str());
+	}
+	m_programId = glCreateProgram();
+	glAttachShader(m_programId, vertex);
+	glTransformFeedbackVaryings(m_programId, static_cast<GLsizei>(names.size()), names.data(), GL_SEPARATE_ATTRIBS);
+	glLinkProgram(m_programId);
+	glGetProgramiv(m_programId, GL_LINK_STATUS, &success);
+	if (!success) {
+		glGetProgramInfoLog(m_programId, 512, NULL, infoLog);
+		throw std::runtime_error(infoLog);
+	}
+	glDeleteShader(vertex);
+}
+
 void ShaderProgram::activate() {
 	glUseProgram(m_programId);
 }
@@ -121,3 +223,7 @@ void ShaderProgram::setUniform(const std::string& uniformName, const glm::mat3&
 void ShaderProgram::setUniform(const std::string& uniformName, const glm::mat4& value) {
 	glUniformMatrix4fv(glGetUniformLocation(m_programId, uniformName.c_str()), 1, false, &value[0][0]);
 }
+
+void ShaderProgram::setUniform(const std::string& uniformName, const glm::vec3* values, size_t count) {
+	glUniform3fv(glGetUniformLocation(m_programId, uniformName.c_str()), static_cast<GLsizei>(count), &values[0][0]);
+}
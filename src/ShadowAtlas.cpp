@@ -0,0 +1,194 @@
+#include "ShadowAtlas.h"
+#include "LightClusters.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+ShadowAtlas::ShadowAtlas(ShaderProgram depthProgram, uint32_t tilesPerSide, uint32_t tileResolution) :
+	m_depthProgram{ std::move(depthProgram) },
+	m_tilesPerSide{ tilesPerSide },
+	m_tileResolution{ tileResolution },
+	m_tiles(tilesPerSide * tilesPerSide, Tile{ ShadowView{}, false }),
+	m_staticFbo{ 0 }, m_staticDepth{ 0 },
+	m_liveFbo{ 0 }, m_liveDepth{ 0 },
+	m_staticRenders{ 0 } {
+}
+
+ShadowAtlas::~ShadowAtlas() {
+	destroy();
+}
+
+void ShadowAtlas::assignSampler(ShaderProgram& program) {
+	program.setUniform("shadowAtlas", ATLAS_UNIT);
+	program.setUniform("directionalShadowTile", -1);
+}
+
+ShadowView ShadowAtlas::spotView(const PointLight& light) {
+	glm::vec3 direction{ glm::normalize(light.direction) };
+	// lookAt needs an up vector that isn't parallel to the view direction.
+	glm::vec3 up{ std::abs(direction.y) > 0.99f ? glm::vec3{ 1, 0, 0 } : glm::vec3{ 0, 1, 0 } };
+	float fov{ 2.0f * std::acos(std::clamp(light.cosOuter, std::cos(1.45f), 1.0f)) };
+	return ShadowView{
+		glm::lookAt(light.position, light.position + direction, up),
+		glm::perspective(fov, 1.0f, 0.05f, light.radius)
+	};
+}
+
+ShadowView ShadowAtlas::directionalView(const glm::vec3& direction, const glm::vec3& center, float radius) {
+	glm::vec3 d{ glm::normalize(direction) };
+	glm::vec3 up{ std::abs(d.y) > 0.99f ? glm::vec3{ 1, 0, 0 } : glm::vec3{ 0, 1, 0 } };
+	glm::vec3 eye{ center - d * (2.0f * radius) };
+	return ShadowView{
+		glm::lookAt(eye, center, up),
+		glm::ortho(-radius, radius, -radius, radius, 0.1f, 4.0f * radius)
+	};
+}
+
+namespace {
+	uint32_t createShadowDepth(uint32_t size) {
+		uint32_t id;
+		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D, id);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+		// Linear filtering on a comparison sampler gives 2x2 percentage-closer filtering for free.
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return id;
+	}
+
+	uint32_t createDepthOnlyFbo(uint32_t depthTexture) {
+		uint32_t fbo;
+		glGenFramebuffers(1, &fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		return fbo;
+	}
+}
+
+void ShadowAtlas::allocate() {
+	uint32_t size{ m_tilesPerSide * m_tileResolution };
+	m_staticDepth = createShadowDepth(size);
+	m_liveDepth = createShadowDepth(size);
+	m_staticFbo = createDepthOnlyFbo(m_staticDepth);
+	m_liveFbo = createDepthOnlyFbo(m_liveDepth);
+}
+
+void ShadowAtlas::destroy() {
+	if (m_staticFbo != 0) {
+		uint32_t fbos[]{ m_staticFbo, m_liveFbo };
+		uint32_t textures[]{ m_staticDepth, m_liveDepth };
+		glDeleteFramebuffers(2, fbos);
+		glDeleteTextures(2, textures);
+		m_staticFbo = 0;
+	}
+}
+
+void ShadowAtlas::setTileResolution(uint32_t resolution) {
+	if (resolution == m_tileResolution) {
+		return;
+	}
+	m_tileResolution = resolution;
+	destroy();
+	invalidateStatic();
+}
+
+void ShadowAtlas::setStaticCasters(std::vector<const Object3D*> casters) {
+	m_staticCasters = std::move(casters);
+	invalidateStatic();
+}
+
+void ShadowAtlas::setDynamicCasters(std::vector<const Object3D*> casters) {
+	m_dynamicCasters = std::move(casters);
+}
+
+void ShadowAtlas::invalidateStatic() {
+	for (auto& tile : m_tiles) {
+		tile.staticValid = false;
+	}
+}
+
+void ShadowAtlas::setTileViewport(size_t tile) const {
+	int32_t x{ static_cast<int32_t>((tile % m_tilesPerSide) * m_tileResolution) };
+	int32_t y{ static_cast<int32_t>((tile / m_tilesPerSide) * m_tileResolution) };
+	glViewport(x, y, m_tileResolution, m_tileResolution);
+	glScissor(x, y, m_tileResolution, m_tileResolution);
+}
+
+void ShadowAtlas::renderCasters(const std::vector<const Object3D*>& casters, const ShadowView& view) {
+	m_depthProgram.setUniform("view", view.view);
+	m_depthProgram.setUniform("projection", view.projection);
+	for (auto* caster : casters) {
+		caster->renderDepth(m_depthProgram);
+	}
+}
+
+void ShadowAtlas::update(const std::vector<ShadowView>& views) {
+	if (m_staticFbo == 0) {
+		allocate();
+	}
+	m_staticRenders = 0;
+
+	m_depthProgram.activate();
+	glEnable(GL_SCISSOR_TEST);
+	glEnable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(2.0f, 4.0f);
+
+	size_t count{ std::min<size_t>(views.size(), m_tiles.size()) };
+	for (size_t i{ 0 }; i < count; ++i) {
+		Tile& tile{ m_tiles[i] };
+		setTileViewport(i);
+
+		// Re-render the static cache only when the light or the static content changed.
+		if (!tile.staticValid || !(tile.view == views[i])) {
+			tile.view = views[i];
+			glBindFramebuffer(GL_FRAMEBUFFER, m_staticFbo);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			renderCasters(m_staticCasters, tile.view);
+			tile.staticValid = true;
+			++m_staticRenders;
+		}
+
+		// Start the live tile from the cached static depth, then add this frame's dynamic casters.
+		int32_t x{ static_cast<int32_t>((i % m_tilesPerSide) * m_tileResolution) };
+		int32_t y{ static_cast<int32_t>((i / m_tilesPerSide) * m_tileResolution) };
+		int32_t size{ static_cast<int32_t>(m_tileResolution) };
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_staticFbo);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_liveFbo);
+		glBlitFramebuffer(x, y, x + size, y + size, x, y, x + size, y + size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_liveFbo);
+		renderCasters(m_dynamicCasters, tile.view);
+	}
+
+	glDisable(GL_POLYGON_OFFSET_FILL);
+	glDisable(GL_SCISSOR_TEST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ShadowAtlas::bind(ShaderProgram& program) const {
+	// Maps clip space [-1, 1] to texture space [0, 1].
+	const glm::mat4 bias{
+		0.5f, 0.0f, 0.0f, 0.0f,
+		0.0f, 0.5f, 0.0f, 0.0f,
+		0.0f, 0.0f, 0.5f, 0.0f,
+		0.5f, 0.5f, 0.5f, 1.0f
+	};
+	float tileScale{ 1.0f / m_tilesPerSide };
+	for (size_t i{ 0 }; i < std::min<size_t>(m_tiles.size(), MAX_SHADOWS); ++i) {
+		std::string index{ "[" + std::to_string(i) + "]" };
+		program.setUniform("shadowMatrices" + index, bias * m_tiles[i].view.projection * m_tiles[i].view.view);
+		program.setUniform("shadowTileRects" + index,
+			glm::vec3{ (i % m_tilesPerSide) * tileScale, (i / m_tilesPerSide) * tileScale, tileScale });
+	}
+	glActiveTexture(GL_TEXTURE0 + ATLAS_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_liveDepth);
+	glActiveTexture(GL_TEXTURE0);
+}
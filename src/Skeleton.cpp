@@ -0,0 +1,119 @@
+#include "Skeleton.h"
+#include "Simd.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+	/**
+	 * @brief out = a * b, for column-major matrices. Each column of the result is a combination
+	 * of a's columns, weighted by the matching column of b.
+	 */
+	void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) {
+#ifdef SIMD_SSE
+		const float* pa{ &a[0][0] };
+		const float* pb{ &b[0][0] };
+		__m128 a0{ _mm_loadu_ps(pa) };
+		__m128 a1{ _mm_loadu_ps(pa + 4) };
+		__m128 a2{ _mm_loadu_ps(pa + 8) };
+		__m128 a3{ _mm_loadu_ps(pa + 12) };
+		float* po{ &out[0][0] };
+		for (int c{ 0 }; c < 4; ++c) {
+			const float* column{ pb + 4 * c };
+			__m128 r{ _mm_mul_ps(a0, _mm_set1_ps(column[0])) };
+			r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(column[1])));
+			r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(column[2])));
+			r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(column[3])));
+			_mm_storeu_ps(po + 4 * c, r);
+		}
+#else
+		out = a * b;
+#endif
+	}
+}
+
+uint32_t Skeleton::addJoint(std::string name, int32_t parent, const glm::mat4& bindLocal) {
+	m_joints.push_back(Joint{ std::move(name), parent, bindLocal });
+	return static_cast<uint32_t>(m_joints.size() - 1);
+}
+
+uint32_t Skeleton::addSkin(uint32_t meshJoint, std::vector<SkinBone> bones) {
+	glm::mat4 meshBind{ 1 };
+	for (int32_t j{ static_cast<int32_t>(meshJoint) }; j >= 0; j = m_joints[j].parent) {
+		meshBind = m_joints[j].bindLocal * meshBind;
+	}
+	uint32_t offset{ m_paletteSize };
+	m_paletteSize += static_cast<uint32_t>(bones.size());
+	m_skins.push_back(Skin{ meshJoint, glm::inverse(meshBind), offset, std::move(bones) });
+	return offset;
+}
+
+void Skeleton::addClip(CompressedClip clip) {
+	m_clips.push_back(std::move(clip));
+}
+
+const CompressedClip* Skeleton::findClip(const std::string& name) const {
+	for (auto& clip : m_clips) {
+		if (clip.name() == name) {
+			return &clip;
+		}
+	}
+	return nullptr;
+}
+
+int32_t Skeleton::findJoint(const std::string& name) const {
+	for (size_t i{ 0 }; i < m_joints.size(); ++i) {
+		if (m_joints[i].name == name) {
+			return static_cast<int32_t>(i);
+		}
+	}
+	return -1;
+}
+
+void Skeleton::bindPose(std::vector<glm::mat4>& locals) const {
+	locals.resize(m_joints.size());
+	for (size_t i{ 0 }; i < m_joints.size(); ++i) {
+		locals[i] = m_joints[i].bindLocal;
+	}
+}
+
+std::vector<float> Skeleton::jointReach() const {
+	std::vector<glm::mat4> locals{};
+	std::vector<glm::mat4> globals{};
+	bindPose(locals);
+	computeGlobals(locals, globals);
+	// Children come after their parents, so walking backwards finishes each joint's subtree
+	// before its parent adds it.
+	std::vector<float> reach(m_joints.size(), 0.0f);
+	for (size_t i{ m_joints.size() }; i-- > 0;) {
+		int32_t parent{ m_joints[i].parent };
+		if (parent >= 0) {
+			float bone{ glm::distance(glm::vec3{ globals[parent][3] }, glm::vec3{ globals[i][3] }) };
+			reach[parent] = std::max(reach[parent], bone + reach[i]);
+		}
+	}
+	return reach;
+}
+
+void Skeleton::computeGlobals(const std::vector<glm::mat4>& locals, std::vector<glm::mat4>& globals) const {
+	globals.resize(m_joints.size());
+	for (size_t i{ 0 }; i < m_joints.size(); ++i) {
+		int32_t parent{ m_joints[i].parent };
+		if (parent < 0) {
+			globals[i] = locals[i];
+		}
+		else {
+			multiply(globals[parent], locals[i], globals[i]);
+		}
+	}
+}
+
+void Skeleton::computePalette(const std::vector<glm::mat4>& globals, std::vector<glm::mat4>& palette) const {
+	palette.resize(m_paletteSize);
+	glm::mat4 jointToMesh;
+	for (auto& skin : m_skins) {
+		for (size_t b{ 0 }; b < skin.bones.size(); ++b) {
+			multiply(skin.inverseMeshBind, globals[skin.bones[b].joint], jointToMesh);
+			multiply(jointToMesh, skin.bones[b].offset, palette[skin.paletteOffset + b]);
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#include "SkeletonPose.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <utility>
+
+SkeletonPose::SkeletonPose(std::shared_ptr<const Skeleton> skeleton) :
+	m_skeleton{ std::move(skeleton) }, m_buffer{ 0 }, m_texture{ 0 } {
+	m_skeleton->bindPose(m_locals);
+	update();
+
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+	// An empty buffer cannot back a texture, so reserve at least one matrix.
+	glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(m_palette.size(), 1) * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+	glGenTextures(1, &m_texture);
+	glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_buffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	upload();
+}
+
+SkeletonPose::~SkeletonPose() {
+	glDeleteTextures(1, &m_texture);
+	glDeleteBuffers(1, &m_buffer);
+}
+
+void SkeletonPose::resetToBind() {
+	m_skeleton->bindPose(m_locals);
+	m_changed = true;
+}
+
+void SkeletonPose::update() {
+	m_skeleton->computeGlobals(m_locals, m_globals);
+	m_skeleton->computePalette(m_globals, m_palette);
+	m_changed = false;
+}
+
+void SkeletonPose::upload() {
+	if (m_palette.empty()) {
+		return;
+	}
+	// Orphan the previous frame's palette, so the upload doesn't wait on draws still reading it.
+	glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+	glBufferData(GL_TEXTURE_BUFFER, m_palette.size() * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_TEXTURE_BUFFER, 0, m_palette.size() * sizeof(glm::mat4), &m_palette[0]);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void SkeletonPose::bind(ShaderProgram& program) const {
+	program.setUniform("bonePalette", PALETTE_UNIT);
+	glActiveTexture(GL_TEXTURE0 + PALETTE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+	glActiveTexture(GL_TEXTURE0);
+}
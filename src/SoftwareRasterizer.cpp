@@ -0,0 +1,398 @@
+#include "SoftwareRasterizer.h"
+#include "Simd.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+	// Triangles set up per chunk of a draw, in parallel.
+	constexpr size_t SETUP_CHUNK = 1024;
+	constexpr size_t VERTEX_CHUNK = 4096;
+
+	int32_t wrap(int32_t i, int32_t n) {
+		int32_t m{ i % n };
+		return m < 0 ? m + n : m;
+	}
+
+	glm::vec4 texel(const SoftwareTexture& texture, int32_t x, int32_t y) {
+		const uint8_t* t{ &texture.texels[(static_cast<size_t>(y) * texture.width + x) * 4] };
+		return glm::vec4(t[0], t[1], t[2], t[3]) * (1.0f / 255.0f);
+	}
+
+	// Diffuse and specular Phong terms of one light arriving from lightDir, as lighting.frag has them.
+	glm::vec3 phong(const glm::vec4& material, const glm::vec3& norm, const glm::vec3& eyeDir, const glm::vec3& lightDir,
+		const glm::vec3& color) {
+		float lambertFactor{ glm::dot(norm, lightDir) };
+		if (lambertFactor <= 0) {
+			return glm::vec3{ 0 };
+		}
+		glm::vec3 result{ material.y * color * lambertFactor };
+		glm::vec3 reflectDir{ glm::normalize(glm::reflect(-lightDir, norm)) };
+		float spec{ glm::dot(reflectDir, eyeDir) };
+		if (spec > 0) {
+			result += material.z * color * std::pow(spec, material.w);
+		}
+		return result;
+	}
+
+	// The edge function of a to b at p, scaled by twice the area it spans; positive on its left.
+	struct Edge {
+		float a;
+		float b;
+		float c;
+		// Whether pixels exactly on the edge belong to this triangle, so that a pixel on an edge
+		// two triangles share is drawn by exactly one of them.
+		bool inclusive;
+
+		Edge(const glm::vec2& from, const glm::vec2& to, float sign) {
+			a = (from.y - to.y) * sign;
+			b = (to.x - from.x) * sign;
+			c = (from.x * to.y - from.y * to.x) * sign;
+			inclusive = a > 0 || (a == 0 && b > 0);
+		}
+
+		float at(float x, float y) const { return a * x + b * y + c; }
+	};
+}
+
+glm::vec4 SoftwareTexture::sample(glm::vec2 uv) const {
+	if (texels.empty()) {
+		return glm::vec4{ 1 };
+	}
+	float x{ uv.x * width - 0.5f };
+	float y{ uv.y * height - 0.5f };
+	float fx{ std::floor(x) };
+	float fy{ std::floor(y) };
+	// Coordinates far from the texture lose their fraction to rounding; wrap them in first.
+	int32_t x0{ wrap(static_cast<int32_t>(std::fmod(fx, static_cast<float>(width))), width) };
+	int32_t y0{ wrap(static_cast<int32_t>(std::fmod(fy, static_cast<float>(height))), height) };
+	int32_t x1{ (x0 + 1) % width };
+	int32_t y1{ (y0 + 1) % height };
+	float tx{ x - fx };
+	float ty{ y - fy };
+	return glm::mix(glm::mix(texel(*this, x0, y0), texel(*this, x1, y0), tx),
+		glm::mix(texel(*this, x0, y1), texel(*this, x1, y1), tx), ty);
+}
+
+SoftwareTexture SoftwareTexture::readBack(uint32_t textureId) {
+	SoftwareTexture texture{};
+	glBindTexture(GL_TEXTURE_2D, textureId);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &texture.width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &texture.height);
+	if (texture.width > 0 && texture.height > 0) {
+		texture.texels.resize(static_cast<size_t>(texture.width) * texture.height * 4);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, texture.texels.data());
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return texture;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(int32_t width, int32_t height, WorkerPool& pool) :
+	m_pool{ pool },
+	m_width{ width },
+	m_height{ height },
+	m_tilesX{ (width + TILE_SIZE - 1) / TILE_SIZE },
+	m_tilesY{ (height + TILE_SIZE - 1) / TILE_SIZE },
+	m_color(static_cast<size_t>(width) * height * 3),
+	m_depth(static_cast<size_t>(width) * height),
+	m_bins(static_cast<size_t>(m_tilesX) * m_tilesY) {
+}
+
+void SoftwareRasterizer::beginFrame(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos,
+	const SoftwareLighting& lighting) {
+	m_viewProjection = projection * view;
+	m_viewPos = viewPos;
+	m_lighting = lighting;
+	for (uint32_t id : m_renderTargets) {
+		m_textureCache.erase(id);
+	}
+	m_draws.clear();
+	m_drawLights.clear();
+	m_triangles.clear();
+	for (auto& bin : m_bins) {
+		bin.clear();
+	}
+	std::fill(m_color.begin(), m_color.end(), uint8_t{ 0 });
+	std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+}
+
+void SoftwareRasterizer::draw(const Mesh& mesh, const glm::mat4& model, const glm::vec4& material) {
+	auto found{ m_meshCache.find(&mesh) };
+	if (found == m_meshCache.end()) {
+		found = m_meshCache.emplace(&mesh, mesh.readBack()).first;
+	}
+	const SoftwareTexture* texture{ nullptr };
+	if (uint32_t id{ found->second.baseTexture }; id != 0) {
+		auto cached{ m_textureCache.find(id) };
+		if (cached == m_textureCache.end()) {
+			cached = m_textureCache.emplace(id, SoftwareTexture::readBack(id)).first;
+		}
+		texture = &cached->second;
+	}
+	draw(found->second, texture, model, material);
+}
+
+void SoftwareRasterizer::draw(const SoftwareMesh& mesh, const SoftwareTexture* texture, const glm::mat4& model,
+	const glm::vec4& material) {
+	if (mesh.indices.size() < 3) {
+		return;
+	}
+
+	// Only lights whose reach overlaps the mesh's world bounds are shaded for it.
+	glm::vec3 worldMin{ std::numeric_limits<float>::max() };
+	glm::vec3 worldMax{ std::numeric_limits<float>::lowest() };
+	for (int32_t corner{ 0 }; corner < 8; ++corner) {
+		glm::vec3 local{
+			(corner & 1) ? mesh.boundsMax.x : mesh.boundsMin.x,
+			(corner & 2) ? mesh.boundsMax.y : mesh.boundsMin.y,
+			(corner & 4) ? mesh.boundsMax.z : mesh.boundsMin.z
+		};
+		glm::vec3 world{ model * glm::vec4{ local, 1 } };
+		worldMin = glm::min(worldMin, world);
+		worldMax = glm::max(worldMax, world);
+	}
+	uint32_t drawIndex{ static_cast<uint32_t>(m_draws.size()) };
+	Draw draw{ texture, material, static_cast<uint32_t>(m_drawLights.size()), 0 };
+	for (uint32_t l{ 0 }; l < m_lighting.lights.size(); ++l) {
+		auto& light{ m_lighting.lights[l] };
+		glm::vec3 nearest{ glm::clamp(light.position, worldMin, worldMax) };
+		if (glm::dot(nearest - light.position, nearest - light.position) < light.radius * light.radius) {
+			m_drawLights.push_back(l);
+			++draw.lightsCount;
+		}
+	}
+	m_draws.push_back(draw);
+
+	// Transform the vertices, as the vertex shader does.
+	glm::mat4 clipFromModel{ m_viewProjection * model };
+	glm::mat3 normalMatrix{ glm::transpose(glm::inverse(glm::mat3{ model })) };
+	m_vertices.resize(mesh.positions.size());
+	m_pool.parallelFor(mesh.positions.size(), VERTEX_CHUNK, [&](size_t begin, size_t end) {
+		for (size_t v{ begin }; v < end; ++v) {
+			glm::vec4 position{ mesh.positions[v], 1 };
+			m_vertices[v] = ClipVertex{ clipFromModel * position, glm::vec3{ model * position },
+				normalMatrix * mesh.normals[v], mesh.texCoords[v] };
+		}
+	});
+
+	// Clip and set up the triangles a chunk at a time, then bin them in order.
+	size_t triangleCount{ mesh.indices.size() / 3 };
+	size_t chunks{ (triangleCount + SETUP_CHUNK - 1) / SETUP_CHUNK };
+	std::vector<std::vector<Triangle>> chunkTriangles(chunks);
+	m_pool.parallelFor(chunks, 1, [&](size_t begin, size_t end) {
+		for (size_t chunk{ begin }; chunk < end; ++chunk) {
+			size_t last{ std::min(triangleCount, (chunk + 1) * SETUP_CHUNK) };
+			for (size_t t{ chunk * SETUP_CHUNK }; t < last; ++t) {
+				setUpTriangle(m_vertices[mesh.indices[t * 3]], m_vertices[mesh.indices[t * 3 + 1]],
+					m_vertices[mesh.indices[t * 3 + 2]], drawIndex, chunkTriangles[chunk]);
+			}
+		}
+	});
+	for (auto& triangles : chunkTriangles) {
+		for (auto& triangle : triangles) {
+			auto [lo, hi] { screenBounds(triangle) };
+			int32_t tx0{ std::max(static_cast<int32_t>(lo.x) / TILE_SIZE, 0) };
+			int32_t ty0{ std::max(static_cast<int32_t>(lo.y) / TILE_SIZE, 0) };
+			int32_t tx1{ std::min(static_cast<int32_t>(hi.x) / TILE_SIZE, m_tilesX - 1) };
+			int32_t ty1{ std::min(static_cast<int32_t>(hi.y) / TILE_SIZE, m_tilesY - 1) };
+			uint32_t index{ static_cast<uint32_t>(m_triangles.size()) };
+			m_triangles.push_back(triangle);
+			for (int32_t ty{ ty0 }; ty <= ty1; ++ty) {
+				for (int32_t tx{ tx0 }; tx <= tx1; ++tx) {
+					m_bins[static_cast<size_t>(ty) * m_tilesX + tx].push_back(index);
+				}
+			}
+		}
+	}
+}
+
+std::pair<glm::vec2, glm::vec2> SoftwareRasterizer::screenBounds(const Triangle& triangle) const {
+	// Vertices just in front of the camera can project far off the screen; only the screen matters.
+	glm::vec2 limit{ static_cast<float>(m_width), static_cast<float>(m_height) };
+	glm::vec2 lo{ glm::min(triangle.screen[0], glm::min(triangle.screen[1], triangle.screen[2])) };
+	glm::vec2 hi{ glm::max(triangle.screen[0], glm::max(triangle.screen[1], triangle.screen[2])) };
+	return { glm::clamp(lo, glm::vec2{ 0 }, limit), glm::clamp(hi, glm::vec2{ 0 }, limit) };
+}
+
+void SoftwareRasterizer::setUpTriangle(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, uint32_t draw,
+	std::vector<Triangle>& out) const {
+	// Triangles wholly outside one side of the view volume are dropped.
+	const ClipVertex* corners[3]{ &a, &b, &c };
+	for (int32_t axis{ 0 }; axis < 3; ++axis) {
+		bool allBelow{ true };
+		bool allAbove{ true };
+		for (auto* v : corners) {
+			allBelow = allBelow && v->clip[axis] < -v->clip.w;
+			allAbove = allAbove && v->clip[axis] > v->clip.w;
+		}
+		if (allBelow || allAbove) {
+			return;
+		}
+	}
+
+	// Clip to the near plane, z >= -w, which leaves at most a quad.
+	ClipVertex polygon[4];
+	int32_t count{ 0 };
+	for (int32_t i{ 0 }; i < 3; ++i) {
+		const ClipVertex& from{ *corners[i] };
+		const ClipVertex& to{ *corners[(i + 1) % 3] };
+		float dFrom{ from.clip.z + from.clip.w };
+		float dTo{ to.clip.z + to.clip.w };
+		if (dFrom >= 0) {
+			polygon[count++] = from;
+		}
+		if ((dFrom >= 0) != (dTo >= 0)) {
+			float t{ dFrom / (dFrom - dTo) };
+			polygon[count++] = ClipVertex{ glm::mix(from.clip, to.clip, t), glm::mix(from.world, to.world, t),
+				glm::mix(from.normal, to.normal, t), glm::mix(from.uv, to.uv, t) };
+		}
+	}
+
+	for (int32_t i{ 1 }; i + 1 < count; ++i) {
+		Triangle triangle{};
+		const ClipVertex* fan[3]{ &polygon[0], &polygon[i], &polygon[i + 1] };
+		for (int32_t v{ 0 }; v < 3; ++v) {
+			float invW{ 1.0f / fan[v]->clip.w };
+			glm::vec3 ndc{ glm::vec3{ fan[v]->clip } * invW };
+			triangle.screen[v] = glm::vec2{ (ndc.x * 0.5f + 0.5f) * m_width, (ndc.y * 0.5f + 0.5f) * m_height };
+			triangle.depth[v] = ndc.z * 0.5f + 0.5f;
+			triangle.invW[v] = invW;
+			triangle.world[v] = fan[v]->world;
+			triangle.normal[v] = fan[v]->normal;
+			triangle.uv[v] = fan[v]->uv;
+		}
+		triangle.draw = draw;
+		glm::vec2 e1{ triangle.screen[1] - triangle.screen[0] };
+		glm::vec2 e2{ triangle.screen[2] - triangle.screen[0] };
+		if (e1.x * e2.y - e1.y * e2.x != 0) {
+			out.push_back(triangle);
+		}
+	}
+}
+
+void SoftwareRasterizer::endFrame() {
+	// The busiest tiles go first, so that no thread is left with a heavy one at the end.
+	std::vector<int32_t> order(m_bins.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [this](int32_t a, int32_t b) { return m_bins[a].size() > m_bins[b].size(); });
+	m_pool.parallelFor(order.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i{ begin }; i < end; ++i) {
+			rasterizeTile(order[i]);
+		}
+	});
+}
+
+void SoftwareRasterizer::rasterizeTile(int32_t tile) {
+	int32_t tileX0{ (tile % m_tilesX) * TILE_SIZE };
+	int32_t tileY0{ (tile / m_tilesX) * TILE_SIZE };
+	int32_t tileX1{ std::min(tileX0 + TILE_SIZE, m_width) };
+	int32_t tileY1{ std::min(tileY0 + TILE_SIZE, m_height) };
+
+	for (uint32_t index : m_bins[tile]) {
+		const Triangle& triangle{ m_triangles[index] };
+		const glm::vec2* s{ triangle.screen };
+		float area{ (s[1].x - s[0].x) * (s[2].y - s[0].y) - (s[1].y - s[0].y) * (s[2].x - s[0].x) };
+		// Either winding is drawn, as with face culling off; the edges are turned to face inwards.
+		float sign{ area > 0 ? 1.0f : -1.0f };
+		float invArea{ 1.0f / std::abs(area) };
+		Edge edges[3]{ Edge{ s[1], s[2], sign }, Edge{ s[2], s[0], sign }, Edge{ s[0], s[1], sign } };
+
+		auto [lo, hi] { screenBounds(triangle) };
+		int32_t x0{ std::max(static_cast<int32_t>(std::floor(lo.x)), tileX0) };
+		int32_t y0{ std::max(static_cast<int32_t>(std::floor(lo.y)), tileY0) };
+		int32_t x1{ std::min(static_cast<int32_t>(std::ceil(hi.x)), tileX1) };
+		int32_t y1{ std::min(static_cast<int32_t>(std::ceil(hi.y)), tileY1) };
+		const Draw& draw{ m_draws[triangle.draw] };
+
+		for (int32_t y{ y0 }; y < y1; ++y) {
+			float py{ y + 0.5f };
+			for (int32_t x{ x0 }; x < x1; x += 4) {
+				float px{ x + 0.5f };
+				float w[3][4];
+				uint32_t inside{ 0 };
+#ifdef SIMD_SSE
+				const __m128 lanes{ _mm_set_ps(3, 2, 1, 0) };
+				__m128 mask{ _mm_castsi128_ps(_mm_set1_epi32(-1)) };
+				for (int32_t e{ 0 }; e < 3; ++e) {
+					__m128 value{ _mm_add_ps(_mm_set1_ps(edges[e].at(px, py)), _mm_mul_ps(_mm_set1_ps(edges[e].a), lanes)) };
+					_mm_storeu_ps(w[e], value);
+					__m128 test{ edges[e].inclusive ? _mm_cmpge_ps(value, _mm_setzero_ps()) : _mm_cmpgt_ps(value, _mm_setzero_ps()) };
+					mask = _mm_and_ps(mask, test);
+				}
+				inside = static_cast<uint32_t>(_mm_movemask_ps(mask));
+#else
+				for (int32_t lane{ 0 }; lane < 4; ++lane) {
+					bool in{ true };
+					for (int32_t e{ 0 }; e < 3; ++e) {
+						w[e][lane] = edges[e].at(px, py) + edges[e].a * lane;
+						in = in && (edges[e].inclusive ? w[e][lane] >= 0 : w[e][lane] > 0);
+					}
+					inside |= static_cast<uint32_t>(in) << lane;
+				}
+#endif
+				// Lanes past the tile's edge belong to the next tile.
+				inside &= (1u << std::min(x1 - x, 4)) - 1;
+				for (int32_t lane{ 0 }; inside != 0; ++lane, inside >>= 1) {
+					if (!(inside & 1)) {
+						continue;
+					}
+					float b0{ w[0][lane] * invArea };
+					float b1{ w[1][lane] * invArea };
+					float b2{ w[2][lane] * invArea };
+					float depth{ b0 * triangle.depth[0] + b1 * triangle.depth[1] + b2 * triangle.depth[2] };
+					size_t pixel{ static_cast<size_t>(y) * m_width + x + lane };
+					if (depth < 0 || depth >= m_depth[pixel]) {
+						continue;
+					}
+					m_depth[pixel] = depth;
+
+					// Perspective-correct weights, for what the fragment interpolates.
+					float q0{ b0 * triangle.invW[0] };
+					float q1{ b1 * triangle.invW[1] };
+					float q2{ b2 * triangle.invW[2] };
+					float invSum{ 1.0f / (q0 + q1 + q2) };
+					glm::vec3 color{ glm::clamp(shade(triangle, draw, q0 * invSum, q1 * invSum, q2 * invSum), 0.0f, 1.0f) };
+					m_color[pixel * 3] = static_cast<uint8_t>(color.x * 255.0f + 0.5f);
+					m_color[pixel * 3 + 1] = static_cast<uint8_t>(color.y * 255.0f + 0.5f);
+					m_color[pixel * 3 + 2] = static_cast<uint8_t>(color.z * 255.0f + 0.5f);
+				}
+			}
+		}
+	}
+}
+
+glm::vec3 SoftwareRasterizer::shade(const Triangle& triangle, const Draw& draw, float q0, float q1, float q2) const {
+	glm::vec3 world{ triangle.world[0] * q0 + triangle.world[1] * q1 + triangle.world[2] * q2 };
+	glm::vec3 normal{ triangle.normal[0] * q0 + triangle.normal[1] * q1 + triangle.normal[2] * q2 };
+	glm::vec2 uv{ triangle.uv[0] * q0 + triangle.uv[1] * q1 + triangle.uv[2] * q2 };
+	const glm::vec4& material{ draw.material };
+
+	// lighting.frag, without shadows or baked light.
+	glm::vec3 norm{ glm::normalize(normal) };
+	glm::vec3 eyeDir{ glm::normalize(m_viewPos - world) };
+	glm::vec3 lightIntensity{ material.x * m_lighting.ambientColor
+		+ phong(material, norm, eyeDir, glm::normalize(-m_lighting.directionalLight), m_lighting.directionalColor) };
+	for (uint32_t i{ draw.lightsBegin }; i < draw.lightsBegin + draw.lightsCount; ++i) {
+		const PointLight& light{ m_lighting.lights[m_drawLights[i]] };
+		glm::vec3 toLight{ light.position - world };
+		float distance{ glm::length(toLight) };
+		if (distance >= light.radius || distance == 0) {
+			continue;
+		}
+		glm::vec3 lightDir{ toLight / distance };
+		float falloff{ 1 - (distance * distance) / (light.radius * light.radius) };
+		float attenuation{ falloff * falloff };
+		if (light.cosOuter > -1) {
+			attenuation *= glm::smoothstep(light.cosOuter, light.cosInner, glm::dot(-lightDir, light.direction));
+		}
+		lightIntensity += attenuation * phong(material, norm, eyeDir, lightDir, light.color);
+	}
+
+	// texturing.frag's base texture.
+	glm::vec4 base{ draw.texture ? draw.texture->sample(uv) : glm::vec4{ 1 } };
+	return lightIntensity * glm::vec3{ base };
+}
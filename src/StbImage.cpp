@@ -17,10 +17,22 @@ void StbImage::loadFromFile(const std::string& filepath) {
     m_data = std::unique_ptr<unsigned char[]>(data);
 }
 
+void StbImage::loadHdrFromFile(const std::string& filepath) {
+    float* data{ stbi_loadf(filepath.c_str(), &m_width, &m_height, &m_bpp, 3) };
+
+    if (data == nullptr) {
+        throw std::runtime_error("Could not load file " + filepath);
+    }
+
+    m_hdrData = std::unique_ptr<float[]>(data);
+}
+
 int StbImage::getWidth() const { return m_width; }
 
 int StbImage::getHeight() const { return m_height; }
 
 int StbImage::getBpp() const { return m_bpp; }
 
-unsigned char* StbImage::getData() const { return m_data.get(); }
\ No newline at end of file
+unsigned char* StbImage::getData() const { return m_data.get(); }
+
+float* StbImage::getHdrData() const { return m_hdrData.get(); }
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "TimerWheel.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+TimerWheel::TimerWheel(float tickLength) :
+	m_tickLength{ tickLength }, m_heads(LEVELS * SLOTS, -1) {
+}
+
+void TimerWheel::link(int32_t timer) {
+	Timer& t{ m_timers[timer] };
+	// The finest level whose slots, counted from now, reach the expiry. Expiries beyond the
+	// coarsest level wait in its farthest slot, and are placed again when it cascades.
+	uint64_t delta{ t.expiry - m_now };
+	uint32_t level{ 0 };
+	while (level + 1 < LEVELS && delta >> (SLOT_BITS * (level + 1)) != 0) {
+		++level;
+	}
+	uint64_t expiry{ std::min(t.expiry, m_now + (uint64_t{ 1 } << (SLOT_BITS * LEVELS)) - 1) };
+	int32_t slot{ static_cast<int32_t>(level * SLOTS + ((expiry >> (SLOT_BITS * level)) & (SLOTS - 1))) };
+
+	t.slot = slot;
+	t.prev = -1;
+	t.next = m_heads[slot];
+	if (t.next >= 0) {
+		m_timers[t.next].prev = timer;
+	}
+	m_heads[slot] = timer;
+}
+
+void TimerWheel::unlink(int32_t timer) {
+	Timer& t{ m_timers[timer] };
+	if (t.prev >= 0) {
+		m_timers[t.prev].next = t.next;
+	}
+	else {
+		m_heads[t.slot] = t.next;
+	}
+	if (t.next >= 0) {
+		m_timers[t.next].prev = t.prev;
+	}
+	t.prev = -1;
+	t.next = -1;
+	t.slot = -1;
+}
+
+void TimerWheel::release(int32_t timer) {
+	m_timers[timer].callback = nullptr;
+	++m_timers[timer].generation;
+	m_free.push_back(timer);
+	--m_pending;
+}
+
+TimerWheel::TimerId TimerWheel::schedule(float delay, std::function<void()> callback) {
+	uint64_t ticks{ static_cast<uint64_t>(std::max(std::ceil(delay / m_tickLength), 1.0f)) };
+	int32_t timer;
+	if (m_free.empty()) {
+		timer = static_cast<int32_t>(m_timers.size());
+		m_timers.emplace_back();
+	}
+	else {
+		timer = m_free.back();
+		m_free.pop_back();
+	}
+	m_timers[timer].expiry = m_now + ticks;
+	m_timers[timer].callback = std::move(callback);
+	link(timer);
+	++m_pending;
+	return (static_cast<uint64_t>(m_timers[timer].generation) << 32) | static_cast<uint64_t>(timer + 1);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+	int64_t timer{ static_cast<int64_t>(id & 0xffffffffu) - 1 };
+	if (timer < 0 || timer >= static_cast<int64_t>(m_timers.size())
+		|| m_timers[timer].generation != static_cast<uint32_t>(id >> 32) || m_timers[timer].slot < 0) {
+		return false;
+	}
+	unlink(static_cast<int32_t>(timer));
+	release(static_cast<int32_t>(timer));
+	return true;
+}
+
+void TimerWheel::cascade(uint32_t level) {
+	int32_t slot{ static_cast<int32_t>(level * SLOTS + ((m_now >> (SLOT_BITS * level)) & (SLOTS - 1))) };
+	int32_t timer{ m_heads[slot] };
+	m_heads[slot] = -1;
+	while (timer >= 0) {
+		int32_t next{ m_timers[timer].next };
+		link(timer);
+		timer = next;
+	}
+}
+
+void TimerWheel::tick() {
+	++m_now;
+	// Each wheel that has come round pulls the next slot of the coarser one down, coarsest first.
+	for (uint32_t level{ LEVELS - 1 }; level > 0; --level) {
+		if ((m_now & ((uint64_t{ 1 } << (SLOT_BITS * level)) - 1)) == 0) {
+			cascade(level);
+		}
+	}
+	// Everything left in the finest wheel's slot expires now. The callback is moved out first, as
+	// it may schedule timers that reuse its own.
+	int32_t slot{ static_cast<int32_t>(m_now & (SLOTS - 1)) };
+	while (m_heads[slot] >= 0) {
+		int32_t timer{ m_heads[slot] };
+		unlink(timer);
+		std::function<void()> callback{ std::move(m_timers[timer].callback) };
+		release(timer);
+		callback();
+	}
+}
+
+void TimerWheel::advance(float dt) {
+	m_remainder += dt;
+	uint64_t ticks{ static_cast<uint64_t>(m_remainder / m_tickLength) };
+	m_remainder -= ticks * m_tickLength;
+	// With nothing pending there is nothing to fire or cascade.
+	if (m_pending == 0) {
+		m_now += ticks;
+		return;
+	}
+	for (uint64_t t{ 0 }; t < ticks; ++t) {
+		tick();
+	}
+}
@@ -0,0 +1,358 @@
+#include "TriangleBVH.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+	constexpr uint32_t SAH_BINS = 12;
+	constexpr uint32_t STACK_SIZE = 64;
+
+	struct Bounds {
+		glm::vec3 min{ std::numeric_limits<float>::max() };
+		glm::vec3 max{ -std::numeric_limits<float>::max() };
+
+		void grow(const glm::vec3& p) {
+			min = glm::min(min, p);
+			max = glm::max(max, p);
+		}
+		void grow(const Bounds& b) {
+			min = glm::min(min, b.min);
+			max = glm::max(max, b.max);
+		}
+		float area() const {
+			glm::vec3 e{ max - min };
+			if (e.x < 0) {
+				return 0;
+			}
+			return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+		}
+	};
+
+	/**
+	 * @brief Replaces zero direction components with a tiny value of the same sign, so their
+	 * reciprocals are huge rather than infinite and slab tests never compute 0 * inf.
+	 */
+	glm::vec3 safeInverse(const glm::vec3& d) {
+		glm::vec3 r;
+		for (int i{ 0 }; i < 3; ++i) {
+			float c{ std::abs(d[i]) < 1e-12f ? std::copysign(1e-12f, d[i]) : d[i] };
+			r[i] = 1.0f / c;
+		}
+		return r;
+	}
+}
+
+TriangleBVH::TriangleBVH(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+	build(positions, indices);
+}
+
+void TriangleBVH::build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+	size_t triangleCount{ indices.size() / 3 };
+	std::vector<Bounds> triBounds(triangleCount);
+	std::vector<glm::vec3> centroids(triangleCount);
+	for (size_t i{ 0 }; i < triangleCount; ++i) {
+		for (size_t k{ 0 }; k < 3; ++k) {
+			triBounds[i].grow(positions[indices[3 * i + k]]);
+		}
+		centroids[i] = (triBounds[i].min + triBounds[i].max) * 0.5f;
+	}
+
+	std::vector<uint32_t> order(triangleCount);
+	std::iota(order.begin(), order.end(), 0);
+
+	m_nodes.clear();
+	m_nodes.reserve(2 * triangleCount + 1);
+	m_nodes.push_back(Node{ glm::vec3{ 0 }, 0, glm::vec3{ 0 }, static_cast<uint32_t>(triangleCount) });
+
+	std::vector<uint32_t> pending{ 0 };
+	while (!pending.empty()) {
+		uint32_t nodeIndex{ pending.back() };
+		pending.pop_back();
+		uint32_t first{ m_nodes[nodeIndex].leftOrFirst };
+		uint32_t count{ m_nodes[nodeIndex].count };
+
+		Bounds bounds{}, centroidBounds{};
+		for (uint32_t i{ first }; i < first + count; ++i) {
+			bounds.grow(triBounds[order[i]]);
+			centroidBounds.grow(centroids[order[i]]);
+		}
+		m_nodes[nodeIndex].boundsMin = bounds.min;
+		m_nodes[nodeIndex].boundsMax = bounds.max;
+		if (count <= MAX_LEAF_SIZE) {
+			continue;
+		}
+
+		// Binned SAH: bucket centroids along each axis and evaluate every bucket boundary.
+		float bestCost{ std::numeric_limits<float>::max() };
+		int bestAxis{ -1 };
+		uint32_t bestSplit{ 0 };
+		glm::vec3 extent{ centroidBounds.max - centroidBounds.min };
+		for (int axis{ 0 }; axis < 3; ++axis) {
+			if (extent[axis] <= 0) {
+				continue;
+			}
+			Bounds binBounds[SAH_BINS]{};
+			uint32_t binCounts[SAH_BINS]{};
+			float scale{ SAH_BINS / extent[axis] };
+			for (uint32_t i{ first }; i < first + count; ++i) {
+				uint32_t bin{ std::min(SAH_BINS - 1, static_cast<uint32_t>((centroids[order[i]][axis] - centroidBounds.min[axis]) * scale)) };
+				++binCounts[bin];
+				binBounds[bin].grow(triBounds[order[i]]);
+			}
+			// Sweep from the right to accumulate the cost of everything right of each boundary.
+			float rightArea[SAH_BINS]{};
+			uint32_t rightCount[SAH_BINS]{};
+			Bounds right{};
+			uint32_t rightSum{ 0 };
+			for (uint32_t b{ SAH_BINS - 1 }; b > 0; --b) {
+				right.grow(binBounds[b]);
+				rightSum += binCounts[b];
+				rightArea[b] = right.area();
+				rightCount[b] = rightSum;
+			}
+			Bounds left{};
+			uint32_t leftSum{ 0 };
+			for (uint32_t b{ 1 }; b < SAH_BINS; ++b) {
+				left.grow(binBounds[b - 1]);
+				leftSum += binCounts[b - 1];
+				float cost{ leftSum * left.area() + rightCount[b] * rightArea[b] };
+				if (leftSum > 0 && rightCount[b] > 0 && cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = b;
+				}
+			}
+		}
+
+		uint32_t middle;
+		if (bestAxis >= 0) {
+			float scale{ SAH_BINS / extent[bestAxis] };
+			auto split{ std::partition(order.begin() + first, order.begin() + first + count, [&](uint32_t t) {
+				uint32_t bin{ std::min(SAH_BINS - 1, static_cast<uint32_t>((centroids[t][bestAxis] - centroidBounds.min[bestAxis]) * scale)) };
+				return bin < bestSplit;
+			}) };
+			middle = static_cast<uint32_t>(split - order.begin());
+		}
+		else {
+			// Every centroid coincides; split the range in half.
+			middle = first + count / 2;
+		}
+
+		uint32_t leftChild{ static_cast<uint32_t>(m_nodes.size()) };
+		m_nodes.push_back(Node{ glm::vec3{ 0 }, first, glm::vec3{ 0 }, middle - first });
+		m_nodes.push_back(Node{ glm::vec3{ 0 }, middle, glm::vec3{ 0 }, first + count - middle });
+		m_nodes[nodeIndex].leftOrFirst = leftChild;
+		m_nodes[nodeIndex].count = 0;
+		pending.push_back(leftChild);
+		pending.push_back(leftChild + 1);
+	}
+
+	// Store triangles in leaf order, so each leaf reads a contiguous run.
+	m_v0.resize(triangleCount);
+	m_e1.resize(triangleCount);
+	m_e2.resize(triangleCount);
+	m_original = std::move(order);
+	for (size_t i{ 0 }; i < triangleCount; ++i) {
+		uint32_t t{ m_original[i] };
+		const glm::vec3& a{ positions[indices[3 * t]] };
+		m_v0[i] = a;
+		m_e1[i] = positions[indices[3 * t + 1]] - a;
+		m_e2[i] = positions[indices[3 * t + 2]] - a;
+	}
+}
+
+template <bool AnyHit>
+bool TriangleBVH::traverse(const Ray& ray, RayHit& hit) const {
+	if (m_original.empty()) {
+		return false;
+	}
+	glm::vec3 invDir{ safeInverse(ray.direction) };
+	float tMax{ ray.tMax };
+	bool found{ false };
+
+	uint32_t stack[STACK_SIZE];
+	uint32_t top{ 0 };
+	stack[top++] = 0;
+	while (top > 0) {
+		const Node& node{ m_nodes[stack[--top]] };
+		glm::vec3 t1{ (node.boundsMin - ray.origin) * invDir };
+		glm::vec3 t2{ (node.boundsMax - ray.origin) * invDir };
+		glm::vec3 tNear{ glm::min(t1, t2) };
+		glm::vec3 tFar{ glm::max(t1, t2) };
+		float entry{ std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f)) };
+		float exit{ std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax)) };
+		if (entry > exit) {
+			continue;
+		}
+
+		if (node.count == 0) {
+			stack[top++] = node.leftOrFirst;
+			stack[top++] = node.leftOrFirst + 1;
+			continue;
+		}
+
+		for (uint32_t i{ node.leftOrFirst }; i < node.leftOrFirst + node.count; ++i) {
+			// Moller-Trumbore ray/triangle intersection.
+			glm::vec3 p{ glm::cross(ray.direction, m_e2[i]) };
+			float det{ glm::dot(m_e1[i], p) };
+			if (std::abs(det) < 1e-12f) {
+				continue;
+			}
+			float invDet{ 1.0f / det };
+			glm::vec3 s{ ray.origin - m_v0[i] };
+			float u{ glm::dot(s, p) * invDet };
+			if (u < 0 || u > 1) {
+				continue;
+			}
+			glm::vec3 q{ glm::cross(s, m_e1[i]) };
+			float v{ glm::dot(ray.direction, q) * invDet };
+			if (v < 0 || u + v > 1) {
+				continue;
+			}
+			float t{ glm::dot(m_e2[i], q) * invDet };
+			if (t > EPSILON && t < tMax) {
+				found = true;
+				if (AnyHit) {
+					return true;
+				}
+				tMax = t;
+				hit = RayHit{ t, m_original[i], u, v };
+			}
+		}
+	}
+	return found;
+}
+
+bool TriangleBVH::intersect(const Ray& ray, RayHit& hit) const {
+	return traverse<false>(ray, hit);
+}
+
+bool TriangleBVH::occluded(const Ray& ray) const {
+	RayHit unused{};
+	return traverse<true>(ray, unused);
+}
+
+template <bool AnyHit>
+uint32_t TriangleBVH::traverse4(const Ray* rays, RayHit* hits) const {
+#ifdef SIMD_SSE
+	if (m_original.empty()) {
+		return 0;
+	}
+	// The packet in structure-of-arrays form: one SSE lane per ray.
+	alignas(16) float lanes[10][4];
+	for (int r{ 0 }; r < 4; ++r) {
+		glm::vec3 inv{ safeInverse(rays[r].direction) };
+		lanes[0][r] = rays[r].origin.x; lanes[1][r] = rays[r].origin.y; lanes[2][r] = rays[r].origin.z;
+		lanes[3][r] = rays[r].direction.x; lanes[4][r] = rays[r].direction.y; lanes[5][r] = rays[r].direction.z;
+		lanes[6][r] = inv.x; lanes[7][r] = inv.y; lanes[8][r] = inv.z;
+		lanes[9][r] = rays[r].tMax;
+	}
+	const __m128 ox{ _mm_load_ps(lanes[0]) }, oy{ _mm_load_ps(lanes[1]) }, oz{ _mm_load_ps(lanes[2]) };
+	const __m128 dx{ _mm_load_ps(lanes[3]) }, dy{ _mm_load_ps(lanes[4]) }, dz{ _mm_load_ps(lanes[5]) };
+	const __m128 ix{ _mm_load_ps(lanes[6]) }, iy{ _mm_load_ps(lanes[7]) }, iz{ _mm_load_ps(lanes[8]) };
+	__m128 tMax{ _mm_load_ps(lanes[9]) };
+	const __m128 zero{ _mm_setzero_ps() }, one{ _mm_set1_ps(1.0f) };
+	const __m128 epsilon{ _mm_set1_ps(EPSILON) }, detEpsilon{ _mm_set1_ps(1e-12f) };
+	const __m128 signMask{ _mm_set1_ps(-0.0f) };
+
+	uint32_t hitMask{ 0 };
+	uint32_t stack[STACK_SIZE];
+	uint32_t top{ 0 };
+	stack[top++] = 0;
+	while (top > 0) {
+		const Node& node{ m_nodes[stack[--top]] };
+
+		// Slab test of the node's box against all four rays.
+		__m128 t1x{ _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.x), ox), ix) };
+		__m128 t2x{ _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.x), ox), ix) };
+		__m128 t1y{ _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.y), oy), iy) };
+		__m128 t2y{ _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.y), oy), iy) };
+		__m128 t1z{ _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.z), oz), iz) };
+		__m128 t2z{ _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.z), oz), iz) };
+		__m128 entry{ _mm_max_ps(_mm_max_ps(_mm_min_ps(t1x, t2x), _mm_min_ps(t1y, t2y)), _mm_max_ps(_mm_min_ps(t1z, t2z), zero)) };
+		__m128 exit{ _mm_min_ps(_mm_min_ps(_mm_max_ps(t1x, t2x), _mm_max_ps(t1y, t2y)), _mm_min_ps(_mm_max_ps(t1z, t2z), tMax)) };
+		if (_mm_movemask_ps(_mm_cmple_ps(entry, exit)) == 0) {
+			continue;
+		}
+
+		if (node.count == 0) {
+			stack[top++] = node.leftOrFirst;
+			stack[top++] = node.leftOrFirst + 1;
+			continue;
+		}
+
+		for (uint32_t i{ node.leftOrFirst }; i < node.leftOrFirst + node.count; ++i) {
+			// Moller-Trumbore against one triangle, four rays at a time.
+			__m128 e1x{ _mm_set1_ps(m_e1[i].x) }, e1y{ _mm_set1_ps(m_e1[i].y) }, e1z{ _mm_set1_ps(m_e1[i].z) };
+			__m128 e2x{ _mm_set1_ps(m_e2[i].x) }, e2y{ _mm_set1_ps(m_e2[i].y) }, e2z{ _mm_set1_ps(m_e2[i].z) };
+			__m128 px{ _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y)) };
+			__m128 py{ _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z)) };
+			__m128 pz{ _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x)) };
+			__m128 det{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz)) };
+			__m128 valid{ _mm_cmpgt_ps(_mm_andnot_ps(signMask, det), detEpsilon) };
+			__m128 invDet{ _mm_div_ps(one, det) };
+
+			__m128 sx{ _mm_sub_ps(ox, _mm_set1_ps(m_v0[i].x)) };
+			__m128 sy{ _mm_sub_ps(oy, _mm_set1_ps(m_v0[i].y)) };
+			__m128 sz{ _mm_sub_ps(oz, _mm_set1_ps(m_v0[i].z)) };
+			__m128 u{ _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet) };
+
+			__m128 qx{ _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y)) };
+			__m128 qy{ _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z)) };
+			__m128 qz{ _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x)) };
+			__m128 v{ _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet) };
+			__m128 t{ _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet) };
+
+			valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+			valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+			valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), one));
+			valid = _mm_and_ps(valid, _mm_cmpgt_ps(t, epsilon));
+			valid = _mm_and_ps(valid, _mm_cmplt_ps(t, tMax));
+			int mask{ _mm_movemask_ps(valid) };
+			if (mask == 0) {
+				continue;
+			}
+
+			hitMask |= static_cast<uint32_t>(mask);
+			if (AnyHit) {
+				// Blocked rays are finished: shrink their segment to nothing.
+				tMax = _mm_andnot_ps(valid, tMax);
+				if (hitMask == 0xF) {
+					return hitMask;
+				}
+				continue;
+			}
+			tMax = _mm_or_ps(_mm_and_ps(valid, t), _mm_andnot_ps(valid, tMax));
+			alignas(16) float ts[4], us[4], vs[4];
+			_mm_store_ps(ts, t);
+			_mm_store_ps(us, u);
+			_mm_store_ps(vs, v);
+			for (int r{ 0 }; r < 4; ++r) {
+				if (mask & (1 << r)) {
+					hits[r] = RayHit{ ts[r], m_original[i], us[r], vs[r] };
+				}
+			}
+		}
+	}
+	return hitMask;
+#else
+	uint32_t hitMask{ 0 };
+	for (int r{ 0 }; r < 4; ++r) {
+		RayHit unused{};
+		if (traverse<AnyHit>(rays[r], AnyHit ? unused : hits[r])) {
+			hitMask |= 1u << r;
+		}
+	}
+	return hitMask;
+#endif
+}
+
+uint32_t TriangleBVH::intersect4(const Ray rays[4], RayHit hits[4]) const {
+	return traverse4<false>(rays, hits);
+}
+
+uint32_t TriangleBVH::occluded4(const Ray rays[4]) const {
+	return traverse4<true>(rays, nullptr);
+}
@@ -0,0 +1,70 @@
+#include "VertexAnimation.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+VertexAnimation::VertexAnimation(std::string name, float duration, uint32_t frameCount) :
+	m_name{ std::move(name) }, m_duration{ duration }, m_frameCount{ frameCount } {
+}
+
+VertexAnimation VertexAnimation::bake(Object3D& model, const CompressedClip& clip, ShaderProgram& skinProgram,
+	const VertexAnimationSettings& settings) {
+	auto& pose{ model.getSkeletonPose() };
+	if (!pose) {
+		throw std::runtime_error("Only skinned models can bake vertex animations");
+	}
+
+	// One frame past the end, so that the last frame interpolates to the clip's final pose. The
+	// largest mesh's frames must also fit in the textures' height.
+	int32_t maxSize;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+	uint32_t maxRows{ 1 };
+	model.forEachMesh([&](Mesh& mesh) {
+		if (mesh.isSkinned()) {
+			maxRows = std::max(maxRows, (mesh.vertexCount() + maxSize - 1) / maxSize);
+		}
+	});
+	uint32_t frameCount{ static_cast<uint32_t>(std::ceil(clip.duration() * settings.frameRate)) + 1 };
+	frameCount = std::clamp(frameCount, 2u, std::min(settings.maxFrames, static_cast<uint32_t>(maxSize) / maxRows));
+
+	model.forEachMesh([&](Mesh& mesh) {
+		mesh.allocateVertexAnimation(frameCount, maxSize);
+	});
+
+	std::vector<glm::mat4> bindLocals{};
+	pose->skeleton().bindPose(bindLocals);
+	CompressedClipSampler sampler{ clip, bindLocals };
+	skinProgram.activate();
+	glEnable(GL_RASTERIZER_DISCARD);
+	for (uint32_t f{ 0 }; f < frameCount; ++f) {
+		pose->resetToBind();
+		sampler.sample(clip.duration() * f / (frameCount - 1), pose->locals());
+		pose->update();
+		pose->upload();
+		model.skin(skinProgram);
+		model.forEachMesh([f](Mesh& mesh) {
+			mesh.captureVertexAnimationFrame(f);
+		});
+	}
+
+	// Leave the posed buffers in the bind pose, as they were loaded.
+	pose->resetToBind();
+	pose->update();
+	pose->upload();
+	model.skin(skinProgram);
+	glDisable(GL_RASTERIZER_DISCARD);
+	return VertexAnimation{ clip.name(), clip.duration(), frameCount };
+}
+
+float VertexAnimation::frameAt(float time) const {
+	if (m_duration <= 0) {
+		return 0;
+	}
+	float looped{ std::fmod(time, m_duration) };
+	if (looped < 0) {
+		looped += m_duration;
+	}
+	return looped / m_duration * (m_frameCount - 1);
+}
@@ -0,0 +1,41 @@
+#include "VertexBaker.h"
+#include <algorithm>
+
+VertexBaker::VertexBaker(const BakeScene& scene, WorkerPool& pool, const VertexBakeSettings& settings) :
+	m_scene{ scene },
+	m_pool{ pool },
+	m_settings{ settings } {
+}
+
+VertexLighting VertexBaker::bake(size_t firstMesh, size_t meshCount) const {
+	const auto& meshes{ m_scene.meshes() };
+
+	// Every vertex of every mesh goes into one parallel loop, so small meshes don't leave
+	// threads idle; offsets map the loop index back to a mesh and vertex.
+	VertexLighting lighting(meshCount);
+	std::vector<size_t> offsets{ 0 };
+	for (size_t m{ 0 }; m < meshCount; ++m) {
+		lighting[m].resize(meshes[firstMesh + m].positions.size());
+		offsets.push_back(offsets.back() + lighting[m].size());
+	}
+
+	m_pool.parallelFor(offsets.back(), 64, [&](size_t begin, size_t end) {
+		size_t m{ static_cast<size_t>(std::upper_bound(offsets.begin(), offsets.end(), begin) - offsets.begin()) - 1 };
+		for (size_t i{ begin }; i < end; ++i) {
+			while (i >= offsets[m + 1]) {
+				++m;
+			}
+			const BakeMesh& mesh{ meshes[firstMesh + m] };
+			size_t v{ i - offsets[m] };
+			glm::vec3 normal{ mesh.normals.empty() ? glm::vec3{ 0, 1, 0 } : mesh.normals[v] };
+			glm::vec3 position{ mesh.positions[v] + normal * BakeScene::SURFACE_OFFSET };
+			uint32_t seed{ static_cast<uint32_t>(i) };
+
+			glm::vec3 irradiance{ m_scene.directIrradiance(position, normal)
+				+ m_scene.indirectIrradiance(position, normal, m_settings.samples, seed) };
+			float occlusion{ m_scene.ambientOcclusion(position, normal, m_settings.samples, m_settings.occlusionDistance, seed) };
+			lighting[m][v] = glm::vec4{ irradiance, occlusion };
+		}
+	});
+	return lighting;
+}
@@ -0,0 +1,89 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(uint32_t workers) :
+	m_job{ nullptr },
+	m_end{ 0 },
+	m_grain{ 1 },
+	m_next{ 0 },
+	m_generation{ 0 },
+	m_busy{ 0 },
+	m_stopping{ false } {
+	for (uint32_t i{ 0 }; i < workers; ++i) {
+		m_workers.emplace_back(&WorkerPool::workerLoop, this);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+	for (auto& worker : m_workers) {
+		worker.join();
+	}
+}
+
+uint32_t WorkerPool::defaultWorkerCount() {
+	uint32_t hardware{ std::thread::hardware_concurrency() };
+	return hardware > 1 ? hardware - 1 : 0;
+}
+
+void WorkerPool::runChunks() {
+	while (true) {
+		size_t begin{ m_next.fetch_add(m_grain) };
+		if (begin >= m_end) {
+			return;
+		}
+		(*m_job)(begin, std::min(begin + m_grain, m_end));
+	}
+}
+
+void WorkerPool::workerLoop() {
+	uint64_t seen{ 0 };
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			m_wake.wait(lock, [&] { return m_stopping || m_generation != seen; });
+			if (m_stopping) {
+				return;
+			}
+			seen = m_generation;
+		}
+		runChunks();
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			if (--m_busy == 0) {
+				m_done.notify_one();
+			}
+		}
+	}
+}
+
+void WorkerPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+	if (count == 0) {
+		return;
+	}
+	grain = std::max<size_t>(grain, 1);
+	if (m_workers.empty() || count <= grain) {
+		body(0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_job = &body;
+		m_end = count;
+		m_grain = grain;
+		m_next = 0;
+		m_busy = static_cast<uint32_t>(m_workers.size());
+		++m_generation;
+	}
+	m_wake.notify_all();
+	runChunks();
+
+	std::unique_lock<std::mutex> lock{ m_mutex };
+	m_done.wait(lock, [&] { return m_busy == 0; });
+	m_job = nullptr;
+}
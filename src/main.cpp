@@ -1,9 +1,15 @@
 #include <glad/glad.h>
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <filesystem>
 #include <numbers>
+#include <limits>
 #include <map>
+#include <cmath>
+#include <charconv>
+#include <optional>
+#include <random>
 #include <string>
 
 #include <SFML/Window/Event.hpp>
@@ -14,33 +20,141 @@
 #include "Mesh.h"
 #include "Object3D.h"
 #include "Animator.h"
+#include "FnafNight.h"
+#include "FixedTimestep.h"
+#include "Flythrough.h"
+#include "GlIntercept.h"
+#ifdef HEADLESS_EGL
+#include "HeadlessContext.h"
+#endif
+#include "InputRecording.h"
+#include "PassTimer.h"
 #include "ShaderProgram.h"
-#include <TranslationAnimation.h>
+#include "QualityGovernor.h"
+#include "DepthPrepass.h"
+#include "LightClusters.h"
+#include "DeferredRenderer.h"
+#include "ShadowAtlas.h"
+#include "SoftwareRasterizer.h"
+#include "FnafLayout.h"
+#include "LightProbeGrid.h"
+#include "ShadingLod.h"
+#include "AnimationLod.h"
+#include "Impostor.h"
+#include "VertexAnimation.h"
 
 #define M_PI std::numbers::pi_v<float>
 //#define LOG_FPS
 
+// A keyframed clip looping on one of a scene's skinned objects.
+struct ClipPlayback {
+	size_t object;
+	CompressedClipSampler sampler;
+	float time{ 0 };
+	// The joints sampled at AnimationRate::Reduced.
+	std::vector<uint8_t> majorJoints{};
+	// The distance to the nearest camera pass that saw the object this frame, and the frames
+	// since its pose was last sampled.
+	float viewDistance{ std::numeric_limits<float>::infinity() };
+	uint32_t framesSinceSample{ 0 };
+};
+
+// A clip baked into vertex animation textures, looping on one of a scene's skinned objects.
+struct VertexAnimationPlayback {
+	size_t object;
+	VertexAnimation animation;
+	float time{ 0 };
+	// As in ClipPlayback, for the frames since the object's frame was last set.
+	float viewDistance{ std::numeric_limits<float>::infinity() };
+	uint32_t framesSinceSample{ 0 };
+};
+
 // We use a structure to track all the elements of a scene, including a list of objects,
-// a list of animators, and a shader program to use to render those objects.
+// an animator that plays sequences of animations on them, a list of point and spot lights, and a shader program to use to render those objects.
+// Objects with baked lightmaps or vertex lighting are rendered with a permutation of that program instead.
+// A scene with light probes gives the other objects bounced light from them, interpolated once per frame.
+// Distant objects may be shaded with cheaper permutations of these programs (see ShadingLod), or
+// replaced by impostors. Skinned objects may be posed by keyframed clips, or play them baked into
+// vertex animation textures; characters few or no passes see are posed less often (see AnimationLod).
 struct Scene {
 	ShaderProgram program{};
+	ShaderProgram lightmapProgram{};
+	ShaderProgram vertexLitProgram{};
 	std::vector<Object3D> objects{};
-	std::vector<Animator> animators{};
+	Animator animator{};
+	std::vector<PointLight> lights{};
+	// Coarser shading levels of the three programs above, by kind of baked lighting. Objects whose
+	// permutation is missing are shaded at the finest level.
+	std::map<std::pair<BakedLighting, ShadingLevel>, ShaderProgram> lodPrograms{};
+	std::optional<LightProbeGrid> probes{};
+	// Each object's probe lighting for the current frame.
+	std::vector<ShIrradiance> probeLighting{};
+	// Impostors of some objects, by index, drawn instead of them when they are smaller on screen
+	// than impostorScreenSize pixels.
+	std::map<size_t, Impostor> impostors{};
+	ShaderProgram impostorProgram{};
+	float impostorScreenSize{ 0 };
+	std::vector<ClipPlayback> clips{};
+	AnimationLod animationLod{};
+	std::vector<VertexAnimationPlayback> vertexAnimations{};
 };
 
 /**
- * @brief Constructs a shader program that applies the Phong reflection model.
+ * @brief Constructs a shader program that applies the Phong reflection model, optionally with
+ * defines that select a permutation of it.
  */
-ShaderProgram phongLightingShader() {
+ShaderProgram phongLightingShader(const std::vector<std::string>& defines = {}) {
 	ShaderProgram shader{};
 	try {
 		// These shaders are INCOMPLETE.
-		shader.load("shaders/light_perspective.vert", "shaders/lighting.frag");
+		shader.load("shaders/light_perspective.vert", "shaders/lighting.frag", defines);
+	}
+	catch (std::runtime_error& e) {
+		std::cout << "ERROR: " << e.what() << std::endl;
+		exit(1);
+	}
+	shader.activate();
+	LightClusters::assignSamplers(shader);
+	ShadowAtlas::assignSampler(shader);
+	return shader;
+}
+
+/**
+ * @brief Constructs a coarser shading level of the lighting program for one kind of baked
+ * lighting: Gouraud shading for PerVertex, or the UNLIT permutation of lighting.frag for Unlit.
+ */
+ShaderProgram shadingLodShader(BakedLighting kind, ShadingLevel level, bool probes) {
+	std::vector<std::string> defines{};
+	if (kind == BakedLighting::Lightmap) {
+		defines.push_back("LIGHTMAP");
+	}
+	else if (kind == BakedLighting::PerVertex) {
+		defines.push_back("VERTEX_LIGHTING");
+	}
+	else {
+		// Only the live-lit objects move, so only they can play vertex animations.
+		defines.push_back("VERTEX_ANIMATION");
+		if (probes) {
+			defines.push_back("PROBE_LIGHTING");
+		}
+	}
+	ShaderProgram shader{};
+	try {
+		if (level == ShadingLevel::PerVertex) {
+			shader.load("shaders/gouraud.vert", "shaders/gouraud.frag", defines);
+		}
+		else {
+			defines.push_back("UNLIT");
+			shader.load("shaders/light_perspective.vert", "shaders/lighting.frag", defines);
+		}
 	}
 	catch (std::runtime_error& e) {
 		std::cout << "ERROR: " << e.what() << std::endl;
 		exit(1);
 	}
+	shader.activate();
+	LightClusters::assignSamplers(shader);
+	ShadowAtlas::assignSampler(shader);
 	return shader;
 }
 
@@ -59,6 +173,84 @@ ShaderProgram texturingShader() {
 	return shader;
 }
 
+/**
+ * @brief Constructs a shader program that only transforms positions, for depth-only passes.
+ */
+ShaderProgram depthOnlyShader() {
+	ShaderProgram shader{};
+	try {
+		shader.load("shaders/simple_perspective.vert", "shaders/depth_only.frag", { "VERTEX_ANIMATION" });
+	}
+	catch (std::runtime_error& e) {
+		std::cout << "ERROR: " << e.what() << std::endl;
+		exit(1);
+	}
+	return shader;
+}
+
+/**
+ * @brief Constructs a shader program that writes surface attributes to a G-buffer.
+ */
+ShaderProgram gbufferShader() {
+	ShaderProgram shader{};
+	try {
+		shader.load("shaders/light_perspective.vert", "shaders/gbuffer.frag", { "VERTEX_ANIMATION" });
+	}
+	catch (std::runtime_error& e) {
+		std::cout << "ERROR: " << e.what() << std::endl;
+		exit(1);
+	}
+	return shader;
+}
+
+/**
+ * @brief Constructs a shader program that poses skinned meshes into their posed buffers, with
+ * transform feedback and no rasterization.
+ */
+ShaderProgram skinningShader() {
+	ShaderProgram shader{};
+	try {
+		shader.loadTransformFeedback("shaders/skin_cache.vert", { "PosedPosition", "PosedNormal" });
+	}
+	catch (std::runtime_error& e) {
+		std::cout << "ERROR: " << e.what() << std::endl;
+		exit(1);
+	}
+	return shader;
+}
+
+/**
+ * @brief Constructs a shader program that lights a G-buffer with a fullscreen pass.
+ */
+ShaderProgram deferredLightingShader() {
+	ShaderProgram shader{};
+	try {
+		shader.load("shaders/fullscreen.vert", "shaders/deferred_lighting.frag");
+	}
+	catch (std::runtime_error& e) {
+		std::cout << "ERROR: " << e.what() << std::endl;
+		exit(1);
+	}
+	return shader;
+}
+
+/**
+ * @brief Constructs a shader program that draws impostors from their baked atlases.
+ */
+ShaderProgram impostorShader() {
+	ShaderProgram shader{};
+	try {
+		shader.load("shaders/impostor.vert", "shaders/impostor.frag");
+	}
+	catch (std::runtime_error& e) {
+		std::cout << "ERROR: " << e.what() << std::endl;
+		exit(1);
+	}
+	shader.activate();
+	Impostor::assignSamplers(shader);
+	return shader;
+}
+
 /**
  * @brief Loads an image from the given path into an OpenGL texture.
  */
@@ -68,6 +260,17 @@ Texture loadTexture(const std::filesystem::path& path, const std::string& sample
 	return Texture::loadImage(i, samplerName);
 }
 
+/**
+ * @brief Loads a model and places it in the world.
+ */
+Object3D placeModel(const Placement& placement) {
+	auto object{ assimpLoad(placement.modelPath, true) };
+	object.move(placement.position);
+	object.grow(placement.scale);
+	object.rotate(placement.orientation);
+	return object;
+}
+
 /*****************************************************************************************
 *  DEMONSTRATION SCENES
 *****************************************************************************************/
@@ -86,12 +289,9 @@ Scene bunny() {
 	// Now the "bunny" variable is empty; if we want to refer to the bunny object, we need to reference 
 	// scene.objects[0]
 
-	Animator spinBunny{};
+	uint32_t spinBunny{ scene.animator.addSequence() };
 	// Spin the bunny 360 degrees over 10 seconds.
-	spinBunny.addAnimation(std::make_unique<RotationAnimation>(scene.objects[0], 10.0f, glm::vec3{ 0, 1, 0 }));
-
-	// Move all animators into the scene's animators list.
-	scene.animators.push_back(std::move(spinBunny));
+	scene.animator.addRotation(spinBunny, scene.objects[0], 10.0f, glm::vec3{ 0, 1, 0 });
 
 	return scene;
 }
@@ -127,12 +327,10 @@ Scene cube() {
 
 	scene.objects.push_back(std::move(cube));
 
-	Animator spinCube{};
-	spinCube.addAnimation(std::make_unique<RotationAnimation>(scene.objects[0], 10.0f, glm::vec3{ 0, 2 * M_PI, 0 }));
+	uint32_t spinCube{ scene.animator.addSequence() };
+	scene.animator.addRotation(spinCube, scene.objects[0], 10.0f, glm::vec3{ 0, 2 * M_PI, 0 });
 	// Then spin around the x axis.
-	spinCube.addAnimation(std::make_unique<RotationAnimation>(scene.objects[0], 10.0f, glm::vec3{ 2 * M_PI, 0, 0 }));
-
-	scene.animators.push_back(std::move(spinCube));
+	scene.animator.addRotation(spinCube, scene.objects[0], 10.0f, glm::vec3{ 2 * M_PI, 0, 0 });
 
 	return scene;
 }
@@ -143,7 +341,7 @@ Scene cube() {
  * @return
  */
 Scene lifeOfPi() {
-	// This scene is more complicated; it has child objects, as well as animators.
+	// This scene is more complicated; it has child objects, as well as animations.
 	Scene scene{ phongLightingShader() };
 
 	scene.program.setUniform("directionalLight", glm::vec3(0, -1, 0));
@@ -163,20 +361,15 @@ Scene lifeOfPi() {
 	// We want these animations to referenced the *moved* objects, which are no longer
 	// in the variables named "tiger" and "boat". "boat" is now in the "objects" list at
 	// index 0, and "tiger" is the index-1 child of the boat.
-	Animator animBoat{};
-	animBoat.addAnimation(std::make_unique<RotationAnimation>(scene.objects[0], 10.0f, glm::vec3{ 0, 2 * M_PI, 0 }));
-	Animator animTiger{};
-	animTiger.addAnimation(std::make_unique<RotationAnimation>(scene.objects[0].getChild(1), 10.0f, glm::vec3{ 0, 0, 2 * M_PI }));
-
-	// The Animators will be destroyed when leaving this function, so we move them into
-	// a list to be returned.
-	scene.animators.push_back(std::move(animBoat));
-	scene.animators.push_back(std::move(animTiger));
+	uint32_t animBoat{ scene.animator.addSequence() };
+	scene.animator.addRotation(animBoat, scene.objects[0], 10.0f, glm::vec3{ 0, 2 * M_PI, 0 });
+	uint32_t animTiger{ scene.animator.addSequence() };
+	scene.animator.addRotation(animTiger, scene.objects[0].getChild(1), 10.0f, glm::vec3{ 0, 0, 2 * M_PI });
 
 	scene.program.activate();
 	scene.program.setUniform("directionalLight", glm::vec3(0, -1, 0));
 
-	// Transfer ownership of the objects and animators back to the main.
+	// Transfer ownership of the objects and their animations back to the main.
 	return scene;
 }
 
@@ -194,15 +387,38 @@ Scene freddy() {
 
 	scene.objects.push_back(std::move(bright_freddy));
 
-	Animator animFreddy{};
-	//animFreddy.addAnimation(std::make_unique<RotationAnimation>(scene.objects[0], 10.0f, glm::vec3{ 0, 2 * M_PI, 0 }));
-	scene.animators.push_back(std::move(animFreddy));
+	//scene.animator.addRotation(scene.animator.addSequence(), scene.objects[0], 10.0f, glm::vec3{ 0, 2 * M_PI, 0 });
 
 	return scene;
 }
 
 Scene fnaf(std::vector<Object3D> extra) {
-	Scene scene{ phongLightingShader() };
+	// Light probes are optional; without them, the live-lit programs evaluate none.
+	std::optional<LightProbeGrid> probes{};
+	if (std::filesystem::exists(FNAF_LIGHT_PROBES_PATH)) {
+		std::cout << "loading " << FNAF_LIGHT_PROBES_PATH << std::endl;
+		try {
+			probes = readLightProbes(FNAF_LIGHT_PROBES_PATH);
+		}
+		catch (std::runtime_error& e) {
+			std::cout << "ERROR: " << e.what() << std::endl;
+			exit(1);
+		}
+	}
+	std::vector<std::string> liveDefines{ "VERTEX_ANIMATION" };
+	if (probes) {
+		liveDefines.push_back("PROBE_LIGHTING");
+	}
+	Scene scene{ phongLightingShader(liveDefines), phongLightingShader({ "LIGHTMAP" }), phongLightingShader({ "VERTEX_LIGHTING" }) };
+	scene.probes = std::move(probes);
+	// The rooms are placed from the shared layout, which the lightmap baker also reads.
+	auto rooms{ fnafStaticRooms() };
+	// Cheaper permutations, for distant objects and low-resolution passes.
+	for (auto kind : { BakedLighting::None, BakedLighting::Lightmap, BakedLighting::PerVertex }) {
+		for (auto level : { ShadingLevel::PerVertex, ShadingLevel::Unlit }) {
+			scene.lodPrograms.emplace(std::pair{ kind, level }, shadingLodShader(kind, level, scene.probes.has_value()));
+		}
+	}
 
 	auto freddy{ assimpLoad("models/fnaf_movie/freddy/scene.gltf", true) };
 	freddy.move(glm::vec3{ 0, -.5, -29 });
@@ -226,15 +442,8 @@ Scene fnaf(std::vector<Object3D> extra) {
 	foxy.rotate(glm::vec3{ 0, M_PI / 4, 0 });
 	scene.objects.push_back(std::move(foxy));
 
-	auto stage{ assimpLoad("models/fnaf_movie/stage/scene.gltf", true) };
-	stage.move(glm::vec3{ 0, .55, -30 });
-	stage.grow(glm::vec3{ 0.336, 0.336, 0.336 });
-	stage.rotate(glm::vec3{ 0, M_PI, 0 });
-	scene.objects.push_back(std::move(stage));
-
-	auto office{ assimpLoad("models/fnaf_movie/office/scene.gltf", true) };
-	office.move(glm::vec3{ 0, -.5, 4.5 });
-	scene.objects.push_back(std::move(office));
+	scene.objects.push_back(placeModel(rooms[0]));
+	scene.objects.push_back(placeModel(rooms[1]));
 
 	auto rightOfficeDoor{ assimpLoad("models/fnaf_movie/office_door/scene.gltf", true) };
 	// Closed
@@ -252,41 +461,59 @@ Scene fnaf(std::vector<Object3D> extra) {
 	leftOfficeDoor.grow(glm::vec3{ .2, .2, .2 });
 	scene.objects.push_back(std::move(leftOfficeDoor));
 
-	auto cove{ assimpLoad("models/fnaf_movie/pirate_cove/scene.gltf", true) };
-	cove.move(glm::vec3{ -9, -.8, -28 });
-	cove.grow(glm::vec3{ .84, .84, .84 });
-	cove.rotate(glm::vec3{ 0, (5 * M_PI) / 4, 0 });
-	scene.objects.push_back(std::move(cove));
+	scene.objects.push_back(placeModel(rooms[2]));
 
 	for (auto obj : extra) scene.objects.push_back(std::move(obj));
 
-	Animator animRightDoorDown{};
-	animRightDoorDown.addAnimation(std::make_unique<TranslationAnimation>(scene.objects[6], 1.0f, glm::vec3{ 0, -1.15, 0 }));
-	scene.animators.push_back(std::move(animRightDoorDown));
+	scene.lights = fnafLights();
+
+	// Animatronics that come with keyframed animations loop the first one.
+	for (size_t i{ 0 }; i < 4; ++i) {
+		auto& pose{ scene.objects[i].getSkeletonPose() };
+		if (pose && !pose->skeleton().clips().empty()) {
+			std::vector<glm::mat4> bindLocals{};
+			pose->skeleton().bindPose(bindLocals);
+			scene.clips.push_back(ClipPlayback{ i, CompressedClipSampler{ pose->skeleton().clips()[0], bindLocals } });
+		}
+	}
+
+	// The animatronics are baked into impostors, for when they are small on screen.
+	scene.impostorProgram = impostorShader();
+	ShaderProgram impostorBakeProgram{ gbufferShader() };
+	try {
+		for (size_t i{ 0 }; i < 4; ++i) {
+			scene.impostors.emplace(i, Impostor::bake(scene.objects[i], impostorBakeProgram, ImpostorSettings{}));
+		}
+	}
+	catch (std::runtime_error& e) {
+		std::cout << "ERROR: " << e.what() << std::endl;
+		exit(1);
+	}
+
+	// The door sequences, in the order playNightEvent refers to them.
+	uint32_t animRightDoorDown{ scene.animator.addSequence() };
+	scene.animator.addTranslation(animRightDoorDown, scene.objects[6], 1.0f, glm::vec3{ 0, -1.15, 0 });
 
-	Animator animLeftDoorDown{};
-	animLeftDoorDown.addAnimation(std::make_unique<TranslationAnimation>(scene.objects[7], 1.0f, glm::vec3{ 0, -1.15, 0 }));
-	scene.animators.push_back(std::move(animLeftDoorDown));
+	uint32_t animLeftDoorDown{ scene.animator.addSequence() };
+	scene.animator.addTranslation(animLeftDoorDown, scene.objects[7], 1.0f, glm::vec3{ 0, -1.15, 0 });
 
-	Animator animRightDoorUp{};
-	animRightDoorUp.addAnimation(std::make_unique<TranslationAnimation>(scene.objects[6], 2.0f, glm::vec3{ 0, 1.15, 0 }));
-	scene.animators.push_back(std::move(animRightDoorUp));
+	uint32_t animRightDoorUp{ scene.animator.addSequence() };
+	scene.animator.addTranslation(animRightDoorUp, scene.objects[6], 2.0f, glm::vec3{ 0, 1.15, 0 });
 
-	Animator animLeftDoorUp{};
-	animLeftDoorUp.addAnimation(std::make_unique<TranslationAnimation>(scene.objects[7], 2.0f, glm::vec3{ 0, 1.15, 0 }));
-	scene.animators.push_back(std::move(animLeftDoorUp));
+	uint32_t animLeftDoorUp{ scene.animator.addSequence() };
+	scene.animator.addTranslation(animLeftDoorUp, scene.objects[7], 2.0f, glm::vec3{ 0, 1.15, 0 });
 
 	return scene;
 }
 
-void movement(glm::vec3& cameraPos, glm::vec3& cameraForwards, float& yaw, float deltaTime, float moveSpeed, float rotationSpeed) {
+void movement(const InputState& input, glm::vec3& cameraPos, glm::vec3& cameraForwards, float& yaw, float deltaTime, float moveSpeed, float rotationSpeed) {
 	auto deltaYaw = 0;
 
-	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) {
+	if (input.held(InputKey::A)) {
 		yaw -= rotationSpeed * deltaTime;
 	}
 
-	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) {
+	if (input.held(InputKey::D)) {
 		yaw += rotationSpeed * deltaTime;
 	}
 
@@ -294,49 +521,30 @@ void movement(glm::vec3& cameraPos, glm::vec3& cameraForwards, float& yaw, float
 
 	cameraForwards = glm::normalize(glm::vec3{ std::cos(yaw), 0, std::sin(yaw) });
 
-	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W)) {
+	if (input.held(InputKey::W)) {
 		cameraPos += cameraForwards * deltaTime * moveSpeed;
 	}
 
-	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S)) {
+	if (input.held(InputKey::S)) {
 		cameraPos -= cameraForwards * deltaTime * moveSpeed;
 	}
 
-	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space)) {
+	if (input.held(InputKey::Space)) {
 		cameraPos.y += moveSpeed * deltaTime;
 	}
 
-	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LControl)) {
+	if (input.held(InputKey::LControl)) {
 		cameraPos.y -= moveSpeed * deltaTime;
 	}
 }
 
-void doorAction(Scene& scene, bool& leftDoorClosed, bool& rightDoorClosed, const std::optional<sf::Event>& event) {
-	if (event->is<sf::Event::KeyPressed>()) {
-		auto key = event->getIf<sf::Event::KeyPressed>()->code;
-		if (key == sf::Keyboard::Key::Q) {
-			if (!leftDoorClosed) {
-				scene.animators[1].start();
-				leftDoorClosed = true;
-			}
-			else if (leftDoorClosed) {
-				scene.animators[3].start();
-				leftDoorClosed = false;
-			}
+void doorAction(Scene& scene, FnafNight& night, const InputState& input) {
+	for (InputKey key : input.pressed()) {
+		if (key == InputKey::Q) {
+			night.setLeftDoor(!night.leftDoorClosed());
 		}
-	}
-
-	if (event->is<sf::Event::KeyPressed>()) {
-		auto key = event->getIf<sf::Event::KeyPressed>()->code;
-		if (key == sf::Keyboard::Key::E) {
-			if (!rightDoorClosed) {
-				scene.animators[0].start();
-				rightDoorClosed = true;
-			}
-			else if (rightDoorClosed) {
-				scene.animators[2].start();
-				rightDoorClosed = false;
-			}
+		if (key == InputKey::E) {
+			night.setRightDoor(!night.rightDoorClosed());
 		}
 	}
 
@@ -344,42 +552,769 @@ void doorAction(Scene& scene, bool& leftDoorClosed, bool& rightDoorClosed, const
 	scene.objects[7].setPosition(glm::clamp(scene.objects[7].getPosition(), glm::vec3{ -.525, -.5, 4.25 }, glm::vec3{ -.525, .65, 4.25 }));
 }
 
-void cameraAction(std::map<std::string, glm::vec3>& activeCamInfo, int& activeCam, std::map<std::string, glm::vec3> stageCamera, std::map<std::string, glm::vec3> coveCamera, std::map<std::string, glm::vec3> hallCamera, const std::optional<sf::Event>& event) {
-	if (event->is<sf::Event::KeyPressed>()) {
-		auto key = event->getIf<sf::Event::KeyPressed>()->code;
-		if (key == sf::Keyboard::Key::Num1) {
+/**
+ * @brief Plays the animations of the night's events: the doors sliding.
+ */
+void playNightEvent(Scene& scene, NightEvent event) {
+	switch (event) {
+	case NightEvent::RightDoorClosed:
+		scene.animator.start(0);
+		break;
+	case NightEvent::LeftDoorClosed:
+		scene.animator.start(1);
+		break;
+	case NightEvent::RightDoorOpened:
+		scene.animator.start(2);
+		break;
+	case NightEvent::LeftDoorOpened:
+		scene.animator.start(3);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Places Foxy as far along his run as the night says: out of the cove diagonally for 8
+ * units, then down the hallway for 24 more. In the office, he is tilted in over the player.
+ */
+void placeFoxy(Scene& scene, const FnafNight& night) {
+	auto& foxy{ scene.objects[3] };
+	float distance{ night.foxyRunProgress() * 32.0f };
+	foxy.setPosition(glm::vec3{ -9, -.55, -28 } + glm::vec3{ std::min(distance, 8.0f), 0, distance });
+	foxy.setOrientation(glm::vec3{ 0, M_PI / 4, night.foxy() == FoxyState::InOffice ? -M_PI / 8 : 0 });
+}
+
+/**
+ * @brief The benchmark flythrough of the fnaf scene: idling in the office, walking the hallway
+ * from the office to the cove, a close-up of the stage, and flicking between the security cameras
+ * four times a second while watching the feed.
+ */
+std::vector<FlythroughSegment> fnafFlythrough() {
+	glm::vec3 office{ 0, 0, 5 };
+	CameraKey stageFeed{ 0, glm::vec3{ 0, 1, -28 }, glm::vec3{ 0, 0, -29 } };
+	CameraKey coveFeed{ 0, glm::vec3{ -9, .6, -27.15 }, glm::vec3{ -10, .6, -28.15 } };
+	CameraKey hallFeed{ 0, glm::vec3{ -1, .7, 3 }, glm::vec3{ -2, .7, 2 } };
+	auto at{ [](CameraKey key, float time, bool cut) { key.time = time; key.cut = cut; return key; } };
+
+	std::vector<CameraKey> switching{};
+	CameraKey feeds[]{ stageFeed, coveFeed, hallFeed };
+	for (uint32_t i{ 0 }; i < 24; ++i) {
+		switching.push_back(at(feeds[i % 3], i * 0.25f, i > 0));
+	}
+
+	return {
+		FlythroughSegment{ "office idle", 10.0f,
+			CameraPath{ { { 0, office, glm::vec3{ 0, 0, 4 } }, { 3, office, glm::vec3{ -1, 0, 4.3f } },
+				{ 6, office, glm::vec3{ 1, 0, 4.3f } }, { 10, office, glm::vec3{ 0, 0, 4 } } } },
+			CameraPath{ { stageFeed } } },
+		FlythroughSegment{ "hallway walk", 12.0f,
+			CameraPath{ { { 0, glm::vec3{ -0.5, 0, 4 }, glm::vec3{ -1, 0, 2 } }, { 2, glm::vec3{ -1, 0, 2 }, glm::vec3{ -1, 0, -2 } },
+				{ 8, glm::vec3{ -1, 0, -18 }, glm::vec3{ -1, 0, -22 } }, { 12, glm::vec3{ -6, 0, -25 }, glm::vec3{ -9, 0, -28 } } } },
+			CameraPath{ { hallFeed } } },
+		FlythroughSegment{ "stage close-up", 8.0f,
+			CameraPath{ { { 0, glm::vec3{ -2, 0.5, -20 }, glm::vec3{ 0, 0.5, -30 } }, { 4, glm::vec3{ 1, 0.8, -25 }, glm::vec3{ 0, 0.8, -30 } },
+				{ 8, glm::vec3{ 0, 1.2, -27 }, glm::vec3{ 0, 1, -30 } } } },
+			CameraPath{ { stageFeed } } },
+		FlythroughSegment{ "camera switching", 6.0f,
+			CameraPath{ { { 0, office, glm::vec3{ .25, .1, 3.85 } } } },
+			CameraPath{ switching } },
+	};
+}
+
+void cameraAction(std::map<std::string, glm::vec3>& activeCamInfo, int& activeCam, std::map<std::string, glm::vec3> stageCamera, std::map<std::string, glm::vec3> coveCamera, std::map<std::string, glm::vec3> hallCamera, const InputState& input) {
+	for (InputKey key : input.pressed()) {
+		if (key == InputKey::Num1) {
 			activeCam = 0;
 			activeCamInfo = stageCamera;
 		}
-		if (key == sf::Keyboard::Key::Num2) {
+		if (key == InputKey::Num2) {
 			activeCam = 1;
 			activeCamInfo = coveCamera;
 		}
-		if (key == sf::Keyboard::Key::Num3) {
+		if (key == InputKey::Num3) {
 			activeCam = 2;
 			activeCamInfo = hallCamera;
 		}
 	}
 }
 
-int main() {
-	std::cout << std::filesystem::current_path() << std::endl;
+/**
+ * @brief Prints the command line options, for "--help".
+ */
+void printUsage(std::ostream& out) {
+	out << "Usage: Graphics [options]\n"
+		"  --frame-budget <ms>              frame time the quality governor holds to (16.6)\n"
+		"  --percentile <0-100>             frame time percentile held to the budget (95)\n"
+		"  --depth-prepass off|on|auto|benchmark\n"
+		"                                   depth prepass before each camera pass (auto)\n"
+		"  --player-shading forward|deferred\n"
+		"                                   how the player view is shaded (forward); deferred lights\n"
+		"                                   every pixel at full detail, ignoring --shading-lod, and\n"
+		"                                   lights lightmapped and vertex-lit rooms live\n"
+		"  --shading-lod on|off             shade distant objects more cheaply (on)\n"
+		"  --animation-lod on|off           animate hidden and distant characters less often (on);\n"
+		"                                   with vertex animations, their frames change less often,\n"
+		"                                   but every joint still moves\n"
+		"  --sim-rate <hz>                  gameplay simulation steps per second (60)\n"
+		"  --impostor-size <pixels>         draw objects smaller than this as impostors; 0 never (96)\n"
+		"  --vertex-animation on|off        play the animatronics' clips from baked textures (on)\n"
+		"  --seed <n>                       seed of the night's random choices (random)\n"
+		"  --record <file>                  save the session's input\n"
+		"  --replay <file>                  replay saved input as a benchmark\n"
+		"  --flythrough <file.json>         fly the benchmark cameras and write their results\n"
+		"  --headless <width>x<height>      draw offscreen, with no window\n"
+		"  --dump-frames <directory>        save each headless frame\n"
+		"  --frames <n>                     quit after this many frames\n"
+		"  --software-feed on|off           draw the security feed on the CPU (off)\n"
+		"  --gl-stats on|off|mock           count OpenGL calls; mocked, make none (on)\n"
+		"  --gl-budget <pass>=<draws>       fail if a frame's pass makes more draw calls\n";
+}
 
-	// Initialize the window and OpenGL.
-	sf::ContextSettings settings;
-	settings.depthBits = 24; // Request a 24 bits depth buffer
-	settings.stencilBits = 8;  // Request a 8 bits stencil buffer
-	settings.majorVersion = 3; // You might have to change these on Mac.
-	settings.minorVersion = 3;
-
-	sf::Window window{
-		sf::VideoMode::getFullscreenModes().at(0), "Modern OpenGL",
-		sf::Style::Resize | sf::Style::Close,
-		sf::State::Windowed, settings
-	};
+/**
+ * @brief Prints that a command line option was given a value it doesn't take, and quits.
+ */
+[[noreturn]] void badOption(const std::string& option, const std::string& value, const std::string& expected) {
+	std::cout << "ERROR: " << option << " expects " << expected << ", not " << value << std::endl;
+	exit(1);
+}
+
+/**
+ * @brief The value given to a command line option, or nullptr if the option isn't given. An
+ * option with no value after it is an error.
+ */
+const char* optionValue(int argc, char* argv[], const std::string& option) {
+	for (int i{ 1 }; i < argc; ++i) {
+		if (argv[i] == option) {
+			if (i + 1 == argc) {
+				std::cout << "ERROR: " << option << " needs a value" << std::endl;
+				exit(1);
+			}
+			return argv[i + 1];
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * @brief Parses all of text as a number, which must be finite. Returns whether it could.
+ */
+template <typename T>
+bool parseNumber(const std::string& text, T& number) {
+	if constexpr (std::is_floating_point_v<T>) {
+		char* stop{ nullptr };
+		number = static_cast<T>(std::strtod(text.c_str(), &stop));
+		return !text.empty() && stop == text.c_str() + text.size() && std::isfinite(number);
+	}
+	else {
+		const char* end{ text.data() + text.size() };
+		auto [stop, error] { std::from_chars(text.data(), end, number) };
+		return !text.empty() && error == std::errc{} && stop == end;
+	}
+}
+
+/**
+ * @brief The number given to a command line option, or fallback if the option isn't given. A
+ * value that isn't a number, or that accepts rejects, is an error, saying the option expects
+ * what expected describes.
+ */
+template <typename T, typename Accepts>
+T numberOption(int argc, char* argv[], const std::string& option, T fallback, const std::string& expected, Accepts accepts) {
+	const char* value{ optionValue(argc, argv, option) };
+	if (!value) {
+		return fallback;
+	}
+	T number{};
+	if (!parseNumber(value, number) || !accepts(number)) {
+		badOption(option, value, expected);
+	}
+	return number;
+}
+
+/**
+ * @brief Which of choices was given to a command line option, as its index, or fallback if the
+ * option isn't given. Any other value is an error.
+ */
+size_t choiceOption(int argc, char* argv[], const std::string& option, const std::vector<std::string>& choices, size_t fallback) {
+	const char* value{ optionValue(argc, argv, option) };
+	if (!value) {
+		return fallback;
+	}
+	auto found{ std::find(choices.begin(), choices.end(), value) };
+	if (found == choices.end()) {
+		std::string expected{};
+		for (auto& choice : choices) {
+			expected += (expected.empty() ? "" : "|") + choice;
+		}
+		badOption(option, value, expected);
+	}
+	return found - choices.begin();
+}
+
+/**
+ * @brief Reads the frame-time budget from the command line: "--frame-budget <ms>" and
+ * "--percentile <0-100>". Defaults to 16.6 ms at the 95th percentile.
+ */
+QualityGovernor governorFromArgs(int argc, char* argv[]) {
+	float budgetMs{ numberOption(argc, argv, "--frame-budget", 16.6f, "a positive time in ms", [](float ms) { return ms > 0; }) };
+	float percentile{ numberOption(argc, argv, "--percentile", 95.0f, "a percentile above 0, up to 100",
+		[](float p) { return p > 0 && p <= 100; }) };
+	return QualityGovernor{ budgetMs, percentile / 100.0f };
+}
+
+/**
+ * @brief Reads the depth prepass mode from the command line: "--depth-prepass off|on|auto|benchmark".
+ * Defaults to auto.
+ */
+DepthPrepass::Mode prepassModeFromArgs(int argc, char* argv[]) {
+	constexpr DepthPrepass::Mode MODES[]{ DepthPrepass::Mode::Off, DepthPrepass::Mode::On, DepthPrepass::Mode::Auto,
+		DepthPrepass::Mode::Benchmark };
+	return MODES[choiceOption(argc, argv, "--depth-prepass", { "off", "on", "auto", "benchmark" }, 2)];
+}
+
+/**
+ * @brief Reads the player camera's shading path from the command line:
+ * "--player-shading forward|deferred". Defaults to forward.
+ */
+ShadingPath playerShadingFromArgs(int argc, char* argv[]) {
+	return choiceOption(argc, argv, "--player-shading", { "forward", "deferred" }, 0) == 1 ? ShadingPath::Deferred : ShadingPath::Forward;
+}
+
+/**
+ * @brief Reads whether distant objects may be shaded more cheaply from the command line:
+ * "--shading-lod on|off". Defaults to on.
+ */
+bool shadingLodFromArgs(int argc, char* argv[]) {
+	return choiceOption(argc, argv, "--shading-lod", { "off", "on" }, 1) == 1;
+}
+
+/**
+ * @brief Reads whether characters that are hidden or far from every camera may be animated less
+ * often from the command line: "--animation-lod on|off". Defaults to on.
+ */
+bool animationLodFromArgs(int argc, char* argv[]) {
+	return choiceOption(argc, argv, "--animation-lod", { "off", "on" }, 1) == 1;
+}
+
+/**
+ * @brief Reads how many gameplay simulation steps to take per second from the command line:
+ * "--sim-rate <hz>". Defaults to 60.
+ */
+float simulationRateFromArgs(int argc, char* argv[]) {
+	// At most 10 kHz, so that the step cap (a quarter of a second's steps) stays a small count.
+	return numberOption(argc, argv, "--sim-rate", 60.0f, "a rate above 0 Hz, up to 10000",
+		[](float hz) { return hz > 0 && hz <= 10000; });
+}
+
+/**
+ * @brief Reads how small on screen, in pixels, an object with an impostor must be before it is
+ * drawn as one: "--impostor-size <pixels>". Defaults to 96; 0 turns impostors off.
+ */
+float impostorSizeFromArgs(int argc, char* argv[]) {
+	return numberOption(argc, argv, "--impostor-size", 96.0f, "a size in pixels, or 0", [](float size) { return size >= 0; });
+}
+
+/**
+ * @brief Reads whether the animatronics' looping clips are baked into vertex animation textures
+ * from the command line: "--vertex-animation on|off". Defaults to on.
+ */
+bool vertexAnimationFromArgs(int argc, char* argv[]) {
+	return choiceOption(argc, argv, "--vertex-animation", { "off", "on" }, 1) == 1;
+}
+
+/**
+ * @brief Reads the seed of the night's random choices from the command line: "--seed <n>".
+ * Defaults to a random one, which a recording keeps.
+ */
+uint64_t seedFromArgs(int argc, char* argv[]) {
+	std::random_device device{};
+	uint64_t random{ (static_cast<uint64_t>(device()) << 32) | device() };
+	return numberOption(argc, argv, "--seed", random, "a whole number", [](uint64_t) { return true; });
+}
+
+/**
+ * @brief Reads where to save a recording of the session's input from the command line:
+ * "--record <file>". Defaults to none.
+ */
+std::filesystem::path recordPathFromArgs(int argc, char* argv[]) {
+	const char* path{ optionValue(argc, argv, "--record") };
+	return path ? path : std::filesystem::path{};
+}
+
+/**
+ * @brief Reads a recording to replay as a benchmark from the command line: "--replay <file>".
+ * Defaults to none, to play live.
+ */
+std::optional<InputRecording> replayFromArgs(int argc, char* argv[]) {
+	const char* path{ optionValue(argc, argv, "--replay") };
+	if (!path) {
+		return std::nullopt;
+	}
+	try {
+		return InputRecording::load(path);
+	}
+	catch (std::runtime_error& e) {
+		std::cout << "ERROR: " << e.what() << std::endl;
+		exit(1);
+	}
+}
+
+/**
+ * @brief Reads where to write the results of the benchmark flythrough from the command line:
+ * "--flythrough <file.json>". Defaults to none, to play instead.
+ */
+std::filesystem::path flythroughPathFromArgs(int argc, char* argv[]) {
+	const char* path{ optionValue(argc, argv, "--flythrough") };
+	return path ? path : std::filesystem::path{};
+}
+
+/**
+ * @brief Reads the size of the offscreen framebuffer to draw to with no window, display or GPU
+ * from the command line: "--headless <width>x<height>". Defaults to none, to open a window.
+ */
+std::optional<glm::uvec2> headlessSizeFromArgs(int argc, char* argv[]) {
+	const char* value{ optionValue(argc, argv, "--headless") };
+	if (!value) {
+		return std::nullopt;
+	}
+	std::string size{ value };
+	size_t x{ size.find('x') };
+	glm::uvec2 result{};
+	if (x == std::string::npos || !parseNumber(size.substr(0, x), result.x) || !parseNumber(size.substr(x + 1), result.y)
+		|| result.x == 0 || result.y == 0) {
+		badOption("--headless", size, "<width>x<height>");
+	}
+	return result;
+}
+
+/**
+ * @brief Reads where to save each headless frame, as frame_<number>.ppm, from the command line:
+ * "--dump-frames <directory>". Defaults to none.
+ */
+std::filesystem::path dumpFramesPathFromArgs(int argc, char* argv[]) {
+	const char* path{ optionValue(argc, argv, "--dump-frames") };
+	return path ? path : std::filesystem::path{};
+}
+
+/**
+ * @brief Reads how many frames to draw before quitting from the command line: "--frames <n>".
+ * Defaults to no limit.
+ */
+uint64_t frameLimitFromArgs(int argc, char* argv[]) {
+	return numberOption(argc, argv, "--frames", std::numeric_limits<uint64_t>::max(), "a number of frames",
+		[](uint64_t) { return true; });
+}
+
+/**
+ * @brief Reads whether the security feed is drawn on the CPU from the command line:
+ * "--software-feed on|off". Defaults to off.
+ */
+bool softwareFeedFromArgs(int argc, char* argv[]) {
+	return choiceOption(argc, argv, "--software-feed", { "off", "on" }, 0) == 1;
+}
+
+/**
+ * @brief Reads whether to count OpenGL calls from the command line: "--gl-stats on|off|mock".
+ * Mocked, calls are counted but never made, with no context at all. Defaults to on.
+ */
+GlIntercept::Mode glStatsFromArgs(int argc, char* argv[]) {
+	constexpr GlIntercept::Mode MODES[]{ GlIntercept::Mode::Counting, GlIntercept::Mode::Off, GlIntercept::Mode::Mock };
+	return MODES[choiceOption(argc, argv, "--gl-stats", { "on", "off", "mock" }, 0)];
+}
+
+/**
+ * @brief Reads the most draw calls one frame may make in a pass from the command line:
+ * "--gl-budget <pass>=<draws>", once for each pass to check, named as the OpenGL call report
+ * names it. A run that goes over any budget fails. Defaults to none.
+ */
+std::vector<std::pair<std::string, uint64_t>> glBudgetsFromArgs(int argc, char* argv[]) {
+	std::vector<std::pair<std::string, uint64_t>> budgets{};
+	for (int i{ 1 }; i < argc; ++i) {
+		if (std::string{ argv[i] } == "--gl-budget") {
+			if (i + 1 == argc) {
+				std::cout << "ERROR: --gl-budget needs a value" << std::endl;
+				exit(1);
+			}
+			std::string budget{ argv[++i] };
+			size_t equals{ budget.rfind('=') };
+			uint64_t draws{};
+			if (equals == std::string::npos || !parseNumber(budget.substr(equals + 1), draws)) {
+				badOption("--gl-budget", budget, "<pass>=<draws>");
+			}
+			budgets.emplace_back(budget.substr(0, equals), draws);
+		}
+	}
+	return budgets;
+}
+
+/**
+ * @brief The game's key for a keyboard key, if it reads it.
+ */
+std::optional<InputKey> inputKey(sf::Keyboard::Key key) {
+	switch (key) {
+	case sf::Keyboard::Key::A: return InputKey::A;
+	case sf::Keyboard::Key::D: return InputKey::D;
+	case sf::Keyboard::Key::W: return InputKey::W;
+	case sf::Keyboard::Key::S: return InputKey::S;
+	case sf::Keyboard::Key::Space: return InputKey::Space;
+	case sf::Keyboard::Key::LControl: return InputKey::LControl;
+	case sf::Keyboard::Key::Q: return InputKey::Q;
+	case sf::Keyboard::Key::E: return InputKey::E;
+	case sf::Keyboard::Key::Num1: return InputKey::Num1;
+	case sf::Keyboard::Key::Num2: return InputKey::Num2;
+	case sf::Keyboard::Key::Num3: return InputKey::Num3;
+	default: return std::nullopt;
+	}
+}
+
+/**
+ * @brief The program that draws objects with the given kind of baked lighting at the given
+ * shading level, falling back to the finest level if the scene has no such permutation.
+ */
+ShaderProgram& lightingProgram(Scene& scene, BakedLighting kind, ShadingLevel level) {
+	auto lod{ scene.lodPrograms.find({ kind, level }) };
+	if (level != ShadingLevel::PerPixel && lod != scene.lodPrograms.end()) {
+		return lod->second;
+	}
+	switch (kind) {
+	case BakedLighting::Lightmap:
+		return scene.lightmapProgram;
+	case BakedLighting::PerVertex:
+		return scene.vertexLitProgram;
+	default:
+		return scene.program;
+	}
+}
+
+/**
+ * @brief Every lighting program of a scene, which each need a camera pass's uniforms.
+ */
+std::vector<ShaderProgram*> lightingPrograms(Scene& scene) {
+	std::vector<ShaderProgram*> programs{ &scene.program, &scene.lightmapProgram, &scene.vertexLitProgram };
+	for (auto& [key, program] : scene.lodPrograms) {
+		programs.push_back(&program);
+	}
+	if (!scene.impostors.empty()) {
+		programs.push_back(&scene.impostorProgram);
+	}
+	return programs;
+}
+
+/**
+ * @brief Sets a lighting program's uniforms for one camera pass, and binds the pass's light
+ * clusters and the shadow atlas to it. Leaves the program active.
+ */
+void setPassUniforms(ShaderProgram& program, const glm::mat4& view, const glm::mat4& projection,
+	const glm::vec3& viewPos, const glm::vec3& directionalLight, int32_t directionalShadowTile,
+	LightClusters& clusters, const glm::vec2& viewportSize, ShadowAtlas& shadows) {
+	program.activate();
+	program.setUniform("projection", projection);
+	program.setUniform("view", view);
+	program.setUniform("viewPos", viewPos);
+	program.setUniform("ambientColor", glm::vec3(1, 1, 1));
+	program.setUniform("directionalLight", directionalLight);
+	program.setUniform("directionalColor", FNAF_DIRECTIONAL_COLOR);
+	clusters.bind(program, viewportSize);
+	shadows.bind(program);
+	program.setUniform("directionalShadowTile", directionalShadowTile);
+}
+
+/**
+ * @brief Which of the scene's objects a camera pass draws as their impostors: those that have
+ * one and are smaller on screen than the scene's impostorScreenSize.
+ */
+std::vector<bool> impostorSelection(const Scene& scene, const glm::mat4& view, const glm::mat4& projection,
+	float viewportHeight) {
+	std::vector<bool> asImpostor(scene.objects.size(), false);
+	for (auto& [i, impostor] : scene.impostors) {
+		asImpostor[i] = impostor.screenSize(scene.objects[i], view, projection, viewportHeight) < scene.impostorScreenSize;
+	}
+	return asImpostor;
+}
+
+/**
+ * @brief Draws the impostors of the objects selected by impostorSelection, with the scene's
+ * impostor program, whose pass uniforms must already be set.
+ */
+void renderImpostors(Scene& scene, const std::vector<bool>& asImpostor, const glm::vec3& viewPos) {
+	bool impostorsActive{ false };
+	for (auto& [i, impostor] : scene.impostors) {
+		if (!asImpostor[i]) {
+			continue;
+		}
+		if (!impostorsActive) {
+			scene.impostorProgram.activate();
+			impostorsActive = true;
+		}
+		if (i < scene.probeLighting.size()) {
+			scene.impostorProgram.setUniform("probeIrradiance", scene.probeLighting[i].coefficients.data(), ShIrradiance::COEFFICIENTS);
+		}
+		impostor.render(scene.impostorProgram, scene.objects[i], viewPos);
+	}
+}
+
+/**
+ * @brief Draws the scene's objects for one camera pass, each with the program for its kind of
+ * baked lighting at the shading level the pass's ShadingLod picks for its distance, or as its
+ * impostor if it has one and is small enough on screen. If the pass's DepthPrepass asks for it,
+ * depth is laid down first with the position-only program, so that each pixel is shaded only once.
+ */
+void renderObjects(Scene& scene, ShaderProgram& depthProgram, DepthPrepass& prepass,
+	const glm::mat4& view, const glm::mat4& projection, const glm::vec2& viewportSize,
+	const glm::vec3& viewPos, const ShadingLod& lod, float lodBias) {
+	std::vector<bool> asImpostor{ impostorSelection(scene, view, projection, viewportSize.y) };
+
+	if (prepass.beginFrame()) {
+		depthProgram.activate();
+		depthProgram.setUniform("view", view);
+		depthProgram.setUniform("projection", projection);
+		// Impostors don't match their object's depth, so they are drawn after the prepass's color pass.
+		prepass.renderPrepass(depthProgram, scene.objects, asImpostor);
+	}
+	prepass.beginColorPass();
+	std::vector<ShadingLevel> levels(scene.objects.size());
+	for (size_t i{ 0 }; i < scene.objects.size(); ++i) {
+		levels[i] = lod.select(glm::distance(viewPos, scene.objects[i].getPosition()), lodBias);
+	}
+	// Draw the objects of each permutation together, activating its program only if the pass
+	// has any.
+	for (auto kind : { BakedLighting::None, BakedLighting::Lightmap, BakedLighting::PerVertex }) {
+		for (auto level : { ShadingLevel::PerPixel, ShadingLevel::PerVertex, ShadingLevel::Unlit }) {
+			ShaderProgram& program{ lightingProgram(scene, kind, level) };
+			bool active{ false };
+			for (size_t i{ 0 }; i < scene.objects.size(); ++i) {
+				auto& o{ scene.objects[i] };
+				if (o.getBakedLighting() != kind || levels[i] != level || asImpostor[i]) {
+					continue;
+				}
+				if (!active) {
+					program.activate();
+					active = true;
+				}
+				if (kind == BakedLighting::None && i < scene.probeLighting.size()) {
+					program.setUniform("probeIrradiance", scene.probeLighting[i].coefficients.data(), ShIrradiance::COEFFICIENTS);
+				}
+				o.render(program);
+			}
+		}
+	}
+	prepass.endColorPass(static_cast<uint64_t>(viewportSize.x) * static_cast<uint64_t>(viewportSize.y));
+	renderImpostors(scene, asImpostor, viewPos);
+}
+
+/**
+ * @brief Interpolates each object's lighting from the scene's light probes at its position, for
+ * every pass this frame to upload.
+ */
+void updateProbeLighting(Scene& scene) {
+	if (!scene.probes) {
+		return;
+	}
+	scene.probeLighting.resize(scene.objects.size());
+	for (size_t i{ 0 }; i < scene.objects.size(); ++i) {
+		scene.probeLighting[i] = scene.probes->sample(scene.objects[i].getPosition());
+	}
+}
+
+/**
+ * @brief Records, for each object playing a clip, keyframed or baked, how far away the camera
+ * pass with the given matrices is if the object is inside its frustum. The object's bind-pose
+ * bounds are padded by a quarter of their size, for limbs its clip moves out of them.
+ */
+void recordClipVisibility(Scene& scene, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos) {
+	glm::mat4 viewProjection{ projection * view };
+	auto record{ [&](size_t object, float& viewDistance) {
+		auto& o{ scene.objects[object] };
+		glm::vec3 boundsMin{ std::numeric_limits<float>::max() };
+		glm::vec3 boundsMax{ std::numeric_limits<float>::lowest() };
+		o.expandBounds(glm::mat4{ 1 }, boundsMin, boundsMax);
+		glm::vec3 padding{ (boundsMax - boundsMin) * 0.25f };
+		if (boxInFrustum(boundsMin - padding, boundsMax + padding, viewProjection)) {
+			viewDistance = std::min(viewDistance, glm::distance(viewPos, o.getPosition()));
+		}
+	} };
+	for (auto& playback : scene.clips) {
+		record(playback.object, playback.viewDistance);
+	}
+	for (auto& playback : scene.vertexAnimations) {
+		record(playback.object, playback.viewDistance);
+	}
+}
+
+/**
+ * @brief Advances the scene's clips, looping them, and samples each into its object's pose at
+ * the rate the scene's AnimationLod picks from what the camera passes saw last frame. Objects
+ * that are not sampled keep last frame's pose, and need no skinning.
+ */
+void playClips(Scene& scene, float dt) {
+	for (auto& playback : scene.clips) {
+		float duration{ playback.sampler.clip().duration() };
+		playback.time = duration > 0 ? std::fmod(playback.time + dt, duration) : 0;
+		AnimationRate rate{ scene.animationLod.select(playback.viewDistance) };
+		// This frame's passes measure it again.
+		playback.viewDistance = std::numeric_limits<float>::infinity();
+		if (rate == AnimationRate::ClockOnly
+			|| (rate == AnimationRate::Reduced && ++playback.framesSinceSample < scene.animationLod.reducedInterval)) {
+			continue;
+		}
+		playback.framesSinceSample = 0;
+		auto& pose{ scene.objects[playback.object].getSkeletonPose() };
+		playback.sampler.sample(playback.time, pose->locals(), rate == AnimationRate::Reduced ? &playback.majorJoints : nullptr);
+		pose->markChanged();
+	}
+}
+
+/**
+ * @brief Bakes each of the scene's looping clips into vertex animation textures, and plays those
+ * instead of posing the object's skeleton. Each object starts at its first frame.
+ */
+void bakeVertexAnimations(Scene& scene, ShaderProgram& skinProgram) {
+	try {
+		for (auto& playback : scene.clips) {
+			const CompressedClip& clip{ playback.sampler.clip() };
+			scene.vertexAnimations.push_back(VertexAnimationPlayback{ playback.object,
+				VertexAnimation::bake(scene.objects[playback.object], clip, skinProgram, VertexAnimationSettings{}) });
+			scene.objects[playback.object].setVertexAnimationFrame(scene.vertexAnimations.back().animation.frameAt(0));
+		}
+	}
+	catch (std::runtime_error& e) {
+		std::cout << "ERROR: " << e.what() << std::endl;
+		exit(1);
+	}
+	scene.clips.clear();
+}
+
+/**
+ * @brief Advances the scene's vertex animations, looping them, and sets each object's frame at
+ * the rate the scene's AnimationLod picks, as playClips does. A baked frame moves every joint,
+ * so the reduced rate only sets frames less often; objects left unset hold last frame's.
+ */
+void playVertexAnimations(Scene& scene, float dt) {
+	for (auto& playback : scene.vertexAnimations) {
+		playback.time = std::fmod(playback.time + dt, std::max(playback.animation.duration(), 1e-3f));
+		AnimationRate rate{ scene.animationLod.select(playback.viewDistance) };
+		playback.viewDistance = std::numeric_limits<float>::infinity();
+		if (rate == AnimationRate::ClockOnly
+			|| (rate == AnimationRate::Reduced && ++playback.framesSinceSample < scene.animationLod.reducedInterval)) {
+			continue;
+		}
+		playback.framesSinceSample = 0;
+		scene.objects[playback.object].setVertexAnimationFrame(playback.animation.frameAt(playback.time));
+	}
+}
+
+/**
+ * @brief Poses every skinned object's skeleton from its joints' local transformations, uploads
+ * its skinning palette, and skins its meshes into their posed buffers. This is the only
+ * skinning done this frame: every pass then draws the posed meshes like static ones. Poses that
+ * have not changed since they were last skinned, and objects playing vertex animations, need none.
+ */
+void updateSkeletonPoses(Scene& scene, ShaderProgram& skinProgram) {
+	skinProgram.activate();
+	glEnable(GL_RASTERIZER_DISCARD);
+	for (auto& o : scene.objects) {
+		if (o.getVertexAnimationFrame() >= 0) {
+			continue;
+		}
+		if (auto& pose{ o.getSkeletonPose() }; pose && pose->changed()) {
+			pose->update();
+			pose->upload();
+			o.skin(skinProgram);
+		}
+	}
+	glDisable(GL_RASTERIZER_DISCARD);
+}
+
+/**
+ * @brief Prints the shaded-sample counts gathered by a DepthPrepass in Benchmark mode.
+ */
+void reportPrepassBenchmark(const std::string& passName, const DepthPrepass& prepass) {
+	std::cout << passName << " pass fragment shader invocations per pixel: "
+		<< prepass.benchmarkSamplesPerPixel(false) << " without depth prepass ("
+		<< prepass.benchmarkFrames(false) << " frames), "
+		<< prepass.benchmarkSamplesPerPixel(true) << " with depth prepass ("
+		<< prepass.benchmarkFrames(true) << " frames)" << std::endl;
+}
 
+int main(int argc, char* argv[]) {
+	if (std::find(argv + 1, argv + argc, std::string{ "--help" }) != argv + argc) {
+		printUsage(std::cout);
+		return 0;
+	}
+	std::cout << std::filesystem::current_path() << std::endl;
 
-	gladLoadGL();
+	// The governor trades rendering quality for frame time; every decision it makes is reported
+	// through the telemetry callback.
+	QualityGovernor governor{ governorFromArgs(argc, argv) };
+	governor.setTelemetryCallback([](const QualityDecision& d) {
+		if (d.action != QualityDecision::Action::Hold) {
+			std::cout << "quality: level " << d.fromLevel << " -> " << d.toLevel << " ("
+				<< d.measuredMs << " ms vs " << d.budgetMs << " ms budget, " << d.reason << ")" << std::endl;
+		}
+	});
+
+	// Initialize the window and OpenGL; or, headless, an offscreen context whose framebuffer
+	// stands in for the window's. Mocked OpenGL needs no context, but has no window either.
+	std::optional<glm::uvec2> headlessSize{ headlessSizeFromArgs(argc, argv) };
+	std::filesystem::path dumpFramesPath{ dumpFramesPathFromArgs(argc, argv) };
+	GlIntercept::Mode glMode{ glStatsFromArgs(argc, argv) };
+	bool mockGl{ glMode == GlIntercept::Mode::Mock };
+	// The flythrough times its frames and reports their OpenGL calls itself. A replay's timer
+	// queries would overlap its own, and with calls uncounted it would report none.
+	std::filesystem::path flythroughPath{ flythroughPathFromArgs(argc, argv) };
+	if (!flythroughPath.empty() && optionValue(argc, argv, "--replay")) {
+		std::cout << "ERROR: --flythrough and --replay each time the whole run; give only one" << std::endl;
+		exit(1);
+	}
+	if (!flythroughPath.empty() && glMode == GlIntercept::Mode::Off) {
+		std::cout << "ERROR: --flythrough reports OpenGL calls, so it needs --gl-stats on or mock" << std::endl;
+		exit(1);
+	}
+	if (mockGl && !headlessSize) {
+		std::cout << "ERROR: --gl-stats mock draws nothing to a window; it needs --headless" << std::endl;
+		exit(1);
+	}
+	std::optional<sf::Window> window{};
+	uint32_t screenFbo{ 0 };
+#ifdef HEADLESS_EGL
+	std::optional<HeadlessContext> headless{};
+	if (headlessSize && !mockGl) {
+		try {
+			headless.emplace(headlessSize->x, headlessSize->y);
+		}
+		catch (std::runtime_error& e) {
+			std::cout << "ERROR: " << e.what() << std::endl;
+			exit(1);
+		}
+		screenFbo = headless->framebuffer();
+		std::cout << "headless: " << glGetString(GL_RENDERER) << std::endl;
+		if (!dumpFramesPath.empty()) {
+			std::filesystem::create_directories(dumpFramesPath);
+		}
+	}
+#else
+	if (headlessSize && !mockGl) {
+		std::cout << "ERROR: this build has no headless context; it needs EGL" << std::endl;
+		exit(1);
+	}
+#endif
+	if (!headlessSize) {
+		sf::ContextSettings settings;
+		settings.depthBits = 24; // Request a 24 bits depth buffer
+		settings.stencilBits = 8;  // Request a 8 bits stencil buffer
+		settings.majorVersion = 3; // You might have to change these on Mac.
+		settings.minorVersion = 3;
+
+		window.emplace(
+			sf::VideoMode::getFullscreenModes().at(0), "Modern OpenGL",
+			sf::Style::Resize | sf::Style::Close,
+			sf::State::Windowed, settings
+		);
+
+		gladLoadGL();
+	}
+	// Every OpenGL call from here on is counted, in the pass it is made in.
+	GlIntercept::install(glMode);
 	glEnable(GL_DEPTH_TEST);
 	// Enable Backface Culling (Cull triangles whihc normal is not towards the camera)
 	//glEnable(GL_CULL_FACE);
@@ -455,164 +1390,507 @@ int main() {
 	auto pitch = -M_PI / 4;
 	auto moveSpeed = 3.0f;
 	auto rotationSpeed = 2.0f;
-	auto leftDoorClosed = false;
-	auto rightDoorClosed = false;
 	int activeCam = 0; // 0 - Stage, 1 - Cove
-	auto distanceMoved = 0.0f;
-	auto foxyVelocity = 2.0f;
-	auto foxyAcceleration = 1.4f;
-	bool alive = true;
-	bool foxyEvent = false;
-	bool foxyReset = false;
-	sf::Time foxyTrigger = sf::seconds(30.0f);
 
 	auto myScene{ fnaf(extraObj) };
+	myScene.impostorScreenSize = impostorSizeFromArgs(argc, argv);
 	// You can directly access specific objects in the scene using references.
 	auto& firstObject{ myScene.objects[0] };
-	auto& foxy{ myScene.objects[3] };
+
+	// The player's flashlight is a spot light that follows the player camera.
+	size_t flashlightIndex{ myScene.lights.size() };
+	PointLight flashlight{ playerCamera["cameraPos"], 8.0f, glm::vec3{ 1.0, 1.0, 0.9 } };
+	flashlight.cosInner = std::cos(0.2f);
+	flashlight.cosOuter = std::cos(0.35f);
+	myScene.lights.push_back(flashlight);
+
+	// Each camera pass bins the scene's lights into its own view frustum.
+	LightClusters securityClusters{};
+	LightClusters playerClusters{};
+
+	// Skinned meshes are posed once per frame, for every pass to draw.
+	ShaderProgram skinProgram{ skinningShader() };
+	if (vertexAnimationFromArgs(argc, argv)) {
+		bakeVertexAnimations(myScene, skinProgram);
+	}
+
+	// Each camera pass decides separately whether a depth prepass pays off.
+	ShaderProgram depthProgram{ depthOnlyShader() };
+	DepthPrepass::Mode prepassMode{ prepassModeFromArgs(argc, argv) };
+	DepthPrepass securityPrepass{ prepassMode };
+	DepthPrepass playerPrepass{ prepassMode };
+
+	// Shadows of the static rooms are cached; only the animatronics and doors are redrawn each frame.
+	ShadowAtlas shadows{ depthOnlyShader() };
+	shadows.setStaticCasters({ &myScene.objects[4], &myScene.objects[5], &myScene.objects[8] });
+	shadows.setDynamicCasters({ &myScene.objects[0], &myScene.objects[1], &myScene.objects[2], &myScene.objects[3],
+		&myScene.objects[6], &myScene.objects[7] });
+
+	// Shading level of detail: the 256x256 security feed never needs per-pixel lighting, and the
+	// player view only needs it up close. Turned off, every object is shaded per pixel.
+	constexpr float NEVER{ std::numeric_limits<float>::max() };
+	bool shadingLod{ shadingLodFromArgs(argc, argv) };
+	ShadingLod securityLod{ shadingLod ? ShadingLod{ ShadingLevel::PerVertex, 0.0f, 20.0f } : ShadingLod{ ShadingLevel::PerPixel, NEVER, NEVER } };
+	ShadingLod playerLod{ shadingLod ? ShadingLod{ ShadingLevel::PerPixel, 12.0f, 30.0f } : ShadingLod{ ShadingLevel::PerPixel, NEVER, NEVER } };
+
+	// Animation level of detail: characters no camera sees only keep time, and those only seen from
+	// across the building are posed every third frame, without their fingers and other short chains.
+	// Baked into vertex animations, they change frames at the same rates, with every joint.
+	if (animationLodFromArgs(argc, argv)) {
+		myScene.animationLod = AnimationLod{ 10.0f, 3, 0.1f, true };
+	}
+	for (auto& playback : myScene.clips) {
+		playback.majorJoints = myScene.animationLod.majorJoints(myScene.objects[playback.object].getSkeletonPose()->skeleton());
+	}
+
+	// The player view may be shaded deferred; the small security feed always stays forward.
+	ShadingPath playerShading{ playerShadingFromArgs(argc, argv) };
+	DeferredRenderer deferred{ gbufferShader(), deferredLightingShader() };
+
+	// The security feed may instead be drawn on the CPU, into the same texture.
+	std::optional<WorkerPool> softwarePool{};
+	std::optional<SoftwareRasterizer> softwareFeed{};
+	if (softwareFeedFromArgs(argc, argv)) {
+		softwarePool.emplace();
+		softwareFeed.emplace(width, height, *softwarePool);
+		// The monitor shows the feed's own last frame.
+		softwareFeed->addRenderTarget(colorBufferId);
+	}
 
 	// Activate the shader program.
 	myScene.program.activate();
 
-	// Start the animators.
-	//for (auto& anim : myScene.animators) {
-	//	anim.start();
+	// Start the animation sequences.
+	//for (uint32_t s{ 0 }; s < myScene.animator.sequenceCount(); ++s) {
+	//	myScene.animator.start(s);
 	//}
 
+	// Input comes from the keyboard, and may be recorded; or, replaying a recording as a benchmark,
+	// from the recording alone, with the night seeded as it was and every frame one simulation step.
+	std::optional<InputRecording> replay{ replayFromArgs(argc, argv) };
+	std::filesystem::path recordPath{ recordPathFromArgs(argc, argv) };
+	InputRecording recording{ replay ? replay->seed() : seedFromArgs(argc, argv) };
+	InputState input{};
+	size_t replayNext{ 0 };
+	float inputTime{ 0 };
+
+	// The night's rules run on their own; the scene animates what happens in it.
+	NightSettings nightSettings{};
+	nightSettings.seed = recording.seed();
+	FnafNight night{ nightSettings };
+	night.setEventCallback([&myScene](NightEvent event) { playNightEvent(myScene, event); });
+
+	// Gameplay is simulated in fixed steps, whatever the frame rate, and drawn between the last
+	// two of them. A frame never takes more than a quarter second's worth.
+	float simulationRate{ simulationRateFromArgs(argc, argv) };
+	FixedTimestep timestep{ 1.0f / simulationRate, static_cast<uint32_t>(std::ceil(simulationRate / 4)) };
+	TransformInterpolator interpolation{ 2.0f };
+	float previousCameraYaw{ cameraYaw };
+
+	// A replay times each pass of every frame. Quality is held where it starts, so that every run
+	// draws the same.
+	PassTimer passTimer{};
+	uint32_t framePass{ passTimer.addPass("Frame", false) };
+	uint32_t simulationPass{ passTimer.addPass("Simulation", false) };
+	uint32_t animationPass{ passTimer.addPass("Animation") };
+	uint32_t shadowPass{ passTimer.addPass("Shadows") };
+	uint32_t securityPass{ passTimer.addPass("Security feed") };
+	uint32_t playerPass{ passTimer.addPass("Player") };
+	// OpenGL calls are counted in the same passes, whether timed or not, and shown in the title.
+	uint32_t glAnimationPass{ GlIntercept::addPass("Animation") };
+	uint32_t glShadowPass{ GlIntercept::addPass("Shadows") };
+	uint32_t glSecurityPass{ GlIntercept::addPass("Security feed") };
+	uint32_t glPlayerPass{ GlIntercept::addPass("Player") };
+	// The draw call budgets to hold each counted pass to, by pass.
+	std::vector<std::pair<uint32_t, uint64_t>> glBudgets{};
+	for (auto& [name, draws] : glBudgetsFromArgs(argc, argv)) {
+		uint32_t pass{ 0 };
+		while (pass < GlIntercept::passCount() && GlIntercept::passName(pass) != name) {
+			++pass;
+		}
+		if (pass == GlIntercept::passCount()) {
+			std::cout << "ERROR: --gl-budget names no pass " << name << std::endl;
+			exit(1);
+		}
+		if (glMode == GlIntercept::Mode::Off) {
+			std::cout << "ERROR: --gl-budget needs OpenGL calls counted, not --gl-stats off" << std::endl;
+			exit(1);
+		}
+		glBudgets.emplace_back(pass, draws);
+	}
+	float glStatsShown{ 0 };
+	// The benchmark flythrough flies the cameras itself, a simulation step per frame, with quality
+	// held likewise.
+	std::optional<FlythroughBenchmark> flythrough{};
+	if (!flythroughPath.empty()) {
+		flythrough.emplace(fnafFlythrough());
+	}
+	bool scripted{ replay || flythrough };
+	if (scripted) {
+		governor.setLevels({ governor.settings() });
+	}
+
 	// Ready, set, go!
 	bool running{ true };
 	sf::Clock c;
 
 	auto last{ c.getElapsedTime() };
+	uint64_t frameNumber{ 0 };
+	uint64_t frameLimit{ frameLimitFromArgs(argc, argv) };
 
-	
-	while (window.isOpen()) {
-		// Check for events.
-		while (const std::optional event{ window.pollEvent() }) {
-			if (event->is<sf::Event::Closed>()) {
-				window.close();
-			}
-			doorAction(myScene, leftDoorClosed, rightDoorClosed, event);
-			cameraAction(securityCamera, activeCam, stageCamera, coveCamera, hallCamera, event);
+	while (running) {
+		if (replay) {
+			passTimer.begin(framePass);
+		}
+		if (flythrough) {
+			flythrough->beginFrame();
 		}
 		auto now{ c.getElapsedTime() };
 		auto diff{ now - last };
 		last = now;
+		auto deltaTime = scripted ? timestep.step() : diff.asSeconds();
+		inputTime += deltaTime;
 
-		auto deltaTime = diff.asSeconds();
-		movement(playerCamera["cameraPos"], playerCamera["cameraForwards"], yaw, deltaTime, moveSpeed, rotationSpeed);
+		// Check for events. Unscripted, keys go to the input state, and to the recording.
+		input.beginFrame();
+		std::vector<InputEvent> keyEvents{};
+		while (const std::optional event{ window ? window->pollEvent() : std::nullopt }) {
+			if (event->is<sf::Event::Closed>()) {
+				running = false;
+			}
+			// Scripted runs take their input from the script alone, whatever the window sees.
+			if (scripted) {
+				continue;
+			}
+			if (event->is<sf::Event::FocusLost>()) {
+				input.releaseAll(inputTime, keyEvents);
+			}
+			if (auto* pressed{ event->getIf<sf::Event::KeyPressed>() }) {
+				if (auto key{ inputKey(pressed->code) }) {
+					keyEvents.push_back(InputEvent{ inputTime, *key, true });
+				}
+			}
+			if (auto* released{ event->getIf<sf::Event::KeyReleased>() }) {
+				if (auto key{ inputKey(released->code) }) {
+					keyEvents.push_back(InputEvent{ inputTime, *key, false });
+				}
+			}
+		}
+		if (replay) {
+			replayNext = replay->replay(replayNext, inputTime, input);
+			if (inputTime > replay->duration()) {
+				running = false;
+			}
+		}
+		else if (!flythrough) {
+			for (auto& keyEvent : keyEvents) {
+				input.apply(keyEvent);
+				recording.add(keyEvent);
+			}
+		}
+		doorAction(myScene, night, input);
+		cameraAction(securityCamera, activeCam, stageCamera, coveCamera, hallCamera, input);
+
+		governor.recordFrame(deltaTime);
+		const QualitySettings& quality{ governor.settings() };
+		movement(input, playerCamera["cameraPos"], playerCamera["cameraForwards"], yaw, deltaTime, moveSpeed, rotationSpeed);
 
 #ifdef LOG_FPS
 		// FPS calculation.
 		std::cout << 1 / diff.asSeconds() << " FPS " << std::endl;
 #endif
 
-		std::cout << playerCamera["cameraPos"].x << playerCamera["cameraPos"].y << playerCamera["cameraPos"].z << std::endl;
-
-		// Foxy running down hallway
-		if (c.getElapsedTime() > foxyTrigger && c.getElapsedTime() < foxyTrigger + sf::seconds(1.0f)) {
-			foxyEvent = true;
+		// Scripted and headless runs are timed, and their camera follows the script anyway.
+		if (!scripted && !headlessSize) {
+			std::cout << playerCamera["cameraPos"].x << playerCamera["cameraPos"].y << playerCamera["cameraPos"].z << std::endl;
 		}
-		auto deltaMove = (foxyAcceleration * foxyVelocity) * deltaTime;
-		if (foxyEvent && distanceMoved < 8) {
-			foxy.move(glm::vec3{ deltaMove, 0, deltaMove });
-			distanceMoved += deltaMove;
-		}
-		if (foxyEvent && distanceMoved > 8 && distanceMoved < 32) {
-			foxy.move(glm::vec3{ 0, 0, deltaMove });
-			distanceMoved += deltaMove;
+
+		// Simulate the gameplay: step the night, play the animator's sequences and pan the Stage
+		// Camera, a fixed step at a time.
+		if (replay) {
+			passTimer.begin(simulationPass);
 		}
-		if (foxyEvent && distanceMoved > 32) { // If Foxy reaches office and door isn't closed
-			if (!leftDoorClosed && alive) {
-				foxy.rotate(glm::vec3{ 0, 0, -M_PI / 8 });
-				alive = false;
+		uint32_t steps{ timestep.accumulate(deltaTime) };
+		for (uint32_t step{ 0 }; step < steps; ++step) {
+			interpolation.beginStep(myScene.objects);
+			previousCameraYaw = cameraYaw;
+			night.step(timestep.step());
+			placeFoxy(myScene, night);
+			myScene.animator.tick(timestep.step());
+
+			cameraYaw += deltaYaw * timestep.step();
+			if (cameraYaw > -M_PI / 4) {
+				cameraYaw = -M_PI / 4;
+				deltaYaw = -glm::abs(deltaYaw);
 			}
-			if (leftDoorClosed) {
-				foxyEvent = false;
-				foxyReset = true;
+			if (cameraYaw < -3 * M_PI / 4) {
+				cameraYaw = -3 * M_PI / 4;
+				deltaYaw = glm::abs(deltaYaw);
 			}
 		}
-		if (foxyReset) {
-			foxy.setPosition(glm::vec3{ -9, -.55, -28 });
-			foxy.setOrientation(glm::vec3{ 0, M_PI / 4, 0 });
-			foxyReset = false;
+		if (replay) {
+			passTimer.end(simulationPass);
 		}
+		// Everything below draws the scene between the last two steps.
+		interpolation.beginRender(myScene.objects, timestep.alpha());
 
 		// Tilt the Stage Camera down
+		float renderYaw{ glm::mix(previousCameraYaw, cameraYaw, timestep.alpha()) };
 		glm::vec3 front;
-		front.x = cos(pitch) * cos(cameraYaw);
+		front.x = cos(pitch) * cos(renderYaw);
 		front.y = sin(pitch);
-		front.z = cos(pitch) * sin(cameraYaw);
+		front.z = cos(pitch) * sin(renderYaw);
 		securityCamera["cameraForwards"] = glm::normalize(front);
 
-		cameraYaw += deltaYaw * deltaTime;
-		if (cameraYaw > -M_PI / 4) {
-			cameraYaw = -M_PI / 4;
-			deltaYaw = -glm::abs(deltaYaw);
-		}
-		if (cameraYaw < -3 * M_PI / 4) {
-			cameraYaw = -3 * M_PI / 4;
-			deltaYaw = glm::abs(deltaYaw);
+		if (flythrough) {
+			for (auto [camera, path] : { std::pair{ &playerCamera, &flythrough->segment().player },
+				std::pair{ &securityCamera, &flythrough->segment().security } }) {
+				CameraPose pose{ path->sample(flythrough->segmentTime()) };
+				(*camera)["cameraPos"] = pose.position;
+				(*camera)["cameraForwards"] = pose.forwards;
+			}
 		}
 
-		// Security Camera
-		glBindFramebuffer(GL_FRAMEBUFFER, myFbo);
-
-		glViewport(0, 0, width, height);
-
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		
-		glm::mat4 securityCameraMat{ glm::lookAt(securityCamera["cameraPos"], securityCamera["cameraPos"] + securityCamera["cameraForwards"], securityCamera["cameraUp"]) };
-		glm::mat4 securityPerspective{ glm::perspective(glm::radians(45.0f), static_cast<float>(width) / height, 0.1f, 100.0f)};
+		updateProbeLighting(myScene);
+		GlIntercept::beginPass(glAnimationPass);
+		if (replay) {
+			passTimer.begin(animationPass);
+		}
+		playClips(myScene, deltaTime);
+		playVertexAnimations(myScene, deltaTime);
+		updateSkeletonPoses(myScene, skinProgram);
+		if (replay) {
+			passTimer.end(animationPass);
+		}
+		GlIntercept::endPass();
+
+		// Shadow maps are shared by every camera pass: the main directional light first, then each
+		// shadowed spot light while atlas tiles last.
+		myScene.lights[flashlightIndex].position = playerCamera["cameraPos"];
+		myScene.lights[flashlightIndex].direction = playerCamera["cameraForwards"];
+		std::vector<ShadowView> shadowViews{ ShadowAtlas::directionalView(FNAF_DIRECTIONAL_LIGHT, glm::vec3{ -4, 0, -12 }, 24.0f) };
+		for (auto& light : myScene.lights) {
+			light.shadowTile = -1;
+			if (light.castsShadows && shadowViews.size() < shadows.tileCount()) {
+				light.shadowTile = static_cast<int32_t>(shadowViews.size());
+				shadowViews.push_back(ShadowAtlas::spotView(light));
+			}
+		}
+		GlIntercept::beginPass(glShadowPass);
+		if (replay) {
+			passTimer.begin(shadowPass);
+		}
+		shadows.setTileResolution(quality.shadowResolution);
+		shadows.update(shadowViews);
+		if (replay) {
+			passTimer.end(shadowPass);
+		}
+		GlIntercept::endPass();
+
+		// Security Camera. The feed keeps showing its last image on frames it is not refreshed.
+		bool updateFeed{ frameNumber++ % quality.feedUpdateInterval == 0 };
+		if (updateFeed) {
+			GlIntercept::beginPass(glSecurityPass);
+			if (replay) {
+				passTimer.begin(securityPass);
+			}
+			glm::mat4 securityCameraMat{ glm::lookAt(securityCamera["cameraPos"], securityCamera["cameraPos"] + securityCamera["cameraForwards"], securityCamera["cameraUp"]) };
+			glm::mat4 securityPerspective{ glm::perspective(glm::radians(45.0f), static_cast<float>(width) / height, 0.1f, quality.drawDistance)};
+			recordClipVisibility(myScene, securityCameraMat, securityPerspective, securityCamera["cameraPos"]);
+
+			if (softwareFeed) {
+				// Lit as the GPU feed is, without its shadows and baked light, then uploaded whole.
+				SoftwareLighting lighting{ glm::vec3(1, 1, 1), glm::vec3(0, 1, -1), FNAF_DIRECTIONAL_COLOR, myScene.lights };
+				softwareFeed->beginFrame(securityCameraMat, securityPerspective, securityCamera["cameraPos"], lighting);
+				for (auto& o : myScene.objects) {
+					o.forEachMeshTransformed(glm::mat4{ 1 }, [&](const Mesh& mesh, const glm::mat4& model, const glm::vec4& material) {
+						softwareFeed->draw(mesh, model, material);
+					});
+				}
+				softwareFeed->endFrame();
+				glBindTexture(GL_TEXTURE_2D, colorBufferId);
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, softwareFeed->pixels().data());
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+				glBindTexture(GL_TEXTURE_2D, 0);
+			}
+			else {
+				glBindFramebuffer(GL_FRAMEBUFFER, myFbo);
 
-		myScene.program.setUniform("projection", securityPerspective);
-		myScene.program.setUniform("view", securityCameraMat);
-		myScene.program.setUniform("cameraPos", securityCamera["cameraPos"]);
+				glViewport(0, 0, width, height);
 
-		myScene.program.setUniform("directionalLight", glm::vec3(0, 1, -1));
-		myScene.program.setUniform("ambientColor", glm::vec3(1, 1, 1));
-		//myScene.program.setUniform("directionalLight", glm::vec3(-1, -1, -1));
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+				securityClusters.update(myScene.lights, securityCameraMat, securityPerspective, 0.1f, quality.drawDistance,
+					securityCamera["cameraPos"], quality.maxLights);
+				// The feed's directional light points elsewhere, so the shadow map doesn't apply to it.
+				// Lightmapped rooms show their baked lighting either way.
+				for (ShaderProgram* program : lightingPrograms(myScene)) {
+					setPassUniforms(*program, securityCameraMat, securityPerspective, securityCamera["cameraPos"],
+						glm::vec3(0, 1, -1), -1, securityClusters, glm::vec2{ static_cast<float>(width), static_cast<float>(height) }, shadows);
+				}
 
-		for (auto& o : myScene.objects) {
-			o.render(myScene.program);
+				renderObjects(myScene, depthProgram, securityPrepass, securityCameraMat, securityPerspective,
+					glm::vec2{ static_cast<float>(width), static_cast<float>(height) }, securityCamera["cameraPos"], securityLod, quality.lodBias);
+			}
+			if (replay) {
+				passTimer.end(securityPass);
+			}
+			GlIntercept::endPass();
 		}
 
 		// Player Camera
-	    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GlIntercept::beginPass(glPlayerPass);
+		if (replay) {
+			passTimer.begin(playerPass);
+		}
+		uint32_t screenWidth{ window ? window->getSize().x : headlessSize->x };
+		uint32_t screenHeight{ window ? window->getSize().y : headlessSize->y };
+	    glBindFramebuffer(GL_FRAMEBUFFER, screenFbo);
 
-		glViewport(0, 0, window.getSize().x, window.getSize().y);
+		glViewport(0, 0, screenWidth, screenHeight);
 	
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		
 		glm::mat4 playerCameraMat{ glm::lookAt(playerCamera["cameraPos"], playerCamera["cameraPos"] + playerCamera["cameraForwards"], playerCamera["cameraUp"]) };
-		glm::mat4 playerPerspective{ glm::perspective(glm::radians(45.0f), static_cast<float>(window.getSize().x) / window.getSize().y, 0.1f, 100.0f) };
-		myScene.program.setUniform("view", playerCameraMat);
-		myScene.program.setUniform("projection", playerPerspective);
-		myScene.program.setUniform("cameraPos", playerCamera["cameraPos"]);
+		glm::mat4 playerPerspective{ glm::perspective(glm::radians(45.0f), static_cast<float>(screenWidth) / screenHeight, 0.1f, quality.drawDistance) };
+
+		playerClusters.update(myScene.lights, playerCameraMat, playerPerspective, 0.1f, quality.drawDistance,
+			playerCamera["cameraPos"], quality.maxLights);
+		recordClipVisibility(myScene, playerCameraMat, playerPerspective, playerCamera["cameraPos"]);
+
+		if (playerShading == ShadingPath::Deferred) {
+			std::vector<bool> asImpostor{ impostorSelection(myScene, playerCameraMat, playerPerspective, static_cast<float>(screenHeight)) };
+			deferred.geometryPass(myScene.objects, playerCameraMat, playerPerspective, screenWidth, screenHeight, asImpostor);
+
+			ShaderProgram& lighting{ deferred.lightingProgram() };
+			lighting.activate();
+			lighting.setUniform("ambientColor", glm::vec3(1, 1, 1));
+			lighting.setUniform("directionalLight", FNAF_DIRECTIONAL_LIGHT);
+			lighting.setUniform("directionalColor", FNAF_DIRECTIONAL_COLOR);
+			shadows.bind(lighting);
+			lighting.setUniform("directionalShadowTile", 0);
+			deferred.lightingPass(screenFbo, playerCameraMat, playerPerspective, playerCamera["cameraPos"], playerClusters);
+
+			// Impostors are lit as they are drawn, over the lit G-buffer and its copied depth.
+			if (!myScene.impostors.empty()) {
+				setPassUniforms(myScene.impostorProgram, playerCameraMat, playerPerspective, playerCamera["cameraPos"], FNAF_DIRECTIONAL_LIGHT, 0,
+					playerClusters, glm::vec2{ static_cast<float>(screenWidth), static_cast<float>(screenHeight) }, shadows);
+				renderImpostors(myScene, asImpostor, playerCamera["cameraPos"]);
+			}
+		}
+		else {
+			// The lightmaps were baked with the same directional light the player's view uses.
+			for (ShaderProgram* program : lightingPrograms(myScene)) {
+				setPassUniforms(*program, playerCameraMat, playerPerspective, playerCamera["cameraPos"], FNAF_DIRECTIONAL_LIGHT, 0,
+					playerClusters, glm::vec2{ static_cast<float>(screenWidth), static_cast<float>(screenHeight) }, shadows);
+			}
+
+			// Clear the OpenGL "context".
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			// Render the scene objects.
+			renderObjects(myScene, depthProgram, playerPrepass, playerCameraMat, playerPerspective,
+				glm::vec2{ static_cast<float>(screenWidth), static_cast<float>(screenHeight) }, playerCamera["cameraPos"], playerLod, quality.lodBias);
+		}
 
-		myScene.program.setUniform("ambientColor", glm::vec3(1, 1, 1));
-		//myScene.program.setUniform("directionalLight", glm::vec3(-1, -1, -1));
-		myScene.program.setUniform("directionalLight", glm::vec3(0, -1, -1));
-		myScene.program.setUniform("directionalColor", glm::vec3(1, 1, 1));
 
-		// Update the scene.
-		for (auto& anim : myScene.animators) {
-			anim.tick(diff.asSeconds());
+		if (replay) {
+			passTimer.end(playerPass);
 		}
+		GlIntercept::endPass();
 
-		// Clear the OpenGL "context".
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		// Render the scene objects.
-		for (auto& o : myScene.objects) {
-			o.render(myScene.program);
+		if (window) {
+			window->display();
+		}
+#ifdef HEADLESS_EGL
+		else if (headless && !dumpFramesPath.empty()) {
+			std::string number{ std::to_string(frameNumber) };
+			try {
+				headless->saveFrame(dumpFramesPath / ("frame_" + std::string(std::max<size_t>(number.size(), 5) - number.size(), '0') + number + ".ppm"));
+			}
+			catch (std::runtime_error& e) {
+				std::cout << "ERROR: " << e.what() << std::endl;
+				return 1;
+			}
+		}
+#endif
+		interpolation.endRender(myScene.objects);
+
+		// Once a second, the window's title shows the OpenGL calls of the last frame.
+		GlIntercept::endFrame();
+		if (window && glMode != GlIntercept::Mode::Off && inputTime - glStatsShown >= 1) {
+			glStatsShown = inputTime;
+			RenderStats calls{};
+			for (uint32_t pass{ 0 }; pass < GlIntercept::passCount(); ++pass) {
+				calls += GlIntercept::lastFrame(pass);
+			}
+			window->setTitle("Modern OpenGL - " + std::to_string(calls.draws) + " draws, "
+				+ std::to_string(calls.triangles) + " triangles, " + std::to_string(calls.stateChanges) + " state changes, "
+				+ std::to_string(calls.uniformUploads) + " uniform uploads, " + std::to_string(calls.redundantCalls) + " redundant");
+		}
+		if (replay) {
+			passTimer.end(framePass);
+		}
+		if (flythrough) {
+			flythrough->endFrame(deltaTime);
+			if (flythrough->done()) {
+				running = false;
+			}
 		}
+		if (frameNumber >= frameLimit) {
+			running = false;
+		}
+	}
 
+	if (flythrough) {
+		try {
+			flythrough->writeJson(flythroughPath, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+		}
+		catch (std::runtime_error& e) {
+			std::cout << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+		std::cout << "Wrote flythrough results to " << flythroughPath << std::endl;
+	}
+
+	if (replay) {
+		passTimer.finish();
+		std::cout << "Replayed " << replay->events().size() << " input events over " << replay->duration()
+			<< " s (seed " << replay->seed() << ")" << std::endl;
+		passTimer.report(std::cout);
+	}
+	else if (!recordPath.empty()) {
+		recording.setDuration(inputTime);
+		try {
+			recording.save(recordPath);
+		}
+		catch (std::runtime_error& e) {
+			std::cout << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+		std::cout << "Recorded " << recording.events().size() << " input events to " << recordPath << std::endl;
+	}
+	// A benchmark, or a run with OpenGL mocked, reports the calls each pass made.
+	if ((replay || mockGl) && glMode != GlIntercept::Mode::Off) {
+		GlIntercept::report(std::cout);
+	}
+	// Going over a budget fails the run, so that a scripted run catches draw call regressions.
+	bool overBudget{ false };
+	for (auto& [pass, draws] : glBudgets) {
+		uint64_t peak{ GlIntercept::peakFrame(pass).draws };
+		if (peak > draws) {
+			std::cout << "ERROR: " << GlIntercept::passName(pass) << " made " << peak << " draw calls in a frame, over its budget of "
+				<< draws << std::endl;
+			overBudget = true;
+		}
+	}
 
-		window.display();
+	if (prepassMode == DepthPrepass::Mode::Benchmark) {
+		reportPrepassBenchmark("Security feed", securityPrepass);
+		reportPrepassBenchmark("Player", playerPrepass);
 	}
 
-	return 0;
+	return overBudget ? 1 : 0;
 }
 
 